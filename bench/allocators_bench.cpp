@@ -0,0 +1,79 @@
+// Benchmark dos alocadores (include/allocators.h).
+//
+// Compara, para listas temporárias montadas a cada frame, std::vector (heap
+// geral) com std::pmr::vector sobre uma LinearArena reiniciada a cada frame.
+//
+// Além do tempo, mostra quantas alocações no heap cada frame fez (contadas
+// pelos operadores globais substituídos em allocators.cpp).
+#include <chrono>
+#include <cstdio>
+#include <memory_resource>
+#include <vector>
+
+#include "allocators.h"
+
+static const size_t NUM_FRAMES = 60;
+static const size_t LISTS_PER_FRAME = 1000;
+static const size_t ITEMS_PER_LIST = 100;
+
+struct Result
+{
+    double ms;
+    double allocations;
+};
+
+static void Print(const char* label, const Result& r)
+{
+    printf("%-28s %8.3f ms/frame  %10.1f heap allocations/frame\n", label, r.ms, r.allocations);
+}
+
+template <typename Frame>
+static Result Measure(Frame frame)
+{
+    // Um frame de aquecimento, para que a arena atinja seu tamanho de
+    // regime.
+    frame();
+    HeapStats before = GetHeapStats();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t f = 0; f < NUM_FRAMES; ++f)
+        frame();
+    auto end = std::chrono::steady_clock::now();
+    HeapStats after = GetHeapStats();
+    Result r;
+    r.ms = std::chrono::duration<double, std::milli>(end - start).count() / NUM_FRAMES;
+    r.allocations = (double)(after.allocations - before.allocations) / NUM_FRAMES;
+    return r;
+}
+
+int main(int, char**)
+{
+    printf("Temporary lists: %zu lists of %zu items built per frame\n", LISTS_PER_FRAME, ITEMS_PER_LIST);
+    size_t checksum = 0;
+
+    Result heap_lists = Measure([&]() {
+        for (size_t l = 0; l < LISTS_PER_FRAME; ++l)
+        {
+            std::vector<uint32_t> list;
+            for (size_t i = 0; i < ITEMS_PER_LIST; ++i)
+                list.push_back((uint32_t)(l * i));
+            checksum += list.back();
+        }
+    });
+    Print("std::vector", heap_lists);
+
+    LinearArena arena;
+    Result arena_lists = Measure([&]() {
+        arena.Reset();
+        for (size_t l = 0; l < LISTS_PER_FRAME; ++l)
+        {
+            std::pmr::vector<uint32_t> list(&arena);
+            for (size_t i = 0; i < ITEMS_PER_LIST; ++i)
+                list.push_back((uint32_t)(l * i));
+            checksum += list.back();
+        }
+    });
+    Print("std::pmr::vector + arena", arena_lists);
+    printf("%-28s %8.2fx  (arena high water %zu KiB)\n", "", heap_lists.ms / arena_lists.ms, arena.HighWater() / 1024);
+
+    return checksum == 0 ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+// Benchmark do controle da resolução dinâmica (include/dynamic_resolution.h).
+//
+// Simula uma GPU em que o frame custa uma parte fixa (a interface) mais uma
+// parte proporcional ao número de pixels da cena (escala ao quadrado), com
+// os tempos chegando GpuTimer::LATENCY frames depois, como no programa. Para
+// cada cenário mostra quantos frames o controle leva para colocar o tempo
+// dentro de 5% do orçamento, a escala final, o tempo médio e o pior tempo
+// depois de estabilizar, e quantas vezes a escala mudou nos últimos frames
+// (mudanças demais fazem a imagem "pulsar"). Termina com erro se, em algum
+// cenário, a escala mudou mais de MAX_STEADY_CHANGES vezes nesses frames.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "dynamic_resolution.h"
+
+static const int LATENCY = 4; // GpuTimer::LATENCY
+static const int NUM_FRAMES = 900;
+static const int STEADY_FRAMES = 200; // últimos frames de cada fase
+static const float TARGET_MS = 16.6f;
+static const int MAX_STEADY_CHANGES = 3;
+
+struct Scenario
+{
+    const char* name;
+    float fixed_ms;       // parte que não depende da escala
+    float full_scene_ms;  // cena na escala 1.0
+    float step_scene_ms;  // cena na escala 1.0 entre os frames 300 e 600
+    float noise;          // variação aleatória de cada frame (fração)
+};
+
+int main(int, char**)
+{
+    const Scenario scenarios[] = {
+        { "Light scene (fits at 100%)", 1.0f, 10.0f, 10.0f, 0.0f },
+        { "Heavy scene (30 ms at 100%)", 1.0f, 30.0f, 30.0f, 0.0f },
+        { "Heavy scene, 10% noise", 1.0f, 30.0f, 30.0f, 0.10f },
+        { "Load step 30 -> 60 -> 30 ms", 1.0f, 30.0f, 60.0f, 0.05f },
+    };
+
+    printf("Budget %.1f ms, results arrive %d frames late\n", TARGET_MS, LATENCY);
+    printf("  %-30s %8s %7s %9s %9s %8s\n", "Scenario", "settle", "scale", "avg ms", "worst ms", "changes");
+    bool pulsing = false;
+    for (const Scenario& scenario : scenarios)
+    {
+        srand(1);
+        DynamicResolution controller;
+        controller.SetTarget(TARGET_MS, 0.25f, 1.0f);
+        float scales[NUM_FRAMES + 1]; // escala de cada frame
+        float times[NUM_FRAMES];      // tempo de GPU de cada frame
+        std::fill(scales, scales + NUM_FRAMES + 1, 1.0f);
+        int settle = -1;
+        double sum_ms = 0.0;
+        float worst_ms = 0.0f;
+        int changes = 0;
+        for (int frame = 0; frame < NUM_FRAMES; ++frame)
+        {
+            // O frame desenhado agora usa a escala calculada para ele.
+            float scene_ms = frame >= 300 && frame < 600 ? scenario.step_scene_ms : scenario.full_scene_ms;
+            float noise = 1.0f + scenario.noise * (2.0f * rand() / (float)RAND_MAX - 1.0f);
+            float scale = scales[frame];
+            float gpu_ms = (scenario.fixed_ms + scene_ms * scale * scale) * noise;
+
+            times[frame] = gpu_ms;
+
+            // E o controle recebe o tempo de LATENCY frames atrás.
+            if (frame >= LATENCY)
+                scales[frame + 1] = controller.Update((uint64_t)(frame - LATENCY + 1), times[frame - LATENCY]);
+            else
+                scales[frame + 1] = controller.Scale();
+
+            if (settle < 0 && std::fabs(gpu_ms - TARGET_MS) <= 0.05f * TARGET_MS)
+                settle = frame;
+            if (frame >= NUM_FRAMES - STEADY_FRAMES)
+            {
+                sum_ms += gpu_ms / STEADY_FRAMES;
+                worst_ms = std::max(worst_ms, gpu_ms);
+                if (scales[frame + 1] != scales[frame])
+                    ++changes;
+            }
+        }
+        char settle_text[16];
+        if (settle < 0)
+            snprintf(settle_text, sizeof(settle_text), "-");
+        else
+            snprintf(settle_text, sizeof(settle_text), "%d", settle);
+        printf("  %-30s %8s %6.0f%% %9.2f %9.2f %8d%s\n", scenario.name, settle_text, controller.Scale() * 100.0f,
+               sum_ms, worst_ms, changes, changes > MAX_STEADY_CHANGES ? "  <- pulsing" : "");
+        pulsing = pulsing || changes > MAX_STEADY_CHANGES;
+    }
+    if (pulsing)
+    {
+        fprintf(stderr, "ERROR: the scale changed more than %d times in the last %d frames of a scenario.\n",
+                MAX_STEADY_CHANGES, STEADY_FRAMES);
+        return 1;
+    }
+    return 0;
+}
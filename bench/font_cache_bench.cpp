@@ -0,0 +1,149 @@
+// Benchmark do cache do atlas de fontes (include/font_cache.h).
+//
+// Para dois conjuntos de fontes de misc/fonts (o do programa, veja
+// Interface::LoadFonts(), e um maior, com todas as fontes em três tamanhos)
+// mede o tempo de construir o atlas rasterizando os glyphs, como na
+// primeira execução, e o de carregá-lo do cache, como nas seguintes; depois
+// confere que o atlas carregado é igual ao construído. Deve ser executado de
+// dentro de bin/, como o programa principal, para encontrar as fontes.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "font_cache.h"
+
+static const int NUM_RUNS = 10;
+static const char* CACHE_PATH = "font_cache_bench.cache";
+
+struct FontFile
+{
+    const char* path;
+    float size;
+    bool cyrillic;
+};
+
+static const FontFile APP_FONTS[] = {
+    { "../misc/fonts/Roboto-Medium.ttf",   16.0f, false },
+    { "../misc/fonts/Cousine-Regular.ttf", 15.0f, false },
+    { "../misc/fonts/DroidSans.ttf",       18.0f, true  },
+    { "../misc/fonts/Karla-Regular.ttf",   16.0f, false },
+    { "../misc/fonts/ProggyTiny.ttf",      10.0f, false },
+};
+
+static const char* ALL_FILES[] = {
+    "../misc/fonts/Roboto-Medium.ttf", "../misc/fonts/Cousine-Regular.ttf", "../misc/fonts/DroidSans.ttf",
+    "../misc/fonts/Karla-Regular.ttf", "../misc/fonts/ProggyClean.ttf", "../misc/fonts/ProggyTiny.ttf",
+};
+
+// Adiciona as fontes de um conjunto ao atlas. Retorna false se falta algum
+// arquivo.
+static bool AddFonts(ImFontAtlas& atlas, bool heavy)
+{
+    atlas.AddFontDefault();
+    if (!heavy)
+    {
+        for (const FontFile& font : APP_FONTS)
+            if (atlas.AddFontFromFileTTF(font.path, font.size, NULL, font.cyrillic ? atlas.GetGlyphRangesCyrillic() : NULL) == NULL)
+                return false;
+        return true;
+    }
+    static const float sizes[] = { 13.0f, 18.0f, 24.0f };
+    for (const char* path : ALL_FILES)
+        for (float size : sizes)
+            if (atlas.AddFontFromFileTTF(path, size, NULL, atlas.GetGlyphRangesCyrillic()) == NULL)
+                return false;
+    return true;
+}
+
+// Campo a campo: ImFontGlyph tem bytes de preenchimento depois de Codepoint,
+// com lixo diferente em cada construção.
+static bool SameGlyph(const ImFontGlyph& a, const ImFontGlyph& b)
+{
+    return a.Codepoint == b.Codepoint && a.AdvanceX == b.AdvanceX && a.X0 == b.X0 && a.Y0 == b.Y0 && a.X1 == b.X1 &&
+           a.Y1 == b.Y1 && a.U0 == b.U0 && a.V0 == b.V0 && a.U1 == b.U1 && a.V1 == b.V1;
+}
+
+static bool SameAtlas(const ImFontAtlas& a, const ImFontAtlas& b)
+{
+    if (a.TexWidth != b.TexWidth || a.TexHeight != b.TexHeight || a.Fonts.Size != b.Fonts.Size ||
+        memcmp(a.TexPixelsAlpha8, b.TexPixelsAlpha8, (size_t)a.TexWidth * a.TexHeight) != 0 ||
+        a.TexUvWhitePixel.x != b.TexUvWhitePixel.x || a.TexUvWhitePixel.y != b.TexUvWhitePixel.y)
+        return false;
+    for (int i = 0; i < a.Fonts.Size; ++i)
+    {
+        const ImFont* fa = a.Fonts[i];
+        const ImFont* fb = b.Fonts[i];
+        if (fa->Glyphs.Size != fb->Glyphs.Size || fa->IndexLookup.Size != fb->IndexLookup.Size ||
+            fa->FontSize != fb->FontSize || fa->Ascent != fb->Ascent || fa->Descent != fb->Descent ||
+            fa->FallbackAdvanceX != fb->FallbackAdvanceX || fa->EllipsisChar != fb->EllipsisChar)
+            return false;
+        for (int g = 0; g < fa->Glyphs.Size; ++g)
+            if (!SameGlyph(fa->Glyphs[g], fb->Glyphs[g]))
+                return false;
+    }
+    return true;
+}
+
+static bool Run(const char* name, bool heavy)
+{
+    remove(CACHE_PATH);
+    double build_ms = 0.0, load_ms = 0.0;
+    bool same = true;
+    int glyphs = 0, fonts = 0, width = 0, height = 0;
+    for (int run = 0; run < NUM_RUNS; ++run)
+    {
+        // Sem cache: rasteriza tudo (e, na primeira vez, grava o cache).
+        ImFontAtlas built;
+        if (!AddFonts(built, heavy))
+        {
+            fprintf(stderr, "ERROR: fonts not found; run from bin/.\n");
+            return false;
+        }
+        FontAtlasStats stats;
+        BuildFontAtlas(&built, NULL, &stats);
+        build_ms += stats.milliseconds / NUM_RUNS;
+        if (run == 0 && !SaveFontAtlasCache(&built, CACHE_PATH))
+        {
+            fprintf(stderr, "ERROR: could not write \"%s\".\n", CACHE_PATH);
+            return false;
+        }
+
+        // Com cache. O tempo inclui o cálculo da chave (o hash das fontes).
+        ImFontAtlas loaded;
+        AddFonts(loaded, heavy);
+        BuildFontAtlas(&loaded, CACHE_PATH, &stats);
+        load_ms += stats.milliseconds / NUM_RUNS;
+        same = same && stats.cache_hit && SameAtlas(built, loaded);
+
+        fonts = built.Fonts.Size;
+        width = built.TexWidth;
+        height = built.TexHeight;
+        glyphs = 0;
+        for (int i = 0; i < built.Fonts.Size; ++i)
+            glyphs += built.Fonts[i]->Glyphs.Size;
+    }
+
+    FILE* file = fopen(CACHE_PATH, "rb");
+    long size = 0;
+    if (file != NULL)
+    {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fclose(file);
+    }
+    remove(CACHE_PATH);
+
+    printf("%s: %d fonts, %d glyphs, %dx%d atlas, cache %.1f KiB\n", name, fonts, glyphs, width, height, size / 1024.0);
+    printf("  %-22s %10.2f ms\n", "Build (no cache)", build_ms);
+    printf("  %-22s %10.2f ms\n", "Load from cache", load_ms);
+    printf("  %-22s %10.1fx\n", "Speedup", build_ms / load_ms);
+    printf("  Loaded atlas identical to built: %s\n", same ? "yes" : "NO");
+    return same;
+}
+
+int main(int, char**)
+{
+    bool ok = Run("Application fonts", false);
+    ok = Run("All fonts, 3 sizes", true) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+// Benchmark do limite de FPS (FrameLimiter, em include/timestep.h).
+//
+// Compara a espera só com o sleep do sistema operacional com a do
+// FrameLimiter (sleep até perto do instante do frame, e o resto em espera
+// ativa com margem adaptativa), em 60, 144 e 240 FPS. Cada "frame" ocupa a
+// CPU por um quarto do período, como o trabalho de um frame, e depois espera.
+// Mostra o erro médio e o pior erro do intervalo entre frames em relação ao
+// período pedido, o desvio padrão dos intervalos, e o tempo de CPU gasto
+// por frame (a espera ativa custa CPU; o sleep, não).
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <thread>
+
+#include "timestep.h"
+
+static const int WARMUP_FRAMES = 30;
+static const int NUM_FRAMES = 240;
+
+struct Result
+{
+    double mean_error_ms;
+    double max_error_ms;
+    double jitter_ms;
+    double cpu_ms; // por frame
+};
+
+static void Work(FrameClock::duration duration)
+{
+    FrameClock::time_point end = FrameClock::now() + duration;
+    while (FrameClock::now() < end)
+    {
+    }
+}
+
+// Espera de referência: só o sleep, com o próximo instante acumulado como
+// no FrameLimiter (sem acumular o erro de cada frame).
+class SleepLimiter {
+public:
+    explicit SleepLimiter(double fps)
+        : m_period(std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(1.0 / fps))),
+          m_next(FrameClock::now() + m_period)
+    {
+    }
+
+    void Wait()
+    {
+        std::this_thread::sleep_until(m_next);
+        FrameClock::time_point now = FrameClock::now();
+        m_next += m_period;
+        if (m_next < now)
+            m_next = now + m_period;
+    }
+
+private:
+    FrameClock::duration m_period;
+    FrameClock::time_point m_next;
+};
+
+template <typename Limiter>
+static Result Run(Limiter& limiter, double fps)
+{
+    const double period_ms = 1000.0 / fps;
+    const FrameClock::duration work =
+        std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double, std::milli>(period_ms / 4.0));
+    for (int i = 0; i < WARMUP_FRAMES; ++i)
+    {
+        Work(work);
+        limiter.Wait();
+    }
+
+    double intervals[NUM_FRAMES];
+    std::clock_t cpu_start = std::clock();
+    FrameClock::time_point last = FrameClock::now();
+    for (int i = 0; i < NUM_FRAMES; ++i)
+    {
+        Work(work);
+        limiter.Wait();
+        FrameClock::time_point now = FrameClock::now();
+        intervals[i] = std::chrono::duration<double, std::milli>(now - last).count();
+        last = now;
+    }
+    std::clock_t cpu_end = std::clock();
+
+    Result result = { 0.0, 0.0, 0.0, 0.0 };
+    double mean = 0.0;
+    for (int i = 0; i < NUM_FRAMES; ++i)
+    {
+        double error = std::fabs(intervals[i] - period_ms);
+        result.mean_error_ms += error / NUM_FRAMES;
+        result.max_error_ms = std::max(result.max_error_ms, error);
+        mean += intervals[i] / NUM_FRAMES;
+    }
+    for (int i = 0; i < NUM_FRAMES; ++i)
+        result.jitter_ms += (intervals[i] - mean) * (intervals[i] - mean);
+    result.jitter_ms = std::sqrt(result.jitter_ms / (NUM_FRAMES - 1));
+    result.cpu_ms = 1000.0 * (cpu_end - cpu_start) / CLOCKS_PER_SEC / NUM_FRAMES;
+    return result;
+}
+
+static void Print(const char* name, double fps, const Result& result)
+{
+    printf("  %5.0f FPS %-14s %10.3f %10.3f %10.3f %10.3f\n", fps, name, result.mean_error_ms, result.max_error_ms,
+           result.jitter_ms, result.cpu_ms);
+}
+
+int main(int, char**)
+{
+    const double rates[] = { 60.0, 144.0, 240.0 };
+
+    printf("%d frames per run, a quarter of each period busy\n", NUM_FRAMES);
+    printf("  %9s %-14s %10s %10s %10s %10s\n", "", "Limiter", "avg err ms", "max err ms", "jitter ms", "CPU ms");
+    for (double fps : rates)
+    {
+        SleepLimiter sleep_limiter(fps);
+        Result sleep_result = Run(sleep_limiter, fps);
+        Print("sleep only", fps, sleep_result);
+
+        FrameLimiter frame_limiter;
+        frame_limiter.SetTargetFPS(fps);
+        Result limiter_result = Run(frame_limiter, fps);
+        Print("FrameLimiter", fps, limiter_result);
+        printf("  %9s %-14s spin margin %.0f us\n", "", "", frame_limiter.SpinUs());
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Benchmark do atlas de glyphs sob demanda (include/glyph_cache.h).
+//
+// Compara a fonte DroidSans 18 construída com as faixas inteiras (latim
+// básico, suplementar e estendido, cirílico e grego, como faria um programa
+// que precisa mostrar esses textos) com a mesma fonte construída só com o
+// ASCII e uma área de 496x192 para glyphs dinâmicos: tempo de construção e
+// tamanho da textura. Depois mede o Flush() de uma frase em russo e grego,
+// com e sem o JobSystem, confere que os glyphs dinâmicos têm as mesmas
+// métricas e os mesmos pixels dos construídos com o atlas, e força despejos
+// com uma área pequena. Deve ser executado de dentro de bin/, para encontrar
+// as fontes.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "glyph_cache.h"
+#include "job_system.h"
+#include "imgui_internal.h"
+
+static const int NUM_RUNS = 20;
+static const char* FONT_PATH = "../misc/fonts/DroidSans.ttf";
+static const float FONT_SIZE = 18.0f;
+
+static const ImWchar FULL_RANGES[] = {
+    0x0020, 0x00FF, // Latim básico + suplementar
+    0x0100, 0x024F, // Latim estendido A e B
+    0x0370, 0x03FF, // Grego
+    0x0400, 0x052F, // Cirílico + suplementar
+    0x2DE0, 0x2DFF, // Cirílico estendido A
+    0xA640, 0xA69F, // Cirílico estendido B
+    0,
+};
+static const ImWchar ASCII_RANGES[] = { 0x0020, 0x007E, 0 };
+
+static const char* TEXT =
+    "Съешь же ещё этих мягких французских булок, да выпей чаю. "
+    "Ξεσκεπάζω την ψυχοφθόρα βδελυγμία. Déjà vu, naïve café.";
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Milliseconds(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Campo a campo, sem as coordenadas de textura (a posição no atlas muda).
+static bool SameMetrics(const ImFontGlyph& a, const ImFontGlyph& b)
+{
+    return a.Codepoint == b.Codepoint && a.AdvanceX == b.AdvanceX && a.X0 == b.X0 && a.Y0 == b.Y0 && a.X1 == b.X1 &&
+           a.Y1 == b.Y1;
+}
+
+static bool SamePixels(const ImFontAtlas& a, const ImFontGlyph& ga, const ImFontAtlas& b, const ImFontGlyph& gb)
+{
+    int ax = (int)(ga.U0 * a.TexWidth + 0.5f), ay = (int)(ga.V0 * a.TexHeight + 0.5f);
+    int bx = (int)(gb.U0 * b.TexWidth + 0.5f), by = (int)(gb.V0 * b.TexHeight + 0.5f);
+    int width = (int)((ga.U1 - ga.U0) * a.TexWidth + 0.5f);
+    int height = (int)((ga.V1 - ga.V0) * a.TexHeight + 0.5f);
+    for (int y = 0; y < height; ++y)
+        if (memcmp(a.TexPixelsAlpha8 + (size_t)(ay + y) * a.TexWidth + ax,
+                   b.TexPixelsAlpha8 + (size_t)(by + y) * b.TexWidth + bx, (size_t)width) != 0)
+            return false;
+    return true;
+}
+
+// Constrói o atlas; com "cache", só o ASCII e uma área dinâmica.
+static ImFont* Build(ImFontAtlas& atlas, GlyphCache* cache, int area_width, int area_height, double* ms)
+{
+    Clock::time_point start = Clock::now();
+    ImFont* font = atlas.AddFontFromFileTTF(FONT_PATH, FONT_SIZE, NULL, cache != NULL ? ASCII_RANGES : FULL_RANGES);
+    if (font == NULL)
+        return NULL;
+    if (cache != NULL)
+        cache->Attach(&atlas, font, area_width, area_height);
+    atlas.Build();
+    if (cache != NULL && !cache->Init())
+        return NULL;
+    *ms = Milliseconds(start);
+    return font;
+}
+
+int main(int, char**)
+{
+    double full_ms = 0.0, dynamic_ms = 0.0, flush_ms = 0.0, flush_jobs_ms = 0.0, ms;
+    int full_glyphs = 0, dynamic_glyphs = 0, full_w = 0, full_h = 0, dynamic_w = 0, dynamic_h = 0, added = 0;
+    size_t upload_bytes = 0;
+    bool same = true;
+    JobSystem jobs;
+
+    for (int run = 0; run < NUM_RUNS; ++run)
+    {
+        ImFontAtlas full;
+        ImFont* full_font = Build(full, NULL, 0, 0, &ms);
+        if (full_font == NULL)
+        {
+            fprintf(stderr, "ERROR: \"%s\" not found; run from bin/.\n", FONT_PATH);
+            return 1;
+        }
+        full_ms += ms / NUM_RUNS;
+        full_glyphs = full_font->Glyphs.Size;
+        full_w = full.TexWidth;
+        full_h = full.TexHeight;
+
+        for (int with_jobs = 0; with_jobs < 2; ++with_jobs)
+        {
+            ImFontAtlas atlas;
+            GlyphCache cache;
+            ImFont* font = Build(atlas, &cache, 496, 192, &ms);
+            if (font == NULL)
+            {
+                fprintf(stderr, "ERROR: could not build the dynamic atlas.\n");
+                return 1;
+            }
+            dynamic_ms += ms / (2 * NUM_RUNS);
+            dynamic_w = atlas.TexWidth;
+            dynamic_h = atlas.TexHeight;
+            dynamic_glyphs = font->Glyphs.Size;
+
+            jobs.BeginFrame();
+            Clock::time_point start = Clock::now();
+            cache.Request(TEXT);
+            added = cache.Flush(with_jobs ? &jobs : NULL);
+            (with_jobs ? flush_jobs_ms : flush_ms) += Milliseconds(start) / NUM_RUNS;
+
+            GlyphUpload upload;
+            cache.TakeUpload(upload);
+            upload_bytes = upload.pixels.size();
+
+            for (const char* s = TEXT; *s != 0;)
+            {
+                unsigned int c;
+                s += ImTextCharFromUtf8(&c, s, NULL);
+                const ImFontGlyph* a = full_font->FindGlyphNoFallback((ImWchar)c);
+                const ImFontGlyph* b = font->FindGlyphNoFallback((ImWchar)c);
+                same = same && a != NULL && b != NULL && SameMetrics(*a, *b) && SamePixels(full, *a, atlas, *b);
+            }
+        }
+    }
+
+    // Área pequena: cada frame pede um bloco diferente de cirílico, e os
+    // antigos deixam de ser usados.
+    ImFontAtlas small;
+    GlyphCache cache;
+    Build(small, &cache, 128, 64, &ms);
+    for (int frame = 0; frame < 8 * (int)GlyphCache::EVICT_FRAMES; ++frame)
+    {
+        ImWchar chars[16];
+        int block = (frame / (int)GlyphCache::EVICT_FRAMES) % 6;
+        for (int i = 0; i < 16; ++i)
+            chars[i] = (ImWchar)(0x0410 + block * 16 + i);
+        cache.Request(chars, 16);
+        cache.Flush(&jobs);
+        cache.EndFrame();
+    }
+
+    printf("DroidSans %.0f px, %u threads\n", FONT_SIZE, jobs.NumThreads());
+    printf("  %-34s %8.2f ms %5d glyphs, %4dx%-4d atlas (%6.1f KiB RGBA)\n", "Full ranges at startup", full_ms, full_glyphs,
+           full_w, full_h, full_w * full_h * 4 / 1024.0);
+    printf("  %-34s %8.2f ms %5d glyphs, %4dx%-4d atlas (%6.1f KiB RGBA)\n", "ASCII + 496x192 dynamic area", dynamic_ms,
+           dynamic_glyphs, dynamic_w, dynamic_h, dynamic_w * dynamic_h * 4 / 1024.0);
+    printf("  %-34s %8.3f ms (%d glyphs, upload %.1f KiB)\n", "Flush of a new sentence", flush_ms, added,
+           upload_bytes / 1024.0);
+    printf("  %-34s %8.3f ms\n", "Flush of a new sentence, jobs", flush_jobs_ms);
+    printf("  Dynamic glyphs identical to built ones: %s\n", same ? "yes" : "NO");
+    printf("  Small area (128x64): %llu glyphs rasterized, %llu evictions, %d resident, %.0f%% used\n",
+           (unsigned long long)cache.Rasterized(), (unsigned long long)cache.Evictions(), cache.DynamicGlyphs(),
+           cache.AreaUsage() * 100.0f);
+    return same ? 0 : 1;
+}
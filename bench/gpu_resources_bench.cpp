@@ -0,0 +1,168 @@
+// Benchmark do despejo de recursos "streamable" do GpuResourceManager
+// (include/gpu_resources.h).
+//
+// Cria malhas e texturas streamable de 64 KiB cada, com conteúdo gerado a
+// partir do seu índice, e usa a cada frame uma janela deslizante delas com
+// um orçamento de memória menor que o total. Mostra quantos recursos foram
+// despejados e recarregados, o custo médio do frame (Use() de cada recurso
+// e EndFrame()) e o maior total residente. No fim, lê de volta da GPU o
+// conteúdo de cada recurso (recarregando os despejados) e o compara com o
+// original; termina com erro se algum não foi restaurado. Só funciona no
+// Linux (EGL, veja headless.h).
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "gpu_resources.h"
+#include "headless.h"
+
+static const int NUM_MESHES = 32;
+static const int NUM_TEXTURES = 16;
+static const int NUM_ASSETS = NUM_MESHES + NUM_TEXTURES;
+static const int TEXTURE_SIZE = 128;                                   // 128x128 RGBA8
+static const int ASSET_BYTES = TEXTURE_SIZE * TEXTURE_SIZE * 4;        // 64 KiB
+static const int WORKING_SET = 8;                                      // recursos usados por frame
+static const size_t BUDGET_BYTES = 16 * (size_t)ASSET_BYTES;           // 1 MiB, um terço do total
+static const int NUM_FRAMES = 480;
+
+// Um recurso: o índice define o conteúdo. O loader da malha guarda aqui o
+// buffer que criou, para a leitura no fim.
+struct Asset
+{
+    int    index;
+    GLuint buffer;
+};
+
+static void FillAsset(int index, std::vector<unsigned char>& data)
+{
+    data.resize(ASSET_BYTES);
+    uint32_t state = 2654435761u * (uint32_t)(index + 1);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        data[i] = (unsigned char)(state >> 24);
+    }
+}
+
+static void LoadMesh(GpuResourceManager& gpu, GpuResourceRef mesh, void* user_data)
+{
+    Asset* asset = static_cast<Asset*>(user_data);
+    std::vector<unsigned char> data;
+    FillAsset(asset->index, data);
+    asset->buffer = gpu.CreateMeshBuffer(mesh);
+    glBindBuffer(GL_ARRAY_BUFFER, asset->buffer);
+    gpu.BufferData(asset->buffer, GL_ARRAY_BUFFER, (GLsizeiptr)data.size(), data.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, NULL);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Chamada com a textura (recém-criada) ligada em GL_TEXTURE_2D.
+static void LoadTexture(GpuResourceManager& gpu, GpuResourceRef texture, void* user_data)
+{
+    Asset* asset = static_cast<Asset*>(user_data);
+    std::vector<unsigned char> data;
+    FillAsset(asset->index, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    gpu.TexImage2D(gpu.Name(texture), 0, GL_RGBA8, TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+}
+
+int main(int, char**)
+{
+    HeadlessContext context;
+    if (!context.Create())
+        return 1;
+    if (gl3wInit() != 0)
+    {
+        fprintf(stderr, "ERROR: failed to initialize the OpenGL loader.\n");
+        return 1;
+    }
+
+    int restored = 0;
+    GpuMemoryStats stats;
+    {
+        GpuResourceManager gpu(BUDGET_BYTES);
+        Asset assets[NUM_ASSETS];
+        std::vector<GpuVertexArray> meshes;
+        std::vector<GpuTexture> textures;
+        char name[32];
+        for (int i = 0; i < NUM_ASSETS; ++i)
+        {
+            assets[i].index = i;
+            assets[i].buffer = 0;
+            if (i < NUM_MESHES)
+            {
+                snprintf(name, sizeof(name), "mesh %d", i);
+                meshes.push_back(gpu.CreateStreamableMesh(name, LoadMesh, &assets[i]));
+            }
+            else
+            {
+                snprintf(name, sizeof(name), "texture %d", i - NUM_MESHES);
+                textures.push_back(gpu.CreateStreamableTexture(name, LoadTexture, &assets[i]));
+            }
+        }
+        auto use = [&](int i) -> GLuint {
+            return i < NUM_MESHES ? gpu.Use(meshes[i].Ref()) : gpu.Use(textures[i - NUM_MESHES].Ref());
+        };
+
+        // A janela anda um recurso a cada dois frames: cada recurso é usado
+        // por 2 * WORKING_SET frames seguidos e depois fica parado.
+        size_t peak_bytes = 0;
+        double frame_ms = 0.0;
+        for (int f = 0; f < NUM_FRAMES; ++f)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int k = 0; k < WORKING_SET; ++k)
+                use((f / 2 + k) % NUM_ASSETS);
+            gpu.EndFrame();
+            glFinish();
+            frame_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / NUM_FRAMES;
+            // No primeiro frame tudo acabou de ser criado (e usado).
+            size_t total = gpu.Stats().total_bytes;
+            if (f > 0 && total > peak_bytes)
+                peak_bytes = total;
+        }
+        stats = gpu.Stats();
+        printf("%d meshes and %d textures of %d KiB, budget %zu KiB, %d used per frame\n", NUM_MESHES, NUM_TEXTURES,
+               ASSET_BYTES >> 10, BUDGET_BYTES >> 10, WORKING_SET);
+        printf("  %d frames: %llu evictions, %llu reloads, %.3f ms/frame, peak %zu KiB resident\n", NUM_FRAMES,
+               (unsigned long long)stats.evictions, (unsigned long long)stats.reloads, frame_ms, peak_bytes >> 10);
+
+        // Conteúdo depois dos despejos: Use() recarrega o que foi despejado.
+        std::vector<unsigned char> expected, actual(ASSET_BYTES);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        for (int i = 0; i < NUM_ASSETS; ++i)
+        {
+            GLuint id = use(i);
+            FillAsset(i, expected);
+            if (i < NUM_MESHES)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, assets[i].buffer);
+                glGetBufferSubData(GL_ARRAY_BUFFER, 0, ASSET_BYTES, actual.data());
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+            }
+            else
+            {
+                glBindTexture(GL_TEXTURE_2D, id);
+                glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, actual.data());
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+            if (id != 0 && actual == expected)
+                ++restored;
+            gpu.EndFrame();
+        }
+        printf("  contents after reload: %d of %d match\n", restored, NUM_ASSETS);
+
+        meshes.clear();
+        textures.clear();
+        gpu.Shutdown();
+    }
+    context.Destroy();
+    if (stats.evictions == 0 || stats.reloads == 0 || restored != NUM_ASSETS)
+    {
+        fprintf(stderr, "ERROR: streamable resources were not evicted and restored.\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Benchmark do sistema de tarefas (include/job_system.h).
+//
+// Simula o trabalho por frame de uma cena com 200k objetos: cada objeto é
+// animado (posição e rotação dependem do tempo), tem sua matriz world
+// calculada e sua esfera envolvente testada contra os 6 planos do frustum.
+// O laço é executado com JobSystem::ParallelFor() com 1, 2, 4, 8 e 16
+// threads; também medimos o custo de submeter e esperar tarefas vazias.
+//
+// O ganho só aparece até o número de núcleos da máquina: com mais threads
+// que núcleos, as threads extras apenas disputam o mesmo processador.
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "job_system.h"
+
+static const uint32_t NUM_OBJECTS = 200000;
+static const size_t   NUM_FRAMES = 60;
+static const uint32_t MIN_GRAIN = 256;
+static const uint32_t NUM_EMPTY_JOBS = 1000;
+static const uint32_t NUM_EMPTY_BATCHES = 100;
+
+struct Scene
+{
+    std::vector<glm::vec3> base_positions;
+    std::vector<float>     phases;
+    std::vector<float>     radii;
+    std::vector<glm::mat4> world;
+    std::vector<uint8_t>   visible;
+    glm::vec4              planes[6];
+};
+
+static void BuildScene(Scene& scene)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (uint32_t i = 0; i < NUM_OBJECTS; ++i)
+    {
+        scene.base_positions.push_back(glm::vec3(pos(rng), pos(rng), pos(rng)));
+        scene.phases.push_back(unit(rng) * 6.28f);
+        scene.radii.push_back(0.5f + unit(rng));
+    }
+    scene.world.resize(NUM_OBJECTS);
+    scene.visible.resize(NUM_OBJECTS);
+
+    // Frustum de uma câmera na origem olhando para -z (planos normalizados,
+    // com a normal apontando para dentro).
+    glm::mat4 m = glm::perspective(1.0f, 16.0f / 9.0f, 0.1f, 150.0f);
+    for (int k = 0; k < 3; ++k)
+    {
+        glm::vec4 row_w(m[0][3], m[1][3], m[2][3], m[3][3]);
+        glm::vec4 row_k(m[0][k], m[1][k], m[2][k], m[3][k]);
+        glm::vec4 a = row_w + row_k;
+        glm::vec4 b = row_w - row_k;
+        scene.planes[2 * k + 0] = a / glm::length(glm::vec3(a));
+        scene.planes[2 * k + 1] = b / glm::length(glm::vec3(b));
+    }
+}
+
+static void SimulateObjects(Scene& scene, float time, uint32_t begin, uint32_t end)
+{
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        float phase = scene.phases[i] + time;
+        glm::vec3 position = scene.base_positions[i] + glm::vec3(std::sin(phase), std::cos(phase * 0.5f), 0.0f);
+        glm::mat4 world = glm::translate(glm::mat4(1.0f), position);
+        world = glm::rotate(world, phase, glm::vec3(0.0f, 1.0f, 0.0f));
+        scene.world[i] = world;
+
+        glm::vec4 center = world[3];
+        bool inside = true;
+        for (int p = 0; p < 6; ++p)
+            inside = inside && glm::dot(scene.planes[p], center) > -scene.radii[i];
+        scene.visible[i] = inside ? 1 : 0;
+    }
+}
+
+static double RunScene(JobSystem& jobs, Scene& scene, size_t& visible)
+{
+    double total_ms = 0.0;
+    visible = 0;
+    for (size_t frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        jobs.BeginFrame();
+        const float time = frame / 60.0f;
+        auto start = std::chrono::steady_clock::now();
+        jobs.ParallelFor(NUM_OBJECTS, MIN_GRAIN, [&scene, time](uint32_t begin, uint32_t end) {
+            SimulateObjects(scene, time, begin, end);
+        });
+        auto end = std::chrono::steady_clock::now();
+        total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    for (uint8_t v : scene.visible)
+        visible += v;
+    return total_ms / NUM_FRAMES;
+}
+
+// Custo por tarefa de submeter lotes de tarefas vazias e esperar por elas.
+static double RunEmptyJobs(JobSystem& jobs)
+{
+    std::atomic<uint32_t> executed(0);
+    double total_ns = 0.0;
+    for (uint32_t batch = 0; batch < NUM_EMPTY_BATCHES; ++batch)
+    {
+        jobs.BeginFrame();
+        auto start = std::chrono::steady_clock::now();
+        JobCounter counter;
+        for (uint32_t i = 0; i < NUM_EMPTY_JOBS; ++i)
+            jobs.Run(&counter, [&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+        jobs.Wait(&counter);
+        auto end = std::chrono::steady_clock::now();
+        total_ns += std::chrono::duration<double, std::nano>(end - start).count();
+    }
+    if (executed.load() != NUM_EMPTY_JOBS * NUM_EMPTY_BATCHES)
+        printf("ERROR: %u of %u jobs executed\n", executed.load(), NUM_EMPTY_JOBS * NUM_EMPTY_BATCHES);
+    return total_ns / (NUM_EMPTY_JOBS * NUM_EMPTY_BATCHES);
+}
+
+int main(int, char**)
+{
+    Scene scene;
+    BuildScene(scene);
+
+    printf("JobSystem: %u objects (animate + world matrix + frustum cull), %zu frames, %u hardware threads\n",
+           NUM_OBJECTS, NUM_FRAMES, std::thread::hardware_concurrency());
+
+    double single_ms = 0.0;
+    const unsigned int thread_counts[] = { 1, 2, 4, 8, 16 };
+    for (unsigned int t : thread_counts)
+    {
+        JobSystem jobs(t);
+        size_t visible = 0;
+        double ms = RunScene(jobs, scene, visible);
+        if (t == 1)
+            single_ms = ms;
+        double ns_per_job = RunEmptyJobs(jobs);
+        printf("%2u thread(s)  %8.3f ms/frame  %5.2fx  %7zu visible  %6.1f ns/empty job\n",
+               t, ms, single_ms / ms, visible, ns_per_job);
+    }
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Benchmark das funções em lote de matrices_batch.h.
+//
+// Para cada operação, compara as funções escalares de matrices.h (e os
+// operadores do GLM), o caminho SIMD do próprio GLM em include/glm/simd e os
+// kernels em lote com cada conjunto de instruções suportado. Antes de medir,
+// verifica que todos os kernels produzem o mesmo resultado da referência.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "matrices.h"
+#include "matrices_batch.h"
+
+// Definidas em matrices_bench_glm.cpp.
+void GlmSimd_MultiplyMatrices(const float* A, const float* in, float* out, size_t count);
+void GlmSimd_TransformPoints(const float* M, const float* in, float* out, size_t count);
+
+static const size_t COUNT = 1 << 16;
+static const int    REPEAT = 50;
+
+template <typename F>
+static double TimeNs(F f)
+{
+    f(); // aquecimento
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEAT; ++r)
+        f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(REPEAT) * COUNT);
+}
+
+static void Report(const char* op, const char* impl, double ns, double reference_ns)
+{
+    printf("%-22s %-16s %7.2f ns/elem  %6.2fx\n", op, impl, ns, reference_ns / ns);
+}
+
+static float MaxError(const float* a, const float* b, size_t n)
+{
+    float err = 0.0f;
+    for (size_t i = 0; i < n; ++i)
+        err = std::fmax(err, std::fabs(a[i] - b[i]) / (1.0f + std::fabs(b[i])));
+    return err;
+}
+
+// Evita que o compilador descarte os resultados.
+static volatile float g_Sink;
+
+int main(int, char**)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+    glm::mat4 A = Matrix_Translate(0.5f, -1.0f, 2.0f) * Matrix_Rotate(0.3f, glm::vec4(1.0f, 2.0f, 3.0f, 0.0f)) * Matrix_Scale(1.5f, 0.5f, 2.0f);
+
+    std::vector<glm::mat4> mats(COUNT), mats_out(COUNT), mats_ref(COUNT);
+    std::vector<glm::vec4> points(COUNT), points_out(COUNT), points_ref(COUNT);
+    std::vector<glm::vec3> positions(COUNT), scales(COUNT);
+    std::vector<glm::quat> rotations(COUNT);
+    std::vector<float>     angles(COUNT);
+    std::vector<glm::vec4> axes(COUNT);
+    std::vector<BoundingBox> boxes(COUNT), boxes_out(COUNT), boxes_ref(COUNT);
+
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        for (int c = 0; c < 4; ++c)
+            mats[i][c] = glm::vec4(u(rng), u(rng), u(rng), u(rng));
+        points[i] = glm::vec4(u(rng), u(rng), u(rng), 1.0f);
+        positions[i] = glm::vec3(u(rng), u(rng), u(rng));
+        scales[i] = glm::vec3(1.0f + u(rng), 1.0f + u(rng), 1.0f + u(rng)) * 0.5f + 0.25f;
+        glm::vec3 axis = glm::normalize(glm::vec3(u(rng), u(rng), u(rng)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+        angles[i] = 3.0f * u(rng);
+        axes[i] = glm::vec4(axis, 0.0f);
+        rotations[i] = glm::angleAxis(angles[i], axis);
+        glm::vec3 p = glm::vec3(u(rng), u(rng), u(rng));
+        glm::vec3 e = glm::abs(glm::vec3(u(rng), u(rng), u(rng)));
+        boxes[i].min = p - e;
+        boxes[i].max = p + e;
+    }
+
+    printf("Batch math: %zu elements, best instruction set: %s\n\n", COUNT,
+           Batch_InstructionSetName(Batch_GetSupportedInstructionSet()));
+
+    std::vector<BatchInstructionSet> isas;
+    for (int isa = BATCH_SCALAR; isa <= (int)Batch_GetSupportedInstructionSet(); ++isa)
+        isas.push_back((BatchInstructionSet)isa);
+
+    // A * M[i]
+    {
+        double ref = TimeNs([&]() { for (size_t i = 0; i < COUNT; ++i) mats_ref[i] = A * mats[i]; });
+        Report("mat4 * mat4", "glm scalar", ref, ref);
+        double simd = TimeNs([&]() { GlmSimd_MultiplyMatrices(&A[0][0], &mats[0][0][0], &mats_out[0][0][0], COUNT); });
+        Report("mat4 * mat4", "glm simd", simd, ref);
+        for (BatchInstructionSet isa : isas)
+        {
+            Batch_SetInstructionSet(isa);
+            double ns = TimeNs([&]() { Batch_MultiplyMatrices(A, mats.data(), mats_out.data(), COUNT); });
+            Report("mat4 * mat4", Batch_InstructionSetName(isa), ns, ref);
+            printf("%-39s max error %.2e\n", "", MaxError(&mats_out[0][0][0], &mats_ref[0][0][0], COUNT * 16));
+        }
+        printf("\n");
+    }
+
+    // M * p[i]
+    {
+        double ref = TimeNs([&]() { for (size_t i = 0; i < COUNT; ++i) points_ref[i] = A * points[i]; });
+        Report("mat4 * vec4", "glm scalar", ref, ref);
+        double simd = TimeNs([&]() { GlmSimd_TransformPoints(&A[0][0], &points[0][0], &points_out[0][0], COUNT); });
+        Report("mat4 * vec4", "glm simd", simd, ref);
+        for (BatchInstructionSet isa : isas)
+        {
+            Batch_SetInstructionSet(isa);
+            double ns = TimeNs([&]() { Batch_TransformPoints(A, points.data(), points_out.data(), COUNT); });
+            Report("mat4 * vec4", Batch_InstructionSetName(isa), ns, ref);
+            printf("%-39s max error %.2e\n", "", MaxError(&points_out[0][0], &points_ref[0][0], COUNT * 4));
+        }
+        printf("\n");
+    }
+
+    // T * R * S
+    {
+        double ref = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                mats_ref[i] = Matrix_Translate(positions[i].x, positions[i].y, positions[i].z)
+                            * Matrix_Rotate(angles[i], axes[i])
+                            * Matrix_Scale(scales[i].x, scales[i].y, scales[i].z);
+        });
+        Report("compose TRS", "matrices.h", ref, ref);
+        for (BatchInstructionSet isa : isas)
+        {
+            Batch_SetInstructionSet(isa);
+            double ns = TimeNs([&]() { Batch_ComposeTRS(positions.data(), rotations.data(), scales.data(), mats_out.data(), COUNT); });
+            Report("compose TRS", Batch_InstructionSetName(isa), ns, ref);
+            printf("%-39s max error %.2e\n", "", MaxError(&mats_out[0][0][0], &mats_ref[0][0][0], COUNT * 16));
+        }
+        printf("\n");
+    }
+
+    // AABB
+    {
+        double ref = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+            {
+                glm::vec3 lo(INFINITY), hi(-INFINITY);
+                for (int k = 0; k < 8; ++k)
+                {
+                    glm::vec4 corner((k & 1) ? boxes[i].max.x : boxes[i].min.x,
+                                     (k & 2) ? boxes[i].max.y : boxes[i].min.y,
+                                     (k & 4) ? boxes[i].max.z : boxes[i].min.z, 1.0f);
+                    glm::vec3 t = glm::vec3(A * corner);
+                    lo = glm::min(lo, t);
+                    hi = glm::max(hi, t);
+                }
+                boxes_ref[i].min = lo;
+                boxes_ref[i].max = hi;
+            }
+        });
+        Report("bounding box", "8 corners", ref, ref);
+        for (BatchInstructionSet isa : isas)
+        {
+            Batch_SetInstructionSet(isa);
+            double ns = TimeNs([&]() { Batch_TransformBoundingBoxes(A, boxes.data(), boxes_out.data(), COUNT); });
+            Report("bounding box", Batch_InstructionSetName(isa), ns, ref);
+            printf("%-39s max error %.2e\n", "", MaxError(&boxes_out[0].min.x, &boxes_ref[0].min.x, COUNT * 6));
+        }
+    }
+
+    g_Sink = mats_out[COUNT / 2][1][1] + points_out[COUNT / 3].x + boxes_out[COUNT / 4].max.y;
+    return 0;
+}
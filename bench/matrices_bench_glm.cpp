@@ -0,0 +1,30 @@
+// Caminho SIMD do GLM (include/glm/simd) usado como comparação em
+// matrices_bench.cpp. Fica em um arquivo separado porque GLM_FORCE_SSE2
+// altera a definição dos tipos do GLM, e os demais arquivos do benchmark
+// precisam usar os mesmos tipos que o resto do programa. As funções abaixo
+// recebem somente ponteiros para float.
+#define GLM_FORCE_SSE2
+#include <cstddef>
+
+#include <glm/detail/setup.hpp>
+#include <glm/simd/matrix.h>
+
+void GlmSimd_MultiplyMatrices(const float* A, const float* in, float* out, size_t count)
+{
+    glm_vec4 a[4] = { _mm_loadu_ps(A), _mm_loadu_ps(A + 4), _mm_loadu_ps(A + 8), _mm_loadu_ps(A + 12) };
+    for (size_t i = 0; i < count; ++i, in += 16, out += 16)
+    {
+        glm_vec4 b[4] = { _mm_loadu_ps(in), _mm_loadu_ps(in + 4), _mm_loadu_ps(in + 8), _mm_loadu_ps(in + 12) };
+        glm_vec4 r[4];
+        glm_mat4_mul(a, b, r);
+        for (int c = 0; c < 4; ++c)
+            _mm_storeu_ps(out + 4 * c, r[c]);
+    }
+}
+
+void GlmSimd_TransformPoints(const float* M, const float* in, float* out, size_t count)
+{
+    glm_vec4 m[4] = { _mm_loadu_ps(M), _mm_loadu_ps(M + 4), _mm_loadu_ps(M + 8), _mm_loadu_ps(M + 12) };
+    for (size_t i = 0; i < count; ++i, in += 4, out += 4)
+        _mm_storeu_ps(out, glm_mat4_mul_vec4(m, _mm_loadu_ps(in)));
+}
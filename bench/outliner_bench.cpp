@@ -0,0 +1,168 @@
+// Benchmark do "Outliner" (include/scene_outliner.h).
+//
+// Para cenas de 1 mil, 100 mil e 1 milhão de objetos (em grupos de 1000,
+// como com "--scene-objects" no programa) mede o tempo de CPU de um frame da
+// ImGui com a janela: com a árvore recolhida, com todos os grupos
+// expandidos, e enquanto se digita uma busca (um caractere por frame, como
+// um usuário rápido), até a busca terminar. Para comparar, a mesma árvore
+// expandida submetida sem ImGuiListClipper, uma linha por nó. Não desenha
+// nada: NewFrame(), a janela e Render() (que gera os vértices).
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "scene_outliner.h"
+#include "imgui.h"
+
+static const int NUM_FRAMES = 60;
+static const int GROUP_SIZE = 1000;
+static const char* QUERY = "object 12345";
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct FrameTimes
+{
+    double average_ms;
+    double max_ms;
+};
+
+struct Scene
+{
+    TransformHierarchy transforms;
+    SceneIndex         index;
+};
+
+static void BuildScene(Scene& scene, int objects)
+{
+    char name[32];
+    TransformId group = INVALID_TRANSFORM;
+    scene.transforms.Reserve(objects + objects / GROUP_SIZE + 1);
+    for (int i = 0; i < objects; ++i)
+    {
+        if (i % GROUP_SIZE == 0)
+        {
+            group = scene.transforms.Create();
+            snprintf(name, sizeof(name), "Group %d", i / GROUP_SIZE);
+            scene.index.Add(group, INVALID_TRANSFORM, name);
+        }
+        TransformId object = scene.transforms.Create(group);
+        snprintf(name, sizeof(name), "Object %d", i);
+        scene.index.Add(object, group, name);
+    }
+}
+
+template <typename F>
+static double Frame(const F& body)
+{
+    Clock::time_point start = Clock::now();
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(360.0f, 800.0f));
+    body();
+    ImGui::Render();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename F>
+static FrameTimes Frames(int count, const F& body)
+{
+    FrameTimes times = { 0.0, 0.0 };
+    for (int i = 0; i < count; ++i)
+    {
+        double ms = Frame(body);
+        times.average_ms += ms / count;
+        times.max_ms = std::max(times.max_ms, ms);
+    }
+    return times;
+}
+
+// Uma linha por nó visível, sem recorte: o que a janela faria sem o
+// ImGuiListClipper.
+static void ShowUnclipped(const SceneIndex& index)
+{
+    ImGui::Begin("Outliner");
+    ImGui::BeginChild("##rows");
+    for (TransformId root = index.FirstRoot(); root != INVALID_TRANSFORM; root = index.NextSibling(root))
+    {
+        ImGui::SetNextItemOpen(true);
+        if (ImGui::TreeNodeEx((void*)(intptr_t)root, 0, "%s", index.Name(root)))
+        {
+            for (TransformId c = index.FirstChild(root); c != INVALID_TRANSFORM; c = index.NextSibling(c))
+                ImGui::TreeNodeEx((void*)(intptr_t)c, ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen, "%s",
+                                  index.Name(c));
+            ImGui::TreePop();
+        }
+    }
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+static void Print(const char* label, const FrameTimes& times)
+{
+    printf("  %-30s %8.3f ms avg %8.3f ms max\n", label, times.average_ms, times.max_ms);
+}
+
+static void Run(int objects)
+{
+    Scene scene;
+    Clock::time_point start = Clock::now();
+    BuildScene(scene, objects);
+    double build_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    printf("%d objects (index built in %.1f ms)\n", objects, build_ms);
+
+    SceneOutliner outliner;
+    auto show = [&]() { outliner.Show(scene.index, scene.transforms); };
+    Frame(show);
+    Print("Collapsed", Frames(NUM_FRAMES, show));
+    outliner.ExpandAll(scene.index, true);
+    Print("Expanded", Frames(NUM_FRAMES, show));
+
+    // A busca: um clique no campo de texto, um caractere por frame, e
+    // depois frames até ela terminar.
+    ImGuiIO& io = ImGui::GetIO();
+    io.MousePos = ImVec2(100.0f, ImGui::GetFrameHeight() + ImGui::GetFrameHeight() * 0.5f + ImGui::GetStyle().WindowPadding.y);
+    io.MouseDown[0] = true;
+    Frame(show);
+    io.MouseDown[0] = false;
+    Frame(show);
+    FrameTimes typing = { 0.0, 0.0 };
+    int frames = 0;
+    const size_t length = strlen(QUERY);
+    for (size_t i = 0; i < length || outliner.Searching(); ++i, ++frames)
+    {
+        if (i < length)
+            io.AddInputCharacter((unsigned int)QUERY[i]);
+        double ms = Frame(show);
+        typing.average_ms += ms;
+        typing.max_ms = std::max(typing.max_ms, ms);
+    }
+    typing.average_ms /= frames;
+    char label[64];
+    snprintf(label, sizeof(label), "Typing a search (%d frames)", frames);
+    Print(label, typing);
+    printf("  %-30s %8d\n", "Matches", (int)outliner.Matches());
+
+    if (objects <= 100000)
+        Print("Expanded, no clipper", Frames(objects <= 1000 ? NUM_FRAMES : 5, [&]() { ShowUnclipped(scene.index); }));
+}
+
+int main(int, char**)
+{
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = NULL;
+    io.DisplaySize = ImVec2(1280.0f, 800.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    Run(1000);
+    Run(100000);
+    Run(1000000);
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Benchmark do profiler de CPU (include/profiler.h).
+//
+// Mede o custo de uma zona (PROFILE_SCOPE vazio) na thread que a executa,
+// comparando um laço com e sem a zona, e o custo de Profiler::EndFrame()
+// para recolher as zonas de um frame. Compilado com TCC_ENABLE_PROFILER
+// (veja o Makefile).
+#include <chrono>
+#include <cstdio>
+
+#include "profiler.h"
+
+static const int NUM_FRAMES = 200;
+static const int ZONES_PER_FRAME = 4096; // menos que Profiler::THREAD_CAPACITY
+
+static volatile int g_sink = 0;
+
+static void Work(int i)
+{
+    g_sink = g_sink + i;
+}
+
+struct Result
+{
+    double frame_ns;    // laço inteiro
+    double end_frame_ns; // só Profiler::EndFrame()
+};
+
+template <typename Loop>
+static Result Measure(Loop loop)
+{
+    loop();
+    Profiler::EndFrame();
+    Result r = { 0.0, 0.0 };
+    for (int f = 0; f < NUM_FRAMES; ++f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        loop();
+        auto middle = std::chrono::steady_clock::now();
+        Profiler::EndFrame();
+        auto end = std::chrono::steady_clock::now();
+        r.frame_ns += std::chrono::duration<double, std::nano>(middle - start).count() / NUM_FRAMES;
+        r.end_frame_ns += std::chrono::duration<double, std::nano>(end - middle).count() / NUM_FRAMES;
+    }
+    return r;
+}
+
+int main(int, char**)
+{
+    PROFILE_REGISTER_THREAD(TRACE_THREAD_MAIN);
+
+    Result empty = Measure([]() {
+        for (int i = 0; i < ZONES_PER_FRAME; ++i)
+            Work(i);
+    });
+    Result zones = Measure([]() {
+        for (int i = 0; i < ZONES_PER_FRAME; ++i)
+        {
+            PROFILE_SCOPE("Work");
+            Work(i);
+        }
+    });
+
+    printf("Zones per frame: %d\n", ZONES_PER_FRAME);
+    printf("%-28s %8.2f ns/zone\n", "PROFILE_SCOPE", (zones.frame_ns - empty.frame_ns) / ZONES_PER_FRAME);
+    printf("%-28s %8.2f us/frame\n", "Profiler::EndFrame", zones.end_frame_ns / 1000.0);
+    printf("%-28s %8llu\n", "Dropped zones", (unsigned long long)Profiler::Dropped());
+    return 0;
+}
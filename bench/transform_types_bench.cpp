@@ -0,0 +1,146 @@
+// Benchmark das transformações tipadas de transform_types.h.
+//
+// Compara a composição T * R * S feita com matrizes 4x4 completas (funções
+// de matrices.h e operador * do GLM) com a composição dos tipos
+// Translation/Rotation/Scale, que calcula apenas os termos não triviais.
+// Mostra também o caso em que todos os argumentos são constantes e a matriz
+// final é calculada pelo compilador.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "matrices.h"
+#include "transform_types.h"
+
+static const size_t COUNT = 1 << 16;
+static const int    REPEAT = 50;
+
+// Operações por objeto (multiplicações + somas) de cada composição T * R * S.
+// Produto de matrizes 4x4: 64 multiplicações e 48 somas.
+static const int FLOPS_FULL  = 2 * (64 + 48);
+// Translation * Rotation: nenhuma; Affine * Scale: 9 multiplicações.
+static const int FLOPS_TYPED = 9;
+
+// Mesmo exemplo de main.cpp, calculado inteiramente em tempo de compilação.
+constexpr glm::mat4 CONSTANT_MODEL =
+    (Translation(0.0f, 0.0f, -2.0f) * Rotation::Axis(float(CONST_MATH_PI) / 8.0f, glm::vec3(1.0f, 1.0f, 1.0f)) * Scale(2.0f, 0.5f, 0.5f)).ToMatrix();
+static_assert(CONSTANT_MODEL[3][2] == -2.0f, "translação deve ser preservada");
+static_assert(CONSTANT_MODEL[3][3] == 1.0f, "última linha deve ser [0 0 0 1]");
+
+template <typename F>
+static double TimeNs(F f)
+{
+    f(); // aquecimento
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEAT; ++r)
+        f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(REPEAT) * COUNT);
+}
+
+static void Report(const char* op, const char* impl, double ns, double reference_ns)
+{
+    printf("%-22s %-16s %7.2f ns/obj  %6.2fx\n", op, impl, ns, reference_ns / ns);
+}
+
+static float MaxError(const glm::mat4* a, const glm::mat4* b, size_t n)
+{
+    float err = 0.0f;
+    for (size_t i = 0; i < n; ++i)
+        for (int c = 0; c < 4; ++c)
+            for (int l = 0; l < 4; ++l)
+                err = std::fmax(err, std::fabs(a[i][c][l] - b[i][c][l]) / (1.0f + std::fabs(b[i][c][l])));
+    return err;
+}
+
+// Evita que o compilador descarte os resultados.
+static volatile float g_Sink;
+
+int main(int, char**)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+
+    std::vector<glm::vec3> positions(COUNT), scales(COUNT), axes(COUNT);
+    std::vector<float>     angles(COUNT);
+    std::vector<glm::mat4> out(COUNT), ref(COUNT);
+    for (size_t i = 0; i < COUNT; ++i)
+    {
+        positions[i] = glm::vec3(u(rng), u(rng), u(rng));
+        scales[i] = glm::vec3(1.5f + u(rng), 1.5f + u(rng), 1.5f + u(rng));
+        axes[i] = glm::vec3(u(rng), u(rng), u(rng)) + glm::vec3(0.0f, 0.0f, 2.0f);
+        angles[i] = 3.0f * u(rng);
+    }
+
+    printf("Typed transforms: %zu objects\n", COUNT);
+    printf("flops per T*R*S: %d with mat4 products, %d with typed transforms (%d saved)\n\n",
+           FLOPS_FULL, FLOPS_TYPED, FLOPS_FULL - FLOPS_TYPED);
+
+    // Montagem completa: inclui o cálculo de seno/cosseno da rotação, que é
+    // o mesmo nos dois casos.
+    {
+        double full = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                ref[i] = Matrix_Translate(positions[i].x, positions[i].y, positions[i].z)
+                       * Matrix_Rotate(angles[i], glm::vec4(axes[i], 0.0f))
+                       * Matrix_Scale(scales[i].x, scales[i].y, scales[i].z);
+        });
+        Report("build T*R*S", "matrices.h", full, full);
+        double typed = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                out[i] = (Translation(positions[i]) * Rotation::Axis(angles[i], axes[i]) * Scale(scales[i])).ToMatrix();
+        });
+        Report("build T*R*S", "typed", typed, full);
+        printf("%-39s max error %.2e\n\n", "", MaxError(out.data(), ref.data(), COUNT));
+    }
+
+    // Apenas a composição, com as rotações já calculadas.
+    {
+        std::vector<glm::mat4> rotation_matrices(COUNT);
+        std::vector<Rotation>  rotations(COUNT);
+        for (size_t i = 0; i < COUNT; ++i)
+        {
+            rotation_matrices[i] = Matrix_Rotate(angles[i], glm::vec4(axes[i], 0.0f));
+            rotations[i] = Rotation::Axis(angles[i], axes[i]);
+        }
+
+        double full = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                ref[i] = Matrix_Translate(positions[i].x, positions[i].y, positions[i].z)
+                       * rotation_matrices[i]
+                       * Matrix_Scale(scales[i].x, scales[i].y, scales[i].z);
+        });
+        Report("compose T*R*S", "matrices.h", full, full);
+        double typed = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                out[i] = (Translation(positions[i]) * rotations[i] * Scale(scales[i])).ToMatrix();
+        });
+        Report("compose T*R*S", "typed", typed, full);
+        printf("%-39s max error %.2e\n\n", "", MaxError(out.data(), ref.data(), COUNT));
+    }
+
+    // Argumentos constantes: com matrices.h as matrizes de cada termo são
+    // constantes, mas os produtos do GLM ainda são feitos em tempo de
+    // execução. Com os tipos, a matriz final já vem pronta do compilador.
+    {
+        const glm::vec4 axis(1.0f, 1.0f, 1.0f, 0.0f);
+        double full = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                ref[i] = Matrix_Translate(0.0f, 0.0f, -2.0f) * Matrix_Rotate(float(CONST_MATH_PI) / 8.0f, axis) * Matrix_Scale(2.0f, 0.5f, 0.5f);
+        });
+        Report("constant T*R*S", "matrices.h", full, full);
+        double typed = TimeNs([&]() {
+            for (size_t i = 0; i < COUNT; ++i)
+                out[i] = CONSTANT_MODEL;
+        });
+        Report("constant T*R*S", "constexpr", typed, full);
+        printf("%-39s max error %.2e\n", "", MaxError(out.data(), ref.data(), COUNT));
+    }
+
+    g_Sink = out[COUNT / 2][1][1] + ref[COUNT / 3][2][0];
+    return 0;
+}
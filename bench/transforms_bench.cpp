@@ -0,0 +1,105 @@
+// Benchmark da hierarquia de transformações (include/transforms.h).
+//
+// Cria uma hierarquia com 1M de nós e, a cada "frame", modifica a rotação de
+// 1% dos nós escolhidos aleatoriamente. Compara o recálculo completo de todas
+// as matrizes world com o recálculo somente das subárvores modificadas, com
+// diferentes números de threads do JobSystem.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "job_system.h"
+#include "transforms.h"
+
+static const size_t NUM_NODES = 1000000;
+static const size_t NUM_FRAMES = 60;
+static const float  CHANGED_FRACTION = 0.01f;
+static const int    MAX_DEPTH = 8;
+
+// Gera uma árvore aleatória já em pré-ordem: cada novo nó é filho de algum
+// nó do caminho atual da raiz até o último nó criado.
+static void BuildHierarchy(TransformHierarchy& h, std::vector<TransformId>& ids, std::mt19937& rng)
+{
+    h.Reserve(NUM_NODES);
+    ids.reserve(NUM_NODES);
+
+    std::vector<TransformId> path;
+    std::uniform_int_distribution<int> pop(0, 3);
+    std::uniform_real_distribution<float> pos(-1.0f, 1.0f);
+    for (size_t i = 0; i < NUM_NODES; ++i)
+    {
+        int levels = pop(rng);
+        while (levels-- > 0 && !path.empty())
+            path.pop_back();
+        if (path.size() >= (size_t)MAX_DEPTH)
+            path.pop_back();
+
+        TransformId parent = path.empty() ? INVALID_TRANSFORM : path.back();
+        TransformId id = h.Create(parent);
+        h.SetPosition(id, glm::vec3(pos(rng), pos(rng), pos(rng)));
+        ids.push_back(id);
+        path.push_back(id);
+    }
+}
+
+static void Modify(TransformHierarchy& h, const std::vector<TransformId>& ids, std::mt19937& rng)
+{
+    std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+    std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+    const size_t changed = (size_t)(ids.size() * CHANGED_FRACTION);
+    for (size_t i = 0; i < changed; ++i)
+        h.SetRotation(ids[pick(rng)], glm::angleAxis(angle(rng), glm::vec3(0.0f, 1.0f, 0.0f)));
+}
+
+static double Run(const char* label, TransformHierarchy& h, const std::vector<TransformId>& ids, JobSystem* jobs, bool full)
+{
+    std::mt19937 rng(1234);
+    double total_ms = 0.0;
+    size_t updated = 0;
+    for (size_t frame = 0; frame < NUM_FRAMES; ++frame)
+    {
+        Modify(h, ids, rng);
+        if (jobs != NULL)
+            jobs->BeginFrame();
+        auto start = std::chrono::steady_clock::now();
+        if (full)
+            h.UpdateAll();
+        else
+            h.Update(jobs);
+        auto end = std::chrono::steady_clock::now();
+        total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        updated += h.LastUpdatedCount();
+    }
+    double ms = total_ms / NUM_FRAMES;
+    printf("%-24s %8.3f ms/frame  %9zu nodes/frame\n", label, ms, updated / NUM_FRAMES);
+    return ms;
+}
+
+int main(int, char**)
+{
+    std::mt19937 rng(42);
+    TransformHierarchy h;
+    std::vector<TransformId> ids;
+    BuildHierarchy(h, ids, rng);
+    h.UpdateAll();
+
+    printf("TransformHierarchy: %zu nodes, %.0f%% changed per frame, %zu frames\n",
+           NUM_NODES, CHANGED_FRACTION * 100.0f, NUM_FRAMES);
+
+    double full = Run("full recompute", h, ids, NULL, true);
+    const unsigned int thread_counts[] = { 1, 2, 4, 8 };
+    for (unsigned int t : thread_counts)
+    {
+        char label[64];
+        snprintf(label, sizeof(label), "dirty, %u thread(s)", t);
+        JobSystem jobs(t);
+        double ms = Run(label, h, ids, &jobs, false);
+        printf("%-24s %8.2fx vs full\n", "", full / ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,218 @@
+// Benchmark do renderizador da interface (include/ui_renderer.h).
+//
+// Monta uma interface pesada (a demo da ImGui e várias janelas cheias de
+// widgets), sem janela nem GLFW, e desenha os mesmos comandos com o
+// renderizador da ImGui (imgui_impl_opengl3.cpp) e com o UiRenderer, em um
+// contexto EGL sem superfície (veja headless.h). Para cada um mede o tempo
+// de CPU para enviar os comandos e o tempo até a GPU terminar (glFinish()),
+// e no fim compara as imagens desenhadas pelos dois. Mede também a camada da
+// interface (ui_layer.h): o frame em que ela é redesenhada e composta, o
+// frame em que só é composta, e o hash que decide entre os dois. Só funciona no Linux;
+// deve ser executado de dentro de bin/, como o programa principal, para
+// encontrar os shaders.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+
+#include "headless.h"
+#include "render_counters.h"
+#include "render_target.h"
+#include "ui_layer.h"
+#include "ui_renderer.h"
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 720;
+static const int NUM_WINDOWS = 8;
+static const int WIDGETS_PER_WINDOW = 60;
+static const int WARMUP_FRAMES = 20;
+static const int NUM_FRAMES = 300;
+
+static void BuildInterface()
+{
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2((float)WIDTH, (float)HEIGHT);
+    io.DeltaTime = 1.0f / 60.0f;
+    ImGui::NewFrame();
+
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(ImVec2(420.0f, (float)HEIGHT));
+    ImGui::ShowDemoWindow();
+
+    static float values[WIDGETS_PER_WINDOW];
+    static float plot[64];
+    for (int i = 0; i < 64; ++i)
+        plot[i] = (float)((i * 37) % 17);
+    for (int w = 0; w < NUM_WINDOWS; ++w)
+    {
+        char title[32];
+        snprintf(title, sizeof(title), "Window %d", w);
+        ImGui::SetNextWindowPos(ImVec2(430.0f + (w % 4) * 212.0f, (w / 4) * (HEIGHT / 2.0f)));
+        ImGui::SetNextWindowSize(ImVec2(206.0f, HEIGHT / 2.0f - 6.0f));
+        ImGui::Begin(title);
+        for (int i = 0; i < WIDGETS_PER_WINDOW; ++i)
+        {
+            ImGui::PushID(i);
+            switch (i % 4)
+            {
+            case 0: ImGui::Text("Item %d: %.3f", i, values[i]); break;
+            case 1: ImGui::SliderFloat("slider", &values[i], 0.0f, 1.0f); break;
+            case 2: ImGui::Button("Button"); ImGui::SameLine(); ImGui::Text("label"); break;
+            case 3: ImGui::PlotLines("plot", plot, 64, 0, NULL, 0.0f, 16.0f, ImVec2(0, 24)); break;
+            }
+            ImGui::PopID();
+        }
+        ImGui::End();
+    }
+    ImGui::Render();
+}
+
+struct Result
+{
+    double submit_us; // média por frame, só o envio dos comandos
+    double frame_us;  // média por frame, até a GPU terminar
+};
+
+template <typename Render>
+static Result Measure(const RenderTarget& target, Render render)
+{
+    Result r = { 0.0, 0.0 };
+    for (int f = 0; f < WARMUP_FRAMES + NUM_FRAMES; ++f)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer());
+        glViewport(0, 0, WIDTH, HEIGHT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glFinish();
+        auto start = std::chrono::steady_clock::now();
+        render();
+        auto middle = std::chrono::steady_clock::now();
+        glFinish();
+        auto end = std::chrono::steady_clock::now();
+        if (f < WARMUP_FRAMES)
+            continue;
+        r.submit_us += std::chrono::duration<double, std::micro>(middle - start).count() / NUM_FRAMES;
+        r.frame_us += std::chrono::duration<double, std::micro>(end - start).count() / NUM_FRAMES;
+    }
+    return r;
+}
+
+int main(int, char**)
+{
+    HeadlessContext context;
+    if (!context.Create())
+        return 1;
+    if (gl3wInit() != 0)
+    {
+        fprintf(stderr, "ERROR: failed to initialize the OpenGL loader.\n");
+        return 1;
+    }
+
+    {
+        GpuResourceManager gpu;
+        RenderCounters counters;
+        gpu.SetCounters(&counters);
+        RenderTarget target;
+        if (!target.Create(gpu, "ui bench", WIDTH, HEIGHT))
+            return 1;
+        // O estado em que o resto do programa deixa o OpenGL.
+        glEnable(GL_DEPTH_TEST);
+        glClearColor(0.45f, 0.55f, 0.60f, 1.0f);
+
+        ImGui::CreateContext();
+        ImGui::GetIO().IniFilename = NULL; // não grava imgui.ini em bin/
+        ImGui::StyleColorsDark();
+        ImGui_ImplOpenGL3_Init("#version 130");
+        ImGui_ImplOpenGL3_NewFrame();
+        UiRenderer ui_renderer;
+        ui_renderer.Init(gpu);
+        UiLayer ui_layer;
+        ui_layer.Init(gpu);
+
+        // A mesma lista de comandos é desenhada em todos os frames.
+        BuildInterface();
+        BuildInterface();
+        ImDrawData* draw_data = ImGui::GetDrawData();
+        int commands = 0;
+        for (int n = 0; n < draw_data->CmdListsCount; ++n)
+            commands += draw_data->CmdLists[n]->CmdBuffer.Size;
+
+        Result stock = Measure(target, [&]() { ImGui_ImplOpenGL3_RenderDrawData(draw_data); });
+        Result lean = Measure(target, [&]() { ui_renderer.RenderDrawData(draw_data, counters); counters.EndFrame(0); });
+        Result redraw = Measure(target, [&]() {
+            ui_layer.Begin(WIDTH, HEIGHT);
+            ui_renderer.RenderDrawData(draw_data, counters, true);
+            ui_layer.End(target.Framebuffer());
+            ui_layer.Composite(counters);
+            counters.EndFrame(0);
+        });
+        Result composite = Measure(target, [&]() { ui_layer.Composite(counters); counters.EndFrame(0); });
+        volatile uint64_t hash = 0; // para o compilador não descartar o cálculo
+        Result hashing = Measure(target, [&]() { hash = HashDrawData(draw_data); });
+
+        // Compara as imagens dos dois renderizadores.
+        std::vector<unsigned char> stock_pixels, lean_pixels;
+        glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer());
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+        target.ReadPixels(stock_pixels);
+        glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer());
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        ui_renderer.RenderDrawData(draw_data, counters);
+        counters.EndFrame(1);
+        target.ReadPixels(lean_pixels);
+        size_t different = 0;
+        for (size_t i = 0; i < stock_pixels.size(); i += 4)
+            if (!std::equal(&stock_pixels[i], &stock_pixels[i] + 4, &lean_pixels[i]))
+                ++different;
+
+        // E a camada composta com a interface desenhada diretamente: as cores
+        // passam por uma textura de 8 bits pré-multiplicadas, e podem diferir
+        // por arredondamento.
+        std::vector<unsigned char> cached_pixels;
+        glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer());
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        ui_layer.Begin(WIDTH, HEIGHT);
+        ui_renderer.RenderDrawData(draw_data, counters, true);
+        ui_layer.End(target.Framebuffer());
+        glClearColor(0.45f, 0.55f, 0.60f, 1.0f);
+        ui_layer.Composite(counters);
+        counters.EndFrame(2);
+        target.ReadPixels(cached_pixels);
+        size_t cached_different = 0;
+        int max_channel_diff = 0;
+        for (size_t i = 0; i < lean_pixels.size(); i += 4)
+        {
+            int diff = 0;
+            for (size_t c = 0; c < 3; ++c)
+                diff = std::max(diff, std::abs((int)lean_pixels[i + c] - (int)cached_pixels[i + c]));
+            if (diff > 0)
+                ++cached_different;
+            max_channel_diff = std::max(max_channel_diff, diff);
+        }
+
+        printf("Renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+        printf("UI: %dx%d, %d draw lists, %d commands, %d vertices, %d indices\n", WIDTH, HEIGHT,
+               draw_data->CmdListsCount, commands, draw_data->TotalVtxCount, draw_data->TotalIdxCount);
+        printf("%-28s %10.1f us submit %10.1f us frame\n", "imgui_impl_opengl3", stock.submit_us, stock.frame_us);
+        printf("%-28s %10.1f us submit %10.1f us frame\n", "UiRenderer", lean.submit_us, lean.frame_us);
+        printf("%-28s %10.2fx submit %10.2fx frame\n", "Speedup", stock.submit_us / lean.submit_us, stock.frame_us / lean.frame_us);
+        printf("UiRenderer per frame: %llu draw calls, %llu texture binds, %llu uniform uploads, %llu bytes uploaded\n",
+               (unsigned long long)counters.Last(COUNTER_DRAW_CALLS), (unsigned long long)counters.Last(COUNTER_TEXTURE_BINDS),
+               (unsigned long long)counters.Last(COUNTER_UNIFORM_UPLOADS), (unsigned long long)counters.Last(COUNTER_BYTES_UPLOADED));
+        printf("Pixels different from imgui_impl_opengl3: %zu of %d\n", different, WIDTH * HEIGHT);
+        printf("%-28s %10.1f us submit %10.1f us frame\n", "UiLayer redraw + composite", redraw.submit_us, redraw.frame_us);
+        printf("%-28s %10.1f us submit %10.1f us frame\n", "UiLayer composite only", composite.submit_us, composite.frame_us);
+        printf("%-28s %10.1f us per frame\n", "HashDrawData", hashing.submit_us);
+        printf("UiLayer pixels different from UiRenderer: %zu of %d (max %d per channel)\n",
+               cached_different, WIDTH * HEIGHT, max_channel_diff);
+
+        ui_layer.Shutdown();
+        ui_renderer.Shutdown();
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui::DestroyContext();
+        gpu.Shutdown();
+    }
+    context.Destroy();
+    return 0;
+}
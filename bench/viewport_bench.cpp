@@ -0,0 +1,152 @@
+// Benchmark da janela "Viewport" (include/scene_viewport.h).
+//
+// Desenha uma cena limitada pelo preenchimento (camadas de triângulos que
+// cobrem a tela, com um fragment shader com algumas contas por pixel) em
+// uma imagem de 1280x720 com as escalas de resolução de 50%, 75% e 100%,
+// com e sem o passo de nitidez, e mede o tempo até a GPU terminar. Depois
+// simula o redimensionamento da janela, um pixel por frame, e conta quantos
+// alvos o RenderTargetPool criou. Só funciona no Linux (EGL, veja
+// headless.h); deve ser executado de dentro de bin/, como o programa
+// principal, para encontrar os shaders.
+#include <chrono>
+#include <cstdio>
+
+#include "headless.h"
+#include "render_counters.h"
+#include "scene_viewport.h"
+#include "shaders.h"
+
+static const int WIDTH = 1280;
+static const int HEIGHT = 720;
+static const int LAYERS = 8;
+static const int WARMUP_FRAMES = 5;
+static const int NUM_FRAMES = 40;
+
+// A cena: cada camada mistura um padrão com a anterior.
+static const char* SCENE_FRAGMENT =
+    "#version 330 core\n"
+    "uniform float camada;\n"
+    "out vec4 color;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 p = gl_FragCoord.xy * 0.02 + camada;\n"
+    "    float v = 0.5 + 0.5 * sin(p.x * 3.0 + cos(p.y * 2.0 + camada) * 4.0);\n"
+    "    color = vec4(v, 1.0 - v, fract(v * 7.0), 0.1);\n"
+    "}\n";
+
+static GLuint CompileSceneShader()
+{
+    GLuint shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(shader, 1, &SCENE_FRAGMENT, NULL);
+    glCompileShader(shader);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (ok != GL_TRUE)
+    {
+        fprintf(stderr, "ERROR: could not compile the scene shader.\n");
+        return 0;
+    }
+    return shader;
+}
+
+int main(int, char**)
+{
+    HeadlessContext context;
+    if (!context.Create())
+        return 1;
+    if (gl3wInit() != 0)
+    {
+        fprintf(stderr, "ERROR: failed to initialize the OpenGL loader.\n");
+        return 1;
+    }
+
+    {
+        GpuResourceManager gpu;
+        RenderCounters counters;
+        gpu.SetCounters(&counters);
+        SceneViewport viewport;
+        viewport.Init(gpu);
+
+        GLuint scene_shader = CompileSceneShader();
+        if (scene_shader == 0)
+            return 1;
+        GpuShader vertex_shader = gpu.AdoptShader("shader_ui_composite_vertex.glsl", LoadShader_Vertex("../src/shader_ui_composite_vertex.glsl"));
+        GpuShader fragment_shader = gpu.AdoptShader("viewport bench scene", scene_shader);
+        GpuProgram program = gpu.AdoptProgram("viewport bench", CreateGpuProgram(vertex_shader.Id(), fragment_shader.Id()));
+        GLint layer_uniform = glGetUniformLocation(program.Id(), "camada");
+        GpuVertexArray vertex_array = gpu.CreateVertexArray("viewport bench");
+        // O estado em que o resto do programa deixa o OpenGL.
+        glEnable(GL_DEPTH_TEST);
+        const ImVec4 clear_color(0.45f, 0.55f, 0.60f, 1.0f);
+
+        auto draw_scene = [&]() {
+            glDisable(GL_DEPTH_TEST);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glUseProgram(program.Id());
+            glBindVertexArray(vertex_array.Id());
+            for (int layer = 0; layer < LAYERS; ++layer)
+            {
+                glUniform1f(layer_uniform, (float)layer);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            }
+            glBindVertexArray(0);
+            glDisable(GL_BLEND);
+            glEnable(GL_DEPTH_TEST);
+        };
+
+        printf("Renderer: %s\n", (const char*)glGetString(GL_RENDERER));
+        printf("Scene: %d fullscreen layers, image %dx%d\n", LAYERS, WIDTH, HEIGHT);
+        double full_ms = 0.0;
+        for (int sharpen = 0; sharpen < 2; ++sharpen)
+        {
+            for (int s = SCENE_VIEWPORT_SCALE_COUNT - 1; s >= 0; --s)
+            {
+                SceneViewportLayout layout =
+                    ComputeSceneViewportLayout(WIDTH, HEIGHT, SCENE_VIEWPORT_SCALES[s] / 100.0f, SCENE_VIEWPORT_SCALES[s] / 100.0f,
+                                               sharpen ? 0.5f : 0.0f);
+                double ms = 0.0;
+                for (int f = 0; f < WARMUP_FRAMES + NUM_FRAMES; ++f)
+                {
+                    glFinish();
+                    auto start = std::chrono::steady_clock::now();
+                    if (viewport.Begin(layout, clear_color))
+                    {
+                        draw_scene();
+                        viewport.End(layout, counters);
+                    }
+                    glFinish();
+                    auto end = std::chrono::steady_clock::now();
+                    viewport.EndFrame();
+                    counters.EndFrame((uint64_t)f);
+                    if (f >= WARMUP_FRAMES)
+                        ms += std::chrono::duration<double, std::milli>(end - start).count() / NUM_FRAMES;
+                }
+                if (SCENE_VIEWPORT_SCALES[s] == 100 && !sharpen)
+                    full_ms = ms;
+                char name[48];
+                snprintf(name, sizeof(name), "%3d%% (%dx%d)%s", SCENE_VIEWPORT_SCALES[s], layout.scene_width,
+                         layout.scene_height, sharpen ? " + sharpen" : "");
+                printf("  %-34s %8.2f ms/frame %6.2fx\n", name, ms, full_ms / ms);
+            }
+        }
+
+        // Redimensionamento: a largura cresce um pixel por frame.
+        uint64_t created_before = viewport.Pool().Created();
+        const int resize_frames = 640;
+        for (int f = 0; f < resize_frames; ++f)
+        {
+            SceneViewportLayout layout = ComputeSceneViewportLayout(WIDTH / 2 + f, HEIGHT, 0.75f, 0.75f, 0.5f);
+            if (viewport.Begin(layout, clear_color))
+                viewport.End(layout, counters);
+            viewport.EndFrame();
+        }
+        printf("Resize over %d frames: %llu render targets created, %zu pooled at the end\n", resize_frames,
+               (unsigned long long)(viewport.Pool().Created() - created_before), viewport.Pool().Size());
+
+        viewport.Shutdown();
+        gpu.Shutdown();
+    }
+    context.Destroy();
+    return 0;
+}
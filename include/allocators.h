@@ -0,0 +1,145 @@
+#ifndef _ALLOCATORS_H
+#define _ALLOCATORS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+// Alocadores para memória de vida curta, que evitam o heap geral
+// (malloc/new) nos caminhos executados a cada frame:
+//
+//   - FrameAllocator: memória que vive somente durante um frame; pode ser
+//     usada por várias threads ao mesmo tempo (veja JobSystem::FrameMemory()).
+//   - LinearArena: o mesmo, para uma única thread, com marcas que permitem
+//     liberar somente o que foi alocado dentro de um escopo (ArenaScope).
+//
+// As duas arenas são std::pmr::memory_resource, de modo que containers
+// std::pmr::vector, std::pmr::string, ... podem usá-las diretamente:
+//
+//     ArenaScope scope(ScratchArena());
+//     std::pmr::vector<int> indices(&ScratchArena());
+
+// Alinha "address" para cima, para um múltiplo de "alignment" (potência de 2).
+inline uintptr_t AlignUp(uintptr_t address, size_t alignment)
+{
+    return (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+}
+
+// Alocador linear para dados que vivem somente durante um frame. Allocate()
+// é um único incremento atômico e pode ser chamada por qualquer thread; toda
+// a memória é liberada de uma vez por Reset(), que só pode ser chamada
+// quando nenhuma thread está alocando. Se o bloco se esgota, as alocações
+// excedentes vão para o heap até o próximo Reset().
+class FrameAllocator : public std::pmr::memory_resource {
+public:
+    explicit FrameAllocator(size_t capacity = 1 << 20);
+    ~FrameAllocator();
+
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void Reset();
+
+    size_t Capacity() const { return m_capacity; }
+    // Bytes usados desde o último Reset() (incluindo os que foram para o heap).
+    size_t Used() const { return m_offset.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(size_t size, size_t alignment) override { return Allocate(size, alignment); }
+    void  do_deallocate(void*, size_t, size_t) override {}
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    char*               m_buffer;
+    size_t              m_capacity;
+    std::atomic<size_t> m_offset;
+    std::mutex          m_overflow_mutex;
+    std::vector<void*>  m_overflow;
+};
+
+// Alocador linear para uma única thread. A memória é alocada do heap em
+// blocos; quando um bloco se esgota, outro é adicionado, e no próximo
+// Reset() os blocos são trocados por um único bloco do tamanho total usado.
+// Assim, depois dos primeiros frames, um uso estável não toca mais no heap.
+class LinearArena : public std::pmr::memory_resource {
+public:
+    // Posição da arena, para liberar tudo o que foi alocado depois dela.
+    struct Marker
+    {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+
+    explicit LinearArena(size_t initial_capacity = 64 * 1024);
+    ~LinearArena();
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    Marker Mark() const;
+    void Rewind(const Marker& marker);
+    void Reset();
+
+    size_t Used() const { return m_used; }
+    size_t Capacity() const;
+    // Maior valor de Used() desde a criação da arena.
+    size_t HighWater() const { return m_high_water; }
+
+private:
+    struct Block
+    {
+        char*  data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t size, size_t alignment) override { return Allocate(size, alignment); }
+    void  do_deallocate(void*, size_t, size_t) override {}
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::vector<Block> m_blocks;
+    size_t m_block;  // bloco atual
+    size_t m_offset; // posição no bloco atual
+    size_t m_used;
+    size_t m_high_water;
+};
+
+// Restaura a arena, ao sair do escopo, para a posição em que ela estava ao
+// entrar.
+class ArenaScope {
+public:
+    explicit ArenaScope(LinearArena& arena) : m_arena(arena), m_marker(arena.Mark()) {}
+    ~ArenaScope() { m_arena.Rewind(m_marker); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    LinearArena&        m_arena;
+    LinearArena::Marker m_marker;
+};
+
+// Arena de rascunho da thread atual, para alocações temporárias (por
+// exemplo, o código-fonte de um shader enquanto ele é compilado). Use sempre
+// com um ArenaScope.
+LinearArena& ScratchArena();
+
+// Contadores de alocações no heap geral (operator new/delete, de todas as
+// threads), mantidos pela substituição dos operadores globais em
+// allocators.cpp. Alocações feitas diretamente com malloc() (por exemplo,
+// pela ImGui e pela GLFW) não são contadas.
+struct HeapStats
+{
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t bytes_allocated;
+};
+
+HeapStats GetHeapStats();
+
+#endif // _ALLOCATORS_H
@@ -2,11 +2,15 @@
 #define CLASS_HEADER_INITIALIZE_GLOBALS
 #include "globals.h"
 #endif
+#include "input_events.h"
 // funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
+void WindowRefreshCallback(GLFWwindow* window);
 void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void CursorPosCallback(GLFWwindow* window, double xpos, double ypos);
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 void ErrorCallback(int error, const char* description);
+// Aplica um evento registrado pelos callbacks acima. Chamada pela simulação.
+void ProcessInputEvent(GLFWwindow* window, const InputEvent& event);
@@ -0,0 +1,68 @@
+#ifndef _CONST_MATH_H
+#define _CONST_MATH_H
+
+#include <cmath>
+
+// Funções matemáticas "constexpr": quando os argumentos são constantes, o
+// compilador calcula o resultado em tempo de compilação. Em tempo de execução
+// as mesmas funções chamam as versões da biblioteca padrão (std::sin, ...),
+// de forma que o resultado é idêntico ao do código escalar original.
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define CONST_MATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+// Sem como distinguir, usamos sempre as versões constexpr abaixo.
+#define CONST_MATH_IS_CONSTANT_EVALUATED() true
+#endif
+
+constexpr double CONST_MATH_PI = 3.14159265358979323846;
+
+// Raiz quadrada pelo método de Newton.
+constexpr double Const_SqrtNewton(double x, double guess, int iterations)
+{
+    return iterations == 0 ? guess : Const_SqrtNewton(x, 0.5 * (guess + x / guess), iterations - 1);
+}
+
+constexpr float Const_Sqrt(float x)
+{
+    if (!CONST_MATH_IS_CONSTANT_EVALUATED())
+        return std::sqrt(x);
+    if (x <= 0.0f)
+        return 0.0f;
+    return (float)Const_SqrtNewton(x, x > 1.0f ? x : 1.0, 64);
+}
+
+// Seno por série de Taylor, após reduzir o ângulo para [-pi, pi].
+constexpr double Const_SinTaylor(double x)
+{
+    long long turns = (long long)(x / (2.0 * CONST_MATH_PI));
+    x -= (double)turns * 2.0 * CONST_MATH_PI;
+    if (x > CONST_MATH_PI)
+        x -= 2.0 * CONST_MATH_PI;
+    if (x < -CONST_MATH_PI)
+        x += 2.0 * CONST_MATH_PI;
+
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 16; ++n)
+    {
+        term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr float Const_Sin(float angle)
+{
+    if (!CONST_MATH_IS_CONSTANT_EVALUATED())
+        return std::sin(angle);
+    return (float)Const_SinTaylor(angle);
+}
+
+constexpr float Const_Cos(float angle)
+{
+    if (!CONST_MATH_IS_CONSTANT_EVALUATED())
+        return std::cos(angle);
+    return (float)Const_SinTaylor(angle + CONST_MATH_PI / 2.0);
+}
+
+#endif // _CONST_MATH_H
@@ -0,0 +1,74 @@
+#ifndef _DYNAMIC_RESOLUTION_H
+#define _DYNAMIC_RESOLUTION_H
+
+#include <cstdint>
+
+// Resolução dinâmica da cena na janela "Viewport" (veja scene_viewport.h): a
+// escala é ajustada a cada frame medido para que o tempo de GPU do frame
+// fique dentro de um orçamento (por exemplo, 16.6 ms para 60 FPS).
+//
+// O controle é proporcional-integral (PI), no logaritmo da escala. Supondo
+// que o custo da cena é proporcional ao número de pixels (escala ao
+// quadrado), o erro de um frame é o quanto o log da escala teria de mudar
+// para que ele coubesse no orçamento:
+//
+//     erro = 0.5 * ln(orçamento / tempo medido)
+//
+// A parte integral acumula o erro e guarda o ponto de operação (a parte do
+// frame que não depende da escala, como a interface, é absorvida por ela);
+// a proporcional reage rápido a picos. Para que a imagem não oscile:
+//
+// - o erro é calculado sobre uma média móvel exponencial dos tempos (peso
+//   FILTER para a medida nova, cerca de GpuTimer::LATENCY frames de
+//   memória), e não sobre o tempo de cada frame, que tem ruído;
+// - médias a menos de HYSTERESIS do orçamento não mudam nada;
+// - a escala aplicada só muda quando a calculada se afasta dela mais do que
+//   MIN_STEP;
+// - a escala fica entre um mínimo e um máximo, e a integral também (sem
+//   acumular erro além dos limites, "anti-windup").
+//
+// Os tempos de GPU chegam alguns frames depois (veja GpuTimer::LATENCY); os
+// ganhos são baixos para que o atraso não cause oscilação, e cada frame
+// medido só é usado uma vez. Usada pela thread principal.
+class DynamicResolution {
+public:
+    static constexpr float KP = 0.3f;
+    static constexpr float KI = 0.15f;
+    static constexpr float FILTER = 0.2f;
+    static constexpr float HYSTERESIS = 0.05f; // fração do orçamento
+    static constexpr float MIN_STEP = 0.02f;
+    static constexpr int HISTORY = 240; // escalas guardadas para o gráfico
+
+    DynamicResolution();
+
+    // Orçamento por frame e limites da escala (frações da resolução da
+    // imagem, em (0, 1]).
+    void SetTarget(float target_ms, float min_scale, float max_scale);
+    // Tempo de GPU do frame "frame". Frames já usados (ou mais antigos) são
+    // ignorados. Retorna a escala a aplicar.
+    float Update(uint64_t frame, float gpu_ms);
+    // Volta à escala máxima e esquece a integral.
+    void Reset();
+
+    float Scale() const { return m_scale; }
+    float MinScale() const { return m_min_scale; }
+    float MaxScale() const { return m_max_scale; }
+    // Copia as escalas dos últimos frames medidos, da mais antiga para a
+    // mais recente. Retorna quantas foram copiadas.
+    int History(float* out, int max_values) const;
+
+private:
+    float    m_target_ms;
+    float    m_min_scale;
+    float    m_max_scale;
+    float    m_integral; // log da escala
+    float    m_scale;    // escala aplicada
+    float    m_filtered_ms;
+    uint64_t m_last_frame;
+
+    float m_history[HISTORY];
+    int   m_history_next;
+    int   m_history_size;
+};
+
+#endif // _DYNAMIC_RESOLUTION_H
@@ -0,0 +1,55 @@
+#ifndef _FONT_CACHE_H
+#define _FONT_CACHE_H
+
+#include <cstdint>
+
+#include "imgui.h"
+
+// Cache em disco do atlas de fontes da ImGui. Construir o atlas
+// (ImFontAtlas::Build()) rasteriza com o stb_truetype cada glyph de cada
+// fonte, em cada tamanho; com várias fontes e faixas grandes de caracteres
+// isso custa dezenas de milissegundos a cada inicialização, para produzir
+// sempre o mesmo resultado. O cache guarda o resultado: os pixels do atlas
+// (um byte de alfa por pixel), os glyphs e as métricas de cada fonte, e a
+// posição dos retângulos internos da ImGui (cursores do mouse).
+//
+// As fontes são adicionadas ao atlas normalmente (AddFontFromFileTTF(),
+// ...), e no lugar de Build():
+//
+//     FontAtlasStats stats;
+//     BuildFontAtlas(io.Fonts, "font_atlas.cache", &stats);
+//
+// O arquivo é identificado por uma chave calculada das entradas do atlas: o
+// conteúdo de cada arquivo de fonte, tamanhos, faixas de caracteres, opções
+// de rasterização e a versão da ImGui. Se qualquer uma muda, o cache é
+// ignorado e reescrito. Quando a chave bate, o arquivo é mapeado na memória
+// e copiado para o atlas, que fica no mesmo estado de depois de Build():
+// GetTexDataAsRGBA32(), chamada pelo renderizador da ImGui ao criar a
+// textura das fontes, usa os pixels do cache sem rasterizar nada.
+//
+// Como o atlas inteiro, deve ser usado antes do primeiro ImGui::NewFrame().
+
+struct FontAtlasStats
+{
+    bool   cache_hit;
+    bool   cache_written;
+    double milliseconds; // Load ou Build (+ Save)
+};
+
+// Chave das entradas de "atlas" (fontes adicionadas, ainda não construídas).
+uint64_t FontAtlasKey(const ImFontAtlas* atlas);
+
+// Preenche "atlas" com o cache de "path". Retorna false, sem modificar o
+// atlas, se o arquivo não existe, não é um cache válido ou é de outra
+// chave.
+bool LoadFontAtlasCache(ImFontAtlas* atlas, const char* path);
+
+// Grava o atlas construído em "path". Retorna false se não pôde gravar.
+bool SaveFontAtlasCache(const ImFontAtlas* atlas, const char* path);
+
+// Carrega o atlas do cache ou, se não for possível, o constrói e grava o
+// cache. Com "path" NULL, apenas constrói. Retorna false se a construção
+// falhou.
+bool BuildFontAtlas(ImFontAtlas* atlas, const char* path, FontAtlasStats* stats);
+
+#endif
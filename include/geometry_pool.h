@@ -0,0 +1,184 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_GEOMETRY_POOL_HEADER
+#define CLASS_GEOMETRY_POOL_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gpu_resources.h"
+
+// Sub-alocador de faixas [offset, offset + size) dentro de um espaço de
+// "capacity" elementos. Os blocos livres ficam em uma lista ordenada por
+// posição (para juntar vizinhos em Free()) e em outra ordenada por tamanho
+// (para escolher, em Allocate(), o menor bloco onde a faixa cabe).
+class RangeAllocator {
+public:
+    explicit RangeAllocator(uint32_t capacity = 0);
+
+    // Retorna false se não há bloco livre com "size" elementos contíguos.
+    bool Allocate(uint32_t size, uint32_t* offset);
+    void Free(uint32_t offset, uint32_t size);
+    // Ocupa uma faixa específica, que deve estar inteiramente livre.
+    void AllocateAt(uint32_t offset, uint32_t size);
+    // Aumenta o espaço; os novos elementos ficam livres no final.
+    void Grow(uint32_t new_capacity);
+
+    // Primeiro bloco livre que não está no final do espaço (um "buraco"),
+    // ou false se não há nenhum.
+    bool FirstHole(uint32_t* offset, uint32_t* size) const;
+
+    uint32_t Capacity() const { return m_capacity; }
+    uint32_t Used() const { return m_used; }
+    uint32_t FreeBlocks() const { return (uint32_t)m_by_offset.size(); }
+    uint32_t LargestFreeBlock() const;
+    // 0 quando todo o espaço livre é contíguo; próximo de 1 quando ele está
+    // espalhado em muitos blocos pequenos.
+    float Fragmentation() const;
+
+private:
+    void Insert(uint32_t offset, uint32_t size);
+    void Erase(std::map<uint32_t, uint32_t>::iterator it);
+
+    uint32_t m_capacity;
+    uint32_t m_used;
+    std::map<uint32_t, uint32_t>      m_by_offset; // offset -> size
+    std::multimap<uint32_t, uint32_t> m_by_size;   // size -> offset
+};
+
+// Um atributo de vértice do formato de um GeometryPool: "components" floats
+// lidos no "location" correspondente do vertex shader.
+struct GeometryAttribute
+{
+    GLuint location;
+    GLint  components;
+};
+
+static const int GEOMETRY_MAX_ATTRIBUTES = 4;
+
+// Faixa de uma malha nos buffers do pool, no formato esperado por
+// glDrawElementsBaseVertex(): os índices da malha começam em "first_index" e
+// referenciam vértices a partir de "base_vertex". Muda quando o pool cresce
+// ou é desfragmentado, por isso deve ser consultada a cada frame com
+// GeometryPool::Range().
+struct GeometryRange
+{
+    GLint   base_vertex;
+    GLuint  first_index;
+    GLsizei vertex_count;
+    GLsizei index_count;
+};
+
+struct GeometryPoolStats
+{
+    uint32_t allocations;
+    uint32_t vertex_capacity;
+    uint32_t vertices_used;
+    uint32_t vertex_free_blocks;
+    float    vertex_fragmentation;
+    uint32_t index_capacity;
+    uint32_t indices_used;
+    uint32_t index_free_blocks;
+    float    index_fragmentation;
+    size_t   bytes_used;
+    size_t   bytes_capacity;
+    uint64_t bytes_moved; // total copiado pela desfragmentação
+};
+
+// Buffers de geometria compartilhados por todas as malhas de um mesmo
+// formato de vértice: um VBO grande por atributo, um buffer de índices e um
+// único VAO. Cada malha recebe uma faixa de vértices e outra de índices
+// (GeometryRef), e qualquer combinação de malhas pode ser desenhada com o
+// VAO ligado uma só vez, trocando apenas os parâmetros de
+// glDrawElementsBaseVertex(). Os índices de cada malha são relativos ao seu
+// primeiro vértice, e não precisam ser reescritos quando a malha é movida.
+//
+// Quando uma faixa não cabe, o buffer correspondente dobra de tamanho. As
+// faixas liberadas deixam buracos, que Defragment() fecha aos poucos, a cada
+// frame, movendo as malhas com cópias de buffer para buffer feitas pela
+// própria GPU (glCopyBufferSubData()).
+//
+// Assim como o GpuResourceManager, só pode ser usado pela thread que detém o
+// contexto OpenGL; Stats() pode ser chamada por qualquer thread.
+class GeometryPool {
+public:
+    GeometryPool(GpuResourceManager& gpu, const char* name, const GeometryAttribute* attributes, int num_attributes,
+                 uint32_t vertex_capacity = 16 * 1024, uint32_t index_capacity = 64 * 1024);
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // Reserva uma faixa de vertex_count vértices e outra de index_count
+    // índices (ambos maiores que zero), aumentando os buffers se necessário.
+    GeometryRef Allocate(uint32_t vertex_count, uint32_t index_count);
+    void Free(GeometryRef geometry);
+
+    // Copiam os dados de uma malha para o pool: "data" tem vertex_count *
+    // components floats do atributo "attribute", ou index_count índices.
+    void WriteVertices(GeometryRef geometry, int attribute, const GLfloat* data);
+    void WriteIndices(GeometryRef geometry, const GLuint* data);
+
+    GeometryRange Range(GeometryRef geometry) const;
+    GLuint VertexArray() const { return m_vertex_array.Id(); }
+
+    // Move malhas para fechar buracos, copiando no máximo "max_bytes" bytes
+    // (aproximadamente) por chamada. Retorna o número de bytes copiados.
+    size_t Defragment(size_t max_bytes);
+
+    GeometryPoolStats Stats() const;
+
+private:
+    struct Allocation
+    {
+        uint32_t generation;
+        bool     alive;
+        uint32_t first_vertex;
+        uint32_t vertex_count;
+        uint32_t first_index;
+        uint32_t index_count;
+    };
+
+    const Allocation* Find(GeometryRef geometry) const;
+    size_t VertexSize() const;
+    void GrowVertices(uint32_t min_capacity);
+    void GrowIndices(uint32_t min_capacity);
+    void SetupVertexArray();
+    void CopyRange(GLuint buffer, size_t from, size_t to, size_t bytes);
+    size_t MoveVertices(uint32_t hole, uint32_t hole_size);
+    size_t MoveIndices(uint32_t hole, uint32_t hole_size);
+    void UpdateStats();
+
+    GpuResourceManager& m_gpu;
+    std::string         m_name;
+
+    GeometryAttribute m_attributes[GEOMETRY_MAX_ATTRIBUTES];
+    int               m_num_attributes;
+
+    GpuVertexArray m_vertex_array;
+    GpuBuffer      m_vertex_buffers[GEOMETRY_MAX_ATTRIBUTES];
+    GpuBuffer      m_index_buffer;
+    GpuBuffer      m_copy_buffer; // usado para mover faixas que se sobrepõem
+    size_t         m_copy_buffer_size;
+
+    RangeAllocator m_vertices;
+    RangeAllocator m_indices;
+
+    std::vector<Allocation> m_allocations;
+    std::vector<uint32_t>   m_free;
+    // Qual alocação ocupa cada faixa, pela posição inicial.
+    std::map<uint32_t, uint32_t> m_vertex_owner;
+    std::map<uint32_t, uint32_t> m_index_owner;
+
+    uint64_t           m_bytes_moved;
+    mutable std::mutex m_stats_mutex;
+    GeometryPoolStats  m_stats;
+};
+
+#endif
@@ -53,6 +53,111 @@ extern float g_FrustumFarPlane;
 // Variável que controla a cor do plano de clear.
 extern ImVec4 g_ClearColor;
 
+// Variáveis que controlam o loop de frames: modo de apresentação (veja
+// PresentMode em timestep.h), limite de frames por segundo no modo
+// PRESENT_THROTTLED e frequência da simulação (passos por segundo).
+extern int g_PresentMode;
+extern float g_ThrottleFPS;
+extern float g_SimulationHz;
+// Modo de baixa latência: a thread principal espera o frame anterior ser
+// apresentado antes de ler a entrada, e lê a entrada de novo logo antes de
+// publicar o frame. Limite da fila da GPU em frames (0: o driver decide).
+// Veja RenderThread::LimitGpuQueue().
+extern bool g_LowLatency;
+extern int g_GpuQueueDepth;
+
+// Passos de simulação executados no último frame e fração de passo usada na
+// interpolação. Atualizadas dentro do loop principal.
+extern int g_SimulationSteps;
+extern float g_SimulationAlpha;
+
+// Tempos (em milissegundos) de cada thread no último frame: a principal
+// (eventos, simulação e interface) e a de renderização. Veja render_thread.h.
+extern float g_MainThreadMs;
+extern float g_MainThreadWaitMs;
+extern float g_RenderSubmitMs;
+extern float g_RenderSwapMs;
+extern float g_RenderIdleMs;
+// Ritmo dos frames apresentados (veja PacingStats em timestep.h), em
+// milissegundos: intervalo médio, jitter e latência média e máxima da
+// entrada até a apresentação.
+extern float g_FrameIntervalMs;
+extern float g_PacingJitterMs;
+extern float g_LatencyMs;
+extern float g_MaxLatencyMs;
+
+// Alocações no heap (operator new) feitas no último frame, por todas as
+// threads. Veja allocators.h.
+extern int g_FrameHeapAllocations;
+extern float g_FrameHeapKiB;
+
+// Orçamento de memória de GPU e uso atual por categoria, com o número de
+// recursos despejados e recarregados até agora. Veja gpu_resources.h.
+extern float g_GpuBudgetMiB;
+extern float g_GpuBufferKiB;
+extern float g_GpuTextureKiB;
+extern int g_GpuEvictions;
+extern int g_GpuReloads;
+
+// Uso dos buffers de geometria compartilhados (veja geometry_pool.h):
+// ocupado, capacidade, fragmentação do espaço livre (0 a 1) e total já
+// movido pela desfragmentação.
+extern float g_GeometryUsedKiB;
+extern float g_GeometryCapacityKiB;
+extern float g_GeometryFragmentation;
+extern float g_GeometryMovedKiB;
+
+// Pedido, feito pela interface, para salvar um arquivo de trace com os
+// últimos frames (veja trace.h). Atendido e desligado pelo loop principal.
+extern bool g_SaveTrace;
+// Se os contadores de cada frame devem ser gravados em um arquivo CSV (veja
+// render_counters.h). O loop principal abre ou fecha o arquivo.
+extern bool g_RecordCounters;
+// Se a interface é desenhada pelo renderizador próprio (veja ui_renderer.h)
+// ou pelo da ImGui (imgui_impl_opengl3.cpp).
+extern bool g_LeanUiRenderer;
+
+// Detector de travamentos (veja hitch_watchdog.h): múltiplo da mediana a
+// partir do qual um frame é um travamento, travamentos gravados e mediana
+// atual do tempo de frame.
+extern float g_HitchThreshold;
+extern int g_HitchCount;
+extern float g_FrameMedianMs;
+
+// Modo ocioso (veja idle_mode.h): se o loop dorme quando nada muda, quantas
+// vezes dormiu e o tempo total dormindo.
+extern bool g_IdleMode;
+extern int g_IdleWakeups;
+extern float g_IdleSleptSeconds;
+
+// Camada da interface (veja ui_layer.h): se a interface é guardada em uma
+// textura e só redesenhada quando muda, quantas vezes por segundo (no
+// máximo) valores mostrados na tela, sem interação, a atualizam, e quantas
+// vezes foi redesenhada.
+extern bool g_UiCache;
+extern float g_UiLiveRefreshHz;
+extern int g_UiRedraws;
+
+// Se o atlas de fontes é lido do cache em disco (veja font_cache.h).
+extern bool g_FontCache;
+
+// Janela "Viewport" (veja scene_viewport.h): se a cena é desenhada fora da
+// tela e mostrada nela, o índice da escala em SCENE_VIEWPORT_SCALES e a
+// intensidade da nitidez na ampliação (0 desliga o filtro).
+extern bool g_SceneViewport;
+extern int g_ViewportScale;
+extern float g_ViewportSharpen;
+// Resolução dinâmica da janela "Viewport" (veja dynamic_resolution.h): se
+// está ligada (no lugar de g_ViewportScale), o orçamento de tempo de GPU por
+// frame e os limites da escala.
+extern bool g_DynamicResolution;
+extern float g_ResolutionTargetMs;
+extern float g_ResolutionMinScale;
+extern float g_ResolutionMaxScale;
+
+class GpuTimer;
+class RenderCounters;
+
 class Globals {
 public:
   // Variável da cena atual.
@@ -65,4 +170,12 @@ public:
 
   // Variável que controla o ImGui.
   static ImGuiIO* g_Io;
+
+  // Tempos de GPU de cada etapa do frame, mostrados na interface. Veja
+  // gpu_timer.h.
+  static GpuTimer* g_GpuTimer;
+
+  // Contadores de desenho, trocas de estado e envios de cada frame. Veja
+  // render_counters.h.
+  static RenderCounters* g_RenderCounters;
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+#ifndef _GLYPH_CACHE_H
+#define _GLYPH_CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "imgui.h"
+
+class JobSystem;
+
+// Pixels de glyphs novos, a enviar para a textura do atlas de fontes com
+// glTexSubImage2D() (veja RenderThread::Draw()). Vazio quando width == 0.
+struct GlyphUpload
+{
+    ImTextureID texture; // do atlas (ImFontAtlas::TexID)
+    int x, y;
+    int width, height;
+    std::vector<unsigned char> pixels; // RGBA, linhas de cima para baixo
+};
+
+// Atlas de glyphs sob demanda para uma fonte. Construir o atlas da ImGui com
+// faixas inteiras de caracteres (cirílico, grego, latim estendido, ...)
+// rasteriza centenas de glyphs que a sessão nunca mostra, e a textura cresce
+// com eles. Aqui a fonte é construída só com o ASCII, e o atlas reserva uma
+// área livre (um retângulo do usuário, veja ImFontAtlas::AddCustomRectRegular());
+// os demais glyphs são rasterizados quando aparecem, empacotados na área com
+// o imstb_rectpack e acrescentados à fonte.
+//
+//     GlyphCache cache;
+//     cache.Attach(atlas, font, 496, 256);  // antes de construir o atlas
+//     atlas->Build();
+//     cache.Init();                         // depois
+//
+//     // A cada frame, antes do texto ser desenhado:
+//     cache.Request(text);
+//     cache.Flush(&jobs);
+//     cache.TakeUpload(packet.glyph_upload);
+//
+// Request() só anota os caracteres que faltam; Flush() os empacota e os
+// rasteriza em paralelo nas threads do JobSystem, cada glyph direto na sua
+// posição nos pixels do atlas (as regiões não se sobrepõem), e os registra
+// na fonte. Os pixels novos saem em TakeUpload() e são enviados pela thread
+// de renderização junto com o frame que os usa pela primeira vez, então o
+// texto novo já aparece com os glyphs certos.
+//
+// Quando a área enche, os glyphs dinâmicos não pedidos nos últimos
+// EVICT_FRAMES frames são descartados: a área é esvaziada, e os usados
+// recentemente são rasterizados de novo (o empacotador não libera
+// retângulos individuais).
+//
+// Usado apenas pela thread principal, fora de ImGui::Render() (o desenho da
+// interface na thread de renderização usa só a cópia dos vértices).
+class GlyphCache {
+public:
+    static const uint32_t EVICT_FRAMES = 120;
+
+    GlyphCache();
+    ~GlyphCache();
+
+    GlyphCache(const GlyphCache&) = delete;
+    GlyphCache& operator=(const GlyphCache&) = delete;
+
+    // Reserva a área de "width" x "height" pixels no atlas para glyphs de
+    // "font". Deve ser chamada depois de adicionar a fonte e antes de
+    // construir o atlas. Aumenta ImFontAtlas::TexDesiredWidth, se preciso,
+    // para a área caber na largura da textura.
+    void Attach(ImFontAtlas* atlas, ImFont* font, int width, int height);
+    // Prepara a rasterização, com o atlas já construído. Retorna false se a
+    // área não foi empacotada ou a fonte não pôde ser lida.
+    bool Init();
+
+    // Anota os caracteres de "text" (UTF-8) que a fonte ainda não tem, e
+    // marca os que tem como usados neste frame.
+    void Request(const char* text, const char* text_end = NULL);
+    void Request(const ImWchar* chars, int count);
+    // Rasteriza e registra os caracteres anotados. "jobs" pode ser NULL
+    // (tudo na thread que chama). Retorna o número de glyphs novos.
+    int Flush(JobSystem* jobs);
+    // Passa para "upload" os pixels modificados desde a última chamada.
+    // Retorna false (e deixa "upload" vazio) se não há nada.
+    bool TakeUpload(GlyphUpload& upload);
+
+    // Deve ser chamada uma vez por frame, para a idade dos glyphs.
+    void EndFrame() { ++m_frame; }
+
+    ImFont* Font() const { return m_font; }
+    int DynamicGlyphs() const;
+    // Fração da área ocupada (pela altura do empacotador).
+    float AreaUsage() const;
+    uint64_t Evictions() const { return m_evictions; }
+    uint64_t Rasterized() const { return m_rasterized; }
+
+private:
+    struct Impl;
+
+    void Evict();
+    void MarkDirty(int x, int y, int width, int height);
+
+    ImFontAtlas* m_atlas;
+    ImFont*      m_font;
+    int          m_rect_id;         // retângulo da área no atlas
+    int          m_area_x, m_area_y, m_area_width, m_area_height;
+    int          m_static_glyphs;   // glyphs construídos com o atlas
+    Impl*        m_impl;            // fonte e empacotador do stb
+
+    ImVector<ImWchar>  m_pending;
+    std::vector<uint8_t>  m_state;     // por caractere: veja GlyphState em glyph_cache.cpp
+    std::vector<uint32_t> m_last_used; // por caractere: frame do último Request()
+    uint32_t m_frame;
+    uint64_t m_evictions;
+    uint64_t m_rasterized;
+
+    int m_dirty_x0, m_dirty_y0, m_dirty_x1, m_dirty_y1; // vazio se x0 >= x1
+};
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_GPU_RESOURCES_HEADER
+#define CLASS_GPU_RESOURCES_HEADER
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "render_counters.h"
+
+// Tipos de objetos OpenGL gerenciados por GpuResourceManager.
+enum GpuResourceType
+{
+    GPU_BUFFER       = 0, // VBOs e buffers de índices
+    GPU_TEXTURE      = 1,
+    GPU_VERTEX_ARRAY = 2, // VAOs (as malhas "streamable" são VAOs)
+    GPU_PROGRAM      = 3,
+    GPU_SHADER       = 4,
+    GPU_FRAMEBUFFER  = 5, // FBOs (não ocupam memória própria; veja render_target.h)
+    GPU_RESOURCE_TYPES
+};
+
+// Referência não-dona a um recurso: índice na tabela do gerenciador mais a
+// geração do item, para detectar referências a recursos já liberados.
+struct GpuResourceRef
+{
+    uint32_t index;
+    uint32_t generation;
+};
+
+class GpuResourceManager;
+
+// Recria o conteúdo de um recurso "streamable" que foi despejado da GPU.
+// Para malhas, é chamada com o VAO (recém-criado) ligado; os buffers da
+// malha devem ser criados com GpuResourceManager::CreateMeshBuffer().
+typedef void (*GpuResourceLoader)(GpuResourceManager& gpu, GpuResourceRef resource, void* user_data);
+
+// Handle dono de um recurso (RAII): o objeto OpenGL é liberado quando o
+// handle é destruído. Pode ser movido, mas não copiado; para guardar uma
+// referência em outro lugar use Ref().
+template <GpuResourceType TYPE>
+class GpuHandle {
+public:
+    GpuHandle() : m_manager(NULL) { m_ref.index = 0; m_ref.generation = 0; }
+    ~GpuHandle() { Reset(); }
+
+    GpuHandle(GpuHandle&& other) : m_manager(other.m_manager), m_ref(other.m_ref) { other.m_manager = NULL; }
+    GpuHandle& operator=(GpuHandle&& other)
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_manager = other.m_manager;
+            m_ref = other.m_ref;
+            other.m_manager = NULL;
+        }
+        return *this;
+    }
+
+    GpuHandle(const GpuHandle&) = delete;
+    GpuHandle& operator=(const GpuHandle&) = delete;
+
+    // Libera o recurso.
+    inline void Reset();
+
+    // Nome OpenGL atual (0 se o recurso foi despejado).
+    inline GLuint Id() const;
+    GpuResourceRef Ref() const { return m_ref; }
+    explicit operator bool() const { return m_manager != NULL; }
+
+private:
+    friend class GpuResourceManager;
+    GpuHandle(GpuResourceManager* manager, GpuResourceRef ref) : m_manager(manager), m_ref(ref) {}
+
+    GpuResourceManager* m_manager;
+    GpuResourceRef      m_ref;
+};
+
+typedef GpuHandle<GPU_BUFFER>       GpuBuffer;
+typedef GpuHandle<GPU_TEXTURE>      GpuTexture;
+typedef GpuHandle<GPU_VERTEX_ARRAY> GpuVertexArray;
+typedef GpuHandle<GPU_PROGRAM>      GpuProgram;
+typedef GpuHandle<GPU_SHADER>       GpuShader;
+typedef GpuHandle<GPU_FRAMEBUFFER>  GpuFramebuffer;
+
+// Estatísticas do gerenciador. Podem ser lidas por qualquer thread.
+struct GpuMemoryStats
+{
+    size_t   bytes[GPU_RESOURCE_TYPES];
+    uint32_t count[GPU_RESOURCE_TYPES];
+    size_t   total_bytes;
+    size_t   budget_bytes;
+    uint64_t evictions;
+    uint64_t reloads;
+};
+
+// Dono de todos os objetos OpenGL da aplicação (buffers, texturas, VAOs e
+// programas). Contabiliza a memória de GPU alocada em cada categoria e
+// mantém o total abaixo de um orçamento: quando ele é ultrapassado, as
+// malhas e texturas "streamable" usadas há mais tempo (LRU) são despejadas,
+// e recarregadas pelo seu GpuResourceLoader na próxima vez em que forem
+// usadas.
+//
+// Exceto por Stats() e SetBudget(), todos os métodos fazem chamadas OpenGL e
+// só podem ser chamados pela thread que detém o contexto (a principal
+// durante a inicialização, e depois a de renderização).
+class GpuResourceManager {
+public:
+    explicit GpuResourceManager(size_t budget_bytes = 256u << 20);
+    ~GpuResourceManager();
+
+    GpuResourceManager(const GpuResourceManager&) = delete;
+    GpuResourceManager& operator=(const GpuResourceManager&) = delete;
+
+    // Criação de recursos residentes (nunca despejados).
+    GpuBuffer      CreateBuffer(const char* name);
+    GpuTexture     CreateTexture(const char* name);
+    GpuVertexArray CreateVertexArray(const char* name);
+    GpuFramebuffer CreateFramebuffer(const char* name);
+    // Assume a posse de objetos criados por outras funções (por exemplo,
+    // CreateGpuProgram() e LoadShader_Vertex() em shaders.cpp).
+    GpuProgram     AdoptProgram(const char* name, GLuint program_id);
+    GpuShader      AdoptShader(const char* name, GLuint shader_id);
+
+    // Recursos "streamable": o conteúdo é carregado agora por "loader" e
+    // pode ser despejado e recarregado depois.
+    GpuVertexArray CreateStreamableMesh(const char* name, GpuResourceLoader loader, void* user_data);
+    GpuTexture     CreateStreamableTexture(const char* name, GpuResourceLoader loader, void* user_data);
+
+    // Cria (com glGenBuffers()) um buffer que pertence à malha "mesh": ele
+    // é despejado junto com a malha e recriado pelo seu loader.
+    GLuint CreateMeshBuffer(GpuResourceRef mesh);
+
+    // Versões de glBufferData() e glTexImage2D() (alvo GL_TEXTURE_2D) que
+    // contabilizam a memória do buffer ou textura, que deve estar ligado.
+    void BufferData(GLuint buffer, GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+    void TexImage2D(GLuint texture, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+                    GLenum format, GLenum type, const void* data);
+    // glBufferSubData(), no buffer ligado a "target".
+    void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+
+    // Os bytes enviados por BufferData(), TexImage2D() e BufferSubData() são
+    // somados a COUNTER_BYTES_UPLOADED de "counters" (veja render_counters.h).
+    void SetCounters(RenderCounters* counters) { m_counters = counters; }
+
+    // Nome OpenGL do recurso para desenhar neste frame. Marca o recurso como
+    // usado e, se ele foi despejado, o recarrega.
+    GLuint Use(GpuResourceRef resource);
+    // Nome OpenGL atual, sem marcar uso nem recarregar (0 se despejado).
+    GLuint Name(GpuResourceRef resource) const;
+
+    // Chamada uma vez por frame, após os comandos de desenho: despeja
+    // recursos até o total ficar abaixo do orçamento.
+    void EndFrame();
+
+    void SetBudget(size_t budget_bytes) { m_budget_bytes.store(budget_bytes, std::memory_order_relaxed); }
+    GpuMemoryStats Stats() const;
+
+    // Libera todos os recursos restantes. Deve ser chamada antes de o
+    // contexto OpenGL ser destruído; depois dela, destruir handles não tem
+    // efeito.
+    void Shutdown();
+
+    // Usada pelos handles.
+    void Release(GpuResourceRef resource);
+
+private:
+    static const uint32_t NO_PARENT = 0xFFFFFFFFu;
+
+    struct Entry
+    {
+        std::string       name;
+        GLuint            gl_name;
+        GpuResourceType   type;
+        uint32_t          generation;
+        bool              alive;
+        bool              streamable;
+        bool              resident;
+        size_t            bytes;       // memória do próprio objeto
+        uint32_t          parent;      // malha dona do buffer, ou NO_PARENT
+        std::vector<uint32_t> children; // buffers de uma malha
+        GpuResourceLoader loader;
+        void*             user_data;
+        uint64_t          last_used;
+    };
+
+    GpuResourceRef Create(const char* name, GpuResourceType type, GLuint gl_name);
+    Entry* Find(GpuResourceRef resource);
+    const Entry* Find(GpuResourceRef resource) const;
+    void SetBytes(uint32_t index, size_t bytes);
+    void DeleteGlObject(Entry& entry);
+    void Load(uint32_t index);
+    void Evict(uint32_t index);
+    size_t GroupBytes(uint32_t index) const;
+    void FreeEntry(uint32_t index);
+
+    std::vector<Entry>    m_entries;
+    std::vector<uint32_t> m_free;
+
+    // Índice do item de cada buffer e textura, pelo nome OpenGL.
+    std::unordered_map<GLuint, uint32_t> m_buffers_by_name;
+    std::unordered_map<GLuint, uint32_t> m_textures_by_name;
+
+    uint64_t              m_frame;
+    bool                  m_shutdown;
+    RenderCounters*       m_counters;
+
+    std::atomic<size_t>   m_bytes[GPU_RESOURCE_TYPES];
+    std::atomic<uint32_t> m_count[GPU_RESOURCE_TYPES];
+    std::atomic<size_t>   m_budget_bytes;
+    std::atomic<uint64_t> m_evictions;
+    std::atomic<uint64_t> m_reloads;
+};
+
+template <GpuResourceType TYPE>
+inline void GpuHandle<TYPE>::Reset()
+{
+    if (m_manager != NULL)
+        m_manager->Release(m_ref);
+    m_manager = NULL;
+}
+
+template <GpuResourceType TYPE>
+inline GLuint GpuHandle<TYPE>::Id() const
+{
+    return (m_manager != NULL) ? m_manager->Name(m_ref) : 0;
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_GPU_TIMER_HEADER
+#define CLASS_GPU_TIMER_HEADER
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "timestep.h"
+#include "trace.h"
+
+// Etapas ("passes") de um frame medidas separadamente na GPU. Veja
+// RenderThread::Draw().
+enum GpuPass
+{
+    GPU_PASS_FACES = 0, // faces dos cubos
+    GPU_PASS_AXES,      // eixos dos cubos e eixos globais
+    GPU_PASS_EDGES,     // arestas pretas e o ponto sobre o vértice
+    GPU_PASS_UI,        // interface (ImGui)
+    GPU_PASS_COUNT
+};
+
+const char* GpuPassName(int pass);
+
+// Tempos de um frame já desenhado. Os instantes estão em microssegundos no
+// relógio da CPU (FrameClock), para que possam ser colocados na mesma linha
+// do tempo que os intervalos medidos na CPU.
+struct GpuFrameTimings
+{
+    uint64_t frame;
+    uint32_t passes;                   // bit (1 << pass) ligado se a etapa foi medida
+    double   begin_us;                 // frame inteiro, na GPU
+    double   end_us;
+    double   pass_begin_us[GPU_PASS_COUNT];
+    double   pass_end_us[GPU_PASS_COUNT];
+    // Intervalos da thread de renderização (CPU): envio dos comandos e
+    // apresentação (glfwSwapBuffers() e limite de FPS).
+    double   submit_begin_us;
+    double   submit_end_us;
+    double   present_end_us;
+
+    float FrameMs() const { return (float)((end_us - begin_us) / 1000.0); }
+    float PassMs(int pass) const { return (float)((pass_end_us[pass] - pass_begin_us[pass]) / 1000.0); }
+};
+
+// Último valor, média e máximo do histórico, em milissegundos. A posição
+// GPU_PASS_COUNT guarda o frame inteiro.
+struct GpuTimerSummary
+{
+    int   frames;
+    float last_ms[GPU_PASS_COUNT + 1];
+    float average_ms[GPU_PASS_COUNT + 1];
+    float max_ms[GPU_PASS_COUNT + 1];
+};
+
+// Mede quanto tempo a GPU gasta em cada etapa do frame com consultas de
+// tempo (glQueryCounter(GL_TIMESTAMP)), uma no início e outra no fim de cada
+// etapa e do frame inteiro.
+//
+// O resultado de uma consulta só fica pronto quando a GPU chega até ela,
+// normalmente um ou dois frames depois; pedir o resultado antes disso faz a
+// CPU esperar pela GPU. Por isso as consultas ficam em um anel de LATENCY
+// conjuntos, um por frame: o conjunto do frame N só é lido quando vai ser
+// reutilizado, no frame N + LATENCY, e apenas se já estiver pronto. Se não
+// estiver, o frame é descartado (veja Dropped()) em vez de esperar.
+//
+// Init(), Shutdown() e as funções de medida são chamadas pela thread que
+// detém o contexto OpenGL; Summary(), History() e AppendTraceEvents() podem
+// ser chamadas por qualquer thread.
+class GpuTimer {
+public:
+    static const int LATENCY = 4;
+    static const int HISTORY = 240; // frames guardados para o gráfico e o trace
+
+    GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void Init();
+    void Shutdown();
+
+    // Lê os resultados prontos e começa a medir o frame "frame".
+    void BeginFrame(uint64_t frame);
+    void BeginPass(GpuPass pass);
+    void EndPass(GpuPass pass);
+    void EndFrame();
+    // Guarda os instantes medidos na CPU pela thread de renderização para o
+    // frame atual, depois da apresentação.
+    void SetCpuTimes(FrameClock::time_point submit_begin, FrameClock::time_point submit_end,
+                     FrameClock::time_point present_end);
+
+    GpuTimerSummary Summary() const;
+    // Copia os tempos (em ms) dos últimos frames, do mais antigo para o mais
+    // recente, da etapa "pass" (ou do frame inteiro, se pass ==
+    // GPU_PASS_COUNT). Retorna quantos valores foram copiados.
+    int History(int pass, float* out_ms, int max_values) const;
+    // Copia os tempos do frame "frame" para "out". Retorna false se eles
+    // ainda não chegaram, foram descartados ou já saíram do histórico.
+    bool FindFrame(uint64_t frame, GpuFrameTimings* out) const;
+    // Copia os tempos do frame mais recente já lido. Retorna false se o
+    // histórico está vazio.
+    bool LatestFrame(GpuFrameTimings* out) const;
+    // Acrescenta os intervalos dos frames do histórico, na GPU e na thread
+    // de renderização, a "events".
+    void AppendTraceEvents(std::vector<TraceEvent>& events) const;
+
+    uint64_t Dropped() const;
+
+private:
+    // Consultas de um frame: início e fim do frame e de cada etapa.
+    enum { QUERY_FRAME_BEGIN = 0, QUERY_FRAME_END = 1, QUERY_PASSES = 2 };
+    static const int QUERIES_PER_FRAME = QUERY_PASSES + 2 * GPU_PASS_COUNT;
+
+    struct FrameQueries
+    {
+        GLuint   queries[QUERIES_PER_FRAME];
+        bool     pending;
+        GpuFrameTimings timings; // instantes da CPU; os da GPU chegam depois
+    };
+
+    void Collect(FrameQueries& slot);
+    void Calibrate();
+    double GpuToCpuUs(GLuint64 gpu_ns) const;
+
+    FrameQueries m_slots[LATENCY];
+    FrameQueries* m_current;
+    bool         m_initialized;
+
+    // Diferença entre o relógio da GPU e o FrameClock, medida em
+    // Calibrate() e refeita de tempos em tempos, pois os relógios derivam.
+    double   m_gpu_to_cpu_offset_us;
+    uint64_t m_frames_since_calibration;
+
+    mutable std::mutex           m_history_mutex;
+    std::vector<GpuFrameTimings> m_history; // anel de HISTORY frames
+    size_t                       m_history_next;
+    size_t                       m_history_size;
+    uint64_t                     m_dropped;
+};
+
+#endif
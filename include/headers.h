@@ -17,6 +17,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 
 // Headers abaixo são específicos de C++
 #include <map>
@@ -34,12 +35,22 @@
 
 #ifndef CLASS_STRUCTS
 #define CLASS_STRUCTS
+// Referência a uma malha (faixa de vértices e índices) dentro de um
+// GeometryPool: índice na tabela do pool mais a geração da alocação, para
+// detectar referências a malhas já liberadas. Veja geometry_pool.h.
+struct GeometryRef
+{
+    uint32_t index;
+    uint32_t generation;
+};
+
 // Definimos uma estrutura que armazenará dados necessários para renderizar
 // cada objeto da cena virtual.
 struct SceneObject
 {
     const char*  name;        // Nome do objeto
-    void*        first_index; // índice do primeiro vértice dentro do vetor indices[] definido em BuildTriangles()
+    GeometryRef  geometry;    // Malha (no GeometryPool) que contém os vértices e índices do objeto
+    GLuint       first_index; // índice do primeiro vértice dentro do vetor indices[] definido em BuildTriangles()
     int          num_indices; // Número de índices do objeto dentro do vetor indices[] definido em BuildTriangles()
     GLenum       rendering_mode; // Modo de rasterização (GL_TRIANGLES, GL_TRIANGLE_STRIP, etc.)
 };
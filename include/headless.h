@@ -0,0 +1,103 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_HEADLESS_HEADER
+#define CLASS_HEADLESS_HEADER
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "gpu_timer.h"
+
+// Modo sem janela ("--headless"), para medir o desempenho em máquinas sem
+// monitor (por exemplo, servidores de build): o contexto OpenGL é criado
+// com EGL, sem superfície, e cada frame é desenhado em um RenderTarget (veja
+// render_target.h). A câmera segue um caminho fixo, com um passo de
+// simulação por frame, de modo que toda execução desenha a mesma sequência
+// de imagens. No final são impressas, em JSON, estatísticas dos tempos de
+// frame, e opcionalmente a imagem do último frame é salva em PNG para ser
+// comparada com uma imagem de referência.
+struct HeadlessOptions
+{
+    bool        enabled;
+    int         width;
+    int         height;
+    int         warmup_frames; // desenhados, mas fora das estatísticas
+    int         frames;        // frames medidos
+    const char* png_path;      // NULL: não salva a imagem
+    const char* trace_path;    // NULL: não salva o trace (veja trace.h)
+
+    HeadlessOptions()
+        : enabled(false), width(800), height(800), warmup_frames(60), frames(600), png_path(NULL), trace_path(NULL) {}
+};
+
+// Contexto OpenGL 3.3 "core" sem janela nem superfície, criado com EGL
+// (EGL_MESA_platform_surfaceless quando disponível; funciona com o
+// renderizador por software da Mesa, llvmpipe). Só é suportado no Linux.
+class HeadlessContext {
+public:
+    HeadlessContext() : m_display(NULL), m_context(NULL) {}
+    ~HeadlessContext() { Destroy(); }
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Cria o contexto e o torna atual na thread que chamou.
+    bool Create();
+    void Destroy();
+
+    // Equivalentes a glfwMakeContextCurrent(window) e glfwMakeContextCurrent(NULL).
+    void MakeCurrent();
+    void ReleaseCurrent();
+
+private:
+    void* m_display; // EGLDisplay
+    void* m_context; // EGLContext
+};
+
+// Posição no caminho fixo da câmera: os ângulos da câmera (como
+// g_CameraTheta e g_CameraPhi) e um ângulo para animar o terceiro cubo.
+struct CameraPathPoint
+{
+    float theta;
+    float phi;
+    float cube_angle;
+};
+
+// Ponto do caminho no frame "frame" de um total de "frames": uma volta
+// completa em torno da origem, subindo e descendo duas vezes.
+CameraPathPoint HeadlessCameraPath(int frame, int frames);
+
+// Guarda as medidas de cada frame e as escreve em JSON.
+class FrameStatsRecorder {
+public:
+    FrameStatsRecorder() : m_draw_calls(0), m_triangles(0), m_first_frame_ms(-1.0f) {}
+
+    void Reserve(size_t frames) { m_frame_ms.reserve(frames); }
+    void Add(float frame_ms, uint32_t draw_calls, uint32_t triangles);
+    // Tempo do início do programa até o primeiro frame (veja startup.h).
+    void SetTimeToFirstFrame(float ms) { m_first_frame_ms = ms; }
+
+    // Escreve um objeto JSON com o número de frames, média, máximo e
+    // percentis 50, 95 e 99 do tempo de frame (em ms), e a média de
+    // chamadas de desenho e de triângulos por frame. Com "gpu", inclui a
+    // média dos tempos de GPU de cada etapa (veja gpu_timer.h). O tempo até
+    // o primeiro frame só é escrito se foi informado.
+    void WriteJson(FILE* out, const char* renderer, int width, int height, int warmup_frames,
+                   const GpuTimerSummary* gpu) const;
+
+private:
+    std::vector<float> m_frame_ms;
+    uint64_t           m_draw_calls;
+    uint64_t           m_triangles;
+    float              m_first_frame_ms;
+};
+
+// Salva uma imagem RGBA de 8 bits em PNG. "pixels" está na ordem de
+// glReadPixels(): a primeira linha é a de baixo.
+bool WritePng(const char* path, int width, int height, const unsigned char* pixels);
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_HITCH_WATCHDOG_HEADER
+#define CLASS_HITCH_WATCHDOG_HEADER
+
+#include <cstdint>
+#include <cstdio>
+
+#include "gpu_timer.h"
+#include "render_counters.h"
+
+// O que a thread principal mede em cada frame. Os contadores de shaders e
+// de recursos recarregados são os do próprio frame, não totais.
+struct HitchFrameInfo
+{
+    uint64_t frame;            // mesmo número de FramePacket::frame
+    float    frame_ms;         // de início a início do frame
+    float    main_ms;          // thread principal ocupada
+    float    main_wait_ms;     // thread principal esperando a de renderização
+    float    render_submit_ms; // último frame da thread de renderização
+    float    render_swap_ms;
+    int      heap_allocations;
+    float    heap_kib;
+    uint32_t shaders_compiled; // veja GetShaderStats() em shaders.h
+    uint32_t programs_linked;
+    uint32_t gpu_reloads;      // recursos recarregados pelo seu loader (gpu_resources.h)
+};
+
+// Detector de travamentos ("hitches"): frames isolados muito mais lentos que
+// os outros, que o FPS médio esconde. Cada frame é comparado com a mediana
+// dos últimos MEDIAN_FRAMES frames (menos sensível aos próprios travamentos
+// que a média); se demorar mais que "threshold" vezes a mediana, o frame e
+// os CONTEXT_FRAMES anteriores são gravados no relatório da sessão, um
+// arquivo "hitches_AAAAMMDD_HHMMSS.jsonl" criado no primeiro travamento,
+// com um objeto JSON por linha:
+//
+//     {"frame": 812, "frame_ms": 41.3, "median_ms": 8.1, "threshold": 3.0,
+//      "frames": [{"frame": 808, ...}, ..., {"frame": 812, ...}]}
+//
+// Para cada frame o relatório traz os tempos e alocações medidos pela thread
+// principal, shaders compilados e recursos recarregados, os contadores de
+// desenho (render_counters.h), os tempos de GPU (gpu_timer.h) e, se o
+// profiler estiver compilado, as zonas de CPU (profiler.h).
+//
+// Os dados da GPU e da thread de renderização de um frame só ficam prontos
+// alguns frames depois dele, por isso cada travamento é gravado
+// CAPTURE_DELAY frames após ser detectado. Uma vez aberto o arquivo, gravar
+// não aloca memória.
+//
+// Usado apenas pela thread principal.
+class HitchWatchdog {
+public:
+    static constexpr int MEDIAN_FRAMES  = 120;
+    static constexpr int WARMUP_FRAMES  = 30; // frames antes de a detecção começar
+    static constexpr int CONTEXT_FRAMES = 4;  // frames anteriores ao travamento no relatório
+    static constexpr int CAPTURE_DELAY  = GpuTimer::LATENCY + 2;
+    static constexpr int MAX_PENDING    = 8;
+
+    HitchWatchdog();
+    ~HitchWatchdog();
+
+    HitchWatchdog(const HitchWatchdog&) = delete;
+    HitchWatchdog& operator=(const HitchWatchdog&) = delete;
+
+    // Múltiplo da mediana a partir do qual um frame é um travamento.
+    void SetThreshold(float threshold) { m_threshold = threshold; }
+
+    // Chamada no fim de cada frame, depois de PROFILE_END_FRAME(). Detecta
+    // um travamento no frame "info" e grava os que estavam esperando.
+    void EndFrame(const HitchFrameInfo& info, const GpuTimer& gpu_timer, const RenderCounters& counters);
+    // Grava os travamentos ainda pendentes, com os dados que já existirem.
+    // Chamada no fim do programa, antes de a thread de renderização parar.
+    void Flush(const GpuTimer& gpu_timer, const RenderCounters& counters);
+
+    float    MedianMs() const { return m_median_ms; }
+    uint64_t Hitches() const { return m_hitches; }
+    // Caminho do relatório ("" enquanto não houve travamento).
+    const char* ReportPath() const { return m_report_path; }
+
+private:
+    static constexpr int FRAME_HISTORY = 16;
+    static_assert(FRAME_HISTORY > CONTEXT_FRAMES + CAPTURE_DELAY, "histórico menor que o atraso da captura");
+
+    struct PendingHitch
+    {
+        uint64_t frame;
+        float    frame_ms;
+        float    median_ms;
+    };
+
+    float Median();
+    bool OpenReport();
+    void WriteHitch(const PendingHitch& hitch, const GpuTimer& gpu_timer, const RenderCounters& counters);
+    void WriteFrame(const HitchFrameInfo& info, const GpuTimer& gpu_timer, const RenderCounters& counters);
+
+    HitchFrameInfo m_frames[FRAME_HISTORY]; // indexado por frame % FRAME_HISTORY
+
+    float m_times[MEDIAN_FRAMES]; // anel com os últimos tempos de frame
+    float m_sorted[MEDIAN_FRAMES];
+    int   m_times_count;
+    int   m_times_next;
+    float m_median_ms;
+    float m_threshold;
+
+    PendingHitch m_pending[MAX_PENDING];
+    int          m_num_pending;
+    uint64_t     m_hitches;
+
+    FILE* m_report;
+    char  m_report_path[64];
+};
+
+#endif
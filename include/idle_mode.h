@@ -0,0 +1,65 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_IDLE_MODE_HEADER
+#define CLASS_IDLE_MODE_HEADER
+
+#include <atomic>
+#include <cstdint>
+
+// Modo ocioso: quando nada muda na tela, o loop principal para de montar e
+// desenhar frames e dorme em glfwWaitEventsTimeout() até chegar um evento.
+// A janela continua mostrando o último frame apresentado. Sem isto, a cena e
+// a interface são redesenhadas a cada vsync mesmo paradas, ocupando um
+// núcleo inteiro.
+//
+// A cada frame a thread principal informa, em EndFrame(), se houve
+// atividade (câmera em movimento, widget da ImGui ativo, ...). Depois de
+// SETTLE_FRAMES frames seguidos sem atividade, CanSleep() passa a retornar
+// true, e o loop chama Wait() em vez de montar o próximo frame:
+//
+//     if (idle.CanSleep() && !idle.Wait(IdleMode::TIMEOUT_SECONDS))
+//         continue;
+//     ... monta e publica o frame ...
+//     idle.EndFrame(camera_moving || ui_busy);
+//
+// Os frames extras depois da última atividade deixam a ImGui terminar de
+// atualizar o que depende do frame anterior (hover, tamanho automático de
+// janelas). Eventos da janela (callbacks.cpp) e trabalho terminado em outras
+// threads (por exemplo, um recurso carregado em segundo plano) pedem um novo
+// frame com RequestRedraw().
+class IdleMode {
+public:
+    static const int SETTLE_FRAMES = 3;
+    // Limite de cada espera. Ao acordar sem nenhum pedido o loop volta a
+    // dormir, sem desenhar.
+    static constexpr double TIMEOUT_SECONDS = 0.5;
+
+    IdleMode() : m_quiet_frames(0), m_wakeups(0), m_slept_seconds(0.0) {}
+
+    // Pode ser chamada por qualquer thread: pede um frame e, se o loop
+    // principal estiver dormindo em Wait(), o acorda.
+    static void RequestRedraw();
+
+    // Thread principal, no fim de cada frame desenhado.
+    void EndFrame(bool active);
+    bool CanSleep() const;
+    // Dorme até um evento chegar ou "timeout_seconds" passarem. Retorna true
+    // se houve um pedido de frame (e o loop deve desenhar).
+    bool Wait(double timeout_seconds);
+
+    // Vezes que o loop dormiu e tempo total dormindo.
+    uint64_t Wakeups() const { return m_wakeups; }
+    double SleptSeconds() const { return m_slept_seconds; }
+
+private:
+    static std::atomic<bool> s_redraw_requested;
+
+    int      m_quiet_frames; // frames seguidos sem atividade
+    uint64_t m_wakeups;
+    double   m_slept_seconds;
+};
+
+#endif
@@ -50,6 +50,68 @@ float g_FrustumFarPlane = -10.0f;
 // Variável que controla a cor do plano de clear.
 ImVec4 g_ClearColor = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
+// Variáveis que controlam o loop de frames. Veja timestep.h.
+int g_PresentMode = 1; // PRESENT_VSYNC
+float g_ThrottleFPS = 60.0f;
+bool g_LowLatency = false;
+int g_GpuQueueDepth = 0;
+float g_SimulationHz = 120.0f;
+
+int g_SimulationSteps = 0;
+float g_SimulationAlpha = 0.0f;
+
+float g_MainThreadMs = 0.0f;
+float g_MainThreadWaitMs = 0.0f;
+float g_RenderSubmitMs = 0.0f;
+float g_RenderSwapMs = 0.0f;
+float g_RenderIdleMs = 0.0f;
+float g_FrameIntervalMs = 0.0f;
+float g_PacingJitterMs = 0.0f;
+float g_LatencyMs = 0.0f;
+float g_MaxLatencyMs = 0.0f;
+
+int g_FrameHeapAllocations = 0;
+float g_FrameHeapKiB = 0.0f;
+
+float g_GpuBudgetMiB = 256.0f;
+float g_GpuBufferKiB = 0.0f;
+float g_GpuTextureKiB = 0.0f;
+int g_GpuEvictions = 0;
+int g_GpuReloads = 0;
+
+float g_GeometryUsedKiB = 0.0f;
+float g_GeometryCapacityKiB = 0.0f;
+float g_GeometryFragmentation = 0.0f;
+float g_GeometryMovedKiB = 0.0f;
+
+bool g_SaveTrace = false;
+bool g_RecordCounters = false;
+bool g_LeanUiRenderer = true;
+
+float g_HitchThreshold = 3.0f;
+int g_HitchCount = 0;
+float g_FrameMedianMs = 0.0f;
+
+bool g_IdleMode = true;
+int g_IdleWakeups = 0;
+float g_IdleSleptSeconds = 0.0f;
+
+bool g_UiCache = true;
+float g_UiLiveRefreshHz = 4.0f;
+int g_UiRedraws = 0;
+
+bool g_FontCache = true;
+
+bool g_SceneViewport = false;
+int g_ViewportScale = 2;
+float g_ViewportSharpen = 0.0f;
+bool g_DynamicResolution = false;
+float g_ResolutionTargetMs = 16.6f;
+float g_ResolutionMinScale = 0.5f;
+float g_ResolutionMaxScale = 1.0f;
+
 std::map<const char*, SceneObject> Globals::g_VirtualScene;
 double Globals::g_LastCursorPosX, Globals::g_LastCursorPosY;
-ImGuiIO* Globals::g_Io;
\ No newline at end of file
+ImGuiIO* Globals::g_Io;
+GpuTimer* Globals::g_GpuTimer = NULL;
+RenderCounters* Globals::g_RenderCounters = NULL;
\ No newline at end of file
@@ -0,0 +1,128 @@
+#ifndef _INPUT_EVENTS_H
+#define _INPUT_EVENTS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "timestep.h"
+
+// Eventos de entrada gerados pelos callbacks da GLFW (veja callbacks.cpp).
+// Os callbacks apenas registram o evento, com o instante em que ocorreu, em
+// uma fila; a simulação consome a fila a cada passo, na ordem em que os
+// eventos chegaram. Assim o processamento da entrada é determinístico (o
+// mesmo conjunto de eventos por passo gera sempre o mesmo estado) e pode ser
+// gravado e reproduzido com InputRecorder.
+enum InputEventType
+{
+    INPUT_KEY          = 0, // code = tecla,  action, mods
+    INPUT_MOUSE_BUTTON = 1, // code = botão,  action, mods
+    INPUT_CURSOR_POS   = 2, // x, y = posição do cursor
+    INPUT_SCROLL       = 3  // x, y = deslocamento da "rodinha"
+};
+
+struct InputEvent
+{
+    int64_t time_ns;    // instante do evento (FrameClock), em nanossegundos
+    uint8_t type;       // InputEventType
+    uint8_t ui_capture; // a ImGui queria o mouse quando o evento ocorreu
+    int16_t action;
+    int32_t code;
+    int32_t mods;
+    double  x, y;
+};
+
+inline int64_t InputTimestamp(FrameClock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+// Fila circular limitada, sem locks, para exatamente um produtor e um
+// consumidor. Cada índice é escrito por uma única thread; a capacidade deve
+// ser uma potência de 2. Quando a fila está cheia, Push() descarta o item e
+// conta o descarte.
+template <typename T, size_t CAPACITY>
+class SpscRing {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY deve ser uma potência de 2");
+
+public:
+    SpscRing() : m_head(0), m_tail(0), m_dropped(0) {}
+
+    // Produtor.
+    bool Push(const T& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == CAPACITY)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[tail & (CAPACITY - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: Peek() retorna o item mais antigo (ou NULL se a fila está
+    // vazia) sem removê-lo; Pop() o remove.
+    const T* Peek() const
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return NULL;
+        return &m_items[head & (CAPACITY - 1)];
+    }
+
+    void Pop()
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t Size() const { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+    size_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Separados em linhas de cache diferentes para que produtor e consumidor
+    // não disputem a mesma linha.
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+    std::atomic<size_t> m_dropped;
+    alignas(64) T m_items[CAPACITY];
+};
+
+typedef SpscRing<InputEvent, 1024> InputEventQueue;
+
+// Fila preenchida pelos callbacks da GLFW e consumida pela simulação.
+extern InputEventQueue g_InputQueue;
+
+// Grava em arquivo os eventos consumidos em cada passo de simulação, ou os
+// lê de volta para reproduzir uma sessão. A reprodução só é fiel se a
+// frequência da simulação for a mesma da gravação.
+class InputRecorder {
+public:
+    InputRecorder();
+    ~InputRecorder();
+
+    bool OpenForRecording(const char* filename, double ticks_per_second);
+    bool OpenForReplay(const char* filename);
+    void Close();
+
+    bool IsRecording() const { return m_file != NULL && m_recording; }
+    bool IsReplaying() const { return m_file != NULL && !m_recording; }
+    // Frequência da simulação usada na gravação que está sendo reproduzida.
+    double TicksPerSecond() const { return m_ticks_per_second; }
+
+    void Write(uint64_t tick, const InputEvent& event);
+    // Retorna o próximo evento gravado para o passo "tick", se houver.
+    bool Read(uint64_t tick, InputEvent& event);
+
+private:
+    FILE*      m_file;
+    bool       m_recording;
+    double     m_ticks_per_second;
+    bool       m_has_pending;
+    uint64_t   m_pending_tick;
+    InputEvent m_pending;
+};
+
+#endif // _INPUT_EVENTS_H
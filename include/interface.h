@@ -8,18 +8,84 @@
 #include "globals.h"
 #endif
 
+#include "dynamic_resolution.h"
+#include "glyph_cache.h"
+#include "scene_outliner.h"
+#include "scene_viewport.h"
+
 #ifndef CLASS_INTERFACE_CLASS_HEADER
 #define CLASS_INTERFACE_CLASS_HEADER
 class Interface {
   private:
     bool m_show_demo_window;
+    const char* m_glsl_version;
+    // Glyphs da fonte DroidSans fora do ASCII (veja LoadFonts()).
+    GlyphCache m_glyph_cache;
+    JobSystem* m_jobs;
+    char m_glyph_text[256];
+    // Janela "Outliner" (veja SetScene()).
+    SceneOutliner m_outliner;
+    const SceneIndex* m_scene_index;
+    TransformHierarchy* m_transforms;
+    // Janela "Viewport" do último frame.
+    SceneViewportLayout m_viewport;
+    bool m_viewport_visible;
+    const DynamicResolution* m_dynamic_resolution;
+    void ShowViewport();
+    void ShowGlyphCache();
+    static const char* GetClipboardText(void* user_data);
     void Start();
     void SetInterface(bool show_demo_window);
+    void ShowGpuTimings(const GpuTimer& timer);
+    void ShowRenderCounters(const RenderCounters& counters);
+#ifdef TCC_ENABLE_PROFILER
+    void ShowProfiler();
+#endif
   public:
     Interface(bool show_demo_window);
+    // Chamadas pela thread principal, nesta ordem: CreateContext() cria o
+    // contexto da ImGui; LoadFonts() monta o atlas das fontes, sem usar a
+    // janela nem o OpenGL, e pode rodar em outra thread enquanto a janela é
+    // criada; Init() liga a ImGui à janela, depois de LoadFonts() terminar.
+    void CreateContext();
+    void LoadFonts();
     void Init(GLFWwindow *window, const char* glsl_version);
     void Show(GLFWwindow *window);
-    void LoadFonts();
+    // Threads usadas para rasterizar glyphs novos; NULL usa só a principal.
+    void SetJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+    // Cena mostrada e editada na janela "Outliner".
+    void SetScene(const SceneIndex* index, TransformHierarchy* transforms) {
+      m_scene_index = index;
+      m_transforms = transforms;
+    }
+    // Escala da cena com a resolução dinâmica ligada, e o seu histórico.
+    void SetDynamicResolution(const DynamicResolution* resolution) { m_dynamic_resolution = resolution; }
+    // Nó selecionado no "Outliner", ou INVALID_TRANSFORM.
+    TransformId SelectedObject() const { return m_outliner.Selected(); }
+    // Tamanhos da cena na janela "Viewport" no último Show(). Retorna false
+    // se a cena deve ser desenhada direto na tela (janela desligada ou
+    // recolhida).
+    bool ViewportLayout(SceneViewportLayout* layout) const {
+      *layout = m_viewport;
+      return m_viewport_visible;
+    }
+    // Pixels dos glyphs rasterizados desde a última chamada, a enviar junto
+    // com o frame (veja FramePacket::glyph_upload).
+    bool TakeGlyphUpload(GlyphUpload& upload) { return m_glyph_cache.TakeUpload(upload); }
+    // Se a interface precisa do próximo frame mesmo sem eventos de entrada
+    // (veja idle_mode.h).
+    bool WantsRedraw();
+    // Identificador do estado de interação do último frame (item sob o
+    // cursor, item ativo, janelas sob o cursor e em foco, botões do mouse),
+    // que muda quando a aparência da interface pode ter mudado por causa da
+    // entrada. "active" diz se a interface está em uso neste momento (item
+    // ativo, botão pressionado, rolagem, texto sendo editado). Veja
+    // UiRefreshPolicy em ui_layer.h.
+    uint64_t Interaction(bool* active);
     void CleanUp();
+    // Chamadas pela thread que possui o contexto OpenGL (veja render_thread.h).
+    void InitRenderer();
+    void RenderDrawData(ImDrawData* draw_data);
+    void ShutdownRenderer();
 };
 #endif
\ No newline at end of file
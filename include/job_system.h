@@ -0,0 +1,205 @@
+#ifndef _JOB_SYSTEM_H
+#define _JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "allocators.h"
+
+// Sistema de tarefas ("jobs") com roubo de trabalho, usado para paralelizar
+// o trabalho de cada frame (atualização de transformações, culling,
+// animação, decodificação de recursos, ...).
+//
+// Há uma thread de trabalho por núcleo; a thread que cria o JobSystem (a
+// principal) também executa tarefas enquanto espera por elas. Cada thread
+// tem uma fila própria (deque de Chase-Lev): empilha e desempilha tarefas
+// em uma ponta, sem disputa, e as threads ociosas roubam da outra ponta.
+//
+// Dependências são expressas com contadores: cada tarefa submetida com um
+// JobCounter incrementa o contador, e o decrementa ao terminar. Wait()
+// executa outras tarefas até o contador chegar a zero, de modo que uma
+// tarefa pode submeter subtarefas e esperar por elas sem bloquear a thread.
+//
+//     JobCounter counter;
+//     jobs.Run(&counter, [&]() { CullObjects(); });
+//     jobs.Run(&counter, [&]() { UpdateAnimations(); });
+//     jobs.Wait(&counter);
+//
+//     jobs.ParallelFor(count, 256, [&](uint32_t begin, uint32_t end) { ... });
+
+typedef void (*JobFunction)(void* data);
+
+class JobCounter {
+public:
+    JobCounter() : m_value(0) {}
+
+    bool IsDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> m_value;
+};
+
+struct Job
+{
+    JobFunction function;
+    void*       data;
+    JobCounter* counter;
+};
+
+// Deque de Chase-Lev com capacidade fixa ("Correct and Efficient
+// Work-Stealing for Weak Memory Models", Lê et al., 2013). Push() e Pop()
+// só podem ser chamadas pela thread dona; Steal() por qualquer thread.
+class WorkStealingDeque {
+public:
+    static const int64_t CAPACITY = 4096;
+
+    WorkStealingDeque();
+
+    bool Push(Job* job);   // false se a fila está cheia
+    Job* Pop();
+    Job* Steal();
+
+    bool IsEmpty() const
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+    alignas(64) std::atomic<Job*>    m_jobs[CAPACITY];
+};
+
+// Fixa uma thread em um núcleo. Retorna false se o sistema não suporta
+// (macOS) ou se o núcleo não existe.
+bool PinThreadToCore(std::thread& thread, int core);
+bool PinCurrentThreadToCore(int core);
+
+class JobSystem {
+public:
+    // "num_threads" inclui a thread que cria o JobSystem; 0 usa um por
+    // núcleo. Com "pin_threads", cada thread de trabalho é fixada em um
+    // núcleo, pulando "reserved_core" (por exemplo, o núcleo em que a thread
+    // de renderização foi fixada; -1 se nenhum).
+    explicit JobSystem(unsigned int num_threads = 0, bool pin_threads = false, int reserved_core = -1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Número de threads que executam tarefas, incluindo a principal.
+    unsigned int NumThreads() const { return (unsigned int)m_queues.size(); }
+
+    // Deve ser chamada no começo de cada frame, sem tarefas pendentes:
+    // libera a memória do FrameAllocator.
+    void BeginFrame();
+    FrameAllocator& FrameMemory() { return m_frame_allocator; }
+
+    // Submete uma tarefa. "counter" pode ser NULL.
+    void Submit(JobFunction function, void* data, JobCounter* counter);
+
+    // Submete uma cópia de "f", um objeto chamável sem argumentos. A cópia
+    // fica no FrameAllocator; referências capturadas devem continuar
+    // válidas até a tarefa terminar.
+    template <typename F>
+    void Run(JobCounter* counter, const F& f)
+    {
+        void* memory = m_frame_allocator.Allocate(sizeof(F), alignof(F));
+        Submit(&CallAndDestroy<F>, new (memory) F(f), counter);
+    }
+
+    // Executa tarefas até o contador chegar a zero.
+    void Wait(JobCounter* counter);
+
+    // Chama f(begin, end) sobre intervalos que cobrem [0, count). O
+    // intervalo é dividido ao meio sob demanda: a thread que executa um
+    // intervalo maior que o grão submete a metade de cima e continua com a
+    // de baixo, de modo que as threads ociosas sempre roubam os maiores
+    // pedaços restantes. O grão se adapta ao número de threads (cerca de 8
+    // pedaços por thread), mas nunca é menor que "min_grain".
+    template <typename F>
+    void ParallelFor(uint32_t count, uint32_t min_grain, const F& f)
+    {
+        if (count == 0)
+            return;
+        uint32_t grain = count / (NumThreads() * 8);
+        if (grain < min_grain)
+            grain = min_grain;
+        if (grain < 1)
+            grain = 1;
+        if (NumThreads() == 1 || count <= grain)
+        {
+            f(0u, count);
+            return;
+        }
+
+        JobCounter counter;
+        ParallelForRange<F> range = { this, &f, &counter, 0, count, grain };
+        range();
+        Wait(&counter);
+    }
+
+private:
+    template <typename F>
+    static void CallAndDestroy(void* data)
+    {
+        F* f = static_cast<F*>(data);
+        (*f)();
+        f->~F();
+    }
+
+    template <typename F>
+    struct ParallelForRange
+    {
+        JobSystem*  jobs;
+        const F*    f;
+        JobCounter* counter;
+        uint32_t    begin, end, grain;
+
+        void operator()() const
+        {
+            uint32_t last = end;
+            while (last - begin > grain)
+            {
+                uint32_t middle = begin + (last - begin) / 2;
+                ParallelForRange upper = { jobs, f, counter, middle, last, grain };
+                jobs->Run(counter, upper);
+                last = middle;
+            }
+            (*f)(begin, last);
+        }
+    };
+
+    void WorkerLoop(unsigned int index);
+    Job* FindJob(unsigned int index);
+    void Execute(Job* job);
+
+    std::vector<WorkStealingDeque*> m_queues;
+    std::vector<std::thread>        m_threads;
+
+    // Tarefas submetidas por threads que não pertencem ao JobSystem (ou
+    // quando a fila da thread está cheia).
+    std::mutex       m_shared_mutex;
+    std::deque<Job*> m_shared_queue;
+    std::atomic<int> m_shared_size;
+
+    // Threads de trabalho sem tarefas dormem na variável de condição; o
+    // número de tarefas enfileiradas é o que as acorda.
+    std::atomic<int>        m_queued;
+    std::atomic<int>        m_sleeping;
+    std::atomic<bool>       m_stop;
+    std::mutex              m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+
+    FrameAllocator m_frame_allocator;
+};
+
+#endif // _JOB_SYSTEM_H
@@ -8,6 +8,8 @@
 #include <glm/vec4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "const_math.h"
+
 // Esta função Matrix() auxilia na criação de matrizes usando a biblioteca GLM.
 // Note que em OpenGL (e GLM) as matrizes são definidas como "column-major",
 // onde os elementos da matriz são armazenadas percorrendo as COLUNAS da mesma.
@@ -27,7 +29,12 @@
 //
 // Para conseguirmos definir matrizes através de suas LINHAS, a função Matrix()
 // computa a transposta usando os elementos passados por parâmetros.
-glm::mat4 Matrix(
+//
+// As funções Matrix_*() que constroem transformações são "constexpr": quando
+// os argumentos são constantes, a matriz é calculada em tempo de compilação
+// (veja const_math.h). Para compor transformações sem multiplicar matrizes
+// 4x4 completas, veja transform_types.h.
+constexpr glm::mat4 Matrix(
     float m00, float m01, float m02, float m03, // LINHA 1
     float m10, float m11, float m12, float m13, // LINHA 2
     float m20, float m21, float m22, float m23, // LINHA 3
@@ -43,7 +50,7 @@ glm::mat4 Matrix(
 }
 
 // Matriz identidade.
-glm::mat4 Matrix_Identity()
+constexpr glm::mat4 Matrix_Identity()
 {
     return Matrix(
         1.0f , 0.0f , 0.0f , 0.0f , // LINHA 1
@@ -59,7 +66,7 @@ glm::mat4 Matrix_Identity()
 //
 //     T*p = p+t.
 //
-glm::mat4 Matrix_Translate(float tx, float ty, float tz)
+constexpr glm::mat4 Matrix_Translate(float tx, float ty, float tz)
 {
     return Matrix(
         1.0f , 0.0f , 0.0f , tx ,
@@ -75,7 +82,7 @@ glm::mat4 Matrix_Translate(float tx, float ty, float tz)
 //
 //     S*p = [sx*px, sy*py, sz*pz, pw].
 //
-glm::mat4 Matrix_Scale(float sx, float sy, float sz)
+constexpr glm::mat4 Matrix_Scale(float sx, float sy, float sz)
 {
     return Matrix(
         sx   , 0.0f , 0.0f , 0.0f ,
@@ -93,10 +100,10 @@ glm::mat4 Matrix_Scale(float sx, float sy, float sz)
 //   R*p = [ px, c*py-s*pz, s*py+c*pz, pw ];
 //
 // onde 'c' e 's' são o cosseno e o seno do ângulo de rotação, respectivamente.
-glm::mat4 Matrix_Rotate_X(float angle)
+constexpr glm::mat4 Matrix_Rotate_X(float angle)
 {
-    float c = cos(angle);
-    float s = sin(angle);
+    float c = Const_Cos(angle);
+    float s = Const_Sin(angle);
     return Matrix(
         1.0f , 0.0f , 0.0f , 0.0f ,
         0.0f ,  c   , -s   , 0.0f ,
@@ -113,10 +120,10 @@ glm::mat4 Matrix_Rotate_X(float angle)
 //   R*p = [ c*px+s*pz, py, -s*px+c*pz, pw ];
 //
 // onde 'c' e 's' são o cosseno e o seno do ângulo de rotação, respectivamente.
-glm::mat4 Matrix_Rotate_Y(float angle)
+constexpr glm::mat4 Matrix_Rotate_Y(float angle)
 {
-    float c = cos(angle);
-    float s = sin(angle);
+    float c = Const_Cos(angle);
+    float s = Const_Sin(angle);
     return Matrix(
          c   , 0.0f ,  s   , 0.0f ,
         0.0f , 1.0f , 0.0f , 0.0f ,
@@ -133,10 +140,10 @@ glm::mat4 Matrix_Rotate_Y(float angle)
 //   R*p = [ c*px-s*py, s*px+c*py, pz, pw ];
 //
 // onde 'c' e 's' são o cosseno e o seno do ângulo de rotação, respectivamente.
-glm::mat4 Matrix_Rotate_Z(float angle)
+constexpr glm::mat4 Matrix_Rotate_Z(float angle)
 {
-    float c = cos(angle);
-    float s = sin(angle);
+    float c = Const_Cos(angle);
+    float s = Const_Sin(angle);
     return Matrix(
          c   , -s   , 0.0f , 0.0f ,
          s   ,  c   , 0.0f , 0.0f ,
@@ -160,16 +167,17 @@ float norm(glm::vec4 v)
 // coordenadas e em torno do eixo definido pelo vetor 'axis'. Esta matriz pode
 // ser definida pela fórmula de Rodrigues. Lembre-se que o vetor que define o
 // eixo de rotação deve ser normalizado!
-glm::mat4 Matrix_Rotate(float angle, glm::vec4 axis)
+constexpr glm::mat4 Matrix_Rotate(float angle, glm::vec4 axis)
 {
-    float c = cos(angle);
-    float s = sin(angle);
+    float c = Const_Cos(angle);
+    float s = Const_Sin(angle);
 
-    glm::vec4 v = axis / norm(axis);
+    // Mesmo que axis / norm(axis), mas calculável em tempo de compilação.
+    float length = Const_Sqrt(axis.x*axis.x + axis.y*axis.y + axis.z*axis.z);
 
-    float vx = v.x;
-    float vy = v.y;
-    float vz = v.z;
+    float vx = axis.x / length;
+    float vy = axis.y / length;
+    float vz = axis.z / length;
 
     return Matrix(
         vx*vx*(1.0f-c)+c    , vx*vy*(1.0f-c)-vz*s , vx*vz*(1-c)+vy*s , 0.0f ,
@@ -253,7 +261,7 @@ glm::mat4 Matrix_Camera_View(glm::vec4 position_c, glm::vec4 view_vector, glm::v
 }
 
 // Matriz de projeção paralela ortográfica
-glm::mat4 Matrix_Orthographic(float l, float r, float b, float t, float n, float f)
+constexpr glm::mat4 Matrix_Orthographic(float l, float r, float b, float t, float n, float f)
 {
     glm::mat4 M = Matrix(
         2.0f/(r-l) , 0.0f       , 0.0f       , -(r+l)/(r-l) ,
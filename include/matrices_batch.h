@@ -0,0 +1,54 @@
+#ifndef _MATRICES_BATCH_H
+#define _MATRICES_BATCH_H
+
+#include <cstddef>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Versões "em lote" das operações de matrices.h: cada função processa N
+// elementos de uma vez, usando instruções SIMD (SSE4.1 ou AVX2+FMA) quando o
+// processador suporta. O conjunto de instruções é escolhido em tempo de
+// execução, na primeira chamada. As funções escalares de matrices.h
+// continuam sendo a referência para os resultados.
+
+// Conjuntos de instruções suportados pelas funções abaixo.
+enum BatchInstructionSet
+{
+    BATCH_SCALAR = 0,
+    BATCH_SSE41  = 1,
+    BATCH_AVX2   = 2
+};
+
+// Caixa alinhada aos eixos (Axis-Aligned Bounding Box).
+struct BoundingBox
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// out[i] = A * in[i], para i em [0, count).
+void Batch_MultiplyMatrices(const glm::mat4& A, const glm::mat4* in, glm::mat4* out, size_t count);
+
+// out[i] = M * in[i], para i em [0, count).
+void Batch_TransformPoints(const glm::mat4& M, const glm::vec4* in, glm::vec4* out, size_t count);
+
+// out[i] = T(position[i]) * R(rotation[i]) * S(scale[i]), isto é, o mesmo que
+// Matrix_Translate(...) * Matrix_Rotate(...) * Matrix_Scale(...).
+void Batch_ComposeTRS(const glm::vec3* position, const glm::quat* rotation, const glm::vec3* scale, glm::mat4* out, size_t count);
+
+// out[i] é a menor caixa alinhada aos eixos que contém a caixa in[i]
+// transformada pela matriz afim M.
+void Batch_TransformBoundingBoxes(const glm::mat4& M, const BoundingBox* in, BoundingBox* out, size_t count);
+
+// Conjunto de instruções em uso e o melhor suportado pelo processador.
+BatchInstructionSet Batch_GetInstructionSet();
+BatchInstructionSet Batch_GetSupportedInstructionSet();
+// Força um conjunto de instruções (limitado ao suportado). Útil para
+// comparações e benchmarks.
+void Batch_SetInstructionSet(BatchInstructionSet isa);
+const char* Batch_InstructionSetName(BatchInstructionSet isa);
+
+#endif // _MATRICES_BATCH_H
@@ -0,0 +1,172 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+// Profiler de CPU por zonas: cada PROFILE_SCOPE("nome") mede o tempo até o
+// fim do escopo em que está, na thread que o executou.
+//
+//     void Interface::Show(GLFWwindow* window)
+//     {
+//         PROFILE_SCOPE("Interface::Show");
+//         ...
+//     }
+//
+// As zonas das últimas Profiler::HISTORY_FRAMES frames são mostradas na
+// janela "Profiler" da interface, como uma linha do tempo por thread (uma
+// "flame chart": zonas aninhadas ficam embaixo das que as contêm), e são
+// salvas junto com o trace (veja trace.h).
+//
+// Medir precisa ser barato, para não distorcer o que é medido: o instante
+// é lido do contador de ciclos do processador (rdtsc), sem chamada de
+// sistema, e cada thread escreve as suas zonas em um buffer próprio, sem
+// locks. A thread principal recolhe os buffers uma vez por frame, em
+// Profiler::EndFrame().
+//
+// Tudo isto só existe quando TCC_ENABLE_PROFILER está definida (veja o
+// Makefile: builds com RELEASE=1 não a definem). Sem ela as macros não
+// geram código nenhum.
+
+#ifdef TCC_ENABLE_PROFILER
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "trace.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define TCC_PROFILER_RDTSC 1
+#else
+#include <chrono>
+#endif
+
+struct ProfileZone
+{
+    const char* name;  // literal: o ponteiro é guardado, não o texto
+    uint64_t    begin; // em ticks (veja Profiler::Now())
+    uint64_t    end;
+    uint32_t    depth; // 0 para zonas que não estão dentro de outra
+    int         thread; // veja TraceThread
+};
+
+class Profiler {
+public:
+    static const int    MAX_THREADS = 64;
+    static const size_t THREAD_CAPACITY = 8192;    // zonas por thread entre dois EndFrame()
+    static const int    HISTORY_FRAMES = 120;
+    static const size_t HISTORY_ZONES = 64 * 1024;
+
+    // Instante atual em ticks: ciclos do contador do processador (que nos
+    // processadores atuais tem frequência constante, "invariant TSC") ou,
+    // fora do x86, nanossegundos do relógio monotônico.
+    static uint64_t Now()
+    {
+#ifdef TCC_PROFILER_RDTSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // Cria o buffer da thread atual. Zonas de threads não registradas são
+    // ignoradas. "thread" identifica a thread no trace (veja TraceThread).
+    static void RegisterThread(int thread);
+
+    // Chamada pela thread principal no fim de cada frame: recolhe as zonas
+    // de todas as threads e marca o início do próximo frame.
+    static void EndFrame();
+
+    // Com a captura pausada as zonas continuam sendo recolhidas, mas são
+    // descartadas, e o histórico fica congelado para ser examinado.
+    static void SetPaused(bool paused);
+    static bool Paused();
+
+    // Acesso ao histórico, só pela thread principal. Os frames vão de 0 (o
+    // mais antigo) a Frames() - 1.
+    static int Frames();
+    static void FrameBounds(int frame, uint64_t* begin, uint64_t* end);
+    // Posição no histórico do frame que terminou na chamada número "number"
+    // (contando a partir de 1) de EndFrame(), ou -1 se ele não está mais
+    // (ou não foi) guardado.
+    static int FindFrame(uint64_t number);
+    // Chama "visit" para cada zona que se sobrepõe ao frame.
+    template <typename Visit>
+    static void ForEachZone(int frame, Visit visit);
+
+    static double TicksToMs(uint64_t ticks);
+    // Converte um instante em ticks para microssegundos no FrameClock, a
+    // mesma base de tempo do GpuTimer.
+    static double TicksToClockUs(uint64_t ticks);
+
+    // Acrescenta as zonas do histórico a "events".
+    static void AppendTraceEvents(std::vector<TraceEvent>& events);
+
+    // Zonas perdidas porque o buffer de alguma thread encheu.
+    static uint64_t Dropped();
+
+    // Usadas por ProfileScope: EnterZone() aumenta a profundidade da thread
+    // atual, e Record() a diminui e guarda a zona.
+    static void EnterZone();
+    static void Record(const char* name, uint64_t begin, uint64_t end);
+
+private:
+    static bool HistoryRange(int frame, uint64_t* first, uint64_t* last);
+    static const ProfileZone& HistoryZone(uint64_t index);
+};
+
+// Mede do construtor ao destrutor. Use a macro PROFILE_SCOPE.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : m_name(name)
+    {
+        Profiler::EnterZone();
+        m_begin = Profiler::Now();
+    }
+    ~ProfileScope()
+    {
+        Profiler::Record(m_name, m_begin, Profiler::Now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t    m_begin;
+};
+
+template <typename Visit>
+void Profiler::ForEachZone(int frame, Visit visit)
+{
+    uint64_t frame_begin, frame_end, first, last;
+    FrameBounds(frame, &frame_begin, &frame_end);
+    if (!HistoryRange(frame, &first, &last))
+        return;
+    for (uint64_t i = first; i < last; ++i)
+    {
+        const ProfileZone& zone = HistoryZone(i);
+        if (zone.end > frame_begin && zone.begin < frame_end)
+            visit(zone);
+    }
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_REGISTER_THREAD(thread) Profiler::RegisterThread(thread)
+#define PROFILE_END_FRAME() Profiler::EndFrame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_REGISTER_THREAD(thread) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+
+#endif
+
+#endif
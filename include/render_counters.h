@@ -0,0 +1,111 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_RENDER_COUNTERS_HEADER
+#define CLASS_RENDER_COUNTERS_HEADER
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// Quantidades contadas em cada frame. Veja RenderCounters.
+enum RenderCounter
+{
+    COUNTER_DRAW_CALLS = 0,
+    COUNTER_INSTANCES,          // soma das instâncias de cada chamada de desenho
+    COUNTER_TRIANGLES,
+    COUNTER_LINES,
+    COUNTER_POINTS,
+    COUNTER_PROGRAM_BINDS,      // glUseProgram()
+    COUNTER_VERTEX_ARRAY_BINDS, // glBindVertexArray()
+    COUNTER_TEXTURE_BINDS,      // glBindTexture()
+    COUNTER_UNIFORM_UPLOADS,    // glUniform*()
+    COUNTER_BYTES_UPLOADED,     // dados copiados da CPU para buffers e texturas
+    COUNTER_COUNT
+};
+
+// Nome para a interface ("Draw calls") e para a coluna do CSV ("draw_calls").
+const char* RenderCounterLabel(int counter);
+const char* RenderCounterColumn(int counter);
+
+// Último valor, mínimo, média e máximo do histórico.
+struct RenderCounterStats
+{
+    int      frames;
+    uint64_t last[COUNTER_COUNT];
+    uint64_t min[COUNTER_COUNT];
+    double   average[COUNTER_COUNT];
+    uint64_t max[COUNTER_COUNT];
+};
+
+// Contadores do trabalho enviado para a GPU em cada frame. As chamadas
+// OpenGL de desenho, de troca de estado e de envio de dados passam pelas
+// funções abaixo, que fazem a chamada e somam ao frame atual:
+//
+//     counters.UseProgram(program_id);
+//     counters.DrawArrays(GL_POINTS, first, 1);
+//     ...
+//     counters.EndFrame(frame);
+//
+// Código que faz as chamadas por conta própria (por exemplo, o renderizador
+// da ImGui) informa o que fez com CountDraw() e Add(). EndFrame() guarda os
+// totais em um anel de HISTORY frames e, se houver um arquivo aberto com
+// OpenCsv(), escreve uma linha por frame nele.
+//
+// As funções de contagem e EndFrame() são usadas pela thread que detém o
+// contexto OpenGL; Stats(), Last() e as funções do CSV podem ser chamadas
+// por qualquer thread.
+class RenderCounters {
+public:
+    static const int HISTORY = 240;
+
+    RenderCounters();
+    ~RenderCounters();
+
+    RenderCounters(const RenderCounters&) = delete;
+    RenderCounters& operator=(const RenderCounters&) = delete;
+
+    void DrawArrays(GLenum mode, GLint first, GLsizei count);
+    void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint base_vertex);
+    void UseProgram(GLuint program);
+    void BindVertexArray(GLuint vertex_array);
+    void BindTexture(GLenum target, GLuint texture);
+    void UniformMatrix4fv(GLint location, const glm::mat4& matrix);
+    void Uniform1i(GLint location, GLint value);
+
+    // Uma chamada de desenho de "count" vértices (ou índices) no modo
+    // "mode", com "instances" instâncias.
+    void CountDraw(GLenum mode, GLsizei count, GLsizei instances);
+    void Add(RenderCounter counter, uint64_t value) { m_frame[counter] += value; }
+
+    // Fecha o frame "frame" e começa a contar o próximo.
+    void EndFrame(uint64_t frame);
+
+    RenderCounterStats Stats() const;
+    // Valor de "counter" no último frame fechado.
+    uint64_t Last(RenderCounter counter) const;
+    // Copia os COUNTER_COUNT valores do frame "frame" para "out". Retorna
+    // false se ele ainda não foi fechado ou já saiu do histórico.
+    bool FindFrame(uint64_t frame, uint64_t* out) const;
+
+    // Passa a escrever os contadores de cada frame em "path" (uma linha por
+    // frame, com cabeçalho). Retorna false se o arquivo não pôde ser criado.
+    bool OpenCsv(const char* path);
+    void CloseCsv();
+    bool CsvOpen() const;
+
+private:
+    uint64_t m_frame[COUNTER_COUNT]; // frame atual, usado só pela thread de renderização
+
+    mutable std::mutex m_mutex;
+    std::vector<uint64_t> m_history; // anel de HISTORY frames, COUNTER_COUNT valores cada
+    std::vector<uint64_t> m_history_frames; // número de cada frame do anel
+    size_t   m_history_next;
+    size_t   m_history_size;
+    FILE*    m_csv;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_RENDER_TARGET_HEADER
+#define CLASS_RENDER_TARGET_HEADER
+
+#include <vector>
+
+#include "gpu_resources.h"
+
+// Framebuffer fora da tela (FBO): uma textura de cor RGBA de 8 bits e uma
+// de profundidade, ambas de width x height pixels. Desenhar com o FBO
+// ligado (glBindFramebuffer()) escreve nas texturas em vez de na janela.
+class RenderTarget {
+public:
+    RenderTarget() : m_width(0), m_height(0) {}
+
+    // Cria (ou recria, se o tamanho mudou) as texturas e o FBO. Retorna
+    // false se o driver não aceita a combinação de formatos.
+    bool Create(GpuResourceManager& gpu, const char* name, int width, int height);
+
+    GLuint Framebuffer() const { return m_framebuffer.Id(); }
+    GLuint ColorTexture() const { return m_color.Id(); }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+
+    // Copia os pixels de cor para "pixels" (RGBA, linhas de baixo para
+    // cima, como em glReadPixels()). Espera a GPU terminar de desenhar.
+    void ReadPixels(std::vector<unsigned char>& pixels) const;
+
+private:
+    GpuFramebuffer m_framebuffer;
+    GpuTexture     m_color;
+    GpuTexture     m_depth;
+    int            m_width;
+    int            m_height;
+};
+
+// RenderTargets reaproveitados entre frames e entre mudanças de tamanho.
+// Acquire() devolve um alvo livre com exatamente o tamanho pedido, ou cria
+// um; EndFrame() devolve todos ao conjunto e destrói os que não foram usados
+// nos últimos KEEP_FRAMES frames. Quem pede tamanhos arredondados (veja
+// SceneTargetSize() em scene_viewport.h) reencontra o mesmo alvo enquanto a
+// janela é redimensionada, em vez de recriar as texturas a cada frame.
+//
+// Com MAX_TARGETS alvos, o livre usado há mais tempo é recriado no tamanho
+// novo. Os ponteiros devolvidos valem até o próximo EndFrame().
+class RenderTargetPool {
+public:
+    static const int      MAX_TARGETS = 8;
+    static const uint64_t KEEP_FRAMES = 120;
+
+    RenderTargetPool() : m_gpu(NULL), m_name(""), m_frame(0), m_created(0) {}
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // "name" é usado em todos os alvos (veja GpuResourceManager).
+    void Init(GpuResourceManager& gpu, const char* name);
+    // Destrói todos os alvos. Deve ser chamada antes de gpu.Shutdown().
+    void Clear();
+
+    // NULL se o framebuffer não pôde ser criado.
+    RenderTarget* Acquire(int width, int height);
+    void EndFrame();
+
+    size_t   Size() const { return m_entries.size(); }
+    // Alvos criados (ou recriados) desde Init().
+    uint64_t Created() const { return m_created; }
+
+private:
+    struct Entry
+    {
+        RenderTarget target;
+        uint64_t     last_used;
+        bool         in_use;
+    };
+
+    GpuResourceManager* m_gpu;
+    const char*         m_name;
+    std::vector<Entry>  m_entries; // capacidade MAX_TARGETS: não realoca
+    uint64_t            m_frame;
+    uint64_t            m_created;
+};
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_RENDER_THREAD_HEADER
+#define CLASS_RENDER_THREAD_HEADER
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "geometry_pool.h"
+#include "gpu_resources.h"
+#include "gpu_timer.h"
+#include "headless.h"
+#include "interface.h"
+#include "render_counters.h"
+#include "scene_viewport.h"
+#include "timestep.h"
+#include "ui_layer.h"
+#include "ui_renderer.h"
+
+// O que desenhar para cada item da lista de desenho (combinação de bits).
+enum DrawItemFlags
+{
+    DRAW_FACES         = 1 << 0, // faces do cubo
+    DRAW_EDGES         = 1 << 1, // arestas pretas do cubo
+    DRAW_AXES          = 1 << 2, // eixos XYZ do sistema de coordenadas do modelo
+    DRAW_VERTEX_MARKER = 1 << 3, // ponto em cima do terceiro vértice do cubo
+    DRAW_HIGHLIGHT     = 1 << 4  // arestas em destaque (objeto selecionado na interface)
+};
+
+struct DrawItem
+{
+    glm::mat4    model;
+    unsigned int flags;
+    float        axes_line_width;
+};
+
+// Cópia profunda de ImDrawData. As listas de comandos da ImGui pertencem ao
+// contexto da ImGui e são reescritas no próximo ImGui::NewFrame(); para que a
+// thread de renderização possa desenhá-las enquanto a thread principal já
+// monta o próximo frame, copiamos os buffers para listas próprias, que são
+// reaproveitadas de um frame para o outro.
+class UiDrawSnapshot {
+public:
+    UiDrawSnapshot();
+    ~UiDrawSnapshot();
+
+    void Capture(const ImDrawData* draw_data);
+    ImDrawData* Data() { return &m_draw_data; }
+
+private:
+    UiDrawSnapshot(const UiDrawSnapshot&);
+    UiDrawSnapshot& operator=(const UiDrawSnapshot&);
+
+    ImDrawData m_draw_data;
+    ImVector<ImDrawList*> m_lists;
+};
+
+// Tudo o que a thread de renderização precisa para desenhar um frame. É
+// preenchido pela thread principal e não é mais modificado depois de
+// publicado com RenderThread::EndFrame().
+struct FramePacket
+{
+    uint64_t  frame;
+    glm::mat4 view;
+    glm::mat4 projection;
+    ImVec4    clear_color;
+    int       framebuffer_width;
+    int       framebuffer_height;
+    int       present_mode;  // veja PresentMode em timestep.h
+    float     throttle_fps;
+    int       gpu_queue_depth; // frames na fila da GPU; 0 deixa o driver decidir
+    FrameClock::time_point input_sampled; // última leitura da entrada usada no frame
+    bool      lean_ui_renderer; // UiRenderer em vez do renderizador da ImGui
+    bool      ui_cache;  // interface composta da camada (veja ui_layer.h)
+    bool      ui_redraw; // com ui_cache: redesenhar a camada com "ui"
+    bool      scene_viewport; // cena fora da tela, mostrada na janela "Viewport"
+    SceneViewportLayout viewport; // com scene_viewport (veja scene_viewport.h)
+
+    std::vector<DrawItem> draw_list;
+    UiDrawSnapshot ui;
+    GlyphUpload    glyph_upload; // glyphs novos do atlas de fontes (veja glyph_cache.h)
+};
+
+// Objetos OpenGL criados pela thread principal durante a inicialização e
+// usados pela thread de renderização. A partir de Start(), o gerenciador de
+// recursos só é usado pela thread de renderização.
+struct RenderResources
+{
+    GpuResourceManager* gpu;
+    GeometryPool*       geometry; // VAO e buffers com a geometria de BuildTriangles()
+    GpuTimer*           gpu_timer; // tempos de GPU de cada etapa do frame
+    RenderCounters*     counters;  // chamadas de desenho, trocas de estado e envios do frame
+    GLuint              framebuffer; // onde desenhar: 0 é a janela
+    GLuint              program_id;
+    GLint               model_uniform;
+    GLint               view_uniform;
+    GLint               projection_uniform;
+    GLint               render_as_black_uniform;
+    GLint               render_as_highlight_uniform;
+
+    SceneObject cube_faces;
+    SceneObject cube_edges;
+    SceneObject axes;
+};
+
+// Thread dedicada à renderização. Ela é dona do contexto OpenGL da janela:
+// todas as chamadas gl*() e glfwSwapBuffers() são feitas por ela. A thread
+// principal trata os eventos da GLFW, roda a simulação e monta um
+// FramePacket por frame:
+//
+//     FramePacket& packet = render_thread.BeginFrame();
+//     ... preenche packet ...
+//     render_thread.EndFrame();
+//
+// Os pacotes ficam em um buffer triplo: a thread principal escreve em um, a
+// de renderização lê de outro, e o terceiro guarda o último pacote publicado.
+// A troca de pacotes é feita com uma única operação atômica (sem locks).
+// BeginFrame() deixa a thread principal no máximo um frame à frente: o
+// frame N+1 é simulado enquanto o frame N é enviado para a GPU.
+class RenderThread {
+public:
+    RenderThread();
+    ~RenderThread();
+
+    // Libera o contexto OpenGL de "window" na thread atual e inicia a thread
+    // de renderização, que inicializa o renderizador da ImGui. Retorna após a
+    // inicialização terminar.
+    void Start(GLFWwindow* window, const RenderResources& resources, Interface* interface);
+    // O mesmo, para o modo sem janela (veja headless.h): não há interface
+    // nem glfwSwapBuffers(), e cada frame termina com glFinish(), para que
+    // os tempos incluam o trabalho da GPU.
+    void Start(HeadlessContext* context, const RenderResources& resources);
+    // Fixa a thread de renderização em um núcleo (veja PinThreadToCore() em
+    // job_system.h). Deve ser chamada antes de Start().
+    void PinToCore(int core) { m_core = core; }
+    // Termina a thread e devolve o contexto OpenGL para a thread atual.
+    void Stop();
+
+    FramePacket& BeginFrame();
+    void EndFrame();
+    // Espera a thread de renderização terminar de desenhar o último pacote
+    // publicado.
+    void WaitIdle();
+
+    // Tempos da thread de renderização no último frame, em milissegundos:
+    // enviando comandos para a GPU, dentro de glfwSwapBuffers() (e do limite
+    // de FPS) e esperando um novo pacote.
+    float SubmitMs() const { return m_submit_ms.load(std::memory_order_relaxed); }
+    float SwapMs() const   { return m_swap_ms.load(std::memory_order_relaxed); }
+    float IdleMs() const   { return m_idle_ms.load(std::memory_order_relaxed); }
+    // Tempo que a thread principal passou bloqueada no último BeginFrame().
+    float MainWaitMs() const { return m_main_wait_ms; }
+    // Ritmo da apresentação nos últimos frames (veja PacingStats em
+    // timestep.h): intervalo médio, jitter e latência média e máxima da
+    // entrada até a apresentação, em milissegundos.
+    float FrameIntervalMs() const { return m_interval_ms.load(std::memory_order_relaxed); }
+    float PacingJitterMs() const  { return m_jitter_ms.load(std::memory_order_relaxed); }
+    float LatencyMs() const       { return m_latency_ms.load(std::memory_order_relaxed); }
+    float MaxLatencyMs() const    { return m_max_latency_ms.load(std::memory_order_relaxed); }
+    // Instante em que o primeiro frame foi apresentado. Retorna false se
+    // ainda não foi (veja StartupTimeline em startup.h).
+    bool FirstPresent(FrameClock::time_point* presented) const
+    {
+        if (!m_first_presented.load(std::memory_order_acquire))
+            return false;
+        *presented = m_first_present;
+        return true;
+    }
+
+    static constexpr int MAX_GPU_QUEUE_DEPTH = 2;
+
+private:
+    static const uint32_t NEW_PACKET = 4;
+
+    void Run();
+    void Draw(FramePacket& packet);
+    void LimitGpuQueue(int depth);
+    void MakeContextCurrent();
+    void ReleaseContext();
+
+    GLFWwindow*     m_window;
+    HeadlessContext* m_headless;
+    RenderResources m_resources;
+    Interface*      m_interface;
+    UiRenderer      m_ui_renderer;
+    UiLayer         m_ui_layer;
+    SceneViewport   m_viewport;
+    std::thread     m_thread;
+    bool            m_running;
+    int             m_core;
+
+    // Buffer triplo. m_back pertence à thread principal, m_front à de
+    // renderização; m_ready guarda o índice do terceiro pacote, com o bit
+    // NEW_PACKET ligado se ele ainda não foi consumido.
+    FramePacket           m_packets[3];
+    uint32_t              m_back;
+    uint32_t              m_front;
+    std::atomic<uint32_t> m_ready;
+
+    // Contadores de frames publicados e consumidos. Usados apenas para
+    // decidir quando uma das threads precisa dormir: nesse caso a espera é
+    // feita em uma variável de condição.
+    uint64_t              m_published;
+    std::atomic<uint64_t> m_consumed;
+    std::atomic<uint64_t> m_completed; // último pacote desenhado
+    std::atomic<bool>     m_stop;
+    std::mutex            m_mutex;
+    std::condition_variable m_cv;
+
+    FrameLimiter m_frame_limiter;
+    int          m_present_mode;
+    PacingStats  m_pacing;
+    FrameClock::time_point m_first_present;
+    std::atomic<bool>      m_first_presented;
+
+    // Fences dos frames enviados e ainda não terminados pela GPU, do mais
+    // antigo para o mais novo (veja LimitGpuQueue()).
+    GLsync       m_fences[MAX_GPU_QUEUE_DEPTH];
+    int          m_fence_count;
+
+    std::atomic<float> m_submit_ms;
+    std::atomic<float> m_swap_ms;
+    std::atomic<float> m_idle_ms;
+    float              m_main_wait_ms;
+    std::atomic<float> m_interval_ms;
+    std::atomic<float> m_jitter_ms;
+    std::atomic<float> m_latency_ms;
+    std::atomic<float> m_max_latency_ms;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef _SCENE_OUTLINER_H
+#define _SCENE_OUTLINER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "transforms.h"
+
+// Nomes e filhos de cada nó de uma TransformHierarchy, para a interface. A
+// hierarquia só guarda o pai de cada nó; aqui os filhos ficam em listas
+// encadeadas (primeiro filho, próximo irmão), e os nomes em um único bloco
+// de memória, um atrás do outro.
+class SceneIndex {
+public:
+    SceneIndex();
+
+    void Reserve(size_t count, size_t name_bytes);
+    // Registra o nó "id", já criado na hierarquia como filho de "parent"
+    // (INVALID_TRANSFORM se raiz).
+    void Add(TransformId id, TransformId parent, const char* name);
+
+    size_t      Size() const { return m_count; }
+    bool        Contains(TransformId id) const { return id < m_name_offsets.size() && m_name_offsets[id] != NO_NAME; }
+    const char* Name(TransformId id) const { return &m_names[m_name_offsets[id]]; }
+    TransformId Parent(TransformId id) const { return m_parents[id]; }
+    TransformId FirstChild(TransformId id) const { return m_first_child[id]; }
+    TransformId NextSibling(TransformId id) const { return m_next_sibling[id]; }
+    uint32_t    ChildCount(TransformId id) const { return m_child_counts[id]; }
+    TransformId FirstRoot() const { return m_first_root; }
+    // Maior identificador registrado + 1.
+    TransformId IdLimit() const { return (TransformId)m_name_offsets.size(); }
+
+private:
+    static constexpr uint32_t NO_NAME = 0xFFFFFFFFu;
+
+    std::vector<char>        m_names;
+    std::vector<uint32_t>    m_name_offsets;
+    std::vector<TransformId> m_parents;
+    std::vector<TransformId> m_first_child;
+    std::vector<TransformId> m_last_child;
+    std::vector<TransformId> m_next_sibling;
+    std::vector<uint32_t>    m_child_counts;
+    TransformId m_first_root;
+    TransformId m_last_root;
+    size_t      m_count;
+};
+
+// Janela "Outliner": a árvore da cena, uma busca por nome e um inspetor da
+// transformação local do nó selecionado.
+//
+// Para que o custo por frame não dependa do tamanho da cena:
+//
+// - A árvore é mantida "achatada" em m_rows, uma linha por nó visível (os
+//   filhos só entram quando o pai é expandido), e só as linhas dentro da
+//   área visível da janela são submetidas à ImGui (ImGuiListClipper).
+//   Expandir ou recolher um nó insere ou remove apenas as linhas da sua
+//   subárvore visível.
+// - A busca percorre os nomes aos poucos, no máximo SCAN_BUDGET_MS por
+//   frame, e mostra os resultados encontrados até o momento. Quando o texto
+//   novo contém o anterior (o usuário continuou digitando), só os
+//   resultados anteriores e os nós ainda não testados são testados de novo:
+//   a busca continua de onde estava, sem recomeçar.
+//
+// O nó selecionado é destacado na cena pela thread principal (veja
+// DRAW_HIGHLIGHT em render_thread.h).
+class SceneOutliner {
+public:
+    static constexpr double SCAN_BUDGET_MS = 1.0;
+
+    SceneOutliner();
+
+    // Desenha a janela. Modificações no inspetor são aplicadas em
+    // "transforms" (e calculadas no próximo TransformHierarchy::Update()).
+    void Show(const SceneIndex& index, TransformHierarchy& transforms);
+
+    TransformId Selected() const { return m_selected; }
+    void Select(TransformId id) { m_selected = id; }
+    // Expande ou recolhe todos os nós (botões "Expand all" e "Collapse all").
+    void ExpandAll(const SceneIndex& index, bool expanded);
+
+    // Estado da busca, para a interface e o benchmark.
+    bool   Searching() const { return m_source_next < m_search_source.size() || m_range_next < m_range_end; }
+    size_t Matches() const { return m_matches.size(); }
+    size_t VisibleRows() const { return m_rows.size(); }
+
+private:
+    struct Row
+    {
+        TransformId id;
+        uint32_t    depth;
+    };
+
+    void ShowTree(const SceneIndex& index);
+    void ShowMatches(const SceneIndex& index);
+    void ShowInspector(const SceneIndex& index, TransformHierarchy& transforms);
+    void Reset(const SceneIndex& index);
+    void Toggle(const SceneIndex& index, size_t row);
+    size_t AppendVisible(const SceneIndex& index, TransformId first, uint32_t depth, std::vector<Row>& out);
+    void UpdateSearch(const SceneIndex& index);
+    void ContinueSearch(const SceneIndex& index);
+    void Reveal(TransformId id, const SceneIndex& index);
+
+    std::vector<Row>     m_rows;     // árvore achatada: nós visíveis, em pré-ordem
+    std::vector<uint8_t> m_expanded; // por nó
+    std::vector<Row>     m_inserted; // temporário de Toggle()
+    size_t               m_index_size; // SceneIndex::Size() quando m_rows foi montada
+
+    char m_filter[128];       // texto do campo de busca
+    char m_search[128];       // texto da busca em andamento ou concluída
+    // Candidatos a testar: primeiro os da lista (resultados de uma busca
+    // anterior), depois os identificadores do intervalo.
+    std::vector<TransformId> m_matches;
+    std::vector<TransformId> m_search_source;
+    size_t      m_source_next;
+    TransformId m_range_next, m_range_end;
+    size_t      m_search_tested, m_search_total; // para o progresso
+
+    TransformId m_selected;
+    bool        m_scroll_to_selected;
+
+    // Ângulos de Euler mostrados no inspetor. Recalculá-los do quaternion a
+    // cada frame faria a representação saltar durante a edição.
+    TransformId m_euler_id;
+    glm::quat   m_euler_rotation; // rotação de onde m_euler_degrees veio
+    glm::vec3   m_euler_degrees;
+};
+
+#endif // _SCENE_OUTLINER_H
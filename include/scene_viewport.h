@@ -0,0 +1,109 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_SCENE_VIEWPORT_HEADER
+#define CLASS_SCENE_VIEWPORT_HEADER
+
+#include <cstdint>
+
+#include "gpu_resources.h"
+#include "render_counters.h"
+#include "render_target.h"
+
+// Escalas de resolução da cena oferecidas na janela "Viewport", em
+// porcentagem do tamanho da imagem na tela.
+static const int SCENE_VIEWPORT_SCALES[] = { 50, 75, 100 };
+static const int SCENE_VIEWPORT_SCALE_COUNT = (int)(sizeof(SCENE_VIEWPORT_SCALES) / sizeof(SCENE_VIEWPORT_SCALES[0]));
+
+// Os alvos têm as dimensões arredondadas para cima para um múltiplo deste
+// valor: redimensionar a janela só troca de alvo a cada 64 pixels.
+static const int SCENE_TARGET_GRANULARITY = 64;
+
+// ImTextureID colocada pela interface na imagem da cena. A textura só é
+// conhecida pela thread de renderização, que troca este valor pelo nome
+// OpenGL da textura antes de desenhar a interface.
+#define SCENE_VIEWPORT_TEXTURE ((ImTextureID)(intptr_t)-1)
+
+inline int SceneTargetSize(int pixels)
+{
+    return (pixels + SCENE_TARGET_GRANULARITY - 1) / SCENE_TARGET_GRANULARITY * SCENE_TARGET_GRANULARITY;
+}
+
+// Tamanhos de um frame da janela "Viewport", calculados pela interface na
+// thread principal e levados no FramePacket.
+struct SceneViewportLayout
+{
+    int    display_width;  // imagem na tela, em pixels do framebuffer
+    int    display_height;
+    int    scene_width;    // resolução em que a cena é desenhada
+    int    scene_height;
+    int    target_width;   // alvo da cena: a cena ocupa o canto inferior
+    int    target_height;  // esquerdo
+    float  sharpen;        // 0: só a filtragem bilinear da ImGui::Image()
+    ImVec2 uv0, uv1;       // parte usada da textura mostrada (invertida em V)
+};
+
+// "scale" é a fração da resolução da imagem em que a cena é desenhada. O
+// alvo tem o tamanho para "max_scale": com a resolução dinâmica (veja
+// dynamic_resolution.h), a escala muda quase todo frame, e a cena é
+// desenhada em uma parte de um alvo do tamanho máximo, sem recriá-lo.
+SceneViewportLayout ComputeSceneViewportLayout(int display_width, int display_height, float scale, float max_scale,
+                                               float sharpen);
+
+// Cena desenhada fora da tela, em uma resolução independente da janela, e
+// mostrada pela interface como uma imagem (veja Interface::ShowViewport()).
+// Em GPUs fracas, a escala de 50% desenha um quarto dos pixels; a imagem é
+// ampliada pela filtragem bilinear da textura. Opcionalmente, um filtro de
+// nitidez (shader_viewport_sharpen_fragment.glsl) é aplicado antes, na
+// resolução da cena, com cinco leituras sem filtragem por pixel da cena.
+//
+// Os alvos vêm de um RenderTargetPool (veja render_target.h). Usada pela
+// thread de renderização:
+//
+//     if (viewport.Begin(layout, clear_color))
+//     {
+//         ... desenha a cena ...
+//         GLuint texture = viewport.End(layout, counters);
+//     }
+//     ...
+//     viewport.EndFrame();
+class SceneViewport {
+public:
+    SceneViewport()
+        : m_gpu(NULL), m_scene(NULL), m_max_uniform(-1), m_amount_uniform(-1)
+    {
+    }
+
+    SceneViewport(const SceneViewport&) = delete;
+    SceneViewport& operator=(const SceneViewport&) = delete;
+
+    // Carrega os shaders do filtro.
+    void Init(GpuResourceManager& gpu);
+    // Libera os objetos OpenGL. Deve ser chamada antes de gpu.Shutdown().
+    void Shutdown();
+
+    // Liga um alvo de target_width x target_height pixels, limpo com
+    // "clear_color", com o viewport da cena no canto inferior esquerdo.
+    // Retorna false se não há alvo (a cena não deve ser desenhada).
+    bool Begin(const SceneViewportLayout& layout, const ImVec4& clear_color);
+    // Aplica o filtro, se pedido, e retorna a textura a mostrar. Deixa
+    // ligado o framebuffer 0.
+    GLuint End(const SceneViewportLayout& layout, RenderCounters& counters);
+    // Devolve os alvos ao conjunto; destrói os que não são mais usados.
+    void EndFrame() { m_pool.EndFrame(); }
+
+    const RenderTargetPool& Pool() const { return m_pool; }
+
+private:
+    GpuResourceManager* m_gpu;
+    RenderTargetPool    m_pool;
+    RenderTarget*       m_scene; // alvo deste frame, entre Begin() e End()
+    GpuProgram          m_program;
+    GpuVertexArray      m_vertex_array; // vazio: os vértices vêm de gl_VertexID
+    GLint               m_max_uniform;
+    GLint               m_amount_uniform;
+};
+
+#endif
@@ -3,7 +3,36 @@
 #include "headers.h"
 #endif
 
+#ifndef CLASS_SHADERS_HEADER
+#define CLASS_SHADERS_HEADER
+
 GLuint LoadShader_Vertex(const char* filename);   // Carrega um vertex shader
 GLuint LoadShader_Fragment(const char* filename); // Carrega um fragment shader
 void LoadShader(const char* filename, GLuint shader_id); // Funcao utilizada pelas duas acima
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Cria um programa de GPU
+
+// Código-fonte de um shader lido do disco. A leitura não usa o OpenGL e pode
+// ser feita por qualquer thread; só a compilação, com as versões de
+// LoadShader_Vertex() e LoadShader_Fragment() abaixo, precisa do contexto.
+struct ShaderSource
+{
+    std::string filename;
+    std::string code;
+};
+
+bool ReadShaderSource(const char* filename, ShaderSource* source); // false se o arquivo não pode ser lido
+GLuint LoadShader_Vertex(const ShaderSource& source);
+GLuint LoadShader_Fragment(const ShaderSource& source);
+
+// Shaders compilados e programas linkados desde o início do programa, por
+// qualquer thread. Compilar trava a thread por vários milissegundos; veja
+// hitch_watchdog.h.
+struct ShaderStats
+{
+    uint64_t shaders_compiled;
+    uint64_t programs_linked;
+};
+
+ShaderStats GetShaderStats();
+
+#endif
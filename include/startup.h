@@ -0,0 +1,80 @@
+#ifndef _STARTUP_H
+#define _STARTUP_H
+
+#include <atomic>
+#include <cstdio>
+
+#include "timestep.h"
+
+// Linha do tempo da inicialização do programa, até a apresentação do
+// primeiro frame ("time to first frame").
+//
+// As etapas que não usam o OpenGL (leitura dos shaders, montagem da cena,
+// fontes da interface) rodam no JobSystem enquanto a thread principal cria a
+// janela e o contexto; as que usam o OpenGL rodam na thread do contexto, cada
+// uma depois que as suas dependências terminam (veja main()). Cada etapa
+// guarda o seu início e fim, em milissegundos desde o início de main(), para
+// mostrar o quanto elas se sobrepõem:
+//
+//     StartupTimeline startup;
+//     {
+//         StartupStep step(startup, "Window");
+//         ... cria a janela ...
+//     }
+//     ...
+//     startup.SetFirstFrame(presented);
+//     startup.Print(stdout);
+class StartupTimeline {
+public:
+    static const int MAX_STEPS = 16;
+
+    // O relógio começa na construção.
+    StartupTimeline();
+
+    // Registra uma etapa que começou em "begin" e terminou agora. Pode ser
+    // chamada por qualquer thread; etapas além de MAX_STEPS são ignoradas.
+    void Add(const char* name, FrameClock::time_point begin);
+
+    // Instante em que o primeiro frame foi apresentado.
+    void SetFirstFrame(FrameClock::time_point presented);
+    bool HasFirstFrame() const { return m_first_frame_ms >= 0.0f; }
+    // Tempo do início até o primeiro frame, em ms (-1 antes dele).
+    float FirstFrameMs() const { return m_first_frame_ms; }
+
+    // Imprime o tempo até o primeiro frame e o intervalo de cada etapa.
+    // Deve ser chamada depois de todas as etapas terminarem.
+    void Print(FILE* out) const;
+
+private:
+    struct Step
+    {
+        const char* name;
+        float       begin_ms;
+        float       end_ms;
+    };
+
+    FrameClock::time_point m_start;
+    Step                   m_steps[MAX_STEPS];
+    std::atomic<int>       m_count;
+    float                  m_first_frame_ms;
+};
+
+// Registra no StartupTimeline o escopo em que é declarada.
+class StartupStep {
+public:
+    StartupStep(StartupTimeline& timeline, const char* name)
+        : m_timeline(timeline), m_name(name), m_begin(FrameClock::now())
+    {
+    }
+    ~StartupStep() { m_timeline.Add(m_name, m_begin); }
+
+    StartupStep(const StartupStep&) = delete;
+    StartupStep& operator=(const StartupStep&) = delete;
+
+private:
+    StartupTimeline&       m_timeline;
+    const char*            m_name;
+    FrameClock::time_point m_begin;
+};
+
+#endif // _STARTUP_H
@@ -0,0 +1,141 @@
+#ifndef _TIMESTEP_H
+#define _TIMESTEP_H
+
+#include <chrono>
+
+// Relógio de alta resolução e monotônico usado por todo o loop de frames.
+typedef std::chrono::steady_clock FrameClock;
+
+// Passo de tempo fixo para a simulação, desacoplado da taxa de renderização.
+//
+// A cada frame, Advance() mede o tempo real decorrido e o acumula; o
+// retorno é o número de passos de simulação (de Dt() segundos cada) que
+// devem ser executados neste frame. O que sobra no acumulador, em fração de
+// um passo, é dado por Alpha() e serve para interpolar entre os dois últimos
+// estados simulados na hora de desenhar:
+//
+//     for (int i = timestep.Advance(); i > 0; --i)
+//     {
+//         previous = current;
+//         Simulate(current, timestep.Dt());
+//     }
+//     Draw(Interpolate(previous, current, timestep.Alpha()));
+//
+// Para evitar a "espiral da morte" (a simulação demora mais que o tempo que
+// ela simula, e cada frame precisa de mais passos que o anterior), o tempo de
+// um frame é limitado a MaxFrameTime() e o número de passos a MaxSteps(); o
+// tempo excedente é descartado e contado em DroppedTime().
+class FixedTimestep {
+public:
+    FixedTimestep(double ticks_per_second = 120.0, int max_steps = 8, double max_frame_time = 0.25);
+
+    // Reinicia o acumulador e o relógio (por exemplo, após uma pausa).
+    void Reset();
+
+    // Mede o tempo desde a última chamada e retorna quantos passos executar.
+    int Advance();
+
+    // Duração de um passo de simulação, em segundos.
+    double Dt() const { return m_dt; }
+    // Fração de passo acumulada, em [0, 1).
+    float  Alpha() const { return (float)(m_accumulator / m_dt); }
+    // Instante, no relógio real, em que termina o passo "step" (de 0 até
+    // LastSteps() - 1) do último Advance(). Usado para entregar a cada passo
+    // somente os eventos de entrada ocorridos até o seu fim.
+    FrameClock::time_point StepEndTime(int step) const;
+
+    void   SetTicksPerSecond(double ticks_per_second);
+    double TicksPerSecond() const { return 1.0 / m_dt; }
+    int    MaxSteps() const { return m_max_steps; }
+    double MaxFrameTime() const { return m_max_frame_time; }
+
+    // Estatísticas: duração do último frame, passos executados no último
+    // frame, e tempo total descartado pelas proteções acima.
+    double FrameTime() const { return m_frame_time; }
+    int    LastSteps() const { return m_last_steps; }
+    double DroppedTime() const { return m_dropped_time; }
+
+private:
+    double m_dt;
+    int    m_max_steps;
+    double m_max_frame_time;
+
+    FrameClock::time_point m_last;
+    double m_accumulator;
+
+    double m_frame_time;
+    int    m_last_steps;
+    double m_dropped_time;
+};
+
+// Modos de apresentação dos frames. A simulação roda sempre na mesma taxa
+// fixa; apenas a taxa de renderização muda.
+enum PresentMode
+{
+    PRESENT_UNCAPPED  = 0, // sem vsync, o mais rápido possível
+    PRESENT_VSYNC     = 1, // glfwSwapInterval(1)
+    PRESENT_THROTTLED = 2  // sem vsync, limitado a um número de frames por segundo
+};
+
+// Limita a taxa de frames no modo PRESENT_THROTTLED. Wait() deve ser chamada
+// uma vez por frame, após glfwSwapBuffers(): dorme até perto do instante do
+// próximo frame e termina a espera ativamente, o que é mais preciso que
+// depender somente da resolução do sleep do sistema operacional.
+//
+// A margem da espera ativa se adapta ao atraso com que o sleep acorda: ela
+// é o maior atraso recente (que decai aos poucos) mais uma folga, entre
+// MIN_SPIN_US e MAX_SPIN_US. Em um sistema em que o sleep é preciso, quase
+// todo o tempo de espera é dormido, sem ocupar a CPU.
+class FrameLimiter {
+public:
+    static constexpr int MIN_SPIN_US = 200;
+    static constexpr int MAX_SPIN_US = 2000;
+
+    FrameLimiter();
+
+    void SetTargetFPS(double fps);
+    double TargetFPS() const { return m_target_fps; }
+
+    void Wait();
+
+    // Margem atual da espera ativa, em microssegundos.
+    double SpinUs() const { return std::chrono::duration<double, std::micro>(m_spin).count(); }
+
+private:
+    double m_target_fps;
+    FrameClock::duration m_period;
+    FrameClock::time_point m_next;
+    FrameClock::duration m_spin;
+    FrameClock::duration m_oversleep; // maior atraso recente do sleep
+};
+
+// Ritmo dos frames apresentados, medido pela thread de renderização: o
+// intervalo entre apresentações consecutivas e a sua variação ("jitter",
+// desvio padrão), e a latência de cada frame, do instante em que a entrada
+// foi lida pela thread principal até a apresentação. Guarda os últimos
+// HISTORY frames; um intervalo maior que MAX_INTERVAL_MS (o modo ocioso ou
+// uma pausa) recomeça a contagem dos intervalos.
+class PacingStats {
+public:
+    static constexpr int HISTORY = 120;
+    static constexpr double MAX_INTERVAL_MS = 250.0;
+
+    PacingStats();
+
+    void Add(FrameClock::time_point presented, FrameClock::time_point input_sampled);
+
+    float IntervalMs() const;    // média dos intervalos
+    float JitterMs() const;      // desvio padrão dos intervalos
+    float LatencyMs() const;     // média das latências
+    float MaxLatencyMs() const;
+
+private:
+    float m_intervals[HISTORY];
+    float m_latencies[HISTORY];
+    int   m_interval_count, m_interval_next;
+    int   m_latency_count, m_latency_next;
+    FrameClock::time_point m_last_presented;
+    bool  m_has_last;
+};
+
+#endif // _TIMESTEP_H
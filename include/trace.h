@@ -0,0 +1,38 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <cstddef>
+#include <vector>
+
+// Arquivos de "trace" no formato JSON "trace_event" do Chrome, que podem ser
+// abertos em chrome://tracing ou em https://ui.perfetto.dev. Cada evento é
+// um intervalo de tempo com nome, desenhado em uma linha ("thread") da
+// linha do tempo.
+
+// Linhas da linha do tempo. As da CPU são as threads do programa; a da GPU
+// mostra os intervalos medidos com consultas de tempo (veja gpu_timer.h).
+// A thread de trabalho "i" do JobSystem é TRACE_THREAD_WORKERS + i.
+enum TraceThread
+{
+    TRACE_THREAD_MAIN    = 1,
+    TRACE_THREAD_RENDER  = 2,
+    TRACE_THREAD_GPU     = 3,
+    TRACE_THREAD_WORKERS = 16
+};
+
+struct TraceEvent
+{
+    const char* name;   // deve continuar válido até o arquivo ser escrito
+    int         thread; // veja TraceThread
+    double      start_us;
+    double      duration_us;
+};
+
+// Nome da linha "thread" ("Main", "Worker 2", ...).
+void TraceThreadName(int thread, char* out, size_t size);
+
+// Escreve os eventos em "path". Retorna false se o arquivo não pôde ser
+// escrito.
+bool WriteChromeTrace(const char* path, const std::vector<TraceEvent>& events);
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef _TRANSFORM_TYPES_H
+#define _TRANSFORM_TYPES_H
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "const_math.h"
+
+// Transformações geométricas "tipadas". Em vez de montar uma matriz 4x4
+// completa para cada transformação e multiplicá-las (64 multiplicações e 48
+// somas por produto), cada tipo guarda apenas os termos não triviais:
+//
+//   Translation  t          (3 floats)
+//   Scale        s          (3 floats, diagonal)
+//   Rotation     R          (3x3)
+//   Affine       R*S + t    (3x3 + 3 floats, última linha sempre [0 0 0 1])
+//
+// Os operadores * abaixo compõem só esses termos, e o resultado vira uma
+// glm::mat4 apenas no final, com ToMatrix(). Por exemplo, o equivalente a
+//
+//   Matrix_Translate(0,0,-2) * Matrix_Rotate(a, axis) * Matrix_Scale(2,.5,.5)
+//
+// é
+//
+//   (Translation(0,0,-2) * Rotation::Axis(a, axis) * Scale(2,.5,.5)).ToMatrix()
+//
+// que custa 9 multiplicações em vez de 128 multiplicações e 96 somas. Todas
+// as funções são "constexpr": com argumentos constantes, a matriz final é
+// calculada em tempo de compilação.
+//
+// As matrizes 3x3 são guardadas por colunas, como no GLM: m[coluna][linha].
+
+struct Translation
+{
+    float x, y, z;
+
+    constexpr Translation() : x(0.0f), y(0.0f), z(0.0f) {}
+    constexpr Translation(float tx, float ty, float tz) : x(tx), y(ty), z(tz) {}
+    constexpr explicit Translation(const glm::vec3& t) : x(t.x), y(t.y), z(t.z) {}
+
+    constexpr glm::mat4 ToMatrix() const
+    {
+        return glm::mat4(
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            x,    y,    z,    1.0f
+        );
+    }
+};
+
+struct Scale
+{
+    float x, y, z;
+
+    constexpr Scale() : x(1.0f), y(1.0f), z(1.0f) {}
+    constexpr Scale(float sx, float sy, float sz) : x(sx), y(sy), z(sz) {}
+    constexpr explicit Scale(const glm::vec3& s) : x(s.x), y(s.y), z(s.z) {}
+
+    constexpr glm::mat4 ToMatrix() const
+    {
+        return glm::mat4(
+            x,    0.0f, 0.0f, 0.0f,
+            0.0f, y,    0.0f, 0.0f,
+            0.0f, 0.0f, z,    0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f
+        );
+    }
+};
+
+struct Rotation
+{
+    float m[3][3];
+
+    constexpr Rotation() : m{{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}} {}
+
+    // Mesmas matrizes de Matrix_Rotate_X/Y/Z() e Matrix_Rotate().
+    static constexpr Rotation X(float angle)
+    {
+        float c = Const_Cos(angle);
+        float s = Const_Sin(angle);
+        Rotation r;
+        r.m[1][1] = c;  r.m[2][1] = -s;
+        r.m[1][2] = s;  r.m[2][2] = c;
+        return r;
+    }
+
+    static constexpr Rotation Y(float angle)
+    {
+        float c = Const_Cos(angle);
+        float s = Const_Sin(angle);
+        Rotation r;
+        r.m[0][0] = c;  r.m[2][0] = s;
+        r.m[0][2] = -s; r.m[2][2] = c;
+        return r;
+    }
+
+    static constexpr Rotation Z(float angle)
+    {
+        float c = Const_Cos(angle);
+        float s = Const_Sin(angle);
+        Rotation r;
+        r.m[0][0] = c;  r.m[1][0] = -s;
+        r.m[0][1] = s;  r.m[1][1] = c;
+        return r;
+    }
+
+    // Rotação de "angle" radianos em torno de "axis" (não precisa ser unitário).
+    static constexpr Rotation Axis(float angle, const glm::vec3& axis)
+    {
+        float c = Const_Cos(angle);
+        float s = Const_Sin(angle);
+        float length = Const_Sqrt(axis.x*axis.x + axis.y*axis.y + axis.z*axis.z);
+        float vx = axis.x / length;
+        float vy = axis.y / length;
+        float vz = axis.z / length;
+
+        Rotation r;
+        r.m[0][0] = vx*vx*(1-c) + c;     r.m[1][0] = vx*vy*(1-c) - vz*s;  r.m[2][0] = vx*vz*(1-c) + vy*s;
+        r.m[0][1] = vx*vy*(1-c) + vz*s;  r.m[1][1] = vy*vy*(1-c) + c;     r.m[2][1] = vy*vz*(1-c) - vx*s;
+        r.m[0][2] = vx*vz*(1-c) - vy*s;  r.m[1][2] = vy*vz*(1-c) + vx*s;  r.m[2][2] = vz*vz*(1-c) + c;
+        return r;
+    }
+
+    constexpr glm::mat4 ToMatrix() const
+    {
+        return glm::mat4(
+            m[0][0], m[0][1], m[0][2], 0.0f,
+            m[1][0], m[1][1], m[1][2], 0.0f,
+            m[2][0], m[2][1], m[2][2], 0.0f,
+            0.0f,    0.0f,    0.0f,    1.0f
+        );
+    }
+};
+
+struct Affine
+{
+    float m[3][3];
+    float t[3];
+
+    constexpr Affine() : m{{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}, t{0.0f, 0.0f, 0.0f} {}
+
+    // Colunas da parte linear seguidas da translação.
+    constexpr Affine(float m00, float m01, float m02,
+                     float m10, float m11, float m12,
+                     float m20, float m21, float m22,
+                     float tx,  float ty,  float tz)
+        : m{{m00, m01, m02}, {m10, m11, m12}, {m20, m21, m22}}, t{tx, ty, tz} {}
+
+    constexpr Affine(const Translation& tr)
+        : Affine(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, tr.x, tr.y, tr.z) {}
+
+    constexpr Affine(const Scale& s)
+        : Affine(s.x, 0.0f, 0.0f, 0.0f, s.y, 0.0f, 0.0f, 0.0f, s.z, 0.0f, 0.0f, 0.0f) {}
+
+    constexpr Affine(const Rotation& r, float tx = 0.0f, float ty = 0.0f, float tz = 0.0f)
+        : Affine(r.m[0][0], r.m[0][1], r.m[0][2],
+                 r.m[1][0], r.m[1][1], r.m[1][2],
+                 r.m[2][0], r.m[2][1], r.m[2][2], tx, ty, tz) {}
+
+    constexpr glm::mat4 ToMatrix() const
+    {
+        return glm::mat4(
+            m[0][0], m[0][1], m[0][2], 0.0f,
+            m[1][0], m[1][1], m[1][2], 0.0f,
+            m[2][0], m[2][1], m[2][2], 0.0f,
+            t[0],    t[1],    t[2],    1.0f
+        );
+    }
+};
+
+// Composições entre os tipos simples. Apenas os termos não triviais são
+// calculados; o número de operações aparece ao lado de cada uma. Os termos
+// são escritos um a um (sem laços) para que o compilador mantenha tudo em
+// registradores.
+
+// 3 somas
+constexpr Translation operator*(const Translation& a, const Translation& b)
+{
+    return Translation(a.x + b.x, a.y + b.y, a.z + b.z);
+}
+
+// 3 multiplicações
+constexpr Scale operator*(const Scale& a, const Scale& b)
+{
+    return Scale(a.x * b.x, a.y * b.y, a.z * b.z);
+}
+
+// Linha l de A vezes a coluna c de B, para matrizes 3x3 guardadas por colunas.
+#define TRANSFORM_TYPES_DOT(A, B, c, l) ((A)[0][l] * (B)[c][0] + (A)[1][l] * (B)[c][1] + (A)[2][l] * (B)[c][2])
+
+// 27 multiplicações e 18 somas
+constexpr Rotation operator*(const Rotation& a, const Rotation& b)
+{
+    Rotation r;
+    r.m[0][0] = TRANSFORM_TYPES_DOT(a.m, b.m, 0, 0); r.m[0][1] = TRANSFORM_TYPES_DOT(a.m, b.m, 0, 1); r.m[0][2] = TRANSFORM_TYPES_DOT(a.m, b.m, 0, 2);
+    r.m[1][0] = TRANSFORM_TYPES_DOT(a.m, b.m, 1, 0); r.m[1][1] = TRANSFORM_TYPES_DOT(a.m, b.m, 1, 1); r.m[1][2] = TRANSFORM_TYPES_DOT(a.m, b.m, 1, 2);
+    r.m[2][0] = TRANSFORM_TYPES_DOT(a.m, b.m, 2, 0); r.m[2][1] = TRANSFORM_TYPES_DOT(a.m, b.m, 2, 1); r.m[2][2] = TRANSFORM_TYPES_DOT(a.m, b.m, 2, 2);
+    return r;
+}
+
+// 36 multiplicações e 27 somas: A*B = [Ra*Rb, Ra*tb + ta]
+constexpr Affine operator*(const Affine& a, const Affine& b)
+{
+    return Affine(
+        TRANSFORM_TYPES_DOT(a.m, b.m, 0, 0), TRANSFORM_TYPES_DOT(a.m, b.m, 0, 1), TRANSFORM_TYPES_DOT(a.m, b.m, 0, 2),
+        TRANSFORM_TYPES_DOT(a.m, b.m, 1, 0), TRANSFORM_TYPES_DOT(a.m, b.m, 1, 1), TRANSFORM_TYPES_DOT(a.m, b.m, 1, 2),
+        TRANSFORM_TYPES_DOT(a.m, b.m, 2, 0), TRANSFORM_TYPES_DOT(a.m, b.m, 2, 1), TRANSFORM_TYPES_DOT(a.m, b.m, 2, 2),
+        a.m[0][0] * b.t[0] + a.m[1][0] * b.t[1] + a.m[2][0] * b.t[2] + a.t[0],
+        a.m[0][1] * b.t[0] + a.m[1][1] * b.t[1] + a.m[2][1] * b.t[2] + a.t[1],
+        a.m[0][2] * b.t[0] + a.m[1][2] * b.t[1] + a.m[2][2] * b.t[2] + a.t[2]
+    );
+}
+
+#undef TRANSFORM_TYPES_DOT
+
+// Nenhuma operação: T * R = [R, t]
+constexpr Affine operator*(const Translation& t, const Rotation& r)
+{
+    return Affine(r, t.x, t.y, t.z);
+}
+
+// Nenhuma operação: T * S = [S, t]
+constexpr Affine operator*(const Translation& t, const Scale& s)
+{
+    return Affine(s.x, 0.0f, 0.0f, 0.0f, s.y, 0.0f, 0.0f, 0.0f, s.z, t.x, t.y, t.z);
+}
+
+// 9 multiplicações: cada coluna de R é escalada.
+constexpr Affine operator*(const Rotation& r, const Scale& s)
+{
+    return Affine(
+        r.m[0][0] * s.x, r.m[0][1] * s.x, r.m[0][2] * s.x,
+        r.m[1][0] * s.y, r.m[1][1] * s.y, r.m[1][2] * s.y,
+        r.m[2][0] * s.z, r.m[2][1] * s.z, r.m[2][2] * s.z,
+        0.0f, 0.0f, 0.0f
+    );
+}
+
+// 9 multiplicações: cada linha de R é escalada.
+constexpr Affine operator*(const Scale& s, const Rotation& r)
+{
+    return Affine(
+        r.m[0][0] * s.x, r.m[0][1] * s.y, r.m[0][2] * s.z,
+        r.m[1][0] * s.x, r.m[1][1] * s.y, r.m[1][2] * s.z,
+        r.m[2][0] * s.x, r.m[2][1] * s.y, r.m[2][2] * s.z,
+        0.0f, 0.0f, 0.0f
+    );
+}
+
+// 9 multiplicações e 6 somas: t' = R*t
+constexpr Affine operator*(const Rotation& r, const Translation& t)
+{
+    return Affine(r,
+        r.m[0][0] * t.x + r.m[1][0] * t.y + r.m[2][0] * t.z,
+        r.m[0][1] * t.x + r.m[1][1] * t.y + r.m[2][1] * t.z,
+        r.m[0][2] * t.x + r.m[1][2] * t.y + r.m[2][2] * t.z);
+}
+
+// 3 multiplicações: t' = S*t
+constexpr Affine operator*(const Scale& s, const Translation& t)
+{
+    return Affine(s.x, 0.0f, 0.0f, 0.0f, s.y, 0.0f, 0.0f, 0.0f, s.z, s.x * t.x, s.y * t.y, s.z * t.z);
+}
+
+// 3 somas: só a translação muda.
+constexpr Affine operator*(const Translation& t, const Affine& a)
+{
+    return Affine(
+        a.m[0][0], a.m[0][1], a.m[0][2],
+        a.m[1][0], a.m[1][1], a.m[1][2],
+        a.m[2][0], a.m[2][1], a.m[2][2],
+        a.t[0] + t.x, a.t[1] + t.y, a.t[2] + t.z
+    );
+}
+
+// 9 multiplicações: as colunas de M são escaladas.
+constexpr Affine operator*(const Affine& a, const Scale& s)
+{
+    return Affine(
+        a.m[0][0] * s.x, a.m[0][1] * s.x, a.m[0][2] * s.x,
+        a.m[1][0] * s.y, a.m[1][1] * s.y, a.m[1][2] * s.y,
+        a.m[2][0] * s.z, a.m[2][1] * s.z, a.m[2][2] * s.z,
+        a.t[0], a.t[1], a.t[2]
+    );
+}
+
+// 9 multiplicações e 9 somas: t' = M*t + t_a
+constexpr Affine operator*(const Affine& a, const Translation& t)
+{
+    return Affine(
+        a.m[0][0], a.m[0][1], a.m[0][2],
+        a.m[1][0], a.m[1][1], a.m[1][2],
+        a.m[2][0], a.m[2][1], a.m[2][2],
+        a.m[0][0] * t.x + a.m[1][0] * t.y + a.m[2][0] * t.z + a.t[0],
+        a.m[0][1] * t.x + a.m[1][1] * t.y + a.m[2][1] * t.z + a.t[1],
+        a.m[0][2] * t.x + a.m[1][2] * t.y + a.m[2][2] * t.z + a.t[2]
+    );
+}
+
+// Demais combinações com Rotation/Scale e Affine: caem no caso geral.
+constexpr Affine operator*(const Rotation& r, const Affine& a) { return Affine(r) * a; }
+constexpr Affine operator*(const Scale& s, const Affine& a)    { return Affine(s) * a; }
+constexpr Affine operator*(const Affine& a, const Rotation& r) { return a * Affine(r); }
+
+// Aplica a transformação a um ponto (w = 1) ou vetor (w = 0) sem montar a
+// matriz 4x4: 12 multiplicações e 9 somas.
+constexpr glm::vec4 operator*(const Affine& a, const glm::vec4& p)
+{
+    return glm::vec4(
+        a.m[0][0] * p.x + a.m[1][0] * p.y + a.m[2][0] * p.z + a.t[0] * p.w,
+        a.m[0][1] * p.x + a.m[1][1] * p.y + a.m[2][1] * p.z + a.t[1] * p.w,
+        a.m[0][2] * p.x + a.m[1][2] * p.y + a.m[2][2] * p.z + a.t[2] * p.w,
+        p.w
+    );
+}
+
+#endif // _TRANSFORM_TYPES_H
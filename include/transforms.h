@@ -0,0 +1,97 @@
+#ifndef _TRANSFORMS_H
+#define _TRANSFORMS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Identificador estável de um nó da hierarquia de transformações. O índice
+// interno de um nó pode mudar quando a hierarquia é reordenada, mas o
+// TransformId retornado por TransformHierarchy::Create() nunca muda.
+typedef uint32_t TransformId;
+const TransformId INVALID_TRANSFORM = 0xFFFFFFFFu;
+
+class JobSystem;
+
+// Hierarquia de transformações (grafo de cena) com armazenamento em
+// "structure of arrays" (SoA). Cada nó guarda sua transformação LOCAL como
+// posição, rotação (quaternion) e escala, e a matriz WORLD é calculada como
+//
+//     World(nó) = World(pai) * T * R * S.
+//
+// Os nós são mantidos em pré-ordem de uma busca em profundidade: o pai sempre
+// vem antes dos filhos, e a subárvore de um nó no índice i ocupa exatamente o
+// intervalo [i, i + tamanho_da_subárvore). Assim, Update() recalcula somente
+// as subárvores de nós que foram modificados, e subárvores disjuntas podem
+// ser processadas em paralelo por tarefas diferentes.
+class TransformHierarchy {
+public:
+    TransformHierarchy();
+
+    // Cria um novo nó, filho de "parent" (ou raiz, se INVALID_TRANSFORM).
+    TransformId Create(TransformId parent = INVALID_TRANSFORM);
+    void Reserve(size_t count);
+
+    void SetPosition(TransformId id, const glm::vec3& position);
+    void SetRotation(TransformId id, const glm::quat& rotation);
+    void SetScale(TransformId id, const glm::vec3& scale);
+    void SetLocal(TransformId id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+    const glm::vec3& Position(TransformId id) const;
+    const glm::quat& Rotation(TransformId id) const;
+    const glm::vec3& Scale(TransformId id) const;
+    TransformId      Parent(TransformId id) const;
+
+    // Matriz world calculada no último Update().
+    const glm::mat4& World(TransformId id) const;
+
+    // Recalcula as matrizes world das subárvores modificadas desde o último
+    // Update(), dividindo o trabalho em tarefas de "jobs" (ou na thread
+    // atual, se NULL).
+    void Update(JobSystem* jobs = NULL);
+    // Recalcula todas as matrizes world (referência para comparação).
+    void UpdateAll();
+
+    size_t Size() const { return m_parents.size(); }
+    bool   IsDirty() const { return m_needs_sort || !m_dirty_list.empty(); }
+    // Número de nós recalculados no último Update().
+    size_t LastUpdatedCount() const { return m_last_updated; }
+
+private:
+    typedef std::pair<uint32_t, uint32_t> Range; // [begin, end)
+
+    void MarkDirty(uint32_t index);
+    void Sort();
+    void UpdateRange(uint32_t begin, uint32_t end);
+    void UpdateNode(uint32_t index);
+
+    // Transformação local, em SoA.
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::quat> m_rotations;
+    std::vector<glm::vec3> m_scales;
+
+    // Topologia: índice do pai e tamanho da subárvore de cada nó.
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_subtree_sizes;
+
+    std::vector<glm::mat4> m_world;
+
+    // Nós modificados desde o último Update().
+    std::vector<uint8_t>  m_dirty;
+    std::vector<uint32_t> m_dirty_list;
+    std::vector<Range>    m_ranges;
+
+    // Mapeamento entre identificadores estáveis e índices internos.
+    std::vector<uint32_t>    m_index_of;
+    std::vector<TransformId> m_id_of;
+
+    bool   m_needs_sort;
+    size_t m_last_updated;
+};
+
+#endif // _TRANSFORMS_H
@@ -0,0 +1,114 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_UI_LAYER_HEADER
+#define CLASS_UI_LAYER_HEADER
+
+#include <cstdint>
+
+#include "gpu_resources.h"
+#include "render_counters.h"
+#include "render_target.h"
+#include "timestep.h"
+
+// Camada da interface guardada em uma textura. A janela "Settings" quase
+// nunca muda de um frame para o outro, mas a interface era rasterizada de
+// novo a cada frame por cima da cena. Com a camada, a interface é desenhada
+// (pelo UiRenderer, com cores pré-multiplicadas pelo alfa) em um
+// RenderTarget transparente só quando muda; nos outros frames a textura é
+// composta sobre a cena com um único triângulo que cobre a tela.
+//
+// Quem decide quando redesenhar é UiRefreshPolicy, na thread principal; a
+// decisão vai no FramePacket (veja render_thread.h), e a thread de
+// renderização usa a UiLayer:
+//
+//     if (packet.ui_redraw)
+//     {
+//         layer.Begin(width, height);
+//         ui_renderer.RenderDrawData(ui, counters, true);
+//         layer.End(framebuffer);
+//     }
+//     layer.Composite(counters);
+//
+// Usada apenas pela thread que detém o contexto OpenGL.
+class UiLayer {
+public:
+    UiLayer() : m_gpu(NULL), m_layer_uniform(-1), m_valid(false) {}
+
+    UiLayer(const UiLayer&) = delete;
+    UiLayer& operator=(const UiLayer&) = delete;
+
+    // Carrega os shaders ("../src/shader_ui_composite_*.glsl").
+    void Init(GpuResourceManager& gpu);
+    // Libera os objetos OpenGL. Deve ser chamada antes de gpu.Shutdown().
+    void Shutdown();
+
+    // Liga o framebuffer da camada (criado, ou recriado se o tamanho mudou)
+    // e o limpa com transparente. Muda a cor de limpeza.
+    void Begin(int width, int height);
+    // Volta a desenhar em "framebuffer", com o mesmo viewport.
+    void End(GLuint framebuffer);
+    // Compõe a camada sobre o framebuffer ligado. Não faz nada se ela ainda
+    // não foi desenhada.
+    void Composite(RenderCounters& counters);
+
+    // Descarta o conteúdo (por exemplo, quando a camada deixa de ser usada).
+    void Invalidate() { m_valid = false; }
+
+private:
+    GpuResourceManager* m_gpu;
+    RenderTarget   m_target;
+    GpuProgram     m_program;
+    GpuVertexArray m_vertex_array; // vazio: os vértices vêm de gl_VertexID
+    GLint          m_layer_uniform;
+    bool           m_valid;
+};
+
+// Decide, na thread principal, quando a camada da interface precisa ser
+// redesenhada:
+//
+//   - imediatamente quando a interação muda (item sob o cursor, item ativo,
+//     janela em foco, botões do mouse; veja Interface::Interaction()), e em
+//     todos os frames enquanto um item está ativo (slider sendo arrastado,
+//     campo de texto com o cursor piscando, janela sendo movida);
+//   - quando o tamanho da tela muda ou a camada acabou de ser ligada;
+//   - fora isso, quando os comandos de desenho mudam. Como último recurso,
+//     é calculado um hash dos vértices, índices e comandos de cada frame;
+//     mudanças que só aparecem nele são valores mostrados na tela (como o
+//     FPS), e o redesenho por causa delas é limitado a "live_refresh_hz"
+//     vezes por segundo.
+class UiRefreshPolicy {
+public:
+    UiRefreshPolicy();
+
+    // Retorna se a camada deve ser redesenhada com "draw_data" neste frame.
+    // "interaction" identifica o estado de interação (só importa se mudou).
+    bool Update(const ImDrawData* draw_data, uint64_t interaction, bool interacting,
+                int width, int height, float live_refresh_hz);
+    // Força o redesenho no próximo Update().
+    void Invalidate() { m_valid = false; }
+
+    // Frames em que a camada foi redesenhada, desde o início.
+    uint64_t Redraws() const { return m_redraws; }
+
+private:
+    // Frames redesenhados depois de uma mudança na interação: a ImGui só
+    // mostra o efeito de um clique no frame seguinte.
+    static const int INTERACTION_FRAMES = 2;
+
+    bool     m_valid;
+    int      m_width;
+    int      m_height;
+    uint64_t m_interaction;
+    int      m_forced_frames;
+    uint64_t m_hash; // do último frame redesenhado
+    FrameClock::time_point m_last_redraw;
+    uint64_t m_redraws;
+};
+
+// Hash dos vértices, índices e comandos de "draw_data".
+uint64_t HashDrawData(const ImDrawData* draw_data);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef CLASS_ADD_HEADERS
+#define CLASS_ADD_HEADERS
+#include "headers.h"
+#endif
+
+#ifndef CLASS_UI_RENDERER_HEADER
+#define CLASS_UI_RENDERER_HEADER
+
+#include <cstddef>
+
+#include "gpu_resources.h"
+#include "render_counters.h"
+
+// Renderizador da ImGui mais enxuto que o de imgui_impl_opengl3.cpp, que,
+// por precisar funcionar dentro de qualquer programa, a cada frame consulta
+// (glGet*) e restaura umas 25 variáveis de estado do OpenGL, cria e destrói
+// um VAO e chama glBufferData() duas vezes por lista de comandos,
+// realocando a memória do buffer no driver. Aqui:
+//
+//   - o VAO e os atributos de vértices são criados uma vez, em Init();
+//   - os vértices e os índices de todas as listas são escritos com um
+//     único glMapBufferRange() por frame, em um buffer que só é realocado
+//     quando a interface cresce (os vértices no início, os índices depois);
+//   - cada comando é desenhado com glDrawElementsBaseVertex(), com os
+//     deslocamentos da sua lista dentro do buffer;
+//   - o estado do OpenGL não é consultado: o renderizador supõe o estado
+//     deixado pelo resto do programa (teste de profundidade ligado, mistura
+//     e scissor desligados, unidade de textura 0 ativa) e o devolve assim.
+//     Trocas de textura e de scissor iguais à anterior são omitidas, e a
+//     matriz de projeção só é enviada quando o tamanho da tela muda.
+//
+// A textura do atlas de fontes continua sendo criada pelo renderizador da
+// ImGui (veja Interface::InitRenderer()); os dois podem ser alternados
+// durante a execução (g_LeanUiRenderer).
+//
+// Todos os métodos fazem chamadas OpenGL e são usados pela thread que detém
+// o contexto (veja render_thread.h).
+class UiRenderer {
+public:
+    UiRenderer();
+
+    UiRenderer(const UiRenderer&) = delete;
+    UiRenderer& operator=(const UiRenderer&) = delete;
+
+    // Carrega os shaders ("../src/shader_ui_*.glsl") e cria o VAO e o
+    // buffer.
+    void Init(GpuResourceManager& gpu);
+    // Libera os objetos OpenGL. Deve ser chamada antes de gpu.Shutdown().
+    void Shutdown();
+
+    // Desenha "draw_data" no framebuffer ligado, contando as chamadas em
+    // "counters". Com "premultiplied", o destino é uma camada transparente
+    // (veja ui_layer.h): as cores são gravadas já multiplicadas pelo alfa, e
+    // o alfa acumula a cobertura da interface.
+    void RenderDrawData(const ImDrawData* draw_data, RenderCounters& counters, bool premultiplied = false);
+
+    // Tamanho atual do buffer, em bytes.
+    size_t Capacity() const { return m_capacity; }
+
+private:
+    void SetupRenderState(const ImDrawData* draw_data, RenderCounters& counters);
+    void ForgetState();
+    void Upload(const ImDrawData* draw_data, size_t vertex_bytes, size_t index_bytes, RenderCounters& counters);
+
+    GpuResourceManager* m_gpu;
+    GpuProgram     m_program;
+    GpuVertexArray m_vertex_array;
+    GpuBuffer      m_buffer;   // vértices, seguidos dos índices
+    size_t         m_capacity;
+
+    GLint  m_projection_uniform;
+    ImVec2 m_projection_pos;   // tela da última matriz enviada
+    ImVec2 m_projection_size;
+
+    bool   m_premultiplied;
+    // Estado já aplicado no frame atual, para omitir trocas repetidas.
+    GLuint m_bound_texture;
+    int    m_scissor[4];
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include "allocators.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+FrameAllocator::FrameAllocator(size_t capacity)
+    : m_buffer(static_cast<char*>(::operator new(capacity))), m_capacity(capacity), m_offset(0)
+{
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    Reset();
+    ::operator delete(m_buffer);
+}
+
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+    // Reservamos espaço para o pior alinhamento possível; assim basta um
+    // fetch_add, sem laço de compare_exchange.
+    size_t offset = m_offset.fetch_add(size + alignment - 1, std::memory_order_relaxed);
+    if (offset + size + alignment - 1 <= m_capacity)
+        return reinterpret_cast<void*>(AlignUp(reinterpret_cast<uintptr_t>(m_buffer + offset), alignment));
+
+    // Bloco esgotado: a memória ainda é liberada no próximo Reset().
+    void* memory = ::operator new(size + alignment - 1);
+    {
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        m_overflow.push_back(memory);
+    }
+    return reinterpret_cast<void*>(AlignUp(reinterpret_cast<uintptr_t>(memory), alignment));
+}
+
+void FrameAllocator::Reset()
+{
+    for (void* memory : m_overflow)
+        ::operator delete(memory);
+    m_overflow.clear();
+    m_offset.store(0, std::memory_order_relaxed);
+}
+
+LinearArena::LinearArena(size_t initial_capacity)
+    : m_block(0), m_offset(0), m_used(0), m_high_water(0)
+{
+    Block block = { static_cast<char*>(::operator new(initial_capacity)), initial_capacity };
+    m_blocks.push_back(block);
+}
+
+LinearArena::~LinearArena()
+{
+    for (const Block& block : m_blocks)
+        ::operator delete(block.data);
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+    while (true)
+    {
+        const Block& block = m_blocks[m_block];
+        uintptr_t start = reinterpret_cast<uintptr_t>(block.data) + m_offset;
+        uintptr_t aligned = AlignUp(start, alignment);
+        size_t end = m_offset + (aligned - start) + size;
+        if (end <= block.size)
+        {
+            m_used += end - m_offset;
+            m_offset = end;
+            if (m_used > m_high_water)
+                m_high_water = m_used;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        // O que sobrou no bloco atual é desperdiçado até o próximo Reset().
+        m_used += block.size - m_offset;
+        m_offset = 0;
+        if (++m_block == m_blocks.size())
+        {
+            size_t new_size = std::max(block.size * 2, size + alignment);
+            Block new_block = { static_cast<char*>(::operator new(new_size)), new_size };
+            m_blocks.push_back(new_block);
+        }
+    }
+}
+
+LinearArena::Marker LinearArena::Mark() const
+{
+    Marker marker = { m_block, m_offset, m_used };
+    return marker;
+}
+
+void LinearArena::Rewind(const Marker& marker)
+{
+    m_block = marker.block;
+    m_offset = marker.offset;
+    m_used = marker.used;
+}
+
+void LinearArena::Reset()
+{
+    if (m_blocks.size() > 1)
+    {
+        // Trocamos os blocos por um só, grande o bastante para o maior uso
+        // visto até agora.
+        size_t total = 0;
+        for (const Block& block : m_blocks)
+        {
+            total += block.size;
+            ::operator delete(block.data);
+        }
+        m_blocks.clear();
+        Block block = { static_cast<char*>(::operator new(total)), total };
+        m_blocks.push_back(block);
+    }
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+size_t LinearArena::Capacity() const
+{
+    size_t total = 0;
+    for (const Block& block : m_blocks)
+        total += block.size;
+    return total;
+}
+
+LinearArena& ScratchArena()
+{
+    static thread_local LinearArena arena;
+    return arena;
+}
+
+// Substituição dos operadores globais new e delete, somente para contar as
+// alocações. A memória continua vindo de malloc()/free().
+static std::atomic<uint64_t> s_heap_allocations(0);
+static std::atomic<uint64_t> s_heap_deallocations(0);
+static std::atomic<uint64_t> s_heap_bytes(0);
+
+HeapStats GetHeapStats()
+{
+    HeapStats stats;
+    stats.allocations     = s_heap_allocations.load(std::memory_order_relaxed);
+    stats.deallocations   = s_heap_deallocations.load(std::memory_order_relaxed);
+    stats.bytes_allocated = s_heap_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+static void* CountedAlloc(size_t size)
+{
+    s_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    s_heap_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* CountedAlignedAlloc(size_t size, size_t alignment)
+{
+    s_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    s_heap_bytes.fetch_add(size, std::memory_order_relaxed);
+#if defined(_WIN32)
+    return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+    // aligned_alloc() exige um tamanho múltiplo do alinhamento.
+    return std::aligned_alloc(alignment, AlignUp(size == 0 ? 1 : size, alignment));
+#endif
+}
+
+static void CountedFree(void* pointer)
+{
+    if (pointer == NULL)
+        return;
+    s_heap_deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(pointer);
+}
+
+static void CountedAlignedFree(void* pointer)
+{
+    if (pointer == NULL)
+        return;
+    s_heap_deallocations.fetch_add(1, std::memory_order_relaxed);
+#if defined(_WIN32)
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+void* operator new(size_t size)
+{
+    void* pointer = CountedAlloc(size);
+    if (pointer == NULL)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    void* pointer = CountedAlignedAlloc(size, (size_t)alignment);
+    if (pointer == NULL)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAlignedAlloc(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAlignedAlloc(size, (size_t)alignment);
+}
+
+void operator delete(void* pointer) noexcept                                     { CountedFree(pointer); }
+void operator delete[](void* pointer) noexcept                                   { CountedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept                             { CountedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept                           { CountedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept              { CountedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept            { CountedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept                   { CountedAlignedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept                 { CountedAlignedFree(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept           { CountedAlignedFree(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept         { CountedAlignedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept   { CountedAlignedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { CountedAlignedFree(pointer); }
@@ -1,16 +1,17 @@
 #include "callbacks.h"
+#include "idle_mode.h"
 
 // definição da função que será chamada sempre que a janela do sistema
 // operacional for redimensionada, por consequência alterando o tamanho do
 // "framebuffer" (região de memória onde são armazenados os pixels da imagem).
 void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    // Indicamos que queremos renderizar em toda região do framebuffer. A
-    // função "glViewport" define o mapeamento das "normalized device
-    // coordinates" (NDC) para "pixel coordinates".  Essa é a operação de
-    // "Screen Mapping" ou "Viewport Mapping" vista em aula (slides 32 até 40
-    // do documento "Aula_07_Transformacoes_Geometricas_3D.pdf").
-    glViewport(0, 0, width, height);
+    // A função "glViewport", que define o mapeamento das "normalized device
+    // coordinates" (NDC) para "pixel coordinates" (a operação de "Screen
+    // Mapping" ou "Viewport Mapping" vista em aula, slides 32 até 40 do
+    // documento "Aula_07_Transformacoes_Geometricas_3D.pdf"), é chamada pela
+    // thread de renderização a cada frame, já que o contexto OpenGL pertence
+    // a ela. Veja RenderThread::Draw().
 
     // Atualizamos também a razão que define a proporção da janela (largura /
     // altura), a qual será utilizada na definição das matrizes de projeção,
@@ -21,22 +22,90 @@ void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
     // O cast para float é necessário pois números inteiros são arredondados ao
     // serem divididos!
     g_ScreenRatio = (float)width / height;
+    IdleMode::RequestRedraw();
 }
 
+// Chamada quando o conteúdo da janela precisa ser redesenhado (por exemplo,
+// quando ela deixa de estar coberta por outra). Sem ela, no modo ocioso (veja
+// idle_mode.h) a janela ficaria sem imagem até o próximo evento de entrada.
+void WindowRefreshCallback(GLFWwindow* window)
+{
+    IdleMode::RequestRedraw();
+}
+
+// Os callbacks de entrada abaixo apenas registram o evento, com o instante
+// em que ocorreu, na fila g_InputQueue (veja input_events.h). Os eventos são
+// processados pela simulação, em ordem, através de ProcessInputEvent().
+// Cada evento também tira o loop principal do modo ocioso.
+
 // função callback chamada sempre que o usuário aperta algum dos botões do mouse
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
-    if(Globals::g_Io->WantCaptureMouse)
+    InputEvent event = {};
+    event.time_ns = InputTimestamp(FrameClock::now());
+    event.type = INPUT_MOUSE_BUTTON;
+    event.ui_capture = Globals::g_Io->WantCaptureMouse;
+    event.code = button;
+    event.action = (int16_t)action;
+    event.mods = mods;
+    g_InputQueue.Push(event);
+    IdleMode::RequestRedraw();
+}
+
+// função callback chamada sempre que o usuário movimentar o cursor do mouse em
+// cima da janela OpenGL.
+void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
+{
+    InputEvent event = {};
+    event.time_ns = InputTimestamp(FrameClock::now());
+    event.type = INPUT_CURSOR_POS;
+    event.x = xpos;
+    event.y = ypos;
+    g_InputQueue.Push(event);
+    IdleMode::RequestRedraw();
+}
+
+// função callback chamada sempre que o usuário movimenta a "rodinha" do mouse.
+void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    InputEvent event = {};
+    event.time_ns = InputTimestamp(FrameClock::now());
+    event.type = INPUT_SCROLL;
+    event.x = xoffset;
+    event.y = yoffset;
+    g_InputQueue.Push(event);
+    IdleMode::RequestRedraw();
+}
+
+// definição da função que será chamada sempre que o usuário pressionar alguma
+// tecla do teclado. Veja http://www.glfw.org/docs/latest/input_guide.html#input_key
+void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
+{
+    InputEvent event = {};
+    event.time_ns = InputTimestamp(FrameClock::now());
+    event.type = INPUT_KEY;
+    event.code = key;
+    event.action = (int16_t)action;
+    event.mods = mod;
+    g_InputQueue.Push(event);
+    IdleMode::RequestRedraw();
+}
+
+// Processamento de um clique do mouse.
+static void ProcessMouseButton(const InputEvent& event)
+{
+    if (event.ui_capture)
       return;
 
+    int button = event.code;
+    int action = event.action;
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
     {
-        // Se o usuário pressionou o botão esquerdo do mouse, guardamos a
-        // posição atual do cursor nas variáveis Globals::g_LastCursorPosX e
-        // g_LastCursorPosY.  Também, setamos a variável
-        // g_LeftMouseButtonPressed como true, para saber que o usuário está
-        // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &Globals::g_LastCursorPosX, &Globals::g_LastCursorPosY);
+        // Se o usuário pressionou o botão esquerdo do mouse, setamos a
+        // variável g_LeftMouseButtonPressed como true, para saber que o
+        // usuário está com o botão esquerdo pressionado. A posição atual do
+        // cursor já está em Globals::g_LastCursorPosX e g_LastCursorPosY,
+        // atualizadas a cada movimento do mouse em ProcessCursorPos().
         g_LeftMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
@@ -47,36 +116,37 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
     }
 }
 
-// função callback chamada sempre que o usuário movimentar o cursor do mouse em
-// cima da janela OpenGL.
-void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
+// Processamento de um movimento do cursor.
+static void ProcessCursorPos(const InputEvent& event)
 {
     // Abaixo executamos o seguinte: caso o botão esquerdo do mouse esteja
     // pressionado, computamos quanto que o mouse se movimento desde o último
     // instante de tempo, e usamos esta movimentação para atualizar os
     // parâmetros que definem a posição da câmera dentro da cena virtual.
     // Assim, temos que o usuário consegue controlar a câmera.
+    double xpos = event.x;
+    double ypos = event.y;
 
-    if (!g_LeftMouseButtonPressed)
-        return;
-
-    // Deslocamento do cursor do mouse em x e y de coordenadas de tela!
-    float dx = float(xpos - Globals::g_LastCursorPosX);
-    float dy = float(ypos - Globals::g_LastCursorPosY);
+    if (g_LeftMouseButtonPressed)
+    {
+        // Deslocamento do cursor do mouse em x e y de coordenadas de tela!
+        float dx = float(xpos - Globals::g_LastCursorPosX);
+        float dy = float(ypos - Globals::g_LastCursorPosY);
 
-    // Atualizamos parâmetros da câmera com os deslocamentos
-    g_CameraTheta -= 0.01f*dx;
-    g_CameraPhi   += 0.01f*dy;
+        // Atualizamos parâmetros da câmera com os deslocamentos
+        g_CameraTheta -= 0.01f*dx;
+        g_CameraPhi   += 0.01f*dy;
 
-    // Em coordenadas esféricas, o ângulo phi deve ficar entre -pi/2 e +pi/2.
-    float phimax = 3.141592f/2;
-    float phimin = -phimax;
+        // Em coordenadas esféricas, o ângulo phi deve ficar entre -pi/2 e +pi/2.
+        float phimax = 3.141592f/2;
+        float phimin = -phimax;
 
-    if (g_CameraPhi > phimax)
-        g_CameraPhi = phimax;
+        if (g_CameraPhi > phimax)
+            g_CameraPhi = phimax;
 
-    if (g_CameraPhi < phimin)
-        g_CameraPhi = phimin;
+        if (g_CameraPhi < phimin)
+            g_CameraPhi = phimin;
+    }
 
     // Atualizamos as variáveis globais para armazenar a posição atual do
     // cursor como sendo a última posição conhecida do cursor.
@@ -84,21 +154,24 @@ void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
     Globals::g_LastCursorPosY = ypos;
 }
 
-// função callback chamada sempre que o usuário movimenta a "rodinha" do mouse.
-void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
+// Processamento de um movimento da "rodinha" do mouse.
+static void ProcessScroll(const InputEvent& event)
 {
     // Atualizamos a distância da câmera para a origem utilizando a
     // movimentação da "rodinha", simulando um ZOOM.
-    g_CameraDistance -= 0.1f*float(yoffset);
+    g_CameraDistance -= 0.1f*float(event.y);
 
     if (g_CameraDistance < 0.0f)
         g_CameraDistance = 0.0f;
 }
 
-// definição da função que será chamada sempre que o usuário pressionar alguma
-// tecla do teclado. Veja http://www.glfw.org/docs/latest/input_guide.html#input_key
-void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
+// Processamento de uma tecla pressionada ou solta.
+static void ProcessKey(GLFWwindow* window, const InputEvent& event)
 {
+    int key = event.code;
+    int action = event.action;
+    int mod = event.mods;
+
     // Se o usuário pressionar a tecla ESC, fechamos a janela.
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
@@ -185,6 +258,17 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
     }
 }
 
+void ProcessInputEvent(GLFWwindow* window, const InputEvent& event)
+{
+    switch (event.type)
+    {
+    case INPUT_KEY:          ProcessKey(window, event); break;
+    case INPUT_MOUSE_BUTTON: ProcessMouseButton(event); break;
+    case INPUT_CURSOR_POS:   ProcessCursorPos(event); break;
+    case INPUT_SCROLL:       ProcessScroll(event); break;
+    }
+}
+
 // Definimos o callback para impressão de erros da GLFW no terminal
 void ErrorCallback(int error, const char* description)
 {
@@ -0,0 +1,72 @@
+#include "dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution()
+    : m_target_ms(16.6f), m_min_scale(0.5f), m_max_scale(1.0f), m_integral(0.0f), m_scale(1.0f), m_filtered_ms(0.0f),
+      m_last_frame(0), m_history_next(0), m_history_size(0)
+{
+}
+
+void DynamicResolution::SetTarget(float target_ms, float min_scale, float max_scale)
+{
+    m_target_ms = std::max(target_ms, 0.1f);
+    m_max_scale = std::min(std::max(max_scale, 0.01f), 1.0f);
+    m_min_scale = std::min(std::max(min_scale, 0.01f), m_max_scale);
+    m_integral = std::min(std::max(m_integral, std::log(m_min_scale)), std::log(m_max_scale));
+    m_scale = std::min(std::max(m_scale, m_min_scale), m_max_scale);
+}
+
+void DynamicResolution::Reset()
+{
+    m_integral = std::log(m_max_scale);
+    m_scale = m_max_scale;
+    m_filtered_ms = 0.0f;
+    m_history_size = 0;
+    m_history_next = 0;
+}
+
+float DynamicResolution::Update(uint64_t frame, float gpu_ms)
+{
+    // Sem medida nova (ou sem consultas de tempo no driver), nada muda.
+    if (frame <= m_last_frame || gpu_ms <= 0.0f)
+        return m_scale;
+    m_last_frame = frame;
+
+    // Média móvel exponencial dos tempos; a primeira medida a inicia.
+    if (m_filtered_ms <= 0.0f)
+        m_filtered_ms = gpu_ms;
+    else
+        m_filtered_ms += FILTER * (gpu_ms - m_filtered_ms);
+
+    float error = 0.0f;
+    if (std::fabs(m_filtered_ms - m_target_ms) > HYSTERESIS * m_target_ms)
+        error = 0.5f * std::log(m_target_ms / m_filtered_ms);
+    const float log_min = std::log(m_min_scale);
+    const float log_max = std::log(m_max_scale);
+    m_integral = std::min(std::max(m_integral + KI * error, log_min), log_max);
+    float log_scale = m_integral + KP * error;
+
+    // Nos limites, a escala chega até eles mesmo que o passo seja pequeno.
+    if (log_scale <= log_min)
+        m_scale = m_min_scale;
+    else if (log_scale >= log_max)
+        m_scale = m_max_scale;
+    else if (std::fabs(std::exp(log_scale) - m_scale) >= MIN_STEP)
+        m_scale = std::exp(log_scale);
+
+    m_history[m_history_next] = m_scale;
+    m_history_next = (m_history_next + 1) % HISTORY;
+    m_history_size = std::min(m_history_size + 1, HISTORY);
+    return m_scale;
+}
+
+int DynamicResolution::History(float* out, int max_values) const
+{
+    int count = std::min(m_history_size, max_values);
+    int first = (m_history_next + HISTORY - count) % HISTORY;
+    for (int i = 0; i < count; ++i)
+        out[i] = m_history[(first + i) % HISTORY];
+    return count;
+}
@@ -0,0 +1,382 @@
+#include "font_cache.h"
+#include "imgui_internal.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Muda quando o formato do arquivo muda.
+static const uint32_t FONT_CACHE_VERSION = 1;
+static const char FONT_CACHE_MAGIC[8] = { 'T', 'C', 'C', 'F', 'O', 'N', 'T', '\0' };
+
+// O arquivo é: CacheHeader, um CacheFont por fonte, um CacheRect por
+// retângulo do atlas, os glyphs de cada fonte (ImFontGlyph, na ordem das
+// fontes) e os pixels (TexWidth * TexHeight bytes). Os números estão na
+// ordem de bytes da máquina; a chave inclui os tamanhos das estruturas da
+// ImGui, e um arquivo de outra arquitetura é simplesmente ignorado.
+struct CacheHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order; // 0x01020304
+    uint64_t key;
+    uint64_t file_size;
+    int32_t  tex_width;
+    int32_t  tex_height;
+    float    white_pixel_u;
+    float    white_pixel_v;
+    uint32_t font_count;
+    uint32_t rect_count;
+};
+
+struct CacheFont
+{
+    float    font_size;
+    float    ascent;
+    float    descent;
+    int32_t  metrics_total_surface;
+    uint32_t glyph_count;
+    uint16_t fallback_char;
+    uint16_t ellipsis_char;
+};
+
+struct CacheRect
+{
+    uint16_t x;
+    uint16_t y;
+};
+
+// FNV-1a, oito bytes por vez, com os bytes finais um a um.
+static uint64_t Hash(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+template <typename T>
+static uint64_t HashValue(uint64_t hash, const T& value)
+{
+    return Hash(hash, &value, sizeof(value));
+}
+
+static int FontIndex(const ImFontAtlas* atlas, const ImFont* font)
+{
+    for (int i = 0; i < atlas->Fonts.Size; ++i)
+        if (atlas->Fonts[i] == font)
+            return i;
+    return -1;
+}
+
+uint64_t FontAtlasKey(const ImFontAtlas* atlas)
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashValue(hash, FONT_CACHE_VERSION);
+    hash = HashValue(hash, (int)IMGUI_VERSION_NUM);
+    hash = HashValue(hash, sizeof(ImFontGlyph));
+    hash = HashValue(hash, sizeof(ImWchar));
+    hash = HashValue(hash, atlas->Flags);
+    hash = HashValue(hash, atlas->TexDesiredWidth);
+    hash = HashValue(hash, atlas->TexGlyphPadding);
+    hash = HashValue(hash, atlas->Fonts.Size);
+    for (int i = 0; i < atlas->ConfigData.Size; ++i)
+    {
+        // Tudo o que ImFontAtlas::Build() usa de cada entrada, menos o nome.
+        const ImFontConfig& cfg = atlas->ConfigData[i];
+        hash = Hash(hash, cfg.FontData, (size_t)cfg.FontDataSize);
+        hash = HashValue(hash, cfg.FontDataSize);
+        hash = HashValue(hash, cfg.FontNo);
+        hash = HashValue(hash, cfg.SizePixels);
+        hash = HashValue(hash, cfg.OversampleH);
+        hash = HashValue(hash, cfg.OversampleV);
+        hash = HashValue(hash, cfg.PixelSnapH);
+        hash = HashValue(hash, cfg.GlyphExtraSpacing.x);
+        hash = HashValue(hash, cfg.GlyphExtraSpacing.y);
+        hash = HashValue(hash, cfg.GlyphOffset.x);
+        hash = HashValue(hash, cfg.GlyphOffset.y);
+        hash = HashValue(hash, cfg.GlyphMinAdvanceX);
+        hash = HashValue(hash, cfg.GlyphMaxAdvanceX);
+        hash = HashValue(hash, cfg.MergeMode);
+        hash = HashValue(hash, cfg.RasterizerFlags);
+        hash = HashValue(hash, cfg.RasterizerMultiply);
+        hash = HashValue(hash, cfg.EllipsisChar);
+        hash = HashValue(hash, FontIndex(atlas, cfg.DstFont));
+        const ImWchar* ranges = cfg.GlyphRanges != NULL ? cfg.GlyphRanges : const_cast<ImFontAtlas*>(atlas)->GetGlyphRangesDefault();
+        for (; ranges[0] != 0; ranges += 2)
+        {
+            hash = HashValue(hash, ranges[0]);
+            hash = HashValue(hash, ranges[1]);
+        }
+    }
+    // Retângulos do usuário. O dos cursores do mouse é criado por Build(),
+    // e depende apenas de atlas->Flags.
+    for (int i = 0; i < atlas->CustomRects.Size; ++i)
+    {
+        if (i == atlas->CustomRectIds[0])
+            continue;
+        const ImFontAtlasCustomRect& r = atlas->CustomRects[i];
+        hash = HashValue(hash, r.ID);
+        hash = HashValue(hash, r.Width);
+        hash = HashValue(hash, r.Height);
+        hash = HashValue(hash, r.GlyphAdvanceX);
+        hash = HashValue(hash, r.GlyphOffset.x);
+        hash = HashValue(hash, r.GlyphOffset.y);
+        hash = HashValue(hash, FontIndex(atlas, r.Font));
+    }
+    return hash;
+}
+
+// Arquivo inteiro mapeado na memória, apenas para leitura.
+class MappedFile {
+public:
+    MappedFile() : m_data(NULL), m_size(0) {}
+    ~MappedFile() { Close(); }
+
+    bool Open(const char* path)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (mapping == NULL)
+            return false;
+        m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        m_size = m_data != NULL ? (size_t)size.QuadPart : 0;
+#else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = data;
+                m_size = (size_t)st.st_size;
+            }
+        }
+        close(fd);
+#endif
+        return m_data != NULL;
+    }
+
+    void Close()
+    {
+        if (m_data == NULL)
+            return;
+#if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+#else
+        munmap(m_data, m_size);
+#endif
+        m_data = NULL;
+        m_size = 0;
+    }
+
+    const unsigned char* Data() const { return (const unsigned char*)m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    void*  m_data;
+    size_t m_size;
+};
+
+bool LoadFontAtlasCache(ImFontAtlas* atlas, const char* path)
+{
+    if (atlas->Fonts.Size == 0)
+        return false;
+    MappedFile file;
+    if (!file.Open(path) || file.Size() < sizeof(CacheHeader))
+        return false;
+
+    // Confere o arquivo inteiro antes de mexer no atlas.
+    CacheHeader header;
+    memcpy(&header, file.Data(), sizeof(header));
+    if (memcmp(header.magic, FONT_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != FONT_CACHE_VERSION ||
+        header.byte_order != 0x01020304u || header.file_size != file.Size() || header.key != FontAtlasKey(atlas) ||
+        header.font_count != (uint32_t)atlas->Fonts.Size || header.tex_width <= 0 || header.tex_height <= 0)
+        return false;
+    // Os retângulos do atlas construído: os do usuário e o dos cursores.
+    const int user_rects = atlas->CustomRects.Size - (atlas->CustomRectIds[0] >= 0 ? 1 : 0);
+    if (header.rect_count != (uint32_t)user_rects + 1)
+        return false;
+
+    const uint64_t glyphs_offset = sizeof(CacheHeader) + header.font_count * sizeof(CacheFont) + header.rect_count * sizeof(CacheRect);
+    if (glyphs_offset > file.Size())
+        return false;
+    const unsigned char* fonts_data = file.Data() + sizeof(CacheHeader);
+    const unsigned char* rects_data = fonts_data + header.font_count * sizeof(CacheFont);
+    const unsigned char* glyphs_data = file.Data() + glyphs_offset;
+    uint64_t glyph_count = 0;
+    for (uint32_t i = 0; i < header.font_count; ++i)
+    {
+        CacheFont cached;
+        memcpy(&cached, fonts_data + i * sizeof(CacheFont), sizeof(cached));
+        glyph_count += cached.glyph_count;
+    }
+    const uint64_t pixels_offset = glyphs_offset + glyph_count * sizeof(ImFontGlyph);
+    const uint64_t pixel_count = (uint64_t)header.tex_width * (uint64_t)header.tex_height;
+    if (pixels_offset + pixel_count != file.Size())
+        return false;
+    const unsigned char* pixels = file.Data() + pixels_offset;
+
+    ImFontAtlasBuildRegisterDefaultCustomRects(atlas);
+    for (int i = 0; i < atlas->CustomRects.Size; ++i)
+    {
+        CacheRect rect;
+        memcpy(&rect, rects_data + i * sizeof(CacheRect), sizeof(rect));
+        atlas->CustomRects[i].X = rect.x;
+        atlas->CustomRects[i].Y = rect.y;
+    }
+
+    const unsigned char* glyphs = glyphs_data;
+    for (int i = 0; i < atlas->Fonts.Size; ++i)
+    {
+        CacheFont cached;
+        memcpy(&cached, fonts_data + i * sizeof(CacheFont), sizeof(cached));
+        ImFont* font = atlas->Fonts[i];
+        // O que ImFontAtlasBuildSetupFont() e ImFontAtlasBuildFinish()
+        // fariam, com as métricas e os glyphs do cache.
+        font->ClearOutputData();
+        font->ConfigData = NULL;
+        font->ConfigDataCount = 0;
+        for (int c = 0; c < atlas->ConfigData.Size; ++c)
+            if (atlas->ConfigData[c].DstFont == font)
+            {
+                if (font->ConfigData == NULL)
+                    font->ConfigData = &atlas->ConfigData[c];
+                ++font->ConfigDataCount;
+            }
+        font->ContainerAtlas = atlas;
+        font->FontSize = cached.font_size;
+        font->Ascent = cached.ascent;
+        font->Descent = cached.descent;
+        font->MetricsTotalSurface = cached.metrics_total_surface;
+        font->FallbackChar = (ImWchar)cached.fallback_char;
+        font->EllipsisChar = (ImWchar)cached.ellipsis_char;
+        font->Glyphs.resize((int)cached.glyph_count);
+        memcpy(font->Glyphs.Data, glyphs, cached.glyph_count * sizeof(ImFontGlyph));
+        glyphs += cached.glyph_count * sizeof(ImFontGlyph);
+        font->BuildLookupTable();
+    }
+
+    atlas->ClearTexData();
+    atlas->TexWidth = header.tex_width;
+    atlas->TexHeight = header.tex_height;
+    atlas->TexUvScale = ImVec2(1.0f / header.tex_width, 1.0f / header.tex_height);
+    atlas->TexUvWhitePixel = ImVec2(header.white_pixel_u, header.white_pixel_v);
+    atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC((size_t)pixel_count);
+    memcpy(atlas->TexPixelsAlpha8, pixels, (size_t)pixel_count);
+    return true;
+}
+
+bool SaveFontAtlasCache(const ImFontAtlas* atlas, const char* path)
+{
+    if (atlas->TexPixelsAlpha8 == NULL || atlas->Fonts.Size == 0)
+        return false;
+
+    CacheHeader header;
+    memcpy(header.magic, FONT_CACHE_MAGIC, sizeof(header.magic));
+    header.version = FONT_CACHE_VERSION;
+    header.byte_order = 0x01020304u;
+    header.key = FontAtlasKey(atlas);
+    header.tex_width = atlas->TexWidth;
+    header.tex_height = atlas->TexHeight;
+    header.white_pixel_u = atlas->TexUvWhitePixel.x;
+    header.white_pixel_v = atlas->TexUvWhitePixel.y;
+    header.font_count = (uint32_t)atlas->Fonts.Size;
+    header.rect_count = (uint32_t)atlas->CustomRects.Size;
+    uint64_t glyph_count = 0;
+    for (int i = 0; i < atlas->Fonts.Size; ++i)
+        glyph_count += (uint64_t)atlas->Fonts[i]->Glyphs.Size;
+    const size_t pixel_count = (size_t)atlas->TexWidth * (size_t)atlas->TexHeight;
+    header.file_size = sizeof(CacheHeader) + header.font_count * sizeof(CacheFont) + header.rect_count * sizeof(CacheRect) +
+                       glyph_count * sizeof(ImFontGlyph) + pixel_count;
+
+    // Grava em um arquivo temporário e o renomeia no fim: um programa
+    // interrompido no meio não deixa um cache pela metade.
+    std::string temporary = std::string(path) + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == NULL)
+        return false;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; i < atlas->Fonts.Size && ok; ++i)
+    {
+        const ImFont* font = atlas->Fonts[i];
+        CacheFont cached;
+        memset(&cached, 0, sizeof(cached));
+        cached.font_size = font->FontSize;
+        cached.ascent = font->Ascent;
+        cached.descent = font->Descent;
+        cached.metrics_total_surface = font->MetricsTotalSurface;
+        cached.glyph_count = (uint32_t)font->Glyphs.Size;
+        cached.fallback_char = (uint16_t)font->FallbackChar;
+        cached.ellipsis_char = (uint16_t)font->EllipsisChar;
+        ok = fwrite(&cached, sizeof(cached), 1, file) == 1;
+    }
+    for (int i = 0; i < atlas->CustomRects.Size && ok; ++i)
+    {
+        CacheRect rect = { atlas->CustomRects[i].X, atlas->CustomRects[i].Y };
+        ok = fwrite(&rect, sizeof(rect), 1, file) == 1;
+    }
+    for (int i = 0; i < atlas->Fonts.Size && ok; ++i)
+    {
+        const ImVector<ImFontGlyph>& glyphs = atlas->Fonts[i]->Glyphs;
+        ok = glyphs.Size == 0 || fwrite(glyphs.Data, sizeof(ImFontGlyph), (size_t)glyphs.Size, file) == (size_t)glyphs.Size;
+    }
+    ok = ok && fwrite(atlas->TexPixelsAlpha8, 1, pixel_count, file) == pixel_count;
+    ok = fclose(file) == 0 && ok;
+    if (ok)
+    {
+        // No Windows rename() não substitui um arquivo existente.
+        remove(path);
+        ok = rename(temporary.c_str(), path) == 0;
+    }
+    if (!ok)
+        remove(temporary.c_str());
+    return ok;
+}
+
+bool BuildFontAtlas(ImFontAtlas* atlas, const char* path, FontAtlasStats* stats)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    FontAtlasStats result = { false, false, 0.0 };
+    bool ok = true;
+    if (path != NULL && LoadFontAtlasCache(atlas, path))
+        result.cache_hit = true;
+    else
+    {
+        ok = atlas->Build();
+        if (ok && path != NULL)
+            result.cache_written = SaveFontAtlasCache(atlas, path);
+    }
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (stats != NULL)
+        *stats = result;
+    return ok;
+}
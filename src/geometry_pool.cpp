@@ -0,0 +1,426 @@
+#include "geometry_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+RangeAllocator::RangeAllocator(uint32_t capacity)
+    : m_capacity(0), m_used(0)
+{
+    Grow(capacity);
+}
+
+void RangeAllocator::Insert(uint32_t offset, uint32_t size)
+{
+    m_by_offset[offset] = size;
+    m_by_size.insert(std::make_pair(size, offset));
+}
+
+void RangeAllocator::Erase(std::map<uint32_t, uint32_t>::iterator it)
+{
+    std::multimap<uint32_t, uint32_t>::iterator s = m_by_size.lower_bound(it->second);
+    while (s->second != it->first)
+        ++s;
+    m_by_size.erase(s);
+    m_by_offset.erase(it);
+}
+
+bool RangeAllocator::Allocate(uint32_t size, uint32_t* offset)
+{
+    // Menor bloco livre com pelo menos "size" elementos ("best fit").
+    std::multimap<uint32_t, uint32_t>::iterator s = m_by_size.lower_bound(size);
+    if (s == m_by_size.end())
+        return false;
+    *offset = s->second;
+    AllocateAt(s->second, size);
+    return true;
+}
+
+void RangeAllocator::AllocateAt(uint32_t offset, uint32_t size)
+{
+    // Bloco livre que contém "offset".
+    std::map<uint32_t, uint32_t>::iterator it = m_by_offset.upper_bound(offset);
+    assert(it != m_by_offset.begin());
+    --it;
+    uint32_t block = it->first;
+    uint32_t block_size = it->second;
+    assert(offset + size <= block + block_size);
+    Erase(it);
+
+    if (offset > block)
+        Insert(block, offset - block);
+    if (offset + size < block + block_size)
+        Insert(offset + size, block + block_size - (offset + size));
+    m_used += size;
+}
+
+void RangeAllocator::Free(uint32_t offset, uint32_t size)
+{
+    m_used -= size;
+
+    // Juntamos o bloco liberado com os vizinhos livres.
+    std::map<uint32_t, uint32_t>::iterator next = m_by_offset.lower_bound(offset);
+    if (next != m_by_offset.end() && next->first == offset + size)
+    {
+        size += next->second;
+        Erase(next);
+    }
+    std::map<uint32_t, uint32_t>::iterator prev = m_by_offset.lower_bound(offset);
+    if (prev != m_by_offset.begin())
+    {
+        --prev;
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            Erase(prev);
+        }
+    }
+    Insert(offset, size);
+}
+
+void RangeAllocator::Grow(uint32_t new_capacity)
+{
+    if (new_capacity <= m_capacity)
+        return;
+    uint32_t old_capacity = m_capacity;
+    m_capacity = new_capacity;
+    // Free() junta o novo espaço com um bloco livre que termine no fim.
+    m_used += new_capacity - old_capacity;
+    Free(old_capacity, new_capacity - old_capacity);
+}
+
+bool RangeAllocator::FirstHole(uint32_t* offset, uint32_t* size) const
+{
+    if (m_by_offset.empty())
+        return false;
+    std::map<uint32_t, uint32_t>::const_iterator it = m_by_offset.begin();
+    if (it->first + it->second == m_capacity)
+        return false;
+    *offset = it->first;
+    *size = it->second;
+    return true;
+}
+
+uint32_t RangeAllocator::LargestFreeBlock() const
+{
+    return m_by_size.empty() ? 0 : m_by_size.rbegin()->first;
+}
+
+float RangeAllocator::Fragmentation() const
+{
+    uint32_t free = m_capacity - m_used;
+    if (free == 0)
+        return 0.0f;
+    return 1.0f - (float)LargestFreeBlock() / (float)free;
+}
+
+GeometryPool::GeometryPool(GpuResourceManager& gpu, const char* name, const GeometryAttribute* attributes, int num_attributes,
+                           uint32_t vertex_capacity, uint32_t index_capacity)
+    : m_gpu(gpu), m_name(name), m_num_attributes(std::min(num_attributes, GEOMETRY_MAX_ATTRIBUTES)),
+      m_copy_buffer_size(0), m_bytes_moved(0)
+{
+    for (int a = 0; a < m_num_attributes; ++a)
+        m_attributes[a] = attributes[a];
+
+    m_vertex_array = m_gpu.CreateVertexArray(name);
+    GrowVertices(vertex_capacity);
+    GrowIndices(index_capacity);
+    UpdateStats();
+}
+
+const GeometryPool::Allocation* GeometryPool::Find(GeometryRef geometry) const
+{
+    if (geometry.index >= m_allocations.size())
+        return NULL;
+    const Allocation& allocation = m_allocations[geometry.index];
+    return (allocation.alive && allocation.generation == geometry.generation) ? &allocation : NULL;
+}
+
+size_t GeometryPool::VertexSize() const
+{
+    size_t size = 0;
+    for (int a = 0; a < m_num_attributes; ++a)
+        size += m_attributes[a].components * sizeof(GLfloat);
+    return size;
+}
+
+// Cria um buffer novo, maior, e copia para ele o conteúdo do antigo, que é
+// liberado quando o handle é substituído.
+static void GrowBuffer(GpuResourceManager& gpu, GpuBuffer& buffer, const char* name, size_t old_bytes, size_t new_bytes)
+{
+    GpuBuffer grown = gpu.CreateBuffer(name);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown.Id());
+    gpu.BufferData(grown.Id(), GL_COPY_WRITE_BUFFER, new_bytes, NULL, GL_STATIC_DRAW);
+    if (buffer && old_bytes > 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer.Id());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    buffer = std::move(grown);
+}
+
+void GeometryPool::GrowVertices(uint32_t min_capacity)
+{
+    uint32_t old_capacity = m_vertices.Capacity();
+    uint32_t new_capacity = std::max(min_capacity, old_capacity * 2);
+    for (int a = 0; a < m_num_attributes; ++a)
+    {
+        size_t attribute_size = m_attributes[a].components * sizeof(GLfloat);
+        GrowBuffer(m_gpu, m_vertex_buffers[a], m_name.c_str(), old_capacity * attribute_size, new_capacity * attribute_size);
+    }
+    m_vertices.Grow(new_capacity);
+    SetupVertexArray();
+}
+
+void GeometryPool::GrowIndices(uint32_t min_capacity)
+{
+    uint32_t old_capacity = m_indices.Capacity();
+    uint32_t new_capacity = std::max(min_capacity, old_capacity * 2);
+    GrowBuffer(m_gpu, m_index_buffer, m_name.c_str(), old_capacity * sizeof(GLuint), new_capacity * sizeof(GLuint));
+    m_indices.Grow(new_capacity);
+    SetupVertexArray();
+}
+
+void GeometryPool::SetupVertexArray()
+{
+    // O VAO guarda, para cada "location" do vertex shader, qual VBO contém o
+    // atributo e como lê-lo (aqui, "components" floats consecutivos por
+    // vértice). Veja https://www.khronos.org/opengl/wiki/Vertex_Specification#Vertex_Buffer_Object
+    // Como os buffers são trocados quando crescem, o VAO é refeito.
+    glBindVertexArray(m_vertex_array.Id());
+    for (int a = 0; a < m_num_attributes; ++a)
+    {
+        if (!m_vertex_buffers[a])
+            continue;
+        glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffers[a].Id());
+        glVertexAttribPointer(m_attributes[a].location, m_attributes[a].components, GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(m_attributes[a].location);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // O buffer de índices fica ligado ao VAO: não o "desligamos" antes de
+    // desligar o VAO.
+    if (m_index_buffer)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer.Id());
+    glBindVertexArray(0);
+}
+
+GeometryRef GeometryPool::Allocate(uint32_t vertex_count, uint32_t index_count)
+{
+    // Faixas vazias não teriam uma posição própria em m_vertex_owner e
+    // m_index_owner.
+    assert(vertex_count > 0 && index_count > 0);
+
+    uint32_t first_vertex = 0;
+    while (!m_vertices.Allocate(vertex_count, &first_vertex))
+        GrowVertices(m_vertices.Capacity() + vertex_count);
+    uint32_t first_index = 0;
+    while (!m_indices.Allocate(index_count, &first_index))
+        GrowIndices(m_indices.Capacity() + index_count);
+
+    uint32_t index;
+    if (!m_free.empty())
+    {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)m_allocations.size();
+        m_allocations.push_back(Allocation());
+        m_allocations.back().generation = 0;
+    }
+
+    Allocation& allocation = m_allocations[index];
+    allocation.alive = true;
+    allocation.first_vertex = first_vertex;
+    allocation.vertex_count = vertex_count;
+    allocation.first_index = first_index;
+    allocation.index_count = index_count;
+    m_vertex_owner[first_vertex] = index;
+    m_index_owner[first_index] = index;
+    UpdateStats();
+
+    GeometryRef ref = { index, allocation.generation };
+    return ref;
+}
+
+void GeometryPool::Free(GeometryRef geometry)
+{
+    if (Find(geometry) == NULL)
+        return;
+    Allocation& allocation = m_allocations[geometry.index];
+    m_vertices.Free(allocation.first_vertex, allocation.vertex_count);
+    m_indices.Free(allocation.first_index, allocation.index_count);
+    m_vertex_owner.erase(allocation.first_vertex);
+    m_index_owner.erase(allocation.first_index);
+    allocation.alive = false;
+    allocation.generation += 1;
+    m_free.push_back(geometry.index);
+    UpdateStats();
+}
+
+void GeometryPool::WriteVertices(GeometryRef geometry, int attribute, const GLfloat* data)
+{
+    const Allocation* allocation = Find(geometry);
+    if (allocation == NULL || attribute < 0 || attribute >= m_num_attributes)
+        return;
+    size_t attribute_size = m_attributes[attribute].components * sizeof(GLfloat);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffers[attribute].Id());
+    m_gpu.BufferSubData(GL_ARRAY_BUFFER, allocation->first_vertex * attribute_size, allocation->vertex_count * attribute_size, data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryPool::WriteIndices(GeometryRef geometry, const GLuint* data)
+{
+    const Allocation* allocation = Find(geometry);
+    if (allocation == NULL)
+        return;
+    // GL_COPY_WRITE_BUFFER, e não GL_ELEMENT_ARRAY_BUFFER, para não alterar
+    // o buffer de índices do VAO que estiver ligado.
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_index_buffer.Id());
+    m_gpu.BufferSubData(GL_COPY_WRITE_BUFFER, allocation->first_index * sizeof(GLuint), allocation->index_count * sizeof(GLuint), data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+GeometryRange GeometryPool::Range(GeometryRef geometry) const
+{
+    GeometryRange range = { 0, 0, 0, 0 };
+    const Allocation* allocation = Find(geometry);
+    if (allocation != NULL)
+    {
+        range.base_vertex = (GLint)allocation->first_vertex;
+        range.first_index = allocation->first_index;
+        range.vertex_count = (GLsizei)allocation->vertex_count;
+        range.index_count = (GLsizei)allocation->index_count;
+    }
+    return range;
+}
+
+void GeometryPool::CopyRange(GLuint buffer, size_t from, size_t to, size_t bytes)
+{
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    if (to + bytes <= from)
+    {
+        // As faixas não se sobrepõem: copiamos dentro do próprio buffer.
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, to, bytes);
+    }
+    else
+    {
+        // glCopyBufferSubData() não aceita faixas sobrepostas no mesmo
+        // buffer: passamos por um buffer intermediário.
+        if (m_copy_buffer_size < bytes)
+        {
+            m_copy_buffer = m_gpu.CreateBuffer(m_name.c_str());
+            m_copy_buffer_size = bytes;
+            glBindBuffer(GL_COPY_WRITE_BUFFER, m_copy_buffer.Id());
+            m_gpu.BufferData(m_copy_buffer.Id(), GL_COPY_WRITE_BUFFER, bytes, NULL, GL_STREAM_COPY);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_copy_buffer.Id());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, 0, bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, m_copy_buffer.Id());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, to, bytes);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+size_t GeometryPool::MoveVertices(uint32_t hole, uint32_t hole_size)
+{
+    // A malha logo depois do buraco desce para o início dele. Os índices
+    // não mudam: basta o novo base_vertex.
+    std::map<uint32_t, uint32_t>::iterator owner = m_vertex_owner.find(hole + hole_size);
+    assert(owner != m_vertex_owner.end());
+    uint32_t index = owner->second;
+    Allocation& allocation = m_allocations[index];
+
+    size_t bytes = 0;
+    for (int a = 0; a < m_num_attributes; ++a)
+    {
+        size_t attribute_size = m_attributes[a].components * sizeof(GLfloat);
+        CopyRange(m_vertex_buffers[a].Id(), allocation.first_vertex * attribute_size, hole * attribute_size,
+                  allocation.vertex_count * attribute_size);
+        bytes += allocation.vertex_count * attribute_size;
+    }
+
+    m_vertices.Free(allocation.first_vertex, allocation.vertex_count);
+    m_vertices.AllocateAt(hole, allocation.vertex_count);
+    m_vertex_owner.erase(owner);
+    m_vertex_owner[hole] = index;
+    allocation.first_vertex = hole;
+    return bytes;
+}
+
+size_t GeometryPool::MoveIndices(uint32_t hole, uint32_t hole_size)
+{
+    std::map<uint32_t, uint32_t>::iterator owner = m_index_owner.find(hole + hole_size);
+    assert(owner != m_index_owner.end());
+    uint32_t index = owner->second;
+    Allocation& allocation = m_allocations[index];
+
+    size_t bytes = allocation.index_count * sizeof(GLuint);
+    CopyRange(m_index_buffer.Id(), allocation.first_index * sizeof(GLuint), hole * sizeof(GLuint), bytes);
+
+    m_indices.Free(allocation.first_index, allocation.index_count);
+    m_indices.AllocateAt(hole, allocation.index_count);
+    m_index_owner.erase(owner);
+    m_index_owner[hole] = index;
+    allocation.first_index = hole;
+    return bytes;
+}
+
+size_t GeometryPool::Defragment(size_t max_bytes)
+{
+    // A cada passo, o primeiro buraco de cada espaço é fechado movendo a
+    // malha seguinte para o início dele; o buraco se junta ao próximo bloco
+    // livre, até que todo o espaço livre fique contíguo no final. As cópias
+    // são comandos para a GPU, executados em ordem com os desenhos: a CPU
+    // não espera por elas.
+    size_t moved = 0;
+    uint32_t hole, hole_size;
+    while (moved < max_bytes)
+    {
+        size_t step = 0;
+        if (m_vertices.FirstHole(&hole, &hole_size))
+            step += MoveVertices(hole, hole_size);
+        if (m_indices.FirstHole(&hole, &hole_size))
+            step += MoveIndices(hole, hole_size);
+        if (step == 0)
+            break;
+        moved += step;
+    }
+
+    if (moved > 0)
+    {
+        m_bytes_moved += moved;
+        UpdateStats();
+    }
+    return moved;
+}
+
+void GeometryPool::UpdateStats()
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_stats.allocations = (uint32_t)(m_allocations.size() - m_free.size());
+    m_stats.vertex_capacity = m_vertices.Capacity();
+    m_stats.vertices_used = m_vertices.Used();
+    m_stats.vertex_free_blocks = m_vertices.FreeBlocks();
+    m_stats.vertex_fragmentation = m_vertices.Fragmentation();
+    m_stats.index_capacity = m_indices.Capacity();
+    m_stats.indices_used = m_indices.Used();
+    m_stats.index_free_blocks = m_indices.FreeBlocks();
+    m_stats.index_fragmentation = m_indices.Fragmentation();
+    m_stats.bytes_used = m_vertices.Used() * VertexSize() + m_indices.Used() * sizeof(GLuint);
+    m_stats.bytes_capacity = m_vertices.Capacity() * VertexSize() + m_indices.Capacity() * sizeof(GLuint);
+    m_stats.bytes_moved = m_bytes_moved;
+}
+
+GeometryPoolStats GeometryPool::Stats() const
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    return m_stats;
+}
@@ -0,0 +1,407 @@
+#include "glyph_cache.h"
+#include "job_system.h"
+#include "profiler.h"
+#include "imgui_internal.h"
+
+#include <cstring>
+
+// Cópias privadas do imstb_rectpack e do imstb_truetype (as da ImGui são
+// static dentro de imgui_draw.cpp).
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wunused-function" // só uma parte do stb é usada
+#endif
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+// ID do retângulo da área no atlas (>= 0x10000: não é um glyph).
+static const unsigned int GLYPH_AREA_RECT_ID = 0x47430000;
+
+// Estado de cada caractere (um byte por código do plano básico).
+enum GlyphState
+{
+    GLYPH_UNKNOWN = 0, // ainda não pedido
+    GLYPH_STATIC,      // construído com o atlas
+    GLYPH_PENDING,     // em m_pending
+    GLYPH_DYNAMIC,     // acrescentado por Flush()
+    GLYPH_MISSING,     // a fonte não tem
+    GLYPH_DROPPED      // não coube na área; pedido de novo após o próximo despejo
+};
+
+struct GlyphCache::Impl
+{
+    stbtt_fontinfo           info;
+    const ImFontConfig*      config;
+    float                    scale;
+    int                      oversample_h;
+    int                      oversample_v;
+    float                    font_off_y;
+    stbrp_context            packer;
+    std::vector<stbrp_node>  nodes;
+    long long                used_pixels;
+    unsigned char            multiply_table[256];
+};
+
+// Um glyph a rasterizar em Flush().
+struct GlyphWork
+{
+    ImWchar    codepoint;
+    int        glyph;        // índice na fonte TrueType
+    int        x0, y0;       // caixa do bitmap, em pixels sobreamostrados
+    stbrp_rect rect;         // na área, com o preenchimento
+};
+
+GlyphCache::GlyphCache()
+    : m_atlas(NULL), m_font(NULL), m_rect_id(-1), m_area_x(0), m_area_y(0), m_area_width(0), m_area_height(0),
+      m_static_glyphs(0), m_impl(NULL), m_frame(0), m_evictions(0), m_rasterized(0)
+{
+    m_dirty_x0 = m_dirty_y0 = m_dirty_x1 = m_dirty_y1 = 0;
+}
+
+GlyphCache::~GlyphCache()
+{
+    delete m_impl;
+}
+
+void GlyphCache::Attach(ImFontAtlas* atlas, ImFont* font, int width, int height)
+{
+    m_atlas = atlas;
+    m_font = font;
+    m_area_width = width;
+    m_area_height = height;
+    // A ImGui escolhe a largura do atlas só pelos glyphs das fontes (512 no
+    // mínimo); a área precisa caber numa linha.
+    int needed = ImUpperPowerOfTwo(width + atlas->TexGlyphPadding);
+    if (atlas->TexDesiredWidth < needed)
+        atlas->TexDesiredWidth = needed;
+    m_rect_id = atlas->AddCustomRectRegular(GLYPH_AREA_RECT_ID, width, height);
+}
+
+bool GlyphCache::Init()
+{
+    if (m_atlas == NULL || m_font == NULL || m_font->ConfigData == NULL || m_atlas->TexPixelsAlpha8 == NULL)
+        return false;
+    const ImFontAtlasCustomRect* area = m_atlas->GetCustomRectByIndex(m_rect_id);
+    if (area == NULL || !area->IsPacked())
+        return false;
+
+    delete m_impl;
+    m_impl = new Impl();
+    Impl& impl = *m_impl;
+    impl.config = m_font->ConfigData;
+    const unsigned char* data = (const unsigned char*)impl.config->FontData;
+    if (!stbtt_InitFont(&impl.info, data, stbtt_GetFontOffsetForIndex(data, impl.config->FontNo)))
+    {
+        delete m_impl;
+        m_impl = NULL;
+        return false;
+    }
+    // As mesmas escalas e deslocamentos de ImFontAtlasBuildWithStbTruetype(),
+    // para os glyphs novos serem iguais aos construídos com o atlas.
+    impl.scale = stbtt_ScaleForPixelHeight(&impl.info, impl.config->SizePixels);
+    impl.oversample_h = ImClamp(impl.config->OversampleH, 1, STBTT_MAX_OVERSAMPLE);
+    impl.oversample_v = ImClamp(impl.config->OversampleV, 1, STBTT_MAX_OVERSAMPLE);
+    impl.font_off_y = impl.config->GlyphOffset.y + IM_ROUND(m_font->Ascent);
+    ImFontAtlasBuildMultiplyCalcLookupTable(impl.multiply_table, impl.config->RasterizerMultiply);
+
+    m_area_x = area->X;
+    m_area_y = area->Y;
+    impl.nodes.resize((size_t)m_area_width);
+    stbrp_init_target(&impl.packer, m_area_width, m_area_height, impl.nodes.data(), (int)impl.nodes.size());
+    impl.used_pixels = 0;
+
+    // O glyph de tabulação é sempre o último: BuildLookupTable() o recria
+    // depois dos glyphs acrescentados.
+    m_static_glyphs = m_font->Glyphs.Size;
+    if (m_static_glyphs > 0 && m_font->Glyphs.back().Codepoint == '\t')
+        --m_static_glyphs;
+    m_state.assign(0x10000, GLYPH_UNKNOWN);
+    m_last_used.assign(0x10000, 0);
+    m_pending.clear();
+    return true;
+}
+
+void GlyphCache::Request(const ImWchar* chars, int count)
+{
+    if (m_impl == NULL)
+        return;
+    for (int i = 0; i < count; ++i)
+    {
+        ImWchar c = chars[i];
+        if (c < 0x20)
+            continue;
+        uint8_t& state = m_state[c];
+        if (state == GLYPH_UNKNOWN)
+        {
+            if (m_font->FindGlyphNoFallback(c) != NULL)
+                state = GLYPH_STATIC;
+            else
+            {
+                state = GLYPH_PENDING;
+                m_pending.push_back(c);
+            }
+        }
+        m_last_used[c] = m_frame;
+    }
+}
+
+void GlyphCache::Request(const char* text, const char* text_end)
+{
+    if (m_impl == NULL || text == NULL)
+        return;
+    if (text_end == NULL)
+        text_end = text + strlen(text);
+    while (text < text_end)
+    {
+        unsigned int c;
+        int bytes = ImTextCharFromUtf8(&c, text, text_end);
+        if (c == 0)
+            break;
+        text += bytes;
+        ImWchar ch = (ImWchar)c;
+        Request(&ch, 1);
+    }
+}
+
+void GlyphCache::MarkDirty(int x, int y, int width, int height)
+{
+    if (m_dirty_x0 >= m_dirty_x1)
+    {
+        m_dirty_x0 = x;
+        m_dirty_y0 = y;
+        m_dirty_x1 = x + width;
+        m_dirty_y1 = y + height;
+        return;
+    }
+    m_dirty_x0 = ImMin(m_dirty_x0, x);
+    m_dirty_y0 = ImMin(m_dirty_y0, y);
+    m_dirty_x1 = ImMax(m_dirty_x1, x + width);
+    m_dirty_y1 = ImMax(m_dirty_y1, y + height);
+}
+
+void GlyphCache::Evict()
+{
+    // Tira todos os glyphs dinâmicos da fonte e esvazia a área; os usados
+    // recentemente voltam para m_pending.
+    PROFILE_SCOPE("GlyphCache::Evict");
+    m_font->Glyphs.resize(m_static_glyphs);
+    for (int c = 0; c < 0x10000; ++c)
+    {
+        uint8_t& state = m_state[c];
+        if (state == GLYPH_DYNAMIC && m_frame - m_last_used[c] < EVICT_FRAMES)
+        {
+            state = GLYPH_PENDING;
+            m_pending.push_back((ImWchar)c);
+        }
+        else if (state == GLYPH_DYNAMIC || state == GLYPH_DROPPED)
+            state = GLYPH_UNKNOWN;
+    }
+    const int tex_width = m_atlas->TexWidth;
+    for (int y = 0; y < m_area_height; ++y)
+    {
+        memset(m_atlas->TexPixelsAlpha8 + (size_t)(m_area_y + y) * tex_width + m_area_x, 0, (size_t)m_area_width);
+        if (m_atlas->TexPixelsRGBA32 != NULL)
+            for (int x = 0; x < m_area_width; ++x)
+                m_atlas->TexPixelsRGBA32[(size_t)(m_area_y + y) * tex_width + m_area_x + x] = IM_COL32(255, 255, 255, 0);
+    }
+    MarkDirty(m_area_x, m_area_y, m_area_width, m_area_height);
+    stbrp_init_target(&m_impl->packer, m_area_width, m_area_height, m_impl->nodes.data(), (int)m_impl->nodes.size());
+    m_impl->used_pixels = 0;
+    ++m_evictions;
+}
+
+int GlyphCache::Flush(JobSystem* jobs)
+{
+    if (m_impl == NULL || m_pending.empty())
+        return 0;
+    PROFILE_SCOPE("GlyphCache::Flush");
+    Impl& impl = *m_impl;
+    const int padding = m_atlas->TexGlyphPadding;
+    const int oh = impl.oversample_h;
+    const int ov = impl.oversample_v;
+    const float scale_x = impl.scale * oh;
+    const float scale_y = impl.scale * ov;
+
+    // Caixa de cada glyph, como em stbtt_PackFontRangesGatherRects().
+    std::vector<GlyphWork> work;
+    bool evicted = false;
+    while (true)
+    {
+        work.clear();
+        for (int i = 0; i < m_pending.Size; ++i)
+        {
+            GlyphWork w;
+            memset(&w, 0, sizeof(w));
+            w.codepoint = m_pending[i];
+            w.glyph = stbtt_FindGlyphIndex(&impl.info, w.codepoint);
+            if (w.glyph == 0)
+            {
+                m_state[w.codepoint] = GLYPH_MISSING;
+                continue;
+            }
+            int x1, y1;
+            stbtt_GetGlyphBitmapBoxSubpixel(&impl.info, w.glyph, scale_x, scale_y, 0.0f, 0.0f, &w.x0, &w.y0, &x1, &y1);
+            w.rect.id = (int)work.size();
+            w.rect.w = (stbrp_coord)(x1 - w.x0 + padding + oh - 1);
+            w.rect.h = (stbrp_coord)(y1 - w.y0 + padding + ov - 1);
+            work.push_back(w);
+        }
+        m_pending.clear();
+        if (work.empty())
+            return 0;
+
+        std::vector<stbrp_rect> rects(work.size());
+        for (size_t i = 0; i < work.size(); ++i)
+            rects[i] = work[i].rect;
+        stbrp_pack_rects(&impl.packer, rects.data(), (int)rects.size());
+        bool all_packed = true;
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            work[rects[i].id].rect = rects[i];
+            all_packed = all_packed && rects[i].was_packed;
+        }
+        if (all_packed || evicted)
+            break;
+
+        // A área encheu: despeja os glyphs antigos e empacota de novo, junto
+        // com os usados recentemente.
+        for (size_t i = 0; i < work.size(); ++i)
+            m_pending.push_back(work[i].codepoint);
+        Evict();
+        evicted = true;
+    }
+
+    // Rasteriza, como em stbtt_PackFontRangesRenderIntoRects(), direto nos
+    // pixels do atlas. Cada glyph escreve só no seu retângulo.
+    unsigned char* pixels = m_atlas->TexPixelsAlpha8;
+    unsigned int* pixels_rgba = m_atlas->TexPixelsRGBA32;
+    const int stride = m_atlas->TexWidth;
+    const bool multiply = impl.config->RasterizerMultiply != 1.0f;
+    auto rasterize = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const GlyphWork& w = work[i];
+            if (!w.rect.was_packed)
+                continue;
+            int x = m_area_x + w.rect.x + padding;
+            int y = m_area_y + w.rect.y + padding;
+            int width = w.rect.w - padding;
+            int height = w.rect.h - padding;
+            unsigned char* out = pixels + (size_t)y * stride + x;
+            stbtt_MakeGlyphBitmapSubpixel(&impl.info, out, width - oh + 1, height - ov + 1, stride, scale_x, scale_y, 0.0f, 0.0f, w.glyph);
+            if (oh > 1)
+                stbtt__h_prefilter(out, width, height, stride, oh);
+            if (ov > 1)
+                stbtt__v_prefilter(out, width, height, stride, ov);
+            if (multiply)
+                ImFontAtlasBuildMultiplyRectAlpha8(impl.multiply_table, pixels, x, y, width, height, stride);
+            if (pixels_rgba != NULL)
+                for (int row = 0; row < height; ++row)
+                    for (int col = 0; col < width; ++col)
+                    {
+                        size_t index = (size_t)(y + row) * stride + x + col;
+                        pixels_rgba[index] = IM_COL32(255, 255, 255, pixels[index]);
+                    }
+        }
+    };
+    if (jobs != NULL)
+        jobs->ParallelFor((uint32_t)work.size(), 8, rasterize);
+    else
+        rasterize(0, (uint32_t)work.size());
+
+    // Registra os glyphs na fonte, com as coordenadas de stbtt_GetPackedQuad().
+    if (m_font->Glyphs.Size > m_static_glyphs && m_font->Glyphs.back().Codepoint == '\t')
+        m_font->Glyphs.pop_back();
+    const float recip_h = 1.0f / oh;
+    const float recip_v = 1.0f / ov;
+    const float sub_x = stbtt__oversample_shift(oh);
+    const float sub_y = stbtt__oversample_shift(ov);
+    const ImFontConfig& cfg = *impl.config;
+    int added = 0;
+    for (size_t i = 0; i < work.size(); ++i)
+    {
+        const GlyphWork& w = work[i];
+        if (!w.rect.was_packed)
+        {
+            m_state[w.codepoint] = GLYPH_DROPPED;
+            continue;
+        }
+        int x = m_area_x + w.rect.x + padding;
+        int y = m_area_y + w.rect.y + padding;
+        int width = w.rect.w - padding;
+        int height = w.rect.h - padding;
+        float x0 = (float)w.x0 * recip_h + sub_x;
+        float y0 = (float)w.y0 * recip_v + sub_y;
+        float x1 = (w.x0 + width) * recip_h + sub_x;
+        float y1 = (w.y0 + height) * recip_v + sub_y;
+
+        int advance, left_side_bearing;
+        stbtt_GetGlyphHMetrics(&impl.info, w.glyph, &advance, &left_side_bearing);
+        const float advance_org = impl.scale * advance;
+        const float advance_mod = ImClamp(advance_org, cfg.GlyphMinAdvanceX, cfg.GlyphMaxAdvanceX);
+        float off_x = cfg.GlyphOffset.x;
+        if (advance_org != advance_mod)
+            off_x += cfg.PixelSnapH ? ImFloor((advance_mod - advance_org) * 0.5f) : (advance_mod - advance_org) * 0.5f;
+
+        const ImVec2 uv_scale = m_atlas->TexUvScale;
+        m_font->AddGlyph(w.codepoint, x0 + off_x, y0 + impl.font_off_y, x1 + off_x, y1 + impl.font_off_y,
+                         x * uv_scale.x, y * uv_scale.y, (x + width) * uv_scale.x, (y + height) * uv_scale.y, advance_mod);
+        m_state[w.codepoint] = GLYPH_DYNAMIC;
+        MarkDirty(x, y, width, height);
+        impl.used_pixels += (long long)w.rect.w * w.rect.h;
+        ++added;
+    }
+    m_font->BuildLookupTable();
+    m_rasterized += (uint64_t)added;
+    return added;
+}
+
+bool GlyphCache::TakeUpload(GlyphUpload& upload)
+{
+    upload.width = upload.height = 0;
+    if (m_dirty_x0 >= m_dirty_x1)
+        return false;
+    upload.texture = m_atlas->TexID;
+    upload.x = m_dirty_x0;
+    upload.y = m_dirty_y0;
+    upload.width = m_dirty_x1 - m_dirty_x0;
+    upload.height = m_dirty_y1 - m_dirty_y0;
+    upload.pixels.resize((size_t)upload.width * upload.height * 4);
+    const int stride = m_atlas->TexWidth;
+    unsigned char* out = upload.pixels.data();
+    for (int y = 0; y < upload.height; ++y)
+    {
+        size_t row = (size_t)(upload.y + y) * stride + upload.x;
+        if (m_atlas->TexPixelsRGBA32 != NULL)
+            memcpy(out, m_atlas->TexPixelsRGBA32 + row, (size_t)upload.width * 4);
+        else
+            for (int x = 0; x < upload.width; ++x)
+            {
+                ImU32 color = IM_COL32(255, 255, 255, m_atlas->TexPixelsAlpha8[row + x]);
+                memcpy(out + x * 4, &color, 4);
+            }
+        out += (size_t)upload.width * 4;
+    }
+    m_dirty_x0 = m_dirty_x1 = 0;
+    return true;
+}
+
+int GlyphCache::DynamicGlyphs() const
+{
+    if (m_font == NULL || m_impl == NULL)
+        return 0;
+    int count = m_font->Glyphs.Size - m_static_glyphs;
+    if (count > 0 && m_font->Glyphs.back().Codepoint == '\t')
+        --count;
+    return count;
+}
+
+float GlyphCache::AreaUsage() const
+{
+    if (m_impl == NULL || m_area_width * m_area_height == 0)
+        return 0.0f;
+    return (float)m_impl->used_pixels / ((float)m_area_width * m_area_height);
+}
@@ -0,0 +1,398 @@
+#include "gpu_resources.h"
+
+// Bytes por pixel dos formatos internos mais comuns. Formatos RGB de 8 bits
+// são contados como 4 bytes, que é como a maioria dos drivers os armazena.
+static size_t BytesPerPixel(GLint internal_format)
+{
+    switch (internal_format)
+    {
+    case GL_RED:
+    case GL_R8:
+        return 1;
+    case GL_RG:
+    case GL_RG8:
+    case GL_R16F:
+        return 2;
+    case GL_RGBA16F:
+    case GL_RG32F:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+GpuResourceManager::GpuResourceManager(size_t budget_bytes)
+    : m_frame(0), m_shutdown(false), m_counters(NULL), m_budget_bytes(budget_bytes), m_evictions(0), m_reloads(0)
+{
+    for (int t = 0; t < GPU_RESOURCE_TYPES; ++t)
+    {
+        m_bytes[t].store(0, std::memory_order_relaxed);
+        m_count[t].store(0, std::memory_order_relaxed);
+    }
+}
+
+GpuResourceManager::~GpuResourceManager()
+{
+    // Aqui o contexto OpenGL pode já ter sido destruído: não fazemos
+    // chamadas OpenGL, apenas avisamos sobre recursos não liberados.
+    if (!m_shutdown)
+    {
+        uint32_t alive = 0;
+        for (const Entry& entry : m_entries)
+            alive += entry.alive ? 1 : 0;
+        if (alive > 0)
+            fprintf(stderr, "WARNING: %u GPU resources were not released (missing GpuResourceManager::Shutdown()).\n", alive);
+    }
+}
+
+GpuResourceRef GpuResourceManager::Create(const char* name, GpuResourceType type, GLuint gl_name)
+{
+    uint32_t index;
+    if (!m_free.empty())
+    {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)m_entries.size();
+        m_entries.push_back(Entry());
+        m_entries.back().generation = 0;
+    }
+
+    Entry& entry = m_entries[index];
+    entry.name = name;
+    entry.gl_name = gl_name;
+    entry.type = type;
+    entry.alive = true;
+    entry.streamable = false;
+    entry.resident = true;
+    entry.bytes = 0;
+    entry.parent = NO_PARENT;
+    entry.children.clear();
+    entry.loader = NULL;
+    entry.user_data = NULL;
+    entry.last_used = m_frame;
+    m_count[type].fetch_add(1, std::memory_order_relaxed);
+
+    GpuResourceRef ref = { index, entry.generation };
+    return ref;
+}
+
+GpuResourceManager::Entry* GpuResourceManager::Find(GpuResourceRef resource)
+{
+    if (resource.index >= m_entries.size())
+        return NULL;
+    Entry& entry = m_entries[resource.index];
+    return (entry.alive && entry.generation == resource.generation) ? &entry : NULL;
+}
+
+const GpuResourceManager::Entry* GpuResourceManager::Find(GpuResourceRef resource) const
+{
+    if (resource.index >= m_entries.size())
+        return NULL;
+    const Entry& entry = m_entries[resource.index];
+    return (entry.alive && entry.generation == resource.generation) ? &entry : NULL;
+}
+
+void GpuResourceManager::SetBytes(uint32_t index, size_t bytes)
+{
+    Entry& entry = m_entries[index];
+    m_bytes[entry.type].fetch_add(bytes - entry.bytes, std::memory_order_relaxed);
+    entry.bytes = bytes;
+}
+
+void GpuResourceManager::DeleteGlObject(Entry& entry)
+{
+    if (entry.gl_name == 0)
+        return;
+    switch (entry.type)
+    {
+    case GPU_BUFFER:       glDeleteBuffers(1, &entry.gl_name); break;
+    case GPU_TEXTURE:      glDeleteTextures(1, &entry.gl_name); break;
+    case GPU_VERTEX_ARRAY: glDeleteVertexArrays(1, &entry.gl_name); break;
+    case GPU_PROGRAM:      glDeleteProgram(entry.gl_name); break;
+    case GPU_SHADER:       glDeleteShader(entry.gl_name); break;
+    case GPU_FRAMEBUFFER:  glDeleteFramebuffers(1, &entry.gl_name); break;
+    default: break;
+    }
+    entry.gl_name = 0;
+}
+
+void GpuResourceManager::FreeEntry(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    SetBytes(index, 0);
+    m_count[entry.type].fetch_sub(1, std::memory_order_relaxed);
+    entry.alive = false;
+    entry.generation += 1;
+    entry.name.clear();
+    entry.children.clear();
+    m_free.push_back(index);
+}
+
+GpuBuffer GpuResourceManager::CreateBuffer(const char* name)
+{
+    GLuint id = 0;
+    glGenBuffers(1, &id);
+    GpuResourceRef ref = Create(name, GPU_BUFFER, id);
+    m_buffers_by_name[id] = ref.index;
+    return GpuBuffer(this, ref);
+}
+
+GpuTexture GpuResourceManager::CreateTexture(const char* name)
+{
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    GpuResourceRef ref = Create(name, GPU_TEXTURE, id);
+    m_textures_by_name[id] = ref.index;
+    return GpuTexture(this, ref);
+}
+
+GpuVertexArray GpuResourceManager::CreateVertexArray(const char* name)
+{
+    GLuint id = 0;
+    glGenVertexArrays(1, &id);
+    return GpuVertexArray(this, Create(name, GPU_VERTEX_ARRAY, id));
+}
+
+GpuFramebuffer GpuResourceManager::CreateFramebuffer(const char* name)
+{
+    GLuint id = 0;
+    glGenFramebuffers(1, &id);
+    return GpuFramebuffer(this, Create(name, GPU_FRAMEBUFFER, id));
+}
+
+GpuProgram GpuResourceManager::AdoptProgram(const char* name, GLuint program_id)
+{
+    return GpuProgram(this, Create(name, GPU_PROGRAM, program_id));
+}
+
+GpuShader GpuResourceManager::AdoptShader(const char* name, GLuint shader_id)
+{
+    return GpuShader(this, Create(name, GPU_SHADER, shader_id));
+}
+
+GpuVertexArray GpuResourceManager::CreateStreamableMesh(const char* name, GpuResourceLoader loader, void* user_data)
+{
+    GpuResourceRef ref = Create(name, GPU_VERTEX_ARRAY, 0);
+    Entry& entry = m_entries[ref.index];
+    entry.streamable = true;
+    entry.resident = false;
+    entry.loader = loader;
+    entry.user_data = user_data;
+    Load(ref.index);
+    return GpuVertexArray(this, ref);
+}
+
+GpuTexture GpuResourceManager::CreateStreamableTexture(const char* name, GpuResourceLoader loader, void* user_data)
+{
+    GpuResourceRef ref = Create(name, GPU_TEXTURE, 0);
+    Entry& entry = m_entries[ref.index];
+    entry.streamable = true;
+    entry.resident = false;
+    entry.loader = loader;
+    entry.user_data = user_data;
+    Load(ref.index);
+    return GpuTexture(this, ref);
+}
+
+GLuint GpuResourceManager::CreateMeshBuffer(GpuResourceRef mesh)
+{
+    GLuint id = 0;
+    glGenBuffers(1, &id);
+    GpuResourceRef ref = Create("", GPU_BUFFER, id);
+    Entry* owner = Find(mesh);
+    if (owner != NULL)
+    {
+        m_entries[ref.index].name = owner->name;
+        m_entries[ref.index].parent = mesh.index;
+        owner->children.push_back(ref.index);
+    }
+    m_buffers_by_name[id] = ref.index;
+    return id;
+}
+
+void GpuResourceManager::BufferData(GLuint buffer, GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    glBufferData(target, size, data, usage);
+    if (m_counters != NULL && data != NULL)
+        m_counters->Add(COUNTER_BYTES_UPLOADED, (uint64_t)size);
+    std::unordered_map<GLuint, uint32_t>::const_iterator it = m_buffers_by_name.find(buffer);
+    if (it != m_buffers_by_name.end())
+        SetBytes(it->second, (size_t)size);
+}
+
+void GpuResourceManager::TexImage2D(GLuint texture, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+                                    GLenum format, GLenum type, const void* data)
+{
+    glTexImage2D(GL_TEXTURE_2D, level, internal_format, width, height, 0, format, type, data);
+    size_t bytes = (size_t)width * (size_t)height * BytesPerPixel(internal_format);
+    if (m_counters != NULL && data != NULL)
+        m_counters->Add(COUNTER_BYTES_UPLOADED, bytes);
+    std::unordered_map<GLuint, uint32_t>::const_iterator it = m_textures_by_name.find(texture);
+    if (it == m_textures_by_name.end())
+        return;
+    // O nível 0 define o tamanho; os níveis de mipmap somam a ele.
+    SetBytes(it->second, (level == 0) ? bytes : m_entries[it->second].bytes + bytes);
+}
+
+void GpuResourceManager::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    glBufferSubData(target, offset, size, data);
+    if (m_counters != NULL)
+        m_counters->Add(COUNTER_BYTES_UPLOADED, (uint64_t)size);
+}
+
+void GpuResourceManager::Load(uint32_t index)
+{
+    GLuint id = 0;
+    if (m_entries[index].type == GPU_VERTEX_ARRAY)
+    {
+        glGenVertexArrays(1, &id);
+        glBindVertexArray(id);
+    }
+    else
+    {
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        m_textures_by_name[id] = index;
+    }
+    m_entries[index].gl_name = id;
+    m_entries[index].resident = true;
+
+    // O loader pode criar novos itens (buffers da malha), o que pode
+    // realocar m_entries: não guardamos referências para ele durante a chamada.
+    GpuResourceRef ref = { index, m_entries[index].generation };
+    m_entries[index].loader(*this, ref, m_entries[index].user_data);
+
+    if (m_entries[index].type == GPU_VERTEX_ARRAY)
+        glBindVertexArray(0);
+    else
+        glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+size_t GpuResourceManager::GroupBytes(uint32_t index) const
+{
+    const Entry& entry = m_entries[index];
+    size_t bytes = entry.bytes;
+    for (uint32_t child : entry.children)
+        bytes += m_entries[child].bytes;
+    return bytes;
+}
+
+void GpuResourceManager::Evict(uint32_t index)
+{
+    // Os buffers de uma malha não têm handles: pertencem somente a ela.
+    std::vector<uint32_t> children;
+    children.swap(m_entries[index].children);
+    for (uint32_t child : children)
+    {
+        m_buffers_by_name.erase(m_entries[child].gl_name);
+        DeleteGlObject(m_entries[child]);
+        FreeEntry(child);
+    }
+
+    Entry& entry = m_entries[index];
+    if (entry.type == GPU_BUFFER)
+        m_buffers_by_name.erase(entry.gl_name);
+    else if (entry.type == GPU_TEXTURE)
+        m_textures_by_name.erase(entry.gl_name);
+    DeleteGlObject(entry);
+    SetBytes(index, 0);
+    entry.resident = false;
+}
+
+GLuint GpuResourceManager::Use(GpuResourceRef resource)
+{
+    Entry* entry = Find(resource);
+    if (entry == NULL)
+        return 0;
+    if (!entry->resident)
+    {
+        Load(resource.index);
+        m_reloads.fetch_add(1, std::memory_order_relaxed);
+        entry = &m_entries[resource.index];
+    }
+    entry->last_used = m_frame;
+    return entry->gl_name;
+}
+
+GLuint GpuResourceManager::Name(GpuResourceRef resource) const
+{
+    const Entry* entry = Find(resource);
+    return (entry != NULL) ? entry->gl_name : 0;
+}
+
+void GpuResourceManager::EndFrame()
+{
+    size_t total = 0;
+    for (int t = 0; t < GPU_RESOURCE_TYPES; ++t)
+        total += m_bytes[t].load(std::memory_order_relaxed);
+
+    const size_t budget = m_budget_bytes.load(std::memory_order_relaxed);
+    while (total > budget)
+    {
+        // O recurso "streamable" residente usado há mais tempo. Recursos
+        // usados neste frame nunca são despejados.
+        uint32_t victim = NO_PARENT;
+        for (uint32_t i = 0; i < m_entries.size(); ++i)
+        {
+            const Entry& entry = m_entries[i];
+            if (!entry.alive || !entry.streamable || !entry.resident || entry.last_used >= m_frame)
+                continue;
+            if (victim == NO_PARENT || entry.last_used < m_entries[victim].last_used)
+                victim = i;
+        }
+        if (victim == NO_PARENT)
+            break;
+
+        total -= GroupBytes(victim);
+        Evict(victim);
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_frame += 1;
+}
+
+GpuMemoryStats GpuResourceManager::Stats() const
+{
+    GpuMemoryStats stats;
+    stats.total_bytes = 0;
+    for (int t = 0; t < GPU_RESOURCE_TYPES; ++t)
+    {
+        stats.bytes[t] = m_bytes[t].load(std::memory_order_relaxed);
+        stats.count[t] = m_count[t].load(std::memory_order_relaxed);
+        stats.total_bytes += stats.bytes[t];
+    }
+    stats.budget_bytes = m_budget_bytes.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.reloads = m_reloads.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void GpuResourceManager::Release(GpuResourceRef resource)
+{
+    if (m_shutdown || Find(resource) == NULL)
+        return;
+    if (m_entries[resource.index].resident)
+        Evict(resource.index);
+    FreeEntry(resource.index);
+}
+
+void GpuResourceManager::Shutdown()
+{
+    for (uint32_t i = 0; i < m_entries.size(); ++i)
+    {
+        if (!m_entries[i].alive || m_entries[i].parent != NO_PARENT)
+            continue;
+        if (m_entries[i].resident)
+            Evict(i);
+        FreeEntry(i);
+    }
+    m_buffers_by_name.clear();
+    m_textures_by_name.clear();
+    m_shutdown = true;
+}
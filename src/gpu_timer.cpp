@@ -0,0 +1,247 @@
+#include "gpu_timer.h"
+
+#include <algorithm>
+
+// Frames entre duas calibrações do relógio da GPU.
+static const uint64_t CALIBRATION_FRAMES = 600;
+
+const char* GpuPassName(int pass)
+{
+    switch (pass)
+    {
+    case GPU_PASS_FACES: return "Faces";
+    case GPU_PASS_AXES:  return "Axes";
+    case GPU_PASS_EDGES: return "Edges";
+    case GPU_PASS_UI:    return "UI";
+    }
+    return "Frame";
+}
+
+static double ToMicroseconds(FrameClock::time_point time)
+{
+    return std::chrono::duration<double, std::micro>(time.time_since_epoch()).count();
+}
+
+GpuTimer::GpuTimer()
+    : m_current(NULL), m_initialized(false), m_gpu_to_cpu_offset_us(0.0), m_frames_since_calibration(0),
+      m_history_next(0), m_history_size(0), m_dropped(0)
+{
+}
+
+void GpuTimer::Init()
+{
+    for (FrameQueries& slot : m_slots)
+    {
+        glGenQueries(QUERIES_PER_FRAME, slot.queries);
+        slot.pending = false;
+    }
+    m_history.resize(HISTORY);
+    m_initialized = true;
+    Calibrate();
+}
+
+void GpuTimer::Shutdown()
+{
+    if (!m_initialized)
+        return;
+    for (FrameQueries& slot : m_slots)
+        glDeleteQueries(QUERIES_PER_FRAME, slot.queries);
+    m_initialized = false;
+}
+
+void GpuTimer::Calibrate()
+{
+    // GL_TIMESTAMP devolve o relógio da GPU "agora", sem esperar os comandos
+    // já enviados. A diferença para o relógio da CPU no mesmo instante
+    // converte os resultados das consultas para o FrameClock.
+    GLint64 gpu_ns = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_ns);
+    m_gpu_to_cpu_offset_us = ToMicroseconds(FrameClock::now()) - (double)gpu_ns / 1000.0;
+    m_frames_since_calibration = 0;
+}
+
+double GpuTimer::GpuToCpuUs(GLuint64 gpu_ns) const
+{
+    return (double)gpu_ns / 1000.0 + m_gpu_to_cpu_offset_us;
+}
+
+void GpuTimer::BeginFrame(uint64_t frame)
+{
+    if (++m_frames_since_calibration >= CALIBRATION_FRAMES)
+        Calibrate();
+
+    m_current = &m_slots[frame % LATENCY];
+    if (m_current->pending)
+        Collect(*m_current);
+
+    m_current->pending = true;
+    m_current->timings.frame = frame;
+    m_current->timings.passes = 0;
+    glQueryCounter(m_current->queries[QUERY_FRAME_BEGIN], GL_TIMESTAMP);
+}
+
+void GpuTimer::BeginPass(GpuPass pass)
+{
+    glQueryCounter(m_current->queries[QUERY_PASSES + 2 * pass], GL_TIMESTAMP);
+    m_current->timings.passes |= 1u << pass;
+}
+
+void GpuTimer::EndPass(GpuPass pass)
+{
+    glQueryCounter(m_current->queries[QUERY_PASSES + 2 * pass + 1], GL_TIMESTAMP);
+}
+
+void GpuTimer::EndFrame()
+{
+    glQueryCounter(m_current->queries[QUERY_FRAME_END], GL_TIMESTAMP);
+}
+
+void GpuTimer::SetCpuTimes(FrameClock::time_point submit_begin, FrameClock::time_point submit_end,
+                           FrameClock::time_point present_end)
+{
+    m_current->timings.submit_begin_us = ToMicroseconds(submit_begin);
+    m_current->timings.submit_end_us = ToMicroseconds(submit_end);
+    m_current->timings.present_end_us = ToMicroseconds(present_end);
+}
+
+void GpuTimer::Collect(FrameQueries& slot)
+{
+    slot.pending = false;
+    GpuFrameTimings& timings = slot.timings;
+
+    // Só lemos os resultados se todos estiverem prontos; caso contrário
+    // glGetQueryObjectui64v(GL_QUERY_RESULT) bloquearia até a GPU chegar lá.
+    GLuint queries[QUERIES_PER_FRAME];
+    int count = 0;
+    queries[count++] = slot.queries[QUERY_FRAME_BEGIN];
+    queries[count++] = slot.queries[QUERY_FRAME_END];
+    for (int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+        if (timings.passes & (1u << pass))
+        {
+            queries[count++] = slot.queries[QUERY_PASSES + 2 * pass];
+            queries[count++] = slot.queries[QUERY_PASSES + 2 * pass + 1];
+        }
+    for (int q = 0; q < count; ++q)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            std::lock_guard<std::mutex> lock(m_history_mutex);
+            ++m_dropped;
+            return;
+        }
+    }
+
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(slot.queries[QUERY_FRAME_BEGIN], GL_QUERY_RESULT, &ns);
+    timings.begin_us = GpuToCpuUs(ns);
+    glGetQueryObjectui64v(slot.queries[QUERY_FRAME_END], GL_QUERY_RESULT, &ns);
+    timings.end_us = GpuToCpuUs(ns);
+    for (int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+    {
+        timings.pass_begin_us[pass] = timings.pass_end_us[pass] = timings.begin_us;
+        if (!(timings.passes & (1u << pass)))
+            continue;
+        glGetQueryObjectui64v(slot.queries[QUERY_PASSES + 2 * pass], GL_QUERY_RESULT, &ns);
+        timings.pass_begin_us[pass] = GpuToCpuUs(ns);
+        glGetQueryObjectui64v(slot.queries[QUERY_PASSES + 2 * pass + 1], GL_QUERY_RESULT, &ns);
+        timings.pass_end_us[pass] = GpuToCpuUs(ns);
+    }
+
+    std::lock_guard<std::mutex> lock(m_history_mutex);
+    m_history[m_history_next] = timings;
+    m_history_next = (m_history_next + 1) % HISTORY;
+    m_history_size = std::min(m_history_size + 1, (size_t)HISTORY);
+}
+
+static float TimingMs(const GpuFrameTimings& timings, int pass)
+{
+    return pass == GPU_PASS_COUNT ? timings.FrameMs() : timings.PassMs(pass);
+}
+
+GpuTimerSummary GpuTimer::Summary() const
+{
+    GpuTimerSummary summary;
+    std::lock_guard<std::mutex> lock(m_history_mutex);
+    summary.frames = (int)m_history_size;
+    for (int pass = 0; pass <= GPU_PASS_COUNT; ++pass)
+    {
+        float total = 0.0f, max = 0.0f;
+        for (size_t i = 0; i < m_history_size; ++i)
+        {
+            float ms = TimingMs(m_history[i], pass);
+            total += ms;
+            max = std::max(max, ms);
+        }
+        size_t last = (m_history_next + HISTORY - 1) % HISTORY;
+        summary.last_ms[pass] = m_history_size > 0 ? TimingMs(m_history[last], pass) : 0.0f;
+        summary.average_ms[pass] = m_history_size > 0 ? total / (float)m_history_size : 0.0f;
+        summary.max_ms[pass] = max;
+    }
+    return summary;
+}
+
+int GpuTimer::History(int pass, float* out_ms, int max_values) const
+{
+    std::lock_guard<std::mutex> lock(m_history_mutex);
+    int count = std::min((int)m_history_size, max_values);
+    size_t first = (m_history_next + HISTORY - count) % HISTORY;
+    for (int i = 0; i < count; ++i)
+        out_ms[i] = TimingMs(m_history[(first + i) % HISTORY], pass);
+    return count;
+}
+
+bool GpuTimer::FindFrame(uint64_t frame, GpuFrameTimings* out) const
+{
+    std::lock_guard<std::mutex> lock(m_history_mutex);
+    for (size_t i = 0; i < m_history_size; ++i)
+    {
+        const GpuFrameTimings& timings = m_history[(m_history_next + HISTORY - 1 - i) % HISTORY];
+        if (timings.frame == frame)
+        {
+            *out = timings;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GpuTimer::LatestFrame(GpuFrameTimings* out) const
+{
+    std::lock_guard<std::mutex> lock(m_history_mutex);
+    if (m_history_size == 0)
+        return false;
+    *out = m_history[(m_history_next + HISTORY - 1) % HISTORY];
+    return true;
+}
+
+void GpuTimer::AppendTraceEvents(std::vector<TraceEvent>& events) const
+{
+    std::lock_guard<std::mutex> lock(m_history_mutex);
+    size_t first = (m_history_next + HISTORY - m_history_size) % HISTORY;
+    for (size_t i = 0; i < m_history_size; ++i)
+    {
+        const GpuFrameTimings& timings = m_history[(first + i) % HISTORY];
+        TraceEvent submit = { "Submit", TRACE_THREAD_RENDER, timings.submit_begin_us, timings.submit_end_us - timings.submit_begin_us };
+        TraceEvent present = { "Present", TRACE_THREAD_RENDER, timings.submit_end_us, timings.present_end_us - timings.submit_end_us };
+        TraceEvent frame = { "GPU frame", TRACE_THREAD_GPU, timings.begin_us, timings.end_us - timings.begin_us };
+        events.push_back(submit);
+        events.push_back(present);
+        events.push_back(frame);
+        for (int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+        {
+            if (!(timings.passes & (1u << pass)))
+                continue;
+            TraceEvent event = { GpuPassName(pass), TRACE_THREAD_GPU, timings.pass_begin_us[pass],
+                                 timings.pass_end_us[pass] - timings.pass_begin_us[pass] };
+            events.push_back(event);
+        }
+    }
+}
+
+uint64_t GpuTimer::Dropped() const
+{
+    std::lock_guard<std::mutex> lock(m_history_mutex);
+    return m_dropped;
+}
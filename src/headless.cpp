@@ -0,0 +1,283 @@
+#include "headless.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#if defined(__linux__)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#if defined(__linux__)
+bool HeadlessContext::Create()
+{
+    // Preferimos a plataforma "surfaceless" da Mesa, que não precisa de
+    // servidor X nem de Wayland; sem ela, tentamos o display padrão.
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display != NULL)
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        fprintf(stderr, "ERROR: could not initialize an EGL display.\n");
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        fprintf(stderr, "ERROR: EGL %d.%d does not support desktop OpenGL.\n", major, minor);
+        eglTerminate(display);
+        return false;
+    }
+
+    // Não usamos nenhuma superfície (tudo é desenhado em FBOs), mas o padrão
+    // de EGL_SURFACE_TYPE é EGL_WINDOW_BIT, que não existe sem janela.
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint num_configs = 0;
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &num_configs) || num_configs == 0)
+    {
+        fprintf(stderr, "ERROR: no EGL config supports desktop OpenGL.\n");
+        eglTerminate(display);
+        return false;
+    }
+
+    // Mesma versão e perfil pedidos para a janela em InitializeOpenGL3().
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        fprintf(stderr, "ERROR: could not create an OpenGL 3.3 core context with EGL (0x%04X).\n", eglGetError());
+        eglTerminate(display);
+        return false;
+    }
+
+    m_display = display;
+    m_context = context;
+    MakeCurrent();
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (m_display == NULL)
+        return;
+    eglMakeCurrent((EGLDisplay)m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext((EGLDisplay)m_display, (EGLContext)m_context);
+    eglTerminate((EGLDisplay)m_display);
+    m_display = NULL;
+    m_context = NULL;
+}
+
+void HeadlessContext::MakeCurrent()
+{
+    // Sem superfície (EGL_KHR_surfaceless_context): o framebuffer padrão
+    // não existe, e os desenhos precisam de um FBO ligado.
+    eglMakeCurrent((EGLDisplay)m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)m_context);
+}
+
+void HeadlessContext::ReleaseCurrent()
+{
+    eglMakeCurrent((EGLDisplay)m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+#else
+bool HeadlessContext::Create()
+{
+    fprintf(stderr, "ERROR: --headless is only supported on Linux (EGL).\n");
+    return false;
+}
+
+void HeadlessContext::Destroy() {}
+void HeadlessContext::MakeCurrent() {}
+void HeadlessContext::ReleaseCurrent() {}
+#endif
+
+CameraPathPoint HeadlessCameraPath(int frame, int frames)
+{
+    const float pi = 3.141592f;
+    float t = (frames > 0) ? (float)frame / (float)frames : 0.0f;
+    CameraPathPoint point;
+    point.theta = 2.0f * pi * t;
+    point.phi = 0.4f + 0.2f * sinf(4.0f * pi * t);
+    point.cube_angle = 4.0f * pi * t;
+    return point;
+}
+
+void FrameStatsRecorder::Add(float frame_ms, uint32_t draw_calls, uint32_t triangles)
+{
+    m_frame_ms.push_back(frame_ms);
+    m_draw_calls += draw_calls;
+    m_triangles += triangles;
+}
+
+// Percentil pelo método do "nearest rank", sobre valores já ordenados.
+static float Percentile(const std::vector<float>& sorted, float p)
+{
+    if (sorted.empty())
+        return 0.0f;
+    size_t rank = (size_t)ceil(p / 100.0f * (float)sorted.size());
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+void FrameStatsRecorder::WriteJson(FILE* out, const char* renderer, int width, int height, int warmup_frames,
+                                   const GpuTimerSummary* gpu) const
+{
+    std::vector<float> sorted(m_frame_ms);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (float ms : sorted)
+        total += ms;
+    size_t n = sorted.size();
+    double frames = (n > 0) ? (double)n : 1.0;
+
+    // O nome do renderizador vem do driver; tiramos aspas e barras para não
+    // quebrar o JSON.
+    std::string safe_renderer(renderer != NULL ? renderer : "");
+    for (char& c : safe_renderer)
+        if (c == '"' || c == '\\' || (unsigned char)c < 0x20)
+            c = ' ';
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"renderer\": \"%s\",\n", safe_renderer.c_str());
+    fprintf(out, "  \"width\": %d,\n", width);
+    fprintf(out, "  \"height\": %d,\n", height);
+    fprintf(out, "  \"warmup_frames\": %d,\n", warmup_frames);
+    if (m_first_frame_ms >= 0.0f)
+        fprintf(out, "  \"time_to_first_frame_ms\": %.2f,\n", m_first_frame_ms);
+    fprintf(out, "  \"frames\": %zu,\n", n);
+    fprintf(out, "  \"frame_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+            total / frames, Percentile(sorted, 50.0f), Percentile(sorted, 95.0f), Percentile(sorted, 99.0f),
+            n > 0 ? sorted.back() : 0.0f);
+    fprintf(out, "  \"draw_calls\": %.1f,\n", (double)m_draw_calls / frames);
+    fprintf(out, "  \"triangles\": %.1f%s\n", (double)m_triangles / frames, gpu != NULL ? "," : "");
+    if (gpu != NULL)
+    {
+        fprintf(out, "  \"gpu_ms\": {\"frame\": %.4f", gpu->average_ms[GPU_PASS_COUNT]);
+        for (int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+            fprintf(out, ", \"%s\": %.4f", GpuPassName(pass), gpu->average_ms[pass]);
+        fprintf(out, "}\n");
+    }
+    fprintf(out, "}\n");
+}
+
+// Um PNG é uma assinatura seguida de blocos ("chunks"), cada um com tamanho,
+// tipo, dados e CRC-32. Os pixels vão no bloco IDAT, comprimidos com zlib;
+// para não depender de uma biblioteca, usamos blocos "stored" do deflate
+// (sem compressão), que qualquer leitor de PNG aceita.
+static uint32_t Crc32(uint32_t crc, const unsigned char* data, size_t size)
+{
+    static uint32_t table[256];
+    static bool table_ready = false;
+    if (!table_ready)
+    {
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        table_ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutU32(std::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+static void WriteChunk(FILE* file, const char* type, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> chunk;
+    PutU32(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    PutU32(chunk, Crc32(0, chunk.data() + 4, chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+bool WritePng(const char* path, int width, int height, const unsigned char* pixels)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot open \"%s\" for writing.\n", path);
+        return false;
+    }
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, 1, sizeof(signature), file);
+
+    std::vector<unsigned char> header;
+    PutU32(header, (uint32_t)width);
+    PutU32(header, (uint32_t)height);
+    header.push_back(8); // bits por canal
+    header.push_back(6); // RGBA
+    header.push_back(0); // compressão deflate
+    header.push_back(0); // filtros padrão
+    header.push_back(0); // sem entrelaçamento
+    WriteChunk(file, "IHDR", header);
+
+    // Cada linha começa com o tipo de filtro (0: nenhum). As linhas são
+    // escritas de cima para baixo, ao contrário de glReadPixels().
+    size_t row_size = (size_t)width * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((row_size + 1) * (size_t)height);
+    for (int y = height - 1; y >= 0; --y)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels + (size_t)y * row_size, pixels + (size_t)(y + 1) * row_size);
+    }
+
+    std::vector<unsigned char> zlib;
+    zlib.push_back(0x78); // deflate, janela de 32 KiB
+    zlib.push_back(0x01); // sem dicionário, nível mais rápido
+    const size_t MAX_STORED = 65535;
+    for (size_t offset = 0; offset < raw.size() || offset == 0; offset += MAX_STORED)
+    {
+        size_t size = std::min(MAX_STORED, raw.size() - offset);
+        bool last = offset + size >= raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back((unsigned char)size);
+        zlib.push_back((unsigned char)(size >> 8));
+        zlib.push_back((unsigned char)~size);
+        zlib.push_back((unsigned char)(~size >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+        if (last)
+            break;
+    }
+    uint32_t a = 1, b = 0; // Adler-32 dos dados sem compressão
+    for (unsigned char c : raw)
+    {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutU32(zlib, (b << 16) | a);
+    WriteChunk(file, "IDAT", zlib);
+
+    WriteChunk(file, "IEND", std::vector<unsigned char>());
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,163 @@
+#include "hitch_watchdog.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <ctime>
+
+// Abaixo disto um frame nunca é um travamento: com frames de poucos
+// décimos de milissegundo, qualquer interrupção do sistema passaria do
+// limite sem que ninguém perceba.
+static const float MIN_HITCH_MS = 2.0f;
+
+HitchWatchdog::HitchWatchdog()
+    : m_times_count(0), m_times_next(0), m_median_ms(0.0f), m_threshold(3.0f),
+      m_num_pending(0), m_hitches(0), m_report(NULL)
+{
+    for (HitchFrameInfo& info : m_frames)
+        info.frame = 0;
+    m_report_path[0] = '\0';
+}
+
+HitchWatchdog::~HitchWatchdog()
+{
+    if (m_report != NULL)
+        fclose(m_report);
+}
+
+float HitchWatchdog::Median()
+{
+    std::copy(m_times, m_times + m_times_count, m_sorted);
+    float* middle = m_sorted + m_times_count / 2;
+    std::nth_element(m_sorted, middle, m_sorted + m_times_count);
+    return *middle;
+}
+
+void HitchWatchdog::EndFrame(const HitchFrameInfo& info, const GpuTimer& gpu_timer, const RenderCounters& counters)
+{
+    m_frames[info.frame % FRAME_HISTORY] = info;
+
+    // O frame é comparado com a mediana dos anteriores, sem ele.
+    if (m_times_count >= WARMUP_FRAMES)
+    {
+        m_median_ms = Median();
+        if (info.frame_ms > m_median_ms * m_threshold && info.frame_ms > MIN_HITCH_MS && m_num_pending < MAX_PENDING)
+        {
+            PendingHitch hitch = { info.frame, info.frame_ms, m_median_ms };
+            m_pending[m_num_pending++] = hitch;
+            ++m_hitches;
+        }
+    }
+    m_times[m_times_next] = info.frame_ms;
+    m_times_next = (m_times_next + 1) % MEDIAN_FRAMES;
+    m_times_count = std::min(m_times_count + 1, MEDIAN_FRAMES);
+
+    // Grava os travamentos cujos dados da GPU já devem estar prontos.
+    int kept = 0;
+    for (int i = 0; i < m_num_pending; ++i)
+    {
+        if (info.frame >= m_pending[i].frame + CAPTURE_DELAY)
+            WriteHitch(m_pending[i], gpu_timer, counters);
+        else
+            m_pending[kept++] = m_pending[i];
+    }
+    m_num_pending = kept;
+}
+
+void HitchWatchdog::Flush(const GpuTimer& gpu_timer, const RenderCounters& counters)
+{
+    for (int i = 0; i < m_num_pending; ++i)
+        WriteHitch(m_pending[i], gpu_timer, counters);
+    m_num_pending = 0;
+    if (m_report != NULL)
+        fflush(m_report);
+}
+
+bool HitchWatchdog::OpenReport()
+{
+    if (m_report != NULL)
+        return true;
+    time_t now = time(NULL);
+    strftime(m_report_path, sizeof(m_report_path), "hitches_%Y%m%d_%H%M%S.jsonl", localtime(&now));
+    m_report = fopen(m_report_path, "w");
+    if (m_report == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot open \"%s\" for writing.\n", m_report_path);
+        return false;
+    }
+    fprintf(stderr, "Frame hitch detected, writing report to \"%s\".\n", m_report_path);
+    return true;
+}
+
+void HitchWatchdog::WriteHitch(const PendingHitch& hitch, const GpuTimer& gpu_timer, const RenderCounters& counters)
+{
+    if (!OpenReport())
+        return;
+    fprintf(m_report, "{\"frame\": %llu, \"frame_ms\": %.3f, \"median_ms\": %.3f, \"threshold\": %.2f, \"frames\": [",
+            (unsigned long long)hitch.frame, hitch.frame_ms, hitch.median_ms, m_threshold);
+    uint64_t first = (hitch.frame > CONTEXT_FRAMES) ? hitch.frame - CONTEXT_FRAMES : 1;
+    bool separator = false;
+    for (uint64_t frame = first; frame <= hitch.frame; ++frame)
+    {
+        const HitchFrameInfo& info = m_frames[frame % FRAME_HISTORY];
+        if (info.frame != frame)
+            continue;
+        fprintf(m_report, "%s", separator ? ", " : "");
+        WriteFrame(info, gpu_timer, counters);
+        separator = true;
+    }
+    fprintf(m_report, "]}\n");
+    // O relatório deve sobreviver a um travamento que termine em crash.
+    fflush(m_report);
+}
+
+void HitchWatchdog::WriteFrame(const HitchFrameInfo& info, const GpuTimer& gpu_timer, const RenderCounters& counters)
+{
+    FILE* out = m_report;
+    fprintf(out, "{\"frame\": %llu, \"frame_ms\": %.3f, \"main_ms\": %.3f, \"main_wait_ms\": %.3f, "
+                 "\"render_submit_ms\": %.3f, \"render_swap_ms\": %.3f, \"heap_allocations\": %d, \"heap_kib\": %.1f, "
+                 "\"shaders_compiled\": %u, \"programs_linked\": %u, \"gpu_reloads\": %u",
+            (unsigned long long)info.frame, info.frame_ms, info.main_ms, info.main_wait_ms,
+            info.render_submit_ms, info.render_swap_ms, info.heap_allocations, info.heap_kib,
+            info.shaders_compiled, info.programs_linked, info.gpu_reloads);
+
+    uint64_t values[COUNTER_COUNT];
+    if (counters.FindFrame(info.frame, values))
+    {
+        fprintf(out, ", \"counters\": {");
+        for (int c = 0; c < COUNTER_COUNT; ++c)
+            fprintf(out, "%s\"%s\": %llu", c > 0 ? ", " : "", RenderCounterColumn(c), (unsigned long long)values[c]);
+        fprintf(out, "}");
+    }
+
+    GpuFrameTimings timings;
+    if (gpu_timer.FindFrame(info.frame, &timings))
+    {
+        fprintf(out, ", \"gpu_ms\": {\"%s\": %.3f", GpuPassName(GPU_PASS_COUNT), timings.FrameMs());
+        for (int pass = 0; pass < GPU_PASS_COUNT; ++pass)
+            if (timings.passes & (1u << pass))
+                fprintf(out, ", \"%s\": %.3f", GpuPassName(pass), timings.PassMs(pass));
+        fprintf(out, "}");
+    }
+
+#ifdef TCC_ENABLE_PROFILER
+    int frame = Profiler::FindFrame(info.frame);
+    if (frame >= 0)
+    {
+        uint64_t frame_begin, frame_end;
+        Profiler::FrameBounds(frame, &frame_begin, &frame_end);
+        bool separator = false;
+        fprintf(out, ", \"zones\": [");
+        Profiler::ForEachZone(frame, [&](const ProfileZone& zone) {
+            char thread[32];
+            TraceThreadName(zone.thread, thread, sizeof(thread));
+            double start_ms = (zone.begin >= frame_begin) ? Profiler::TicksToMs(zone.begin - frame_begin)
+                                                          : -Profiler::TicksToMs(frame_begin - zone.begin);
+            fprintf(out, "%s{\"thread\": \"%s\", \"name\": \"%s\", \"depth\": %u, \"start_ms\": %.3f, \"ms\": %.3f}",
+                    separator ? ", " : "", thread, zone.name, zone.depth, start_ms, Profiler::TicksToMs(zone.end - zone.begin));
+            separator = true;
+        });
+        fprintf(out, "]");
+    }
+#endif
+    fprintf(out, "}");
+}
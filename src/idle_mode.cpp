@@ -0,0 +1,34 @@
+#include "idle_mode.h"
+#include "timestep.h"
+
+std::atomic<bool> IdleMode::s_redraw_requested(false);
+
+void IdleMode::RequestRedraw()
+{
+    // Chamada de um callback da GLFW, a thread principal já está acordada;
+    // de outra thread, glfwPostEmptyEvent() faz glfwWaitEventsTimeout()
+    // retornar.
+    if (!s_redraw_requested.exchange(true, std::memory_order_acq_rel))
+        glfwPostEmptyEvent();
+}
+
+void IdleMode::EndFrame(bool active)
+{
+    if (s_redraw_requested.exchange(false, std::memory_order_acq_rel))
+        active = true;
+    m_quiet_frames = active ? 0 : m_quiet_frames + 1;
+}
+
+bool IdleMode::CanSleep() const
+{
+    return m_quiet_frames >= SETTLE_FRAMES && !s_redraw_requested.load(std::memory_order_acquire);
+}
+
+bool IdleMode::Wait(double timeout_seconds)
+{
+    FrameClock::time_point start = FrameClock::now();
+    glfwWaitEventsTimeout(timeout_seconds);
+    m_slept_seconds += std::chrono::duration<double>(FrameClock::now() - start).count();
+    ++m_wakeups;
+    return s_redraw_requested.load(std::memory_order_acquire);
+}
@@ -0,0 +1,101 @@
+#include "input_events.h"
+
+#include <cstring>
+
+InputEventQueue g_InputQueue;
+
+// Cabeçalho dos arquivos de gravação.
+static const char   INPUT_RECORDING_MAGIC[4] = { 'T', 'C', 'C', 'I' };
+static const uint32_t INPUT_RECORDING_VERSION = 1;
+
+InputRecorder::InputRecorder()
+    : m_file(NULL), m_recording(false), m_ticks_per_second(0.0), m_has_pending(false), m_pending_tick(0)
+{
+}
+
+InputRecorder::~InputRecorder()
+{
+    Close();
+}
+
+bool InputRecorder::OpenForRecording(const char* filename, double ticks_per_second)
+{
+    Close();
+    m_file = fopen(filename, "wb");
+    if (m_file == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\" to record input.\n", filename);
+        return false;
+    }
+    m_recording = true;
+    m_ticks_per_second = ticks_per_second;
+    fwrite(INPUT_RECORDING_MAGIC, 1, sizeof(INPUT_RECORDING_MAGIC), m_file);
+    fwrite(&INPUT_RECORDING_VERSION, sizeof(INPUT_RECORDING_VERSION), 1, m_file);
+    fwrite(&m_ticks_per_second, sizeof(m_ticks_per_second), 1, m_file);
+    return true;
+}
+
+bool InputRecorder::OpenForReplay(const char* filename)
+{
+    Close();
+    m_file = fopen(filename, "rb");
+    if (m_file == NULL)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\" to replay input.\n", filename);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    if (fread(magic, 1, sizeof(magic), m_file) != sizeof(magic)
+        || memcmp(magic, INPUT_RECORDING_MAGIC, sizeof(magic)) != 0
+        || fread(&version, sizeof(version), 1, m_file) != 1
+        || version != INPUT_RECORDING_VERSION
+        || fread(&m_ticks_per_second, sizeof(m_ticks_per_second), 1, m_file) != 1)
+    {
+        fprintf(stderr, "ERROR: \"%s\" is not an input recording.\n", filename);
+        Close();
+        return false;
+    }
+    m_recording = false;
+    m_has_pending = false;
+    return true;
+}
+
+void InputRecorder::Close()
+{
+    if (m_file != NULL)
+        fclose(m_file);
+    m_file = NULL;
+    m_has_pending = false;
+}
+
+void InputRecorder::Write(uint64_t tick, const InputEvent& event)
+{
+    if (!IsRecording())
+        return;
+    fwrite(&tick, sizeof(tick), 1, m_file);
+    fwrite(&event, sizeof(event), 1, m_file);
+}
+
+bool InputRecorder::Read(uint64_t tick, InputEvent& event)
+{
+    if (!IsReplaying())
+        return false;
+    if (!m_has_pending)
+    {
+        if (fread(&m_pending_tick, sizeof(m_pending_tick), 1, m_file) != 1
+            || fread(&m_pending, sizeof(m_pending), 1, m_file) != 1)
+        {
+            // Fim da gravação.
+            Close();
+            return false;
+        }
+        m_has_pending = true;
+    }
+    if (m_pending_tick > tick)
+        return false;
+    event = m_pending;
+    m_has_pending = false;
+    return true;
+}
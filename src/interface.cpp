@@ -1,10 +1,38 @@
 #include "interface.h"
+#include "gpu_timer.h"
+#include "render_counters.h"
+#include "profiler.h"
+#include "font_cache.h"
+#include "imgui_internal.h"
 
-Interface::Interface(bool show_demo_window) {
+#include <algorithm>
+
+Interface::Interface(bool show_demo_window)
+    : m_jobs(NULL), m_scene_index(NULL), m_transforms(NULL), m_viewport(), m_viewport_visible(false),
+      m_dynamic_resolution(NULL) {
   SetInterface(show_demo_window);
+  // Texto de exemplo para o campo do cache de glyphs: nenhum destes
+  // caracteres fora do ASCII está no atlas construído na inicialização.
+  snprintf(m_glyph_text, sizeof(m_glyph_text), "%s", "Olá! Привет, мир! Γειά σου, κόσμε!");
 }
 
-void Interface::Init(GLFWwindow *window, const char* glsl_version) {
+// GetClipboardTextFn original (do imgui_impl_glfw.cpp) e a interface que
+// recebe o texto colado.
+static const char* (*s_glfw_get_clipboard_text)(void* user_data) = NULL;
+static Interface* s_clipboard_interface = NULL;
+
+// O texto colado é desenhado no mesmo frame, pelo próprio InputText(): os
+// glyphs que faltam precisam ser rasterizados antes.
+const char* Interface::GetClipboardText(void* user_data) {
+  const char* text = s_glfw_get_clipboard_text(user_data);
+  if (text != NULL && s_clipboard_interface != NULL) {
+    s_clipboard_interface->m_glyph_cache.Request(text);
+    s_clipboard_interface->m_glyph_cache.Flush(s_clipboard_interface->m_jobs);
+  }
+  return text;
+}
+
+void Interface::CreateContext() {
   // Setup Dear ImGui context
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
@@ -15,15 +43,27 @@ void Interface::Init(GLFWwindow *window, const char* glsl_version) {
   // Setup Dear ImGui style
   ImGui::StyleColorsDark();
   //ImGui::StyleColorsClassic();
+}
 
-  // Setup Platform/Renderer bindings
+void Interface::Init(GLFWwindow *window, const char* glsl_version) {
+  // Setup Platform bindings. The renderer bindings are set up by the render
+  // thread, which owns the OpenGL context (see InitRenderer()).
   ImGui_ImplGlfw_InitForOpenGL(window, true);
-  ImGui_ImplOpenGL3_Init(glsl_version);
-
-  // LoadFonts();
+  m_glsl_version = glsl_version;
+  s_glfw_get_clipboard_text = Globals::g_Io->GetClipboardTextFn;
+  s_clipboard_interface = this;
+  Globals::g_Io->GetClipboardTextFn = GetClipboardText;
 }
 
 void Interface::Show(GLFWwindow *window) {
+  PROFILE_SCOPE("Interface::Show");
+  // Os glyphs que faltam para o texto deste frame (o campo do cache de
+  // glyphs e os caracteres digitados) são rasterizados antes de a ImGui
+  // desenhar qualquer texto.
+  const ImGuiIO& io = ImGui::GetIO();
+  m_glyph_cache.Request(m_glyph_text);
+  m_glyph_cache.Request(io.InputQueueCharacters.Data, io.InputQueueCharacters.Size);
+  m_glyph_cache.Flush(m_jobs);
   Start();
   //1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can browse its code to learn more about Dear ImGui!).
   if (m_show_demo_window)
@@ -45,6 +85,35 @@ void Interface::Show(GLFWwindow *window) {
     ImGui::Text("counter = %d", counter);
 
     ImGui::Checkbox("Perspective Projection", &g_UsePerspectiveProjection);
+    ImGui::Checkbox("Lean UI renderer", &g_LeanUiRenderer);
+    ImGui::Checkbox("Cache UI layer", &g_UiCache);
+    ImGui::SameLine();
+    ImGui::Text("(%d redraws)", g_UiRedraws);
+    if (g_UiCache)
+      ImGui::SliderFloat("UI live refresh", &g_UiLiveRefreshHz, 1.0f, 60.0f, "%.0f Hz");
+    ImGui::Checkbox("Scene viewport", &g_SceneViewport);
+    if (g_SceneViewport) {
+      ImGui::Checkbox("Dynamic resolution", &g_DynamicResolution);
+      if (g_DynamicResolution) {
+        ImGui::SliderFloat("GPU frame budget", &g_ResolutionTargetMs, 2.0f, 50.0f, "%.1f ms");
+        ImGui::SliderFloat("Min scale", &g_ResolutionMinScale, 0.25f, 1.0f, "%.2f");
+        ImGui::SliderFloat("Max scale", &g_ResolutionMaxScale, 0.25f, 1.0f, "%.2f");
+        if (m_dynamic_resolution != NULL) {
+          static float history[DynamicResolution::HISTORY];
+          int count = m_dynamic_resolution->History(history, DynamicResolution::HISTORY);
+          char overlay[32];
+          snprintf(overlay, sizeof(overlay), "%.0f%%", m_dynamic_resolution->Scale() * 100.0f);
+          ImGui::PlotLines("Scale", history, count, 0, overlay, 0.0f, 1.0f, ImVec2(0, 40));
+        }
+      } else {
+        // Na mesma ordem de SCENE_VIEWPORT_SCALES.
+        ImGui::Combo("Viewport scale", &g_ViewportScale, "50%\0" "75%\0" "100%\0");
+      }
+      ImGui::SliderFloat("Sharpen", &g_ViewportSharpen, 0.0f, 1.0f, "%.2f");
+      if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Extra pass over the scene's pixels, before upscaling.\n"
+                          "llvmpipe, 1280x720: about +3 ms at 50%%, +20 ms at 100%%.");
+    }
 
     ImGui::Text("Block Settings");
     ImGui::SliderFloat("Angle Z", &g_AngleZ, -10.0f, 10.0f);
@@ -55,45 +124,368 @@ void Interface::Show(GLFWwindow *window) {
     ImGui::SliderFloat("Near Plane", &g_FrustumNearPlane, -10.0f, 10.0f);
     ImGui::SliderFloat("Far Plane", &g_FrustumFarPlane, -10.0f, 10.0f);
 
+    ImGui::Text("Frame Settings");
+    ImGui::Combo("Present Mode", &g_PresentMode, "Uncapped\0VSync\0Throttled\0");
+    if (g_PresentMode == 2)
+      ImGui::SliderFloat("Max FPS", &g_ThrottleFPS, 10.0f, 240.0f, "%.0f");
+    ImGui::SliderFloat("Simulation Hz", &g_SimulationHz, 30.0f, 240.0f, "%.0f");
+    ImGui::Checkbox("Low latency", &g_LowLatency);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(ImGui::GetFontSize() * 7.0f);
+    ImGui::Combo("GPU queue", &g_GpuQueueDepth, "Driver\0" "1 frame\0" "2 frames\0");
+    ImGui::Text("Pacing: %.2f ms interval, %.2f ms jitter", g_FrameIntervalMs, g_PacingJitterMs);
+    ImGui::Text("Latency: %.2f ms average, %.2f ms max (input to present)", g_LatencyMs, g_MaxLatencyMs);
+    ImGui::Checkbox("Idle when nothing changes", &g_IdleMode);
+    ImGui::SameLine();
+    ImGui::Text("(%d waits, %.1f s asleep)", g_IdleWakeups, g_IdleSleptSeconds);
+    ImGui::Text("Simulation: %d steps this frame, alpha %.2f", g_SimulationSteps, g_SimulationAlpha);
+
+    ImGui::Text("Thread Timings");
+    ImGui::Text("Main:   %.2f ms busy, %.2f ms waiting", g_MainThreadMs, g_MainThreadWaitMs);
+    ImGui::Text("Render: %.2f ms submit, %.2f ms swap, %.2f ms idle", g_RenderSubmitMs, g_RenderSwapMs, g_RenderIdleMs);
+    ImGui::Text("Heap:   %d allocations (%.1f KiB) last frame", g_FrameHeapAllocations, g_FrameHeapKiB);
+
+    ImGui::Text("GPU Memory");
+    ImGui::SliderFloat("Budget", &g_GpuBudgetMiB, 1.0f, 1024.0f, "%.0f MiB");
+    ImGui::Text("Buffers: %.1f KiB, textures: %.1f KiB", g_GpuBufferKiB, g_GpuTextureKiB);
+    ImGui::Text("Evictions: %d, reloads: %d", g_GpuEvictions, g_GpuReloads);
+    ImGui::Text("Geometry: %.1f / %.1f KiB, fragmentation %.0f%%, moved %.1f KiB",
+                g_GeometryUsedKiB, g_GeometryCapacityKiB, g_GeometryFragmentation * 100.0f, g_GeometryMovedKiB);
+
+    if (Globals::g_RenderCounters != NULL)
+      ShowRenderCounters(*Globals::g_RenderCounters);
+    if (Globals::g_GpuTimer != NULL)
+      ShowGpuTimings(*Globals::g_GpuTimer);
+    if (ImGui::Button("Save trace"))
+      g_SaveTrace = true;
+
+    ShowGlyphCache();
+
+    ImGui::Text("Hitch Watchdog");
+    ImGui::SliderFloat("Threshold", &g_HitchThreshold, 1.5f, 10.0f, "%.1fx median");
+    ImGui::Text("Median frame %.2f ms, %d hitches recorded", g_FrameMedianMs, g_HitchCount);
+
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
     ImGui::End();
   }
 
-  // Rendering
+  if (m_scene_index != NULL)
+    m_outliner.Show(*m_scene_index, *m_transforms);
+  ShowViewport();
+
+#ifdef TCC_ENABLE_PROFILER
+  ShowProfiler();
+#endif
+
+  // Rendering: only builds the draw data. It is copied into the frame packet
+  // and drawn by the render thread with RenderDrawData().
   ImGui::Render();
+  m_glyph_cache.EndFrame();
+}
 
-  int display_w, display_h;
-  glfwGetFramebufferSize(window, &display_w, &display_h);
-  glViewport(0, 0, display_w, display_h);
-
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-}
-
- void Interface::LoadFonts() {
-    // Load Fonts
-    // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use ImGui::PushFont()/PopFont() to select them.
-    // - AddFontFromFileTTF() will return the ImFont* so you can store it if you need to select the font among multiple.
-    // - If the file cannot be loaded, the function will return NULL. Please handle those errors in your application (e.g. use an assertion, or display an error and quit).
-    // - The fonts will be rasterized at a given size (w/ oversampling) and stored into a texture when calling ImFontAtlas::Build()/GetTexDataAsXXXX(), which ImGui_ImplXXXX_NewFrame below will call.
-    // - Read 'misc/fonts/README.txt' for more instructions and details.
-    // - Remember that in C/C++ if you want to include a backslash \ in a string literal you need to write a double backslash \\ !
-    //Globals::g_Io.Fonts->AddFontDefault();
-    //Globals::g_Io.Fonts->AddFontFromFileTTF("../../misc/fonts/Roboto-Medium.ttf", 16.0f);
-    //Globals::g_Io.Fonts->AddFontFromFileTTF("../../misc/fonts/Cousine-Regular.ttf", 15.0f);
-    //Globals::g_Io.Fonts->AddFontFromFileTTF("../../misc/fonts/DroidSans.ttf", 16.0f);
-    //Globals::g_Io.Fonts->AddFontFromFileTTF("../../misc/fonts/ProggyTiny.ttf", 10.0f);
-    //ImFont* font = Globals::g_Io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, NULL, Globals::g_Io.Fonts->GetGlyphRangesJapanese());
-    //IM_ASSERT(font != NULL);
+// Janela com a imagem da cena, desenhada pela thread de renderização em um
+// alvo fora da tela (veja scene_viewport.h). A ImGui 1.74 não tem janelas
+// encaixáveis ("docking"); é uma janela comum, que pode ser movida e
+// redimensionada.
+void Interface::ShowViewport() {
+  m_viewport_visible = false;
+  if (!g_SceneViewport)
+    return;
+  ImGui::SetNextWindowSize(ImVec2(640, 400), ImGuiCond_FirstUseEver);
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+  bool visible = ImGui::Begin("Viewport", &g_SceneViewport, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
+  ImGui::PopStyleVar();
+  ImVec2 size = ImGui::GetContentRegionAvail();
+  if (!visible || size.x < 1.0f || size.y < 1.0f) {
+    ImGui::End();
+    return;
   }
 
-void Interface::CleanUp() {
+  // A imagem ocupa toda a janela, em pixels do framebuffer (que podem ser
+  // mais de um por unidade da ImGui em telas de alta densidade).
+  const ImGuiIO& io = ImGui::GetIO();
+  float scale = SCENE_VIEWPORT_SCALES[std::min(std::max(g_ViewportScale, 0), SCENE_VIEWPORT_SCALE_COUNT - 1)] / 100.0f;
+  float max_scale = scale;
+  if (g_DynamicResolution && m_dynamic_resolution != NULL) {
+    scale = m_dynamic_resolution->Scale();
+    max_scale = m_dynamic_resolution->MaxScale();
+  }
+  m_viewport = ComputeSceneViewportLayout((int)(size.x * io.DisplayFramebufferScale.x),
+                                          (int)(size.y * io.DisplayFramebufferScale.y), scale, max_scale,
+                                          g_ViewportSharpen);
+  m_viewport_visible = true;
+
+  // Um botão invisível embaixo da imagem: arrastar sobre ela não move a
+  // janela, e a ImGui deixa de capturar o mouse no próximo frame, para que
+  // a câmera seja controlada como fora das janelas (veja callbacks.cpp).
+  ImVec2 position = ImGui::GetCursorScreenPos();
+  ImGui::InvisibleButton("##scene", size);
+  if (ImGui::IsItemHovered() || ImGui::IsItemActive())
+    ImGui::CaptureMouseFromApp(false);
+  ImDrawList* draw_list = ImGui::GetWindowDrawList();
+  draw_list->AddImage(SCENE_VIEWPORT_TEXTURE, position, ImVec2(position.x + size.x, position.y + size.y),
+                      m_viewport.uv0, m_viewport.uv1);
+  char label[64];
+  snprintf(label, sizeof(label), "%dx%d (%.0f%%)", m_viewport.scene_width, m_viewport.scene_height, scale * 100.0f);
+  draw_list->AddText(ImVec2(position.x + 4.0f, position.y + 2.0f), IM_COL32(255, 255, 255, 200), label);
+  ImGui::End();
+}
+
+// Campo de texto com a fonte DroidSans: caracteres digitados ou colados fora
+// do ASCII são rasterizados sob demanda (veja glyph_cache.h).
+void Interface::ShowGlyphCache() {
+  ImGui::Text("Glyph Cache");
+  ImFont* font = m_glyph_cache.Font();
+  if (font == NULL) {
+    ImGui::Text("(DroidSans.ttf not found)");
+    return;
+  }
+  ImGui::PushFont(font);
+  ImGui::InputText("##glyph_text", m_glyph_text, sizeof(m_glyph_text));
+  ImGui::PopFont();
+  ImGui::Text("%d dynamic glyphs, area %.0f%% used, %llu evictions", m_glyph_cache.DynamicGlyphs(),
+              m_glyph_cache.AreaUsage() * 100.0f, (unsigned long long)m_glyph_cache.Evictions());
+}
+
+// Tabela com o tempo de GPU de cada etapa do frame (último frame, média e
+// máximo do histórico) e um gráfico por etapa.
+void Interface::ShowGpuTimings(const GpuTimer& timer) {
+  GpuTimerSummary summary = timer.Summary();
+  ImGui::Text("GPU Timings (%d frames, %llu dropped)", summary.frames, (unsigned long long)timer.Dropped());
+  ImGui::Columns(4, "gpu_timings");
+  ImGui::Text("Pass"); ImGui::NextColumn();
+  ImGui::Text("Last ms"); ImGui::NextColumn();
+  ImGui::Text("Avg ms"); ImGui::NextColumn();
+  ImGui::Text("Max ms"); ImGui::NextColumn();
+  ImGui::Separator();
+  for (int pass = 0; pass <= GPU_PASS_COUNT; ++pass) {
+    ImGui::Text("%s", GpuPassName(pass)); ImGui::NextColumn();
+    ImGui::Text("%.3f", summary.last_ms[pass]); ImGui::NextColumn();
+    ImGui::Text("%.3f", summary.average_ms[pass]); ImGui::NextColumn();
+    ImGui::Text("%.3f", summary.max_ms[pass]); ImGui::NextColumn();
+  }
+  ImGui::Columns(1);
+
+  static float history[GpuTimer::HISTORY];
+  for (int pass = 0; pass <= GPU_PASS_COUNT; ++pass) {
+    int count = timer.History(pass, history, GpuTimer::HISTORY);
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "%.3f ms", summary.average_ms[pass]);
+    ImGui::PlotLines(GpuPassName(pass), history, count, 0, overlay, 0.0f, summary.max_ms[pass], ImVec2(0, 30));
+  }
+}
+
+// Tabela com os contadores do último frame e o mínimo, a média e o máximo
+// do histórico (veja render_counters.h).
+void Interface::ShowRenderCounters(const RenderCounters& counters) {
+  RenderCounterStats stats = counters.Stats();
+  ImGui::Text("Render Counters (%d frames)", stats.frames);
+  ImGui::Columns(5, "render_counters");
+  ImGui::Text("Counter"); ImGui::NextColumn();
+  ImGui::Text("Last"); ImGui::NextColumn();
+  ImGui::Text("Min"); ImGui::NextColumn();
+  ImGui::Text("Avg"); ImGui::NextColumn();
+  ImGui::Text("Max"); ImGui::NextColumn();
+  ImGui::Separator();
+  for (int c = 0; c < COUNTER_COUNT; ++c) {
+    ImGui::Text("%s", RenderCounterLabel(c)); ImGui::NextColumn();
+    ImGui::Text("%llu", (unsigned long long)stats.last[c]); ImGui::NextColumn();
+    ImGui::Text("%llu", (unsigned long long)stats.min[c]); ImGui::NextColumn();
+    ImGui::Text("%.1f", stats.average[c]); ImGui::NextColumn();
+    ImGui::Text("%llu", (unsigned long long)stats.max[c]); ImGui::NextColumn();
+  }
+  ImGui::Columns(1);
+  ImGui::Checkbox("Record counters CSV", &g_RecordCounters);
+}
+
+#ifdef TCC_ENABLE_PROFILER
+// Linha do tempo de um frame do profiler de CPU (veja profiler.h): um bloco
+// por thread, com uma faixa por nível de aninhamento. Zonas que começaram
+// no frame anterior ou terminam no seguinte são cortadas nas bordas.
+void Interface::ShowProfiler() {
+  ImGui::Begin("Profiler");
+  bool paused = Profiler::Paused();
+  if (ImGui::Checkbox("Pause", &paused))
+    Profiler::SetPaused(paused);
+
+  int frames = Profiler::Frames();
+  static int selected = 0;
+  if (frames == 0) {
+    ImGui::End();
+    return;
+  }
+  if (!paused)
+    selected = frames - 1;
+  ImGui::SameLine();
+  ImGui::SliderInt("Frame", &selected, 0, frames - 1);
+  selected = std::min(std::max(selected, 0), frames - 1);
+
+  uint64_t frame_begin, frame_end;
+  Profiler::FrameBounds(selected, &frame_begin, &frame_end);
+  ImGui::Text("%.3f ms, %llu zones dropped", Profiler::TicksToMs(frame_end - frame_begin),
+              (unsigned long long)Profiler::Dropped());
+
+  // Threads presentes no frame e quantos níveis de zonas cada uma tem.
+  int threads[Profiler::MAX_THREADS];
+  int depths[Profiler::MAX_THREADS];
+  int num_threads = 0;
+  Profiler::ForEachZone(selected, [&](const ProfileZone& zone) {
+    int t = 0;
+    while (t < num_threads && threads[t] != zone.thread)
+      ++t;
+    if (t == num_threads) {
+      if (num_threads == Profiler::MAX_THREADS)
+        return;
+      threads[t] = zone.thread;
+      depths[t] = 0;
+      ++num_threads;
+    }
+    depths[t] = std::max(depths[t], (int)zone.depth + 1);
+  });
+  for (int i = 1; i < num_threads; ++i)
+    for (int j = i; j > 0 && threads[j - 1] > threads[j]; --j) {
+      std::swap(threads[j - 1], threads[j]);
+      std::swap(depths[j - 1], depths[j]);
+    }
+
+  ImDrawList* draw_list = ImGui::GetWindowDrawList();
+  const float lane = ImGui::GetTextLineHeightWithSpacing();
+  const float width = ImGui::GetContentRegionAvail().x;
+  const double frame_ticks = (double)(frame_end - frame_begin);
+  const ImVec2 mouse = ImGui::GetIO().MousePos;
+  for (int t = 0; t < num_threads; ++t) {
+    char name[32];
+    TraceThreadName(threads[t], name, sizeof(name));
+    ImGui::Text("%s", name);
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(width, lane * depths[t]));
+
+    Profiler::ForEachZone(selected, [&](const ProfileZone& zone) {
+      if (zone.thread != threads[t])
+        return;
+      double begin = (double)(int64_t)(zone.begin - frame_begin) / frame_ticks;
+      double end = (double)(int64_t)(zone.end - frame_begin) / frame_ticks;
+      ImVec2 min(origin.x + (float)std::max(begin, 0.0) * width, origin.y + zone.depth * lane);
+      ImVec2 max(origin.x + (float)std::min(end, 1.0) * width, min.y + lane - 1.0f);
+      if (max.x - min.x < 1.0f)
+        max.x = min.x + 1.0f;
+
+      // A cor depende só do nome, para que a mesma zona tenha sempre a
+      // mesma cor.
+      float hue = (float)(((uintptr_t)zone.name * 2654435761u) % 360u) / 360.0f;
+      draw_list->AddRectFilled(min, max, ImColor::HSV(hue, 0.5f, 0.7f));
+      ImVec2 text_size = ImGui::CalcTextSize(zone.name);
+      if (text_size.x + 4.0f < max.x - min.x)
+        draw_list->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_WHITE, zone.name);
+      if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+        ImGui::SetTooltip("%s: %.3f ms", zone.name, Profiler::TicksToMs(zone.end - zone.begin));
+    });
+  }
+  ImGui::End();
+}
+#endif
+
+void Interface::InitRenderer() {
+  ImGui_ImplOpenGL3_Init(m_glsl_version);
+  // Creates the device objects (shaders, font atlas texture) right away, so
+  // the main thread can start a frame as soon as this returns.
+  ImGui_ImplOpenGL3_NewFrame();
+}
+
+void Interface::RenderDrawData(ImDrawData* draw_data) {
+  ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+}
+
+void Interface::ShutdownRenderer() {
   ImGui_ImplOpenGL3_Shutdown();
+}
+
+// Fontes de misc/fonts, relativas a bin/, de onde o programa é executado.
+// A primeira fonte do atlas (a padrão, embutida na ImGui) continua sendo a da
+// interface; as outras podem ser escolhidas no editor de estilo da janela de
+// demonstração ("Style Editor" > "Fonts"). A fonte "dynamic" é construída só
+// com o ASCII; os outros caracteres são rasterizados quando aparecem (veja
+// glyph_cache.h).
+static const struct {
+  const char* path;
+  float size;
+  bool dynamic;
+} s_font_files[] = {
+  { "../misc/fonts/Roboto-Medium.ttf",   16.0f, false },
+  { "../misc/fonts/Cousine-Regular.ttf", 15.0f, false },
+  { "../misc/fonts/DroidSans.ttf",       18.0f, true  },
+  { "../misc/fonts/Karla-Regular.ttf",   16.0f, false },
+  { "../misc/fonts/ProggyTiny.ttf",      10.0f, false },
+};
+
+// Arquivo do cache do atlas de fontes (veja font_cache.h), em bin/.
+static const char* FONT_CACHE_PATH = "font_atlas.cache";
+
+// Área do atlas para os glyphs dinâmicos: cabe na largura mínima do atlas
+// (512) e guarda cerca de 300 glyphs de 18 pixels.
+static const int GLYPH_AREA_WIDTH = 496;
+static const int GLYPH_AREA_HEIGHT = 192;
+static const ImWchar s_ascii_ranges[] = { 0x0020, 0x007E, 0 };
+
+void Interface::LoadFonts() {
+  // As fontes são rasterizadas e guardadas em uma textura por
+  // BuildFontAtlas(), ou lidas do cache gravado em uma execução anterior. A
+  // textura é criada depois pela thread de renderização (veja
+  // InitRenderer()).
+  ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+  atlas->AddFontDefault();
+  for (size_t i = 0; i < sizeof(s_font_files) / sizeof(s_font_files[0]); ++i) {
+    // AddFontFromFileTTF() falha com uma asserção se o arquivo não existe.
+    FILE* file = fopen(s_font_files[i].path, "rb");
+    if (file == NULL)
+      continue;
+    fclose(file);
+    const ImWchar* ranges = s_font_files[i].dynamic ? s_ascii_ranges : NULL;
+    ImFont* font = atlas->AddFontFromFileTTF(s_font_files[i].path, s_font_files[i].size, NULL, ranges);
+    if (s_font_files[i].dynamic)
+      m_glyph_cache.Attach(atlas, font, GLYPH_AREA_WIDTH, GLYPH_AREA_HEIGHT);
+  }
+
+  FontAtlasStats stats;
+  BuildFontAtlas(atlas, g_FontCache ? FONT_CACHE_PATH : NULL, &stats);
+  if (m_glyph_cache.Font() != NULL && !m_glyph_cache.Init())
+    printf("Fonts: could not set up the dynamic glyph area\n");
+  printf("Fonts: %d fonts, %dx%d atlas, %.1f ms (%s)\n", atlas->Fonts.Size, atlas->TexWidth, atlas->TexHeight,
+         stats.milliseconds, stats.cache_hit ? "from cache" : stats.cache_written ? "built, cache written" : "built");
+}
+
+void Interface::CleanUp() {
+  s_clipboard_interface = NULL;
   ImGui_ImplGlfw_Shutdown();
   ImGui::DestroyContext();
 }
 
+// Um widget em uso (arrastando um slider, digitando em um campo de texto,
+// com o cursor piscando) precisa de frames mesmo sem eventos novos, assim
+// como uma busca do "Outliner" ainda em andamento.
+bool Interface::WantsRedraw() {
+  return ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput || m_outliner.Searching();
+}
+
+uint64_t Interface::Interaction(bool* active) {
+  // Os identificadores só estão no contexto interno da ImGui.
+  const ImGuiContext& g = *ImGui::GetCurrentContext();
+  const ImGuiIO& io = g.IO;
+  int mouse_down = 0;
+  for (int i = 0; i < IM_ARRAYSIZE(io.MouseDown); ++i)
+    if (io.MouseDown[i])
+      mouse_down |= 1 << i;
+  *active = g.ActiveId != 0 || mouse_down != 0 || io.MouseWheel != 0.0f || io.MouseWheelH != 0.0f || io.WantTextInput;
+
+  uint64_t values[6] = { g.HoveredId, g.ActiveId, (uint64_t)(uintptr_t)g.HoveredWindow,
+                         (uint64_t)(uintptr_t)g.NavWindow, (uint64_t)mouse_down, (uint64_t)io.WantTextInput };
+  uint64_t hash = 14695981039346656037ull;
+  for (int i = 0; i < IM_ARRAYSIZE(values); ++i)
+    hash = (hash ^ values[i]) * 1099511628211ull;
+  return hash;
+}
+
 void Interface::Start(){
-  ImGui_ImplOpenGL3_NewFrame();
   ImGui_ImplGlfw_NewFrame();
   ImGui::NewFrame();
 }
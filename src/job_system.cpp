@@ -0,0 +1,303 @@
+#include "job_system.h"
+#include "profiler.h"
+
+#include <cassert>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Identificação da thread atual: a qual JobSystem pertence e qual é a sua
+// fila. Threads que não pertencem a nenhum (por exemplo, a de renderização)
+// submetem tarefas na fila compartilhada.
+static thread_local JobSystem*   t_job_system = NULL;
+static thread_local unsigned int t_queue_index = 0;
+static thread_local uint32_t     t_random = 0;
+
+// Número de tentativas de achar uma tarefa antes de uma thread de trabalho
+// dormir. Evita o custo de dormir e acordar entre tarefas muito próximas.
+static const int SPIN_BEFORE_SLEEP = 64;
+
+static uint32_t NextRandom()
+{
+    // xorshift32; basta para escolher de quem roubar.
+    uint32_t x = t_random ? t_random : 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    t_random = x;
+    return x;
+}
+
+WorkStealingDeque::WorkStealingDeque()
+    : m_top(0), m_bottom(0)
+{
+    for (int64_t i = 0; i < CAPACITY; ++i)
+        m_jobs[i].store(NULL, std::memory_order_relaxed);
+}
+
+bool WorkStealingDeque::Push(Job* job)
+{
+    int64_t b = m_bottom.load(std::memory_order_relaxed);
+    int64_t t = m_top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY)
+        return false;
+    m_jobs[b & (CAPACITY - 1)].store(job, std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+Job* WorkStealingDeque::Pop()
+{
+    int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    // A escrita de m_bottom precisa ser vista antes da leitura de m_top:
+    // é isso que impede que Pop() e Steal() peguem a mesma tarefa.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        // Fila vazia.
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return NULL;
+    }
+
+    Job* job = m_jobs[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+        // Última tarefa: disputamos com os ladrões pelo topo.
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = NULL;
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* WorkStealingDeque::Steal()
+{
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = m_bottom.load(std::memory_order_acquire);
+    if (t >= b)
+        return NULL;
+
+    Job* job = m_jobs[t & (CAPACITY - 1)].load(std::memory_order_acquire);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return NULL; // outra thread levou a tarefa
+    return job;
+}
+
+bool PinCurrentThreadToCore(int core)
+{
+#if defined(_WIN32)
+    if (core < 0 || core >= 64)
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+    if (core < 0 || core >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+bool PinThreadToCore(std::thread& thread, int core)
+{
+#if defined(_WIN32)
+    if (core < 0 || core >= 64)
+        return false;
+    return SetThreadAffinityMask((HANDLE)thread.native_handle(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+    if (core < 0 || core >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
+
+JobSystem::JobSystem(unsigned int num_threads, bool pin_threads, int reserved_core)
+    : m_shared_size(0), m_queued(0), m_sleeping(0), m_stop(false)
+{
+    unsigned int num_cores = std::thread::hardware_concurrency();
+    if (num_cores == 0)
+        num_cores = 1;
+    if (num_threads == 0)
+    {
+        num_threads = num_cores;
+        if (reserved_core >= 0 && num_threads > 1)
+            num_threads -= 1;
+    }
+
+    for (unsigned int i = 0; i < num_threads; ++i)
+        m_queues.push_back(new WorkStealingDeque());
+
+    // A fila 0 é da thread que criou o JobSystem.
+    t_job_system = this;
+    t_queue_index = 0;
+
+    int core = 0;
+    for (unsigned int i = 1; i < num_threads; ++i)
+    {
+        m_threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+        if (pin_threads)
+        {
+            // A thread principal fica no núcleo 0; as demais ocupam os
+            // núcleos seguintes, sem usar o reservado.
+            do { ++core; } while (core == reserved_core);
+            PinThreadToCore(m_threads.back(), core % (int)num_cores);
+        }
+    }
+    if (pin_threads)
+        PinCurrentThreadToCore(0);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_sleep_cv.notify_all();
+    for (std::thread& thread : m_threads)
+        thread.join();
+    for (WorkStealingDeque* queue : m_queues)
+        delete queue;
+    if (t_job_system == this)
+        t_job_system = NULL;
+}
+
+void JobSystem::BeginFrame()
+{
+    assert(m_queued.load() == 0);
+    m_frame_allocator.Reset();
+}
+
+void JobSystem::Submit(JobFunction function, void* data, JobCounter* counter)
+{
+    Job* job = static_cast<Job*>(m_frame_allocator.Allocate(sizeof(Job), alignof(Job)));
+    job->function = function;
+    job->data = data;
+    job->counter = counter;
+    if (counter != NULL)
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+
+    m_queued.fetch_add(1, std::memory_order_seq_cst);
+    if (t_job_system != this || !m_queues[t_queue_index]->Push(job))
+    {
+        std::lock_guard<std::mutex> lock(m_shared_mutex);
+        m_shared_queue.push_back(job);
+        m_shared_size.fetch_add(1, std::memory_order_release);
+    }
+
+    // Uma thread que vai dormir incrementa m_sleeping antes de conferir
+    // m_queued (com o mutex travado); portanto ou ela vê a nova tarefa, ou
+    // nós vemos que ela está dormindo e a acordamos.
+    if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_sleep_cv.notify_one();
+    }
+}
+
+Job* JobSystem::FindJob(unsigned int index)
+{
+    // Primeiro a própria fila (a tarefa mais recente, cujos dados
+    // provavelmente ainda estão no cache)...
+    Job* job = m_queues[index]->Pop();
+    if (job != NULL)
+        return job;
+
+    // ... depois as filas das outras threads, a partir de uma aleatória...
+    const unsigned int n = NumThreads();
+    unsigned int start = NextRandom() % n;
+    for (unsigned int k = 0; k < n; ++k)
+    {
+        unsigned int victim = (start + k) % n;
+        if (victim == index)
+            continue;
+        job = m_queues[victim]->Steal();
+        if (job != NULL)
+            return job;
+    }
+
+    // ... e por fim a fila compartilhada (sem travar o mutex se ela está vazia).
+    if (m_shared_size.load(std::memory_order_acquire) == 0)
+        return NULL;
+    std::lock_guard<std::mutex> lock(m_shared_mutex);
+    if (m_shared_queue.empty())
+        return NULL;
+    job = m_shared_queue.front();
+    m_shared_queue.pop_front();
+    m_shared_size.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    PROFILE_SCOPE("Job");
+    job->function(job->data);
+    if (job->counter != NULL)
+        job->counter->m_value.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+    // Threads de fora do JobSystem apenas esperam; as demais ajudam.
+    const bool helps = (t_job_system == this);
+    while (!counter->IsDone())
+    {
+        Job* job = helps ? FindJob(t_queue_index) : NULL;
+        if (job != NULL)
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+    t_job_system = this;
+    t_queue_index = index;
+    t_random = 2463534242u + index * 2654435761u;
+    PROFILE_REGISTER_THREAD(TRACE_THREAD_WORKERS + (int)index);
+
+    int idle = 0;
+    while (!m_stop.load(std::memory_order_relaxed))
+    {
+        Job* job = FindJob(index);
+        if (job != NULL)
+        {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < SPIN_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        m_sleep_cv.wait(lock, [this]() { return m_stop.load() || m_queued.load(std::memory_order_seq_cst) > 0; });
+        m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+}
@@ -11,62 +11,320 @@
 #endif
 
 #pragma region [rgba(80, 80, 0, 0.2)] HEADERS
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 #include "matrices.h"
 #include "shaders.h"
+#include "transforms.h"
+#include "job_system.h"
+#include "allocators.h"
+#include "timestep.h"
 #ifndef CLASS_HEADER_INITIALIZE_GLOBALS
 #define CLASS_HEADER_INITIALIZE_GLOBALS
 #include "initialize_globals.h"
 #endif
 #include "callbacks.h"
 #include "interface.h"
-
-GLuint BuildTriangles();
+#include "render_thread.h"
+#include "gpu_resources.h"
+#include "geometry_pool.h"
+#include "render_target.h"
+#include "headless.h"
+#include "gpu_timer.h"
+#include "render_counters.h"
+#include "hitch_watchdog.h"
+#include "idle_mode.h"
+#include "ui_layer.h"
+#include "dynamic_resolution.h"
+#include "startup.h"
+#include "trace.h"
+#include "profiler.h"
+
+void BuildTriangles(GeometryPool& geometry);
+bool SaveTrace(const GpuTimer& gpu_timer, const char* path);
 
 void SetCallbacks(GLFWwindow* window);
 void InitializeOpenGL3();
 void PrintGPUInformation();
-bool InitializeOpenGLLoader();
+bool InitializeOpenGLLoader(bool headless);
+void ProcessInputUntil(GLFWwindow* window, FrameClock::time_point until, uint64_t tick, InputRecorder& recorder);
 
 #pragma endregion HEADERS
 
 #pragma region [rgba(20, 20, 100, 0.3)] MAIN
-int main(int, char**)
+int main(int argc, char** argv)
 {
-	// Setup window
-	if (!glfwInit())
+	// Tempo de cada etapa da inicialização e até o primeiro frame (veja
+	// startup.h).
+	StartupTimeline startup;
+
+	// "--record-input arquivo" grava os eventos de entrada de cada passo de
+	// simulação; "--replay-input arquivo" os reproduz. Veja input_events.h.
+	// "--pin-threads" fixa cada thread em um núcleo: a principal no 0, a de
+	// renderização no 1 e as do JobSystem nos demais. "--assert-no-alloc"
+	// encerra o programa se, passados os primeiros frames, algum frame fizer
+	// alocações no heap (veja allocators.h). "--headless" desenha sem janela
+	// "--frames N" frames (mais os de aquecimento) de tamanho "--size LxA",
+	// imprime as estatísticas em JSON e, com "--png arquivo", salva a imagem
+	// do último frame (veja headless.h); com "--trace arquivo", salva também
+	// o trace dos últimos frames (veja trace.h). "--counters-csv arquivo"
+	// grava os contadores de desenho de cada frame (veja render_counters.h).
+	// "--hitch-threshold X" muda o múltiplo da mediana a partir do qual um
+	// frame é considerado um travamento (veja hitch_watchdog.h). "--no-idle"
+	// desenha todos os frames, mesmo com a cena e a interface paradas (veja
+	// idle_mode.h). "--no-font-cache" rasteriza as fontes sem ler nem gravar
+	// o cache do atlas (veja font_cache.h). "--scene-objects N" acrescenta N
+	// objetos à cena, para testar o "Outliner" com cenas grandes (veja
+	// scene_outliner.h). "--low-latency" liga o modo de baixa latência (veja
+	// g_LowLatency em globals.h).
+	InputRecorder input_recorder;
+	HeadlessOptions headless;
+	bool pin_threads = false;
+	bool assert_no_alloc = false;
+	const char* counters_csv_path = NULL;
+	int scene_objects = 0;
+	for (int i = 1; i < argc; ++i)
 	{
-		fprintf(stderr, "ERROR: glfwInit() failed.\n");
-		std::exit(1);
+		if (strcmp(argv[i], "--pin-threads") == 0)
+			pin_threads = true;
+		else if (strcmp(argv[i], "--assert-no-alloc") == 0)
+			assert_no_alloc = true;
+		else if (strcmp(argv[i], "--headless") == 0)
+			headless.enabled = true;
+		else if (strcmp(argv[i], "--no-idle") == 0)
+			g_IdleMode = false;
+		else if (strcmp(argv[i], "--no-font-cache") == 0)
+			g_FontCache = false;
+		else if (strcmp(argv[i], "--low-latency") == 0)
+			g_LowLatency = true;
+		else if (i + 1 >= argc)
+			break;
+		else if (strcmp(argv[i], "--frames") == 0)
+			headless.frames = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--size") == 0)
+			sscanf(argv[i + 1], "%dx%d", &headless.width, &headless.height);
+		else if (strcmp(argv[i], "--png") == 0)
+			headless.png_path = argv[i + 1];
+		else if (strcmp(argv[i], "--trace") == 0)
+			headless.trace_path = argv[i + 1];
+		else if (strcmp(argv[i], "--counters-csv") == 0)
+			counters_csv_path = argv[i + 1];
+		else if (strcmp(argv[i], "--hitch-threshold") == 0)
+			g_HitchThreshold = (float)atof(argv[i + 1]);
+		else if (strcmp(argv[i], "--scene-objects") == 0)
+			scene_objects = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "--record-input") == 0)
+			input_recorder.OpenForRecording(argv[i + 1], g_SimulationHz);
+		else if (strcmp(argv[i], "--replay-input") == 0 && input_recorder.OpenForReplay(argv[i + 1]))
+			g_SimulationHz = (float)input_recorder.TicksPerSecond();
+	}
+
+	// Zonas do profiler de CPU desta thread (veja profiler.h).
+	PROFILE_REGISTER_THREAD(TRACE_THREAD_MAIN);
+
+	// Dados preenchidos pelas etapas da inicialização que rodam no JobSystem
+	// (veja abaixo). São declarados antes dele: se main() retornar com uma
+	// etapa em andamento, o JobSystem é destruído primeiro, e espera a
+	// etapa terminar.
+	JobCounter shaders_read, scene_built, fonts_built;
+	ShaderSource vertex_source, fragment_source;
+	bool shaders_ok = false;
+	TransformHierarchy transforms;
+	TransformId cube_transforms[3];
+	glm::vec3 cube_euler_angles(NAN, NAN, NAN); // ângulos do terceiro cubo
+	SceneIndex scene_index;
+
+  //Inicializa a Interface (Imgui)
+  Interface interface = new Interface(true);
+
+	// Threads de trabalho para o processamento paralelo de cada frame (veja
+	// job_system.h), criadas antes da janela para rodar também a
+	// inicialização.
+	const int RENDER_THREAD_CORE = 1;
+	JobSystem jobs(0, pin_threads, pin_threads ? RENDER_THREAD_CORE : -1);
+
+	// As etapas da inicialização que não usam o OpenGL rodam nas threads de
+	// trabalho enquanto esta thread cria a janela e o contexto:
+	//
+	//     leitura dos shaders  ->  compilação dos shaders
+	//     montagem da cena     ->  loop principal
+	//     atlas das fontes     ->  Interface::Init() e thread de renderização
+	//
+	// As que usam o OpenGL rodam nesta thread, que espera (executando tarefas
+	// pendentes; veja JobSystem::Wait()) apenas as etapas de que cada uma
+	// depende.
+	jobs.Run(&shaders_read, [&]() {
+		StartupStep step(startup, "Read shaders");
+		shaders_ok = ReadShaderSource("../src/shader_vertex.glsl", &vertex_source) &&
+			ReadShaderSource("../src/shader_fragment.glsl", &fragment_source);
+	});
+	jobs.Run(&scene_built, [&]() {
+		StartupStep step(startup, "Build scene");
+		// Criamos a hierarquia de transformações com as 3 cópias do cubo. Cada
+		// cópia possui uma matriz de modelagem independente, já que cada cópia
+		// estará em uma posição (rotação, escala, ...) diferente em relação ao
+		// espaço global (World Coordinates). Veja slide 138 do documento
+		// "Aula_08_Sistemas_de_Coordenadas.pdf".
+		// A primeira cópia do cubo não sofrerá nenhuma transformação de
+		// modelagem. Portanto, sua matriz "model" é a identidade.
+		cube_transforms[0] = transforms.Create();
+		// A segunda cópia do cubo sofrerá um escalamento não-uniforme, seguido de
+		// uma rotação no eixo (1,1,1), e uma translação em Z (nessa ordem!).
+		cube_transforms[1] = transforms.Create();
+		transforms.SetLocal(cube_transforms[1],
+			glm::vec3(0.0f, 0.0f, -2.0f),                                                 // TERCEIRO translação
+			glm::angleAxis(3.141592f / 8.0f, glm::normalize(glm::vec3(1.0f, 1.0f, 1.0f))), // SEGUNDO rotação
+			glm::vec3(2.0f, 0.5f, 0.5f));                                                 // PRIMEIRO escala
+		// A terceira cópia do cubo sofrerá rotações em X,Y e Z (nessa ordem)
+		// seguindo o sistema de ângulos de Euler, e após uma translação em X. A
+		// rotação é atualizada dentro do loop somente quando os ângulos mudam.
+		// Veja slide 62 do documento "Aula_07_Transformacoes_Geometricas_3D.pdf".
+		cube_transforms[2] = transforms.Create();
+		transforms.SetPosition(cube_transforms[2], glm::vec3(-2.0f, 0.0f, 0.0f));
+
+		// Nomes dos nós da hierarquia, mostrados no "Outliner" da interface
+		// (veja scene_outliner.h).
+		scene_index.Add(cube_transforms[0], INVALID_TRANSFORM, "Cube 1");
+		scene_index.Add(cube_transforms[1], INVALID_TRANSFORM, "Cube 2");
+		scene_index.Add(cube_transforms[2], INVALID_TRANSFORM, "Cube 3");
+		if (scene_objects > 0)
+		{
+			// Objetos extras, em grupos de até 1000 lado a lado no plano y = -1.5.
+			// Apenas o selecionado no "Outliner" é desenhado.
+			const int GROUP_SIZE = 1000;
+			const int num_groups = (scene_objects + GROUP_SIZE - 1) / GROUP_SIZE;
+			transforms.Reserve(transforms.Size() + scene_objects + num_groups);
+			scene_index.Reserve(transforms.Size() + scene_objects + num_groups, (size_t)(scene_objects + num_groups) * 16);
+			TransformId group = INVALID_TRANSFORM;
+			char name[32];
+			for (int i = 0; i < scene_objects; ++i)
+			{
+				int k = i % GROUP_SIZE;
+				if (k == 0)
+				{
+					int g = i / GROUP_SIZE;
+					group = transforms.Create();
+					transforms.SetPosition(group, glm::vec3(((g % 32) - 16) * 1.75f, -1.5f, ((g / 32) - 16) * 1.75f));
+					snprintf(name, sizeof(name), "Group %d", g);
+					scene_index.Add(group, INVALID_TRANSFORM, name);
+				}
+				TransformId object = transforms.Create(group);
+				transforms.SetLocal(object, glm::vec3((k % 32) * 0.05f, 0.0f, (k / 32) * 0.05f),
+					glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.04f));
+				snprintf(name, sizeof(name), "Object %d", i);
+				scene_index.Add(object, group, name);
+			}
+		}
+	});
+	if (!headless.enabled)
+	{
+		interface.CreateContext();
+		jobs.Run(&fonts_built, [&]() {
+			StartupStep step(startup, "Load fonts");
+			interface.LoadFonts();
+		});
 	}
 
 	// GL 3.0 + GLSL 130
 	const char* glsl_version = "#version 130";
-	InitializeOpenGL3();
+	GLFWwindow* window = NULL;
+	HeadlessContext headless_context;
+	FrameClock::time_point context_start = FrameClock::now();
+	if (headless.enabled)
+	{
+		// Sem janela: o contexto OpenGL é criado com EGL.
+		if (!headless_context.Create())
+			return 1;
+		g_ScreenRatio = (float)headless.width / (float)headless.height;
+	}
+	else
+	{
+		// Setup window
+		if (!glfwInit())
+		{
+			fprintf(stderr, "ERROR: glfwInit() failed.\n");
+			std::exit(1);
+		}
+		InitializeOpenGL3();
 
-	// Create window with graphics context
-	GLFWwindow* window = glfwCreateWindow(800, 800, "TCC - Guilherme", NULL, NULL);
-	if (window == NULL)
-		return 1;
+		// Create window with graphics context
+		window = glfwCreateWindow(800, 800, "TCC - Guilherme", NULL, NULL);
+		if (window == NULL)
+			return 1;
 
-	SetCallbacks(window);
-	glfwMakeContextCurrent(window);
-	glfwSwapInterval(1); // Enable vsync
+		SetCallbacks(window);
+		glfwMakeContextCurrent(window);
+		glfwSwapInterval(1); // Enable vsync
+	}
 
-	bool err = InitializeOpenGLLoader();
+	bool err = InitializeOpenGLLoader(headless.enabled);
 	if (err)
 	{
 		fprintf(stderr, "Failed to initialize OpenGL loader!\n");
 		return 1;
 	}
+	startup.Add(headless.enabled ? "Context" : "Window and context", context_start);
+
+	// No modo sem janela a saída padrão é reservada para o JSON.
+	if (!headless.enabled)
+		PrintGPUInformation();
+	std::string gpu_renderer = (const char*)glGetString(GL_RENDERER);
+
+	// Todos os objetos OpenGL pertencem ao gerenciador de recursos, que
+	// contabiliza a memória de GPU usada (veja gpu_resources.h).
+	GpuResourceManager gpu((size_t)g_GpuBudgetMiB << 20);
+
+	// Contadores das chamadas de desenho, trocas de estado e dados enviados
+	// para a GPU em cada frame; os envios feitos durante a inicialização
+	// entram no primeiro frame.
+	RenderCounters render_counters;
+	gpu.SetCounters(&render_counters);
+	Globals::g_RenderCounters = &render_counters;
+	if (counters_csv_path != NULL && !render_counters.OpenCsv(counters_csv_path))
+		return 1;
+	g_RecordCounters = render_counters.CsvOpen();
 
-	PrintGPUInformation();
-	GLuint vertex_shader_id = LoadShader_Vertex("../src/shader_vertex.glsl");
-	GLuint fragment_shader_id = LoadShader_Fragment("../src/shader_fragment.glsl");
+	// Os shaders são compilados assim que os arquivos foram lidos.
+	jobs.Wait(&shaders_read);
+	if (!shaders_ok)
+		return 1;
+	FrameClock::time_point compile_start = FrameClock::now();
+	GpuShader vertex_shader = gpu.AdoptShader("shader_vertex.glsl", LoadShader_Vertex(vertex_source));
+	GpuShader fragment_shader = gpu.AdoptShader("shader_fragment.glsl", LoadShader_Fragment(fragment_source));
 
 	// Criamos um programa de GPU utilizando os shaders carregados acima
-	GLuint program_id = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+	GpuProgram program = gpu.AdoptProgram("programa principal", CreateGpuProgram(vertex_shader.Id(), fragment_shader.Id()));
+	GLuint program_id = program.Id();
+	// Depois da linkagem os shaders não são mais necessários.
+	vertex_shader.Reset();
+	fragment_shader.Reset();
+	startup.Add("Compile shaders", compile_start);
+
+	// Toda a geometria da cena fica em buffers compartilhados, com um único
+	// VAO (veja geometry_pool.h). Os atributos são os de "shader_vertex.glsl":
+	// posição em "(location = 0)" e cor em "(location = 1)", ambas vec4.
+	const GeometryAttribute scene_vertex_format[] = {
+		{ 0, 4 }, // posição
+		{ 1, 4 }, // cor
+	};
+	FrameClock::time_point geometry_start = FrameClock::now();
+	GeometryPool geometry(gpu, "geometria da cena", scene_vertex_format, 2);
+
 	// Construímos a representação de um triângulo
-	GLuint vertex_array_object_id = BuildTriangles();
+	BuildTriangles(geometry);
+	startup.Add("Upload geometry", geometry_start);
+
+	// Sem janela, os frames são desenhados em um framebuffer fora da tela.
+	RenderTarget offscreen;
+	if (headless.enabled && !offscreen.Create(gpu, "headless", headless.width, headless.height))
+		return 1;
+
+	// Consultas de tempo da GPU, usadas pela thread de renderização para
+	// medir cada etapa do frame (veja gpu_timer.h).
+	GpuTimer gpu_timer;
+	gpu_timer.Init();
+	Globals::g_GpuTimer = &gpu_timer;
 
 	// Buscamos o endereço das variáveis definidas dentro do Vertex Shader.
 	// Utilizaremos estas variáveis para enviar dados para a placa de vídeo
@@ -75,6 +333,7 @@ int main(int, char**)
 	GLint view_uniform = glGetUniformLocation(program_id, "view"); // Variável da matriz "view" em shader_vertex.glsl
 	GLint projection_uniform = glGetUniformLocation(program_id, "projection"); // Variável da matriz "projection" em shader_vertex.glsl
 	GLint render_as_black_uniform = glGetUniformLocation(program_id, "render_as_black"); // Variável booleana em shader_vertex.glsl
+	GLint render_as_highlight_uniform = glGetUniformLocation(program_id, "render_as_highlight"); // Variável booleana em shader_vertex.glsl
 
 	// Habilitamos o Z-buffer. Veja slide 108 do documento "Aula_09_Projecoes.pdf".
 	glEnable(GL_DEPTH_TEST);
@@ -91,90 +350,299 @@ int main(int, char**)
 
 	glm::vec4 camera_position_c = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
 
-  //Inicializa a Interface (Imgui)
-  Interface interface = new Interface(true);
-  interface.Init(window, glsl_version);
+	// A posição da câmera é simulada com passo de tempo fixo (veja
+	// timestep.h): guardamos os dois últimos estados simulados e desenhamos
+	// uma interpolação entre eles. Assim a velocidade de movimento não
+	// depende da taxa de frames nem do modo de apresentação.
+	glm::vec4 previous_camera_position = camera_position_c;
+	glm::vec4 current_camera_position = camera_position_c;
+	const float camera_speed = 0.6f; // vetores "view" por segundo
+	float simulation_hz = g_SimulationHz;
+	FixedTimestep timestep(simulation_hz);
+	uint64_t simulation_tick = 0;
+
+  // Liga a ImGui à janela. A thread de renderização cria a textura das
+  // fontes ao iniciar, então o atlas precisa estar pronto.
+  jobs.Wait(&fonts_built);
+  if (!headless.enabled)
+    interface.Init(window, glsl_version);
 
 #pragma endregion MAIN
 
 #pragma region [rgba(50, 100, 100, 0.2)] DRAW_LOOP
+	// A partir daqui o contexto OpenGL pertence à thread de renderização
+	// (veja render_thread.h). Esta thread trata os eventos, roda a simulação
+	// e monta, a cada frame, um pacote com tudo o que deve ser desenhado;
+	// enquanto isso a thread de renderização envia o frame anterior para a GPU.
+	RenderResources render_resources;
+	render_resources.gpu = &gpu;
+	render_resources.program_id = program_id;
+	render_resources.geometry = &geometry;
+	render_resources.gpu_timer = &gpu_timer;
+	render_resources.counters = &render_counters;
+	render_resources.framebuffer = offscreen.Framebuffer(); // 0 (a janela) se não for headless
+	render_resources.model_uniform = model_uniform;
+	render_resources.view_uniform = view_uniform;
+	render_resources.projection_uniform = projection_uniform;
+	render_resources.render_as_black_uniform = render_as_black_uniform;
+	render_resources.render_as_highlight_uniform = render_as_highlight_uniform;
+	render_resources.cube_faces = Globals::g_VirtualScene["cube_faces"];
+	render_resources.cube_edges = Globals::g_VirtualScene["cube_edges"];
+	render_resources.axes = Globals::g_VirtualScene["axes"];
+
+	FrameClock::time_point render_thread_start = FrameClock::now();
+	RenderThread render_thread;
+	if (pin_threads)
+		render_thread.PinToCore(RENDER_THREAD_CORE);
+	if (headless.enabled)
+		render_thread.Start(&headless_context, render_resources);
+	else
+		render_thread.Start(window, render_resources, &interface);
+	startup.Add("Start render thread", render_thread_start);
+
+	// A interface rasteriza os glyphs que faltam nas threads de trabalho.
+	interface.SetJobSystem(&jobs);
+	// O loop começa com a cena pronta.
+	jobs.Wait(&scene_built);
+	interface.SetScene(&scene_index, &transforms);
+
+	// Nos primeiros frames containers ainda crescem até o tamanho de regime;
+	// depois disso o loop não deve alocar nada no heap.
+	const uint64_t ALLOCATION_WARMUP_FRAMES = 120;
+	uint64_t frame_index = 0;
+
+	// Sem janela, o loop termina após um número fixo de frames.
+	const int headless_total_frames = headless.warmup_frames + headless.frames;
+	FrameStatsRecorder frame_stats;
+	frame_stats.Reserve(headless.frames);
+
+	// Grava os frames muito mais lentos que a mediana, com o que aconteceu
+	// neles e nos anteriores, em um relatório da sessão.
+	HitchWatchdog hitch_watchdog;
+	uint64_t gpu_reloads_before = 0;
+
+	// Com a janela parada o loop dorme em vez de desenhar (veja idle_mode.h).
+	IdleMode idle;
+
+	// A interface é guardada em uma textura e só redesenhada quando muda
+	// (veja ui_layer.h).
+	UiRefreshPolicy ui_refresh;
+
+	// Escala da cena na janela "Viewport", ajustada pelo tempo de GPU dos
+	// frames (veja dynamic_resolution.h).
+	DynamicResolution dynamic_resolution;
+	interface.SetDynamicResolution(&dynamic_resolution);
+
 // Main loop
-	while (!glfwWindowShouldClose(window))
+	while (headless.enabled ? frame_index < (uint64_t)headless_total_frames : !glfwWindowShouldClose(window))
 	{
-		glClearColor(g_ClearColor.x, g_ClearColor.y, g_ClearColor.z, g_ClearColor.w);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// Nada mudou nos últimos frames: a janela continua mostrando o último
+		// e esperamos um evento. Ao acordar, o tempo dormido não é simulado.
+		if (!headless.enabled && g_IdleMode && idle.CanSleep())
+		{
+			bool redraw = idle.Wait(IdleMode::TIMEOUT_SECONDS);
+			g_IdleWakeups = (int)idle.Wakeups();
+			g_IdleSleptSeconds = (float)idle.SleptSeconds();
+			if (!redraw)
+				continue;
+			timestep.Reset();
+		}
+
+		PROFILE_SCOPE("Frame");
+		FrameClock::time_point frame_start = FrameClock::now();
+		HeapStats heap_at_start = GetHeapStats();
+		ShaderStats shaders_at_start = GetShaderStats();
+		jobs.BeginFrame();
+		// No modo de baixa latência a entrada só é lida depois que o frame
+		// anterior foi apresentado (e, com o limite de FPS, depois da espera
+		// dele): a thread principal deixa de montar um frame à frente.
+		float low_latency_wait_ms = 0.0f;
+		if (!headless.enabled && g_LowLatency)
+		{
+			PROFILE_SCOPE("Wait for present");
+			FrameClock::time_point wait_start = FrameClock::now();
+			render_thread.WaitIdle();
+			low_latency_wait_ms = std::chrono::duration<float, std::milli>(FrameClock::now() - wait_start).count();
+		}
 		// Poll and handle events (inputs, window resize, etc.)
 		// You can read the Globals::g_Io.WantCaptureMouse, Globals::g_Io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
 		// - When Globals::g_Io.WantCaptureMouse is true, do not dispatch mouse input data to your main application.
 		// - When Globals::g_Io.WantCaptureKeyboard is true, do not dispatch keyboard input data to your main application.
 		// Generally you may always pass all inputs to dear imgui, and hide them from your application based on those two flags.
-		glfwPollEvents();
-		// Pedimos para a GPU utilizar o programa de GPU criado acima (contendo
-		// os shaders de vértice e fragmentos).
-		glUseProgram(program_id);
-		// "Ligamos" o VAO. Informamos que queremos utilizar os atributos de
-		// vértices apontados pelo VAO criado pela função BuildTriangles(). Veja
-		// comentários detalhados dentro da definição de BuildTriangles().
-		glBindVertexArray(vertex_array_object_id);
-
-		// Computamos a posição da câmera utilizando coordenadas esféricas.  As
-		// variáveis g_CameraDistance, g_CameraPhi, e g_CameraTheta são
-		// controladas pelo mouse do usuário. Veja as funções CursorPosCallback()
-		// e ScrollCallback().
+		if (!headless.enabled)
+		{
+			PROFILE_SCOPE("glfwPollEvents");
+			glfwPollEvents();
+		}
+		FrameClock::time_point input_sampled = FrameClock::now();
+
+		// Aplicamos a frequência da simulação escolhida na interface.
+		if (simulation_hz != g_SimulationHz)
+		{
+			simulation_hz = g_SimulationHz;
+			timestep.SetTicksPerSecond(simulation_hz);
+		}
+
+		glm::vec4 camera_up_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f); // Vetor "up" fixado para apontar para o "céu" (eixo Y global)
+
+		if (headless.enabled)
+		{
+			// Caminho fixo da câmera, sem entrada do usuário e sem depender do
+			// relógio: toda execução desenha a mesma sequência de frames. A
+			// câmera fica a uma distância fixa da origem, olhando para ela.
+			CameraPathPoint point = HeadlessCameraPath((int)frame_index, headless_total_frames);
+			g_CameraTheta = point.theta;
+			g_CameraPhi = point.phi;
+			g_AngleY = point.cube_angle;
+			y = 2.0f * sin(g_CameraPhi);
+			z = 2.0f * cos(g_CameraPhi) * cos(g_CameraTheta);
+			x = 2.0f * cos(g_CameraPhi) * sin(g_CameraTheta);
+			current_camera_position = glm::vec4(-1.5f * x, 1.5f * y, -1.5f * z, 1.0f);
+			previous_camera_position = current_camera_position;
+		}
+
+		// Executamos quantos passos fixos de simulação couberem no tempo real
+		// decorrido desde o último frame, e interpolamos a posição desenhada.
+		g_SimulationSteps = headless.enabled ? 0 : timestep.Advance();
+		for (int step = 0; step < g_SimulationSteps; ++step)
+		{
+			PROFILE_SCOPE("Simulation step");
+			// Cada passo processa, em ordem, os eventos de entrada ocorridos
+			// até o seu fim (teclas, mouse e "rodinha"; veja callbacks.cpp).
+			ProcessInputUntil(window, timestep.StepEndTime(step), simulation_tick, input_recorder);
+			++simulation_tick;
+
+			// Computamos a posição da câmera utilizando coordenadas esféricas.  As
+			// variáveis g_CameraDistance, g_CameraPhi, e g_CameraTheta são
+			// controladas pelo mouse do usuário. Veja as funções CursorPosCallback()
+			// e ScrollCallback().
+			y = 2.0f * sin(g_CameraPhi);
+			z = 2.0f * cos(g_CameraPhi) * cos(g_CameraTheta);
+			x = 2.0f * cos(g_CameraPhi) * sin(g_CameraTheta);
+			glm::vec4 camera_view_vector = glm::vec4(x, -y, z, 0.0f);
+			glm::vec4 camera_right_vector = crossproduct(camera_view_vector, camera_up_vector);
+
+			previous_camera_position = current_camera_position;
+			float distance = camera_speed * (float)timestep.Dt();
+			if (WPressed)
+				current_camera_position += distance * camera_view_vector;
+			if (SPressed)
+				current_camera_position -= distance * camera_view_vector;
+			if (APressed)
+				current_camera_position -= distance * camera_right_vector;
+			if (DPressed)
+				current_camera_position += distance * camera_right_vector;
+		}
+		g_SimulationAlpha = timestep.Alpha();
+		camera_position_c = glm::mix(previous_camera_position, current_camera_position, g_SimulationAlpha);
+
+		// Abaixo definimos as variáveis que efetivamente definem a câmera virtual.
+		// Veja slide 165 do documento "Aula_08_Sistemas_de_Coordenadas.pdf".
+		// O ponto "l", para onde a câmera (look-at) estará sempre olhando, é
+		// (x, -y, z) a partir da posição da câmera; logo o vetor "view" não
+		// depende da posição.
 		y = 2.0f * sin(g_CameraPhi);
 		z = 2.0f * cos(g_CameraPhi) * cos(g_CameraTheta);
 		x = 2.0f * cos(g_CameraPhi) * sin(g_CameraTheta);
-		// Abaixo definimos as variáveis que efetivamente definem a câmera virtual.
-		// Veja slide 165 do documento "Aula_08_Sistemas_de_Coordenadas.pdf".
-		glm::vec4 camera_lookat_l = glm::vec4(x + camera_position_c.x, -y + camera_position_c.y, z + camera_position_c.z, 1.0f); // Ponto "l", para onde a câmera (look-at) estará sempre olhando
-		glm::vec4 camera_view_vector = camera_lookat_l - camera_position_c; // Vetor "view", sentido para onde a câmera está virada
-		glm::vec4 camera_up_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f); // Vetor "up" fixado para apontar para o "céu" (eixo Y global)
-		glm::vec4 camera_right_vector = crossproduct(camera_view_vector, camera_up_vector);
-		if (WPressed)
-			camera_position_c += 0.01f * camera_view_vector;
-		if (SPressed)
-			camera_position_c -= 0.01f * camera_view_vector;
-		if (APressed)
-			camera_position_c -= 0.01f * camera_right_vector;
-		if (DPressed)
-			camera_position_c += 0.01f * camera_right_vector;
-
-		// Computamos a matriz "View" utilizando os parâmetros da câmera para
-		// definir o sistema de coordenadas da câmera.  Veja slide 169 do
-		// documento "Aula_08_Sistemas_de_Coordenadas.pdf".
-		glm::mat4 view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
-		// Agora computamos a matriz de Projeção.
+		glm::vec4 camera_view_vector = glm::vec4(x, -y, z, 0.0f); // Vetor "view", sentido para onde a câmera está virada
+
+		// Com a janela "Viewport", a proporção da imagem é a da janela, com o
+		// tamanho do frame anterior (a interface deste frame ainda não foi
+		// montada).
+		SceneViewportLayout viewport_layout;
+		float screen_ratio = g_ScreenRatio;
+		if (!headless.enabled && interface.ViewportLayout(&viewport_layout))
+			screen_ratio = (float)viewport_layout.display_width / (float)viewport_layout.display_height;
+
+		glm::mat4 view;
 		glm::mat4 projection;
-		// Note que, no sistema de coordenadas da câmera, os planos near e far
-		// estáo no sentido negativo! Veja slides 198-200 do documento
-		// "Aula_09_Projecoes.pdf".
-		if (g_UsePerspectiveProjection)
 		{
-			// Projeção Perspectiva.
-			// Para definição do field of view (FOV), veja slide 234 do
-			// documento "Aula_09_Projecoes.pdf".
-			float field_of_view = 3.141592 / 3.0f;
-			projection = Matrix_Perspective(field_of_view, g_ScreenRatio, g_FrustumNearPlane, g_FrustumFarPlane);
+			PROFILE_SCOPE("Build matrices");
+			// Computamos a matriz "View" utilizando os parâmetros da câmera para
+			// definir o sistema de coordenadas da câmera.  Veja slide 169 do
+			// documento "Aula_08_Sistemas_de_Coordenadas.pdf".
+			view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
+			// Agora computamos a matriz de Projeção.
+			// Note que, no sistema de coordenadas da câmera, os planos near e far
+			// estáo no sentido negativo! Veja slides 198-200 do documento
+			// "Aula_09_Projecoes.pdf".
+			if (g_UsePerspectiveProjection)
+			{
+				// Projeção Perspectiva.
+				// Para definição do field of view (FOV), veja slide 234 do
+				// documento "Aula_09_Projecoes.pdf".
+				float field_of_view = 3.141592 / 3.0f;
+				projection = Matrix_Perspective(field_of_view, screen_ratio, g_FrustumNearPlane, g_FrustumFarPlane);
+			}
+			else
+			{
+				// Projeção Ortográfica.
+				// Para definição dos valores l, r, b, t ("left", "right", "bottom", "top"),
+				// veja slide 243 do documento "Aula_09_Projecoes.pdf".
+				// Para simular um "zoom" ortográfico, computamos o valor de "t"
+				// utilizando a variável g_CameraDistance.
+				float t = 1.5f * g_CameraDistance / 2.5f;
+				float b = -t;
+				float r = t * screen_ratio;
+				float l = -r;
+				projection = Matrix_Orthographic(l, r, b, t, g_FrustumNearPlane, g_FrustumFarPlane);
+			}
 		}
-		else
+
+		// Atualizamos a rotação de Euler do terceiro cubo somente se algum dos
+		// ângulos mudou, e recalculamos as matrizes que ficaram desatualizadas.
+		if (cube_euler_angles != glm::vec3(g_AngleX, g_AngleY, g_AngleZ))
 		{
-			// Projeção Ortográfica.
-			// Para definição dos valores l, r, b, t ("left", "right", "bottom", "top"),
-			// veja slide 243 do documento "Aula_09_Projecoes.pdf".
-			// Para simular um "zoom" ortográfico, computamos o valor de "t"
-			// utilizando a variável g_CameraDistance.
-			float t = 1.5f * g_CameraDistance / 2.5f;
-			float b = -t;
-			float r = t * g_ScreenRatio;
-			float l = -r;
-			projection = Matrix_Orthographic(l, r, b, t, g_FrustumNearPlane, g_FrustumFarPlane);
+			cube_euler_angles = glm::vec3(g_AngleX, g_AngleY, g_AngleZ);
+			transforms.SetRotation(cube_transforms[2],
+				glm::angleAxis(g_AngleZ, glm::vec3(0.0f, 0.0f, 1.0f))    // TERCEIRO rotação Z de Euler
+				* glm::angleAxis(g_AngleY, glm::vec3(0.0f, 1.0f, 0.0f))  // SEGUNDO rotação Y de Euler
+				* glm::angleAxis(g_AngleX, glm::vec3(1.0f, 0.0f, 0.0f))); // PRIMEIRO rotação X de Euler
 		}
+		transforms.Update(&jobs);
 
-		// Enviamos as matrizes "view" e "projection" para a placa de vídeo
-		// (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
-		// efetivamente aplicadas em todos os pontos.
-		glUniformMatrix4fv(view_uniform, 1, GL_FALSE, glm::value_ptr(view));
-		glUniformMatrix4fv(projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+		// A escala deste frame vem do último frame cujo tempo de GPU já
+		// chegou (alguns frames atrás; veja GpuTimer::LATENCY).
+		dynamic_resolution.SetTarget(g_ResolutionTargetMs, g_ResolutionMinScale, g_ResolutionMaxScale);
+		if (!headless.enabled && g_DynamicResolution)
+		{
+			GpuFrameTimings gpu_frame;
+			if (gpu_timer.LatestFrame(&gpu_frame))
+				dynamic_resolution.Update(gpu_frame.frame, gpu_frame.FrameMs());
+		}
+		else
+			dynamic_resolution.Reset();
+
+		// Montamos a interface. Apenas os comandos de desenho da ImGui são
+		// gerados aqui; eles são copiados para o pacote do frame abaixo.
+		if (!headless.enabled)
+			interface.Show(window);
+
+		// Esperamos a thread de renderização pegar o pacote anterior, e
+		// preenchemos o pacote deste frame.
+		FramePacket& packet = render_thread.BeginFrame();
+		packet.view = view;
+		packet.projection = projection;
+		packet.clear_color = g_ClearColor;
+		if (headless.enabled)
+		{
+			packet.framebuffer_width = headless.width;
+			packet.framebuffer_height = headless.height;
+		}
+		else
+			glfwGetFramebufferSize(window, &packet.framebuffer_width, &packet.framebuffer_height);
+		packet.present_mode = headless.enabled ? PRESENT_UNCAPPED : g_PresentMode;
+		packet.throttle_fps = g_ThrottleFPS;
+		packet.lean_ui_renderer = g_LeanUiRenderer;
+		// A imagem da cena faz parte da interface: a camada guardada a
+		// congelaria.
+		packet.scene_viewport = !headless.enabled && interface.ViewportLayout(&packet.viewport);
+		packet.ui_cache = !headless.enabled && g_UiCache && g_LeanUiRenderer && !packet.scene_viewport;
+		packet.ui_redraw = false;
+		const TransformId selected_object = headless.enabled ? INVALID_TRANSFORM : interface.SelectedObject();
+		packet.glyph_upload.width = 0;
+		if (!headless.enabled)
+			interface.TakeGlyphUpload(packet.glyph_upload);
 
 		// Vamos desenhar 3 instâncias (cópias) do cubo
 		for (int i = 1; i <= 3; ++i)
@@ -183,139 +651,90 @@ int main(int, char**)
 			// já que cada cópia estará em uma posição (rotação, escala, ...)
 			// diferente em relação ao espaço global (World Coordinates). Veja
 			// slide 138 do documento "Aula_08_Sistemas_de_Coordenadas.pdf".
-			glm::mat4 model;
-			if (i == 1)
-			{
-				// A primeira cópia do cubo não sofrerá nenhuma transformação
-				// de modelagem. Portanto, sua matriz "model" é a identidade, e
-				// suas coordenadas no espaço global (World Coordinates) seráo
-				// *exatamente iguais* a suas coordenadas no espaço do modelo
-				// (Model Coordinates).
-				model = Matrix_Identity();
-			}
-			else if (i == 2)
-			{
-				// A segunda cópia do cubo sofrerá um escalamento não-uniforme,
-				// seguido de uma rotação no eixo (1,1,1), e uma translação em Z (nessa ordem!).
-				model = Matrix_Translate(0.0f, 0.0f, -2.0f) // TERCEIRO translação
-					* Matrix_Rotate(3.141592f / 8.0f, glm::vec4(1.0f, 1.0f, 1.0f, 0.0f)) // SEGUNDO rotação
-					* Matrix_Scale(2.0f, 0.5f, 0.5f); // PRIMEIRO escala
-			}
-			else if (i == 3)
+			// As matrizes de cada cópia são mantidas pela hierarquia de
+			// transformações (veja a criação de cube_transforms acima) e só são
+			// recalculadas quando a transformação da cópia muda.
+			DrawItem item;
+			item.model = transforms.World(cube_transforms[i - 1]);
+			// Cada cubo é desenhado com suas faces, os eixos do seu sistema de
+			// coordenadas (com linhas de 4 pixels) e suas arestas pretas.
+			item.flags = DRAW_FACES | DRAW_AXES | DRAW_EDGES;
+			item.axes_line_width = 4.0f;
+			if (cube_transforms[i - 1] == selected_object)
+				item.flags |= DRAW_HIGHLIGHT;
+			if (i == 3)
 			{
-				// A terceira cópia do cubo sofrerá rotações em X,Y e Z (nessa
-				// ordem) seguindo o sistema de ângulos de Euler, e após uma
-				// translação em X. Veja slide 62 do documento
-				// "Aula_07_Transformacoes_Geometricas_3D.pdf".
-				model = Matrix_Translate(-2.0f, 0.0f, 0.0f) // QUARTO translação
-					* Matrix_Rotate_Z(g_AngleZ)  // TERCEIRO rotação Z de Euler
-					* Matrix_Rotate_Y(g_AngleY)  // SEGUNDO rotação Y de Euler
-					* Matrix_Rotate_X(g_AngleX); // PRIMEIRO rotação X de Euler
-			  // Armazenamos as matrizes model, view, e projection do terceiro cubo
-			  // para mostrar elas na tela através da função TextRendering_ShowModelViewProjection().
-				the_model = model;
+				// Armazenamos as matrizes model, view, e projection do terceiro cubo
+				// para mostrar elas na tela através da função TextRendering_ShowModelViewProjection().
+				the_model = item.model;
 				the_projection = projection;
 				the_view = view;
+				// Desenhamos um ponto em cima do terceiro vértice do terceiro cubo.
+				item.flags |= DRAW_VERTEX_MARKER;
 			}
+			packet.draw_list.push_back(item);
+		}
 
-			// Enviamos a matriz "model" para a placa de vídeo (GPU). Veja o
-			// arquivo "shader_vertex.glsl", onde esta é efetivamente
-			// aplicada em todos os pontos.
-			glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-			// Informamos para a placa de vídeo (GPU) que a variável booleana
-			// "render_as_black" deve ser colocada como "false". Veja o arquivo
-			// "shader_vertex.glsl".
-			glUniform1i(render_as_black_uniform, false);
-			// Pedimos para a GPU rasterizar os vértices do cubo apontados pelo
-			// VAO como triângulos, formando as faces do cubo. Esta
-			// renderização irá executar o Vertex Shader definido no arquivo
-			// "shader_vertex.glsl", e o mesmo irá utilizar as matrizes
-			// "model", "view" e "projection" definidas acima e já enviadas
-			// para a placa de vídeo (GPU).
-			//
-			// Veja a definição de Globals::g_VirtualScene["cube_faces"] dentro da
-			// função BuildTriangles(), e veja a documentação da função
-			// glDrawElements() em http://docs.gl/gl3/glDrawElements.
-			glDrawElements(
-				Globals::g_VirtualScene["cube_faces"].rendering_mode, // Veja slide 178 do documento "Aula_04_Modelagem_Geometrica_3D.pdf".
-				Globals::g_VirtualScene["cube_faces"].num_indices,    //
-				GL_UNSIGNED_INT,
-				(void*)Globals::g_VirtualScene["cube_faces"].first_index
-			);
-
-			// Pedimos para OpenGL desenhar linhas com largura de 4 pixels.
-			glLineWidth(4.0f);
-			// Pedimos para a GPU rasterizar os vértices dos eixos XYZ
-			// apontados pelo VAO como linhas. Veja a definição de
-			// Globals::g_VirtualScene["axes"] dentro da função BuildTriangles(), e veja
-			// a documentação da função glDrawElements() em
-			// http://docs.gl/gl3/glDrawElements.
-			//
-			// Importante: estes eixos seráo desenhamos com a matriz "model"
-			// definida acima, e portanto sofreráo as mesmas transformações
-			// geométricas que o cubo. Isto é, estes eixos estaráo
-			// representando o sistema de coordenadas do modelo (e não o global)!
-			glDrawElements(
-				Globals::g_VirtualScene["axes"].rendering_mode,
-				Globals::g_VirtualScene["axes"].num_indices,
-				GL_UNSIGNED_INT,
-				(void*)Globals::g_VirtualScene["axes"].first_index
-			);
-
-			// Informamos para a placa de vídeo (GPU) que a variável booleana
-			// "render_as_black" deve ser colocada como "true". Veja o arquivo
-			// "shader_vertex.glsl".
-			glUniform1i(render_as_black_uniform, true);
-			// Pedimos para a GPU rasterizar os vértices do cubo apontados pelo
-			// VAO como linhas, formando as arestas pretas do cubo. Veja a
-			// definição de Globals::g_VirtualScene["cube_edges"] dentro da função
-			// BuildTriangles(), e veja a documentação da função
-			// glDrawElements() em http://docs.gl/gl3/glDrawElements.
-			glDrawElements(
-				Globals::g_VirtualScene["cube_edges"].rendering_mode,
-				Globals::g_VirtualScene["cube_edges"].num_indices,
-				GL_UNSIGNED_INT,
-				(void*)Globals::g_VirtualScene["cube_edges"].first_index
-			);
-			// Desenhamos um ponto de tamanho 15 pixels em cima do terceiro vértice
-			// do terceiro cubo. Este vértice tem coordenada de modelo igual é
-			// (0.5, 0.5, 0.5, 1.0).
-			if (i == 3)
-			{
-				glPointSize(15.0f);
-				glDrawArrays(GL_POINTS, 3, 1);
-			}
+		// Agora queremos desenhar os eixos XYZ de coordenadas GLOBAIS, com
+		// linhas de 10 pixels. Para tanto, colocamos a matriz de modelagem
+		// igual é identidade. Veja slide 134 do documento
+		// "Aula_08_Sistemas_de_Coordenadas.pdf".
+		// Matriz constante, calculada em tempo de compilação (veja matrices.h).
+		constexpr glm::mat4 model = Matrix_Identity();
+		DrawItem axes;
+		axes.model = model;
+		axes.flags = DRAW_AXES;
+		axes.axes_line_width = 10.0f;
+		packet.draw_list.push_back(axes);
+
+		// Um objeto extra selecionado no "Outliner" é desenhado destacado.
+		if (selected_object != INVALID_TRANSFORM && selected_object != cube_transforms[0] &&
+			selected_object != cube_transforms[1] && selected_object != cube_transforms[2])
+		{
+			DrawItem selected;
+			selected.model = transforms.World(selected_object);
+			selected.flags = DRAW_FACES | DRAW_EDGES | DRAW_HIGHLIGHT;
+			selected.axes_line_width = 4.0f;
+			packet.draw_list.push_back(selected);
+		}
+
+		if (packet.ui_cache)
+		{
+			// Os comandos da interface só são copiados quando a camada vai
+			// ser redesenhada; nos outros frames ela é apenas composta.
+			bool interacting = false;
+			uint64_t interaction = interface.Interaction(&interacting);
+			packet.ui_redraw = ui_refresh.Update(ImGui::GetDrawData(), interaction, interacting,
+				packet.framebuffer_width, packet.framebuffer_height, g_UiLiveRefreshHz);
+			g_UiRedraws = (int)ui_refresh.Redraws();
+			if (packet.ui_redraw)
+				packet.ui.Capture(ImGui::GetDrawData());
+		}
+		else
+		{
+			ui_refresh.Invalidate();
+			if (!headless.enabled)
+				packet.ui.Capture(ImGui::GetDrawData());
 		}
 
-		// Agora queremos desenhar os eixos XYZ de coordenadas GLOBAIS.
-		// Para tanto, colocamos a matriz de modelagem igual é identidade.
-		// Veja slide 134 do documento "Aula_08_Sistemas_de_Coordenadas.pdf".
-		glm::mat4 model = Matrix_Identity();
-		// Enviamos a nova matriz "model" para a placa de vídeo (GPU). Veja o
-		// arquivo "shader_vertex.glsl".
-		glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-		// Pedimos para OpenGL desenhar linhas com largura de 10 pixels.
-		glLineWidth(10.0f);
-		// Informamos para a placa de vídeo (GPU) que a variável booleana
-		// "render_as_black" deve ser colocada como "false". Veja o arquivo
-		// "shader_vertex.glsl".
-		glUniform1i(render_as_black_uniform, false);
-
-		// Pedimos para a GPU rasterizar os vértices dos eixos XYZ
-		// apontados pelo VAO como linhas. Veja a definição de
-		// Globals::g_VirtualScene["axes"] dentro da função BuildTriangles(), e veja
-		// a documentação da função glDrawElements() em
-		// http://docs.gl/gl3/glDrawElements.
-		glDrawElements(
-			Globals::g_VirtualScene["axes"].rendering_mode,
-			Globals::g_VirtualScene["axes"].num_indices,
-			GL_UNSIGNED_INT,
-			(void*)Globals::g_VirtualScene["axes"].first_index
-		);
-
-		// "Desligamos" o VAO, evitando assim que operações posteriores venham a
-		// alterar o mesmo. Isso evita bugs.
-		glBindVertexArray(0);
+		// Leitura tardia da entrada: os movimentos do mouse que chegaram
+		// enquanto o frame era montado já giram a câmera deste frame. Os
+		// eventos são gravados no passo seguinte, onde a reprodução os aplica
+		// (a simulação vê a mesma sequência).
+		if (!headless.enabled && g_LowLatency && !input_recorder.IsReplaying())
+		{
+			PROFILE_SCOPE("Late input");
+			glfwPollEvents();
+			input_sampled = FrameClock::now();
+			ProcessInputUntil(window, input_sampled, simulation_tick, input_recorder);
+			y = 2.0f * sin(g_CameraPhi);
+			z = 2.0f * cos(g_CameraPhi) * cos(g_CameraTheta);
+			x = 2.0f * cos(g_CameraPhi) * sin(g_CameraTheta);
+			packet.view = Matrix_Camera_View(camera_position_c, glm::vec4(x, -y, z, 0.0f), camera_up_vector);
+		}
+		packet.input_sampled = input_sampled;
+		packet.gpu_queue_depth = headless.enabled ? 0 : g_GpuQueueDepth;
+		render_thread.EndFrame();
 
 		// Pegamos um vértice com coordenadas de modelo (0.5, 0.5, 0.5, 1) e o
 		// passamos por todos os sistemas de coordenadas armazenados nas
@@ -323,22 +742,209 @@ int main(int, char**)
 		// as matrizes e pontos resultantes dessas transformações.
 		glm::vec4 p_model(0.5f, 0.5f, 0.5f, 1.0f);
 
-    interface.Show(window);
-    glfwSwapBuffers(window);
+		// Tempos de cada thread, mostrados na interface no próximo frame.
+		g_MainThreadWaitMs = render_thread.MainWaitMs() + low_latency_wait_ms;
+		g_MainThreadMs = std::chrono::duration<float, std::milli>(FrameClock::now() - frame_start).count() - g_MainThreadWaitMs;
+		g_RenderSubmitMs = render_thread.SubmitMs();
+		g_RenderSwapMs = render_thread.SwapMs();
+		g_RenderIdleMs = render_thread.IdleMs();
+		g_FrameIntervalMs = render_thread.FrameIntervalMs();
+		g_PacingJitterMs = render_thread.PacingJitterMs();
+		g_LatencyMs = render_thread.LatencyMs();
+		g_MaxLatencyMs = render_thread.MaxLatencyMs();
+
+		// O tempo até o primeiro frame é impresso assim que a thread de
+		// renderização o apresenta; no modo sem janela, vai para o JSON.
+		FrameClock::time_point first_present;
+		if (!headless.enabled && !startup.HasFirstFrame() && render_thread.FirstPresent(&first_present))
+		{
+			startup.SetFirstFrame(first_present);
+			startup.Print(stdout);
+		}
+
+		// Memória de GPU, contabilizada pela thread de renderização.
+		gpu.SetBudget((size_t)g_GpuBudgetMiB << 20);
+		GpuMemoryStats gpu_stats = gpu.Stats();
+		g_GpuBufferKiB = (float)gpu_stats.bytes[GPU_BUFFER] / 1024.0f;
+		g_GpuTextureKiB = (float)gpu_stats.bytes[GPU_TEXTURE] / 1024.0f;
+		g_GpuEvictions = (int)gpu_stats.evictions;
+		g_GpuReloads = (int)gpu_stats.reloads;
+		GeometryPoolStats geometry_stats = geometry.Stats();
+		g_GeometryUsedKiB = (float)geometry_stats.bytes_used / 1024.0f;
+		g_GeometryCapacityKiB = (float)geometry_stats.bytes_capacity / 1024.0f;
+		g_GeometryFragmentation = std::max(geometry_stats.vertex_fragmentation, geometry_stats.index_fragmentation);
+		g_GeometryMovedKiB = (float)geometry_stats.bytes_moved / 1024.0f;
+
+		// Trace pedido pela interface, com um nome baseado na data e hora.
+		if (g_SaveTrace)
+		{
+			g_SaveTrace = false;
+			char trace_path[64];
+			time_t now = time(NULL);
+			strftime(trace_path, sizeof(trace_path), "trace_%Y%m%d_%H%M%S.json", localtime(&now));
+			if (SaveTrace(gpu_timer, trace_path))
+				fprintf(stderr, "Trace saved to \"%s\".\n", trace_path);
+		}
+
+		// Gravação dos contadores ligada ou desligada pela interface.
+		if (g_RecordCounters != render_counters.CsvOpen())
+		{
+			if (g_RecordCounters)
+			{
+				char csv_path[64];
+				time_t now = time(NULL);
+				strftime(csv_path, sizeof(csv_path), "counters_%Y%m%d_%H%M%S.csv", localtime(&now));
+				g_RecordCounters = render_counters.OpenCsv(csv_path);
+				if (g_RecordCounters)
+					fprintf(stderr, "Recording counters to \"%s\".\n", csv_path);
+			}
+			else
+				render_counters.CloseCsv();
+		}
+
+		// Alocações no heap durante o frame, de todas as threads.
+		HeapStats heap_at_end = GetHeapStats();
+		g_FrameHeapAllocations = (int)(heap_at_end.allocations - heap_at_start.allocations);
+		g_FrameHeapKiB = (float)(heap_at_end.bytes_allocated - heap_at_start.bytes_allocated) / 1024.0f;
+		++frame_index;
+		if (assert_no_alloc && frame_index > ALLOCATION_WARMUP_FRAMES && g_FrameHeapAllocations != 0)
+		{
+			fprintf(stderr, "ERROR: %d heap allocations (%.1f KiB) in frame %llu.\n",
+				g_FrameHeapAllocations, g_FrameHeapKiB, (unsigned long long)frame_index);
+			std::abort();
+		}
+
+		// Tempo total do frame, de início a início: com a thread de
+		// renderização um frame atrás, é o inverso da taxa de frames.
+		float frame_ms = std::chrono::duration<float, std::milli>(FrameClock::now() - frame_start).count();
+		if (headless.enabled && frame_index > (uint64_t)headless.warmup_frames)
+			frame_stats.Add(frame_ms, (uint32_t)render_counters.Last(COUNTER_DRAW_CALLS),
+				(uint32_t)render_counters.Last(COUNTER_TRIANGLES));
+
+		// Recolhe as zonas do profiler de todas as threads.
+		PROFILE_END_FRAME();
+
+		// Depois de PROFILE_END_FRAME(), para que as zonas deste frame já
+		// estejam no histórico do profiler.
+		ShaderStats shaders_at_end = GetShaderStats();
+		HitchFrameInfo hitch_info;
+		hitch_info.frame = frame_index;
+		hitch_info.frame_ms = frame_ms;
+		hitch_info.main_ms = g_MainThreadMs;
+		hitch_info.main_wait_ms = g_MainThreadWaitMs;
+		hitch_info.render_submit_ms = g_RenderSubmitMs;
+		hitch_info.render_swap_ms = g_RenderSwapMs;
+		hitch_info.heap_allocations = g_FrameHeapAllocations;
+		hitch_info.heap_kib = g_FrameHeapKiB;
+		hitch_info.shaders_compiled = (uint32_t)(shaders_at_end.shaders_compiled - shaders_at_start.shaders_compiled);
+		hitch_info.programs_linked = (uint32_t)(shaders_at_end.programs_linked - shaders_at_start.programs_linked);
+		hitch_info.gpu_reloads = (uint32_t)(gpu_stats.reloads - gpu_reloads_before);
+		gpu_reloads_before = gpu_stats.reloads;
+		hitch_watchdog.SetThreshold(g_HitchThreshold);
+		hitch_watchdog.EndFrame(hitch_info, gpu_timer, render_counters);
+		g_HitchCount = (int)hitch_watchdog.Hitches();
+		g_FrameMedianMs = hitch_watchdog.MedianMs();
+
+		// Atividade que exige o próximo frame mesmo sem novos eventos: a
+		// câmera andando (ou ainda interpolando entre dois passos), eventos
+		// ainda não consumidos pela simulação, uma reprodução de entrada ou
+		// um widget da interface em uso.
+		bool camera_moving = WPressed || SPressed || APressed || DPressed ||
+			previous_camera_position != current_camera_position;
+		idle.EndFrame(camera_moving || g_InputQueue.Size() > 0 || input_recorder.IsReplaying() ||
+			(!headless.enabled && interface.WantsRedraw()));
 	}
 
+	int exit_code = 0;
+	if (headless.enabled)
+	{
+		// O último pacote precisa ser desenhado antes de lermos a imagem.
+		render_thread.WaitIdle();
+		FrameClock::time_point first_present;
+		if (render_thread.FirstPresent(&first_present))
+		{
+			startup.SetFirstFrame(first_present);
+			frame_stats.SetTimeToFirstFrame(startup.FirstFrameMs());
+		}
+		hitch_watchdog.Flush(gpu_timer, render_counters);
+		render_thread.Stop();
+		GpuTimerSummary gpu_summary = gpu_timer.Summary();
+		frame_stats.WriteJson(stdout, gpu_renderer.c_str(), headless.width, headless.height, headless.warmup_frames, &gpu_summary);
+		if (headless.trace_path != NULL && !SaveTrace(gpu_timer, headless.trace_path))
+			exit_code = 1;
+		if (headless.png_path != NULL)
+		{
+			std::vector<unsigned char> pixels;
+			offscreen.ReadPixels(pixels);
+			if (!WritePng(headless.png_path, headless.width, headless.height, pixels.data()))
+				exit_code = 1;
+		}
+		gpu_timer.Shutdown();
+		gpu.Shutdown();
+		headless_context.Destroy();
+		return exit_code;
+	}
+
+	hitch_watchdog.Flush(gpu_timer, render_counters);
+	render_thread.Stop();
+	gpu_timer.Shutdown();
+	gpu.Shutdown();
   interface.CleanUp();
 	glfwDestroyWindow(window);
 	glfwTerminate();
-	return 0;
+	return exit_code;
 }
 #pragma endregion DRAW_LOOP
 
 #pragma region [rgba(50, 100, 30, 0.2)] FUNCTIONS
 /*
-Constrói triângulos para renderização
+Processa os eventos de entrada ocorridos até o instante "until", gravando-os
+em "recorder" se necessário. Durante uma reprodução, os eventos gravados para
+o passo "tick" substituem a entrada do usuário.
+*/
+void ProcessInputUntil(GLFWwindow* window, FrameClock::time_point until, uint64_t tick, InputRecorder& recorder)
+{
+	if (recorder.IsReplaying())
+	{
+		while (g_InputQueue.Peek() != NULL)
+			g_InputQueue.Pop();
+		InputEvent event;
+		while (recorder.Read(tick, event))
+			ProcessInputEvent(window, event);
+		return;
+	}
+
+	int64_t limit = InputTimestamp(until);
+	for (const InputEvent* event = g_InputQueue.Peek(); event != NULL && event->time_ns <= limit; event = g_InputQueue.Peek())
+	{
+		recorder.Write(tick, *event);
+		ProcessInputEvent(window, *event);
+		g_InputQueue.Pop();
+	}
+}
+
+/*
+Salva em "path" um trace no formato do Chrome (veja trace.h) com os últimos
+frames guardados pelo GpuTimer (as etapas medidas na GPU e os intervalos de
+envio e apresentação da thread de renderização) e, se o profiler estiver
+habilitado, as zonas de CPU de todas as threads (veja profiler.h).
 */
-GLuint BuildTriangles()
+bool SaveTrace(const GpuTimer& gpu_timer, const char* path)
+{
+	std::vector<TraceEvent> events;
+	events.reserve(GpuTimer::HISTORY * (3 + GPU_PASS_COUNT));
+	gpu_timer.AppendTraceEvents(events);
+#ifdef TCC_ENABLE_PROFILER
+	Profiler::AppendTraceEvents(events);
+#endif
+	return WriteChromeTrace(path, events);
+}
+
+/*
+Constrói triângulos para renderização, em uma faixa de vértices e índices do
+GeometryPool da cena (veja geometry_pool.h)
+*/
+void BuildTriangles(GeometryPool& geometry)
 {
 	// Primeiro, definimos os atributos de cada vértice.
 
@@ -378,73 +984,28 @@ GLuint BuildTriangles()
 			 0.0f,  0.0f,  1.0f, 1.0f, // posição do vértice 13
 	};
 
-	// Criamos o identificador (ID) de um Vertex Buffer Object (VBO).  Um VBO é
+	// Os vértices são guardados em Vertex Buffer Objects (VBOs). Um VBO é
 	// um buffer de memória que irá conter os valores de um certo atributo de
 	// um conjunto de vértices; por exemplo: posição, cor, normais, coordenadas
 	// de textura.  Neste exemplo utilizaremos vários VBOs, um para cada tipo de atributo.
-	// Agora criamos um VBO para armazenarmos um atributo: posição.
-	GLuint VBO_model_coefficients_id;
-	glGenBuffers(1, &VBO_model_coefficients_id);
-
-	// Criamos o identificador (ID) de um Vertex Array Object (VAO).  Um VAO
-	// contém a definição de vários atributos de um certo conjunto de vértices;
-	// isto é, um VAO irá conter ponteiros para vários VBOs.
-	GLuint vertex_array_object_id;
-	glGenVertexArrays(1, &vertex_array_object_id);
-
-	// "Ligamos" o VAO ("bind"). Informamos que iremos atualizar o VAO cujo ID
-	// está contido na variável "vertex_array_object_id".
-	glBindVertexArray(vertex_array_object_id);
-
-	// "Ligamos" o VBO ("bind"). Informamos que o VBO cujo ID está contido na
-	// variável VBO_model_coefficients_id será modificado a seguir. A
-	// constante "GL_ARRAY_BUFFER" informa que esse buffer é de fato um VBO, e
-	// irá conter atributos de vértices.
-	glBindBuffer(GL_ARRAY_BUFFER, VBO_model_coefficients_id);
-
-	// Alocamos memória para o VBO "ligado" acima. Como queremos armazenar
-	// nesse VBO todos os valores contidos no array "model_coefficients", pedimos
-	// para alocar um número de bytes exatamente igual ao tamanho ("size")
-	// desse array. A constante "GL_STATIC_DRAW" dá uma dica para o driver da
-	// GPU sobre como utilizaremos os dados do VBO. Neste caso, estamos dizendo
-	// que não pretendemos alterar tais dados (são estáticos: "STATIC"), e
-	// também dizemos que tais dados seráo utilizados para renderizar ou
-	// desenhar ("DRAW").  Pense que:
 	//
-	//            glBufferData()  ==  malloc() do C  ==  new do C++.
+	// Em vez de criar VBOs só para este modelo, reservamos uma faixa de 14
+	// vértices e 66 índices nos VBOs grandes do GeometryPool, que são
+	// compartilhados por todos os modelos da cena. O pool também é dono do
+	// Vertex Array Object (VAO), que contém a definição dos atributos (a
+	// "location" de cada um em "shader_vertex.glsl" e sua dimensão) e
+	// ponteiros para os VBOs. Pense que:
 	//
-	glBufferData(GL_ARRAY_BUFFER, sizeof(model_coefficients), NULL, GL_STATIC_DRAW);
+	//            geometry.Allocate()  ==  malloc() do C  ==  new do C++.
+	//
+	GeometryRef mesh = geometry.Allocate(14, 66);
 
-	// Finalmente, copiamos os valores do array model_coefficients para dentro do
-	// VBO "ligado" acima.  Pense que:
+	// Copiamos os valores do array model_coefficients para dentro da faixa
+	// reservada no VBO do atributo 0 (posição).  Pense que:
 	//
-	//            glBufferSubData()  ==  memcpy() do C.
+	//            WriteVertices()  ==  glBufferSubData()  ==  memcpy() do C.
 	//
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(model_coefficients), model_coefficients);
-
-	// Precisamos então informar um índice de "local" ("location"), o qual será
-	// utilizado no shader "shader_vertex.glsl" para acessar os valores
-	// armazenados no VBO "ligado" acima. Também, informamos a dimensão (número de
-	// coeficientes) destes atributos. Como em nosso caso são pontos em coordenadas
-	// homogêneas, temos quatro coeficientes por vértice (X,Y,Z,W). Isso define
-	// um tipo de dado chamado de "vec4" em "shader_vertex.glsl": um vetor com
-	// quatro coeficientes. Finalmente, informamos que os dados estáo em ponto
-	// flutuante com 32 bits (GL_FLOAT).
-	// Esta função também informa que o VBO "ligado" acima em glBindBuffer()
-	// está dentro do VAO "ligado" acima por glBindVertexArray().
-	// Veja https://www.khronos.org/opengl/wiki/Vertex_Specification#Vertex_Buffer_Object
-	GLuint location = 0; // "(location = 0)" em "shader_vertex.glsl"
-	GLint  number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
-	glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-
-	// "Ativamos" os atributos. Informamos que os atributos com índice de local
-	// definido acima, na variável "location", deve ser utilizado durante o
-	// rendering.
-	glEnableVertexAttribArray(location);
-
-	// "Desligamos" o VBO, evitando assim que operações posteriores venham a
-	// alterar o mesmo. Isso evita bugs.
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	geometry.WriteVertices(mesh, 0, model_coefficients);
 
 	// Agora repetimos todos os passos acima para atribuir um novo atributo a
 	// cada vértice: uma cor (veja slide 137 do documento "Aula_04_Modelagem_Geometrica_3D.pdf").
@@ -472,16 +1033,7 @@ GLuint BuildTriangles()
 			0.0f, 0.0f, 1.0f, 1.0f, // cor do vértice 12
 			0.0f, 0.0f, 1.0f, 1.0f, // cor do vértice 13
 	};
-	GLuint VBO_color_coefficients_id;
-	glGenBuffers(1, &VBO_color_coefficients_id);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO_color_coefficients_id);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(color_coefficients), NULL, GL_STATIC_DRAW);
-	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(color_coefficients), color_coefficients);
-	location = 1; // "(location = 1)" em "shader_vertex.glsl"
-	number_of_dimensions = 4; // vec4 em "shader_vertex.glsl"
-	glVertexAttribPointer(location, number_of_dimensions, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(location);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	geometry.WriteVertices(mesh, 1, color_coefficients);
 
 	// Vamos então definir polígonos utilizando os vértices do array
 	// model_coefficients.
@@ -534,7 +1086,8 @@ GLuint BuildTriangles()
 	// coloridas do cubo.
 	SceneObject cube_faces;
 	cube_faces.name = "Cubo (faces coloridas)";
-	cube_faces.first_index = (void*)0; // Primeiro índice está em indices[0]
+	cube_faces.geometry = mesh;
+	cube_faces.first_index = 0;        // Primeiro índice está em indices[0]
 	cube_faces.num_indices = 36;       // último índice está em indices[35]; total de 36 índices.
 	cube_faces.rendering_mode = GL_TRIANGLES; // índices correspondem ao tipo de rasterização GL_TRIANGLES.
 
@@ -545,7 +1098,8 @@ GLuint BuildTriangles()
 	// pretas do cubo.
 	SceneObject cube_edges;
 	cube_edges.name = "Cubo (arestas pretas)";
-	cube_edges.first_index = (void*)(36 * sizeof(GLuint)); // Primeiro índice está em indices[36]
+	cube_edges.geometry = mesh;
+	cube_edges.first_index = 36; // Primeiro índice está em indices[36]
 	cube_edges.num_indices = 24; // último índice está em indices[59]; total de 24 índices.
 	cube_edges.rendering_mode = GL_LINES; // índices correspondem ao tipo de rasterização GL_LINES.
 
@@ -555,38 +1109,18 @@ GLuint BuildTriangles()
 	// Criamos um terceiro objeto virtual (SceneObject) que se refere aos eixos XYZ.
 	SceneObject axes;
 	axes.name = "Eixos XYZ";
-	axes.first_index = (void*)(60 * sizeof(GLuint)); // Primeiro índice está em indices[60]
+	axes.geometry = mesh;
+	axes.first_index = 60; // Primeiro índice está em indices[60]
 	axes.num_indices = 6; // último índice está em indices[65]; total de 6 índices.
 	axes.rendering_mode = GL_LINES; // índices correspondem ao tipo de rasterização GL_LINES.
 	Globals::g_VirtualScene["axes"] = axes;
 
-	// Criamos um buffer OpenGL para armazenar os índices acima
-	GLuint indices_id;
-	glGenBuffers(1, &indices_id);
-
-	// "Ligamos" o buffer. Note que o tipo agora é GL_ELEMENT_ARRAY_BUFFER.
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices_id);
-
-	// Alocamos memória para o buffer.
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), NULL, GL_STATIC_DRAW);
-
-	// Copiamos os valores do array indices[] para dentro do buffer.
-	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(indices), indices);
-
-	// NÃO faça a chamada abaixo! Diferente de um VBO (GL_ARRAY_BUFFER), um
-	// array de índices (GL_ELEMENT_ARRAY_BUFFER) não pode ser "desligado",
-	// caso contrário o VAO irá perder a informação sobre os índices.
-	//
-	// glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); // XXX Errado!
-	//
-
-	// "Desligamos" o VAO, evitando assim que operações posteriores venham a
-	// alterar o mesmo. Isso evita bugs.
-	glBindVertexArray(0);
-
-	// Retornamos o ID do VAO. Isso é tudo que será necessário para renderizar
-	// os triângulos definidos acima. Veja a chamada glDrawElements() em main().
-	return vertex_array_object_id;
+	// Copiamos os valores do array indices[] para dentro da faixa de índices
+	// reservada no buffer de índices (GL_ELEMENT_ARRAY_BUFFER) do pool. Os
+	// índices são relativos ao primeiro vértice da faixa: o deslocamento
+	// ("base vertex") é informado na hora de desenhar, em
+	// glDrawElementsBaseVertex(). Veja render_thread.cpp.
+	geometry.WriteIndices(mesh, indices);
 }
 
 /*
@@ -606,6 +1140,8 @@ void SetCallbacks(GLFWwindow* window) {
 	// redimensionada, por consequência alterando o tamanho do "framebuffer"
 	// (região de memória onde são armazenados os pixels da imagem).
 	glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+	// ... ou o conteúdo da janela precisar ser redesenhado.
+	glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
 	// Definimos o callback para impressão de erros da GLFW no terminal
 	glfwSetErrorCallback(ErrorCallback);
 
@@ -614,11 +1150,20 @@ void SetCallbacks(GLFWwindow* window) {
 /*
 Initialize OpenGL loader
 */
-bool InitializeOpenGLLoader() {
+bool InitializeOpenGLLoader(bool headless) {
 #if defined(IMGUI_IMPL_OPENGL_LOADER_GL3W)
 	return gl3wInit() != 0;
 #elif defined(IMGUI_IMPL_OPENGL_LOADER_GLEW)
-	return glewInit() != GLEW_OK;
+	// A GLEW compilada para GLX termina glewInit() carregando as extensões
+	// GLX, o que falha sem um display GLX atual. No modo sem janela o
+	// contexto é EGL (veja headless.h) e esse é o único erro esperado: as
+	// funções do OpenGL já foram carregadas antes dele.
+	GLenum status = glewInit();
+#if defined(GLEW_ERROR_NO_GLX_DISPLAY)
+	if (headless && status == GLEW_ERROR_NO_GLX_DISPLAY)
+		return false;
+#endif
+	return status != GLEW_OK;
 #elif defined(IMGUI_IMPL_OPENGL_LOADER_GLAD)
 	return gladLoadGL() == 0;
 #else
@@ -0,0 +1,484 @@
+#include "matrices_batch.h"
+
+#include <cmath>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BATCH_HAS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define BATCH_HAS_X86 0
+#endif
+
+// Em GCC/Clang cada kernel é compilado para seu conjunto de instruções
+// através de atributos, sem exigir -mavx2 para o programa inteiro. O MSVC
+// aceita qualquer intrinsic sem flags adicionais.
+#if BATCH_HAS_X86 && !defined(_MSC_VER)
+#define BATCH_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define BATCH_TARGET_AVX2  __attribute__((target("avx2,fma")))
+#else
+#define BATCH_TARGET_SSE41
+#define BATCH_TARGET_AVX2
+#endif
+
+#pragma region [rgba(80, 80, 0, 0.2)] SCALAR
+// Implementações escalares, usadas como fallback e para o final dos lotes
+// que não completam um registrador SIMD.
+
+static void MultiplyMatrices_Scalar(const glm::mat4& A, const glm::mat4* in, glm::mat4* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = A * in[i];
+}
+
+static void TransformPoints_Scalar(const glm::mat4& M, const glm::vec4* in, glm::vec4* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = M * in[i];
+}
+
+static void ComposeTRS_Scalar(const glm::vec3* position, const glm::quat* rotation, const glm::vec3* scale, glm::mat4* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const glm::quat& q = rotation[i];
+        float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+        glm::mat4& m = out[i];
+        m[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * scale[i].x;
+        m[1] = glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * scale[i].y;
+        m[2] = glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * scale[i].z;
+        m[3] = glm::vec4(position[i], 1.0f);
+    }
+}
+
+// Método de Arvo: transformamos o centro da caixa, e a meia-extensão é
+// transformada pelo valor absoluto da parte linear da matriz.
+static void TransformBoundingBoxes_Scalar(const glm::mat4& M, const BoundingBox* in, BoundingBox* out, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        glm::vec3 c = 0.5f * (in[i].max + in[i].min);
+        glm::vec3 e = 0.5f * (in[i].max - in[i].min);
+
+        glm::vec3 tc = glm::vec3(M[0]) * c.x + glm::vec3(M[1]) * c.y + glm::vec3(M[2]) * c.z + glm::vec3(M[3]);
+        glm::vec3 te = glm::abs(glm::vec3(M[0])) * e.x + glm::abs(glm::vec3(M[1])) * e.y + glm::abs(glm::vec3(M[2])) * e.z;
+
+        out[i].min = tc - te;
+        out[i].max = tc + te;
+    }
+}
+#pragma endregion SCALAR
+
+#if BATCH_HAS_X86
+#pragma region [rgba(20, 20, 100, 0.3)] SSE41
+
+BATCH_TARGET_SSE41
+static inline __m128 Splat(__m128 v, int lane)
+{
+    switch (lane)
+    {
+        case 0:  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+        case 1:  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+        case 2:  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+        default: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+}
+
+// r = a0*v.x + a1*v.y + a2*v.z + a3*v.w
+BATCH_TARGET_SSE41
+static inline __m128 Combine_SSE41(const __m128 a[4], __m128 v)
+{
+    __m128 r = _mm_mul_ps(a[0], Splat(v, 0));
+    r = _mm_add_ps(r, _mm_mul_ps(a[1], Splat(v, 1)));
+    r = _mm_add_ps(r, _mm_mul_ps(a[2], Splat(v, 2)));
+    r = _mm_add_ps(r, _mm_mul_ps(a[3], Splat(v, 3)));
+    return r;
+}
+
+BATCH_TARGET_SSE41
+static void MultiplyMatrices_SSE41(const glm::mat4& A, const glm::mat4* in, glm::mat4* out, size_t count)
+{
+    const float* pa = glm::value_ptr(A);
+    __m128 a[4] = { _mm_loadu_ps(pa), _mm_loadu_ps(pa + 4), _mm_loadu_ps(pa + 8), _mm_loadu_ps(pa + 12) };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* pb = glm::value_ptr(in[i]);
+        float* po = glm::value_ptr(out[i]);
+        __m128 b0 = _mm_loadu_ps(pb);
+        __m128 b1 = _mm_loadu_ps(pb + 4);
+        __m128 b2 = _mm_loadu_ps(pb + 8);
+        __m128 b3 = _mm_loadu_ps(pb + 12);
+        _mm_storeu_ps(po,      Combine_SSE41(a, b0));
+        _mm_storeu_ps(po + 4,  Combine_SSE41(a, b1));
+        _mm_storeu_ps(po + 8,  Combine_SSE41(a, b2));
+        _mm_storeu_ps(po + 12, Combine_SSE41(a, b3));
+    }
+}
+
+BATCH_TARGET_SSE41
+static void TransformPoints_SSE41(const glm::mat4& M, const glm::vec4* in, glm::vec4* out, size_t count)
+{
+    const float* pm = glm::value_ptr(M);
+    __m128 m[4] = { _mm_loadu_ps(pm), _mm_loadu_ps(pm + 4), _mm_loadu_ps(pm + 8), _mm_loadu_ps(pm + 12) };
+
+    for (size_t i = 0; i < count; ++i)
+        _mm_storeu_ps(glm::value_ptr(out[i]), Combine_SSE41(m, _mm_loadu_ps(glm::value_ptr(in[i]))));
+}
+
+// Replica os coeficientes (a,b,c,d) de v nas posições 0..3.
+#define BATCH_SWIZZLE(v, a, b, c, d) _mm_shuffle_ps(v, v, _MM_SHUFFLE(d, c, b, a))
+
+// Cada coluna da matriz de rotação é a soma de dois produtos de coeficientes
+// do quaternion q=(x,y,z,w) (veja ComposeTRS_Scalar):
+//
+//   coluna 0 = [ 1 - 2yy - 2zz , 2xy + 2wz     , 2xz - 2wy     ]
+//   coluna 1 = [ 2xy - 2wz     , 1 - 2xx - 2zz , 2yz + 2wx     ]
+//   coluna 2 = [ 2xz + 2wy     , 2yz - 2wx     , 1 - 2xx - 2yy ]
+//
+// Os produtos são obtidos com permutações de q e 2q, e os sinais com
+// multiplicação por constantes (que também zeram o coeficiente w).
+struct RotationSigns
+{
+    float a[3][4];
+    float b[3][4];
+    float identity[3][4];
+};
+static const RotationSigns g_RotationSigns = {
+    { { -1.0f,  1.0f,  1.0f, 0.0f }, {  1.0f, -1.0f,  1.0f, 0.0f }, {  1.0f,  1.0f, -1.0f, 0.0f } },
+    { { -1.0f,  1.0f, -1.0f, 0.0f }, { -1.0f, -1.0f,  1.0f, 0.0f }, {  1.0f, -1.0f, -1.0f, 0.0f } },
+    { {  1.0f,  0.0f,  0.0f, 0.0f }, {  0.0f,  1.0f,  0.0f, 0.0f }, {  0.0f,  0.0f,  1.0f, 0.0f } },
+};
+
+BATCH_TARGET_SSE41
+static void ComposeTRS_SSE41(const glm::vec3* position, const glm::quat* rotation, const glm::vec3* scale, glm::mat4* out, size_t count)
+{
+    __m128 sign_a[3], sign_b[3], identity[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        sign_a[c] = _mm_loadu_ps(g_RotationSigns.a[c]);
+        sign_b[c] = _mm_loadu_ps(g_RotationSigns.b[c]);
+        identity[c] = _mm_loadu_ps(g_RotationSigns.identity[c]);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        // glm::quat guarda os coeficientes na ordem x, y, z, w.
+        __m128 q = _mm_loadu_ps(&rotation[i].x);
+        __m128 q2 = _mm_add_ps(q, q);
+
+        __m128 a0 = _mm_mul_ps(BATCH_SWIZZLE(q, 1, 0, 0, 3), BATCH_SWIZZLE(q2, 1, 1, 2, 3)); // yy xy xz
+        __m128 b0 = _mm_mul_ps(BATCH_SWIZZLE(q, 2, 3, 3, 3), BATCH_SWIZZLE(q2, 2, 2, 1, 3)); // zz wz wy
+        __m128 a1 = _mm_mul_ps(BATCH_SWIZZLE(q, 0, 0, 1, 3), BATCH_SWIZZLE(q2, 1, 0, 2, 3)); // xy xx yz
+        __m128 b1 = _mm_mul_ps(BATCH_SWIZZLE(q, 3, 2, 3, 3), BATCH_SWIZZLE(q2, 2, 2, 0, 3)); // wz zz wx
+        __m128 a2 = _mm_mul_ps(BATCH_SWIZZLE(q, 0, 1, 0, 3), BATCH_SWIZZLE(q2, 2, 2, 0, 3)); // xz yz xx
+        __m128 b2 = _mm_mul_ps(BATCH_SWIZZLE(q, 3, 3, 1, 3), BATCH_SWIZZLE(q2, 1, 0, 1, 3)); // wy wx yy
+
+        __m128 c0 = _mm_add_ps(identity[0], _mm_add_ps(_mm_mul_ps(a0, sign_a[0]), _mm_mul_ps(b0, sign_b[0])));
+        __m128 c1 = _mm_add_ps(identity[1], _mm_add_ps(_mm_mul_ps(a1, sign_a[1]), _mm_mul_ps(b1, sign_b[1])));
+        __m128 c2 = _mm_add_ps(identity[2], _mm_add_ps(_mm_mul_ps(a2, sign_a[2]), _mm_mul_ps(b2, sign_b[2])));
+
+        float* po = glm::value_ptr(out[i]);
+        _mm_storeu_ps(po,      _mm_mul_ps(c0, _mm_set1_ps(scale[i].x)));
+        _mm_storeu_ps(po + 4,  _mm_mul_ps(c1, _mm_set1_ps(scale[i].y)));
+        _mm_storeu_ps(po + 8,  _mm_mul_ps(c2, _mm_set1_ps(scale[i].z)));
+        _mm_storeu_ps(po + 12, _mm_set_ps(1.0f, position[i].z, position[i].y, position[i].x));
+    }
+}
+
+BATCH_TARGET_SSE41
+static void TransformBoundingBoxes_SSE41(const glm::mat4& M, const BoundingBox* in, BoundingBox* out, size_t count)
+{
+    const float* pm = glm::value_ptr(M);
+    const __m128 m0 = _mm_loadu_ps(pm), m1 = _mm_loadu_ps(pm + 4), m2 = _mm_loadu_ps(pm + 8), m3 = _mm_loadu_ps(pm + 12);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 a0 = _mm_andnot_ps(sign, m0), a1 = _mm_andnot_ps(sign, m1), a2 = _mm_andnot_ps(sign, m2);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        __m128 lo = _mm_set_ps(0.0f, in[i].min.z, in[i].min.y, in[i].min.x);
+        __m128 hi = _mm_set_ps(0.0f, in[i].max.z, in[i].max.y, in[i].max.x);
+        __m128 c = _mm_mul_ps(half, _mm_add_ps(hi, lo));
+        __m128 e = _mm_mul_ps(half, _mm_sub_ps(hi, lo));
+
+        __m128 tc = _mm_add_ps(m3, _mm_mul_ps(m0, Splat(c, 0)));
+        tc = _mm_add_ps(tc, _mm_mul_ps(m1, Splat(c, 1)));
+        tc = _mm_add_ps(tc, _mm_mul_ps(m2, Splat(c, 2)));
+        __m128 te = _mm_mul_ps(a0, Splat(e, 0));
+        te = _mm_add_ps(te, _mm_mul_ps(a1, Splat(e, 1)));
+        te = _mm_add_ps(te, _mm_mul_ps(a2, Splat(e, 2)));
+
+        float r[8];
+        _mm_storeu_ps(r, _mm_sub_ps(tc, te));
+        _mm_storeu_ps(r + 4, _mm_add_ps(tc, te));
+        out[i].min = glm::vec3(r[0], r[1], r[2]);
+        out[i].max = glm::vec3(r[4], r[5], r[6]);
+    }
+}
+#pragma endregion SSE41
+
+#pragma region [rgba(50, 100, 100, 0.2)] AVX2
+// Os kernels AVX2 processam dois vetores de 4 floats por registrador. As
+// colunas da matriz constante são replicadas nas duas metades de 128 bits, e
+// _mm256_shuffle_ps (que opera dentro de cada metade) replica cada
+// coeficiente dos dois vetores de entrada ao mesmo tempo.
+//
+// Antes de chamar o código escalar para o final do lote é obrigatório
+// executar _mm256_zeroupper(): misturar instruções SSE com a metade superior
+// dos registradores AVX "suja" custa centenas de ciclos por chamada.
+
+BATCH_TARGET_AVX2
+static inline __m256 Combine_AVX2(const __m256 a[4], __m256 v)
+{
+    __m256 r = _mm256_mul_ps(a[0], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+    r = _mm256_fmadd_ps(a[1], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), r);
+    r = _mm256_fmadd_ps(a[2], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), r);
+    r = _mm256_fmadd_ps(a[3], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), r);
+    return r;
+}
+
+BATCH_TARGET_AVX2
+static inline void LoadBroadcastColumns_AVX2(const glm::mat4& M, __m256 a[4])
+{
+    const float* p = glm::value_ptr(M);
+    for (int c = 0; c < 4; ++c)
+        a[c] = _mm256_broadcast_ps((const __m128*)(p + 4 * c));
+}
+
+BATCH_TARGET_AVX2
+static void MultiplyMatrices_AVX2(const glm::mat4& A, const glm::mat4* in, glm::mat4* out, size_t count)
+{
+    __m256 a[4];
+    LoadBroadcastColumns_AVX2(A, a);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* pb = glm::value_ptr(in[i]);
+        float* po = glm::value_ptr(out[i]);
+        _mm256_storeu_ps(po,     Combine_AVX2(a, _mm256_loadu_ps(pb)));
+        _mm256_storeu_ps(po + 8, Combine_AVX2(a, _mm256_loadu_ps(pb + 8)));
+    }
+}
+
+BATCH_TARGET_AVX2
+static void TransformPoints_AVX2(const glm::mat4& M, const glm::vec4* in, glm::vec4* out, size_t count)
+{
+    __m256 m[4];
+    LoadBroadcastColumns_AVX2(M, m);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+        _mm256_storeu_ps(glm::value_ptr(out[i]), Combine_AVX2(m, _mm256_loadu_ps(glm::value_ptr(in[i]))));
+    _mm256_zeroupper();
+    TransformPoints_Scalar(M, in + i, out + i, count - i);
+}
+
+#define BATCH_SWIZZLE256(v, a, b, c, d) _mm256_shuffle_ps(v, v, _MM_SHUFFLE(d, c, b, a))
+
+// Mesmo esquema do kernel SSE4.1, com dois quaternions (consecutivos na
+// memória) por registrador.
+BATCH_TARGET_AVX2
+static void ComposeTRS_AVX2(const glm::vec3* position, const glm::quat* rotation, const glm::vec3* scale, glm::mat4* out, size_t count)
+{
+    __m256 sign_a[3], sign_b[3], identity[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        sign_a[c] = _mm256_broadcast_ps((const __m128*)g_RotationSigns.a[c]);
+        sign_b[c] = _mm256_broadcast_ps((const __m128*)g_RotationSigns.b[c]);
+        identity[c] = _mm256_broadcast_ps((const __m128*)g_RotationSigns.identity[c]);
+    }
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        __m256 q = _mm256_loadu_ps(&rotation[i].x);
+        __m256 q2 = _mm256_add_ps(q, q);
+
+        __m256 a0 = _mm256_mul_ps(BATCH_SWIZZLE256(q, 1, 0, 0, 3), BATCH_SWIZZLE256(q2, 1, 1, 2, 3));
+        __m256 b0 = _mm256_mul_ps(BATCH_SWIZZLE256(q, 2, 3, 3, 3), BATCH_SWIZZLE256(q2, 2, 2, 1, 3));
+        __m256 a1 = _mm256_mul_ps(BATCH_SWIZZLE256(q, 0, 0, 1, 3), BATCH_SWIZZLE256(q2, 1, 0, 2, 3));
+        __m256 b1 = _mm256_mul_ps(BATCH_SWIZZLE256(q, 3, 2, 3, 3), BATCH_SWIZZLE256(q2, 2, 2, 0, 3));
+        __m256 a2 = _mm256_mul_ps(BATCH_SWIZZLE256(q, 0, 1, 0, 3), BATCH_SWIZZLE256(q2, 2, 2, 0, 3));
+        __m256 b2 = _mm256_mul_ps(BATCH_SWIZZLE256(q, 3, 3, 1, 3), BATCH_SWIZZLE256(q2, 1, 0, 1, 3));
+
+        __m256 c0 = _mm256_fmadd_ps(a0, sign_a[0], _mm256_fmadd_ps(b0, sign_b[0], identity[0]));
+        __m256 c1 = _mm256_fmadd_ps(a1, sign_a[1], _mm256_fmadd_ps(b1, sign_b[1], identity[1]));
+        __m256 c2 = _mm256_fmadd_ps(a2, sign_a[2], _mm256_fmadd_ps(b2, sign_b[2], identity[2]));
+
+        c0 = _mm256_mul_ps(c0, _mm256_set_m128(_mm_set1_ps(scale[i + 1].x), _mm_set1_ps(scale[i].x)));
+        c1 = _mm256_mul_ps(c1, _mm256_set_m128(_mm_set1_ps(scale[i + 1].y), _mm_set1_ps(scale[i].y)));
+        c2 = _mm256_mul_ps(c2, _mm256_set_m128(_mm_set1_ps(scale[i + 1].z), _mm_set1_ps(scale[i].z)));
+
+        float* p0 = glm::value_ptr(out[i]);
+        float* p1 = glm::value_ptr(out[i + 1]);
+        _mm_storeu_ps(p0,     _mm256_castps256_ps128(c0));
+        _mm_storeu_ps(p0 + 4, _mm256_castps256_ps128(c1));
+        _mm_storeu_ps(p0 + 8, _mm256_castps256_ps128(c2));
+        _mm_storeu_ps(p1,     _mm256_extractf128_ps(c0, 1));
+        _mm_storeu_ps(p1 + 4, _mm256_extractf128_ps(c1, 1));
+        _mm_storeu_ps(p1 + 8, _mm256_extractf128_ps(c2, 1));
+        _mm_storeu_ps(p0 + 12, _mm_set_ps(1.0f, position[i].z, position[i].y, position[i].x));
+        _mm_storeu_ps(p1 + 12, _mm_set_ps(1.0f, position[i + 1].z, position[i + 1].y, position[i + 1].x));
+    }
+    _mm256_zeroupper();
+    ComposeTRS_Scalar(position + i, rotation + i, scale + i, out + i, count - i);
+}
+
+// Duas caixas por iteração, uma em cada metade do registrador.
+BATCH_TARGET_AVX2
+static void TransformBoundingBoxes_AVX2(const glm::mat4& M, const BoundingBox* in, BoundingBox* out, size_t count)
+{
+    __m256 m[4];
+    LoadBroadcastColumns_AVX2(M, m);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 a0 = _mm256_andnot_ps(sign, m[0]), a1 = _mm256_andnot_ps(sign, m[1]), a2 = _mm256_andnot_ps(sign, m[2]);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        const BoundingBox& b0 = in[i];
+        const BoundingBox& b1 = in[i + 1];
+        __m256 lo = _mm256_set_ps(0.0f, b1.min.z, b1.min.y, b1.min.x, 0.0f, b0.min.z, b0.min.y, b0.min.x);
+        __m256 hi = _mm256_set_ps(0.0f, b1.max.z, b1.max.y, b1.max.x, 0.0f, b0.max.z, b0.max.y, b0.max.x);
+        __m256 c = _mm256_mul_ps(half, _mm256_add_ps(hi, lo));
+        __m256 e = _mm256_mul_ps(half, _mm256_sub_ps(hi, lo));
+
+        __m256 tc = _mm256_fmadd_ps(m[0], _mm256_shuffle_ps(c, c, _MM_SHUFFLE(0, 0, 0, 0)), m[3]);
+        tc = _mm256_fmadd_ps(m[1], _mm256_shuffle_ps(c, c, _MM_SHUFFLE(1, 1, 1, 1)), tc);
+        tc = _mm256_fmadd_ps(m[2], _mm256_shuffle_ps(c, c, _MM_SHUFFLE(2, 2, 2, 2)), tc);
+        __m256 te = _mm256_mul_ps(a0, _mm256_shuffle_ps(e, e, _MM_SHUFFLE(0, 0, 0, 0)));
+        te = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(e, e, _MM_SHUFFLE(1, 1, 1, 1)), te);
+        te = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(e, e, _MM_SHUFFLE(2, 2, 2, 2)), te);
+
+        float rmin[8], rmax[8];
+        _mm256_storeu_ps(rmin, _mm256_sub_ps(tc, te));
+        _mm256_storeu_ps(rmax, _mm256_add_ps(tc, te));
+        out[i].min     = glm::vec3(rmin[0], rmin[1], rmin[2]);
+        out[i].max     = glm::vec3(rmax[0], rmax[1], rmax[2]);
+        out[i + 1].min = glm::vec3(rmin[4], rmin[5], rmin[6]);
+        out[i + 1].max = glm::vec3(rmax[4], rmax[5], rmax[6]);
+    }
+    _mm256_zeroupper();
+    TransformBoundingBoxes_Scalar(M, in + i, out + i, count - i);
+}
+#pragma endregion AVX2
+#endif // BATCH_HAS_X86
+
+#pragma region [rgba(50, 100, 30, 0.2)] DISPATCH
+// Tabela de kernels escolhida em tempo de execução.
+struct BatchKernels
+{
+    void (*multiply_matrices)(const glm::mat4&, const glm::mat4*, glm::mat4*, size_t);
+    void (*transform_points)(const glm::mat4&, const glm::vec4*, glm::vec4*, size_t);
+    void (*compose_trs)(const glm::vec3*, const glm::quat*, const glm::vec3*, glm::mat4*, size_t);
+    void (*transform_bounding_boxes)(const glm::mat4&, const BoundingBox*, BoundingBox*, size_t);
+};
+
+static const BatchKernels g_ScalarKernels = {
+    MultiplyMatrices_Scalar, TransformPoints_Scalar, ComposeTRS_Scalar, TransformBoundingBoxes_Scalar
+};
+#if BATCH_HAS_X86
+static const BatchKernels g_SSE41Kernels = {
+    MultiplyMatrices_SSE41, TransformPoints_SSE41, ComposeTRS_SSE41, TransformBoundingBoxes_SSE41
+};
+static const BatchKernels g_AVX2Kernels = {
+    MultiplyMatrices_AVX2, TransformPoints_AVX2, ComposeTRS_AVX2, TransformBoundingBoxes_AVX2
+};
+#endif
+
+static BatchInstructionSet DetectInstructionSet()
+{
+#if BATCH_HAS_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool ymm_enabled = osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    if (avx2 && fma && ymm_enabled)
+        return BATCH_AVX2;
+    if (sse41)
+        return BATCH_SSE41;
+    return BATCH_SCALAR;
+#elif BATCH_HAS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return BATCH_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return BATCH_SSE41;
+    return BATCH_SCALAR;
+#else
+    return BATCH_SCALAR;
+#endif
+}
+
+static BatchInstructionSet g_SupportedInstructionSet = DetectInstructionSet();
+static BatchInstructionSet g_InstructionSet = g_SupportedInstructionSet;
+
+static const BatchKernels& Kernels()
+{
+#if BATCH_HAS_X86
+    if (g_InstructionSet == BATCH_AVX2)
+        return g_AVX2Kernels;
+    if (g_InstructionSet == BATCH_SSE41)
+        return g_SSE41Kernels;
+#endif
+    return g_ScalarKernels;
+}
+
+BatchInstructionSet Batch_GetInstructionSet()
+{
+    return g_InstructionSet;
+}
+
+BatchInstructionSet Batch_GetSupportedInstructionSet()
+{
+    return g_SupportedInstructionSet;
+}
+
+void Batch_SetInstructionSet(BatchInstructionSet isa)
+{
+    g_InstructionSet = (isa > g_SupportedInstructionSet) ? g_SupportedInstructionSet : isa;
+}
+
+const char* Batch_InstructionSetName(BatchInstructionSet isa)
+{
+    switch (isa)
+    {
+        case BATCH_AVX2:  return "AVX2+FMA";
+        case BATCH_SSE41: return "SSE4.1";
+        default:          return "scalar";
+    }
+}
+#pragma endregion DISPATCH
+
+void Batch_MultiplyMatrices(const glm::mat4& A, const glm::mat4* in, glm::mat4* out, size_t count)
+{
+    Kernels().multiply_matrices(A, in, out, count);
+}
+
+void Batch_TransformPoints(const glm::mat4& M, const glm::vec4* in, glm::vec4* out, size_t count)
+{
+    Kernels().transform_points(M, in, out, count);
+}
+
+void Batch_ComposeTRS(const glm::vec3* position, const glm::quat* rotation, const glm::vec3* scale, glm::mat4* out, size_t count)
+{
+    Kernels().compose_trs(position, rotation, scale, out, count);
+}
+
+void Batch_TransformBoundingBoxes(const glm::mat4& M, const BoundingBox* in, BoundingBox* out, size_t count)
+{
+    Kernels().transform_bounding_boxes(M, in, out, count);
+}
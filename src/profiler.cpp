@@ -0,0 +1,230 @@
+#include "profiler.h"
+
+#ifdef TCC_ENABLE_PROFILER
+
+#include <algorithm>
+#include <mutex>
+
+#include "timestep.h"
+
+// Anel de zonas de uma thread. Só a thread dona escreve (e avança "write");
+// só a thread principal lê (e avança "read"). Com um único produtor e um
+// único consumidor, os dois índices atômicos bastam, sem locks.
+struct ProfilerThreadBuffer
+{
+    int                   thread;
+    uint32_t              depth; // usado só pela thread dona
+    std::atomic<uint64_t> write;
+    std::atomic<uint64_t> read;
+    ProfileZone           zones[Profiler::THREAD_CAPACITY];
+};
+
+struct ProfilerFrame
+{
+    uint64_t number; // chamadas de EndFrame() até este frame, inclusive
+    uint64_t begin;
+    uint64_t end;
+    uint64_t first_zone; // posição em s_history da primeira zona recolhida no frame
+};
+
+// Os buffers das threads vivem até o fim do programa: uma thread pode
+// terminar com zonas ainda não recolhidas.
+static std::mutex            s_registry_mutex;
+static ProfilerThreadBuffer* s_threads[Profiler::MAX_THREADS];
+static std::atomic<int>      s_num_threads(0);
+static thread_local ProfilerThreadBuffer* t_buffer = NULL;
+static std::atomic<uint64_t> s_dropped(0);
+
+// Histórico, usado só pela thread principal.
+static std::vector<ProfileZone> s_history;
+static uint64_t                 s_history_write = 0;
+static ProfilerFrame            s_frames[Profiler::HISTORY_FRAMES];
+static uint64_t                 s_frame_count = 0;
+static uint64_t                 s_frame_begin = 0;
+static uint64_t                 s_end_frames = 0;
+static bool                     s_paused = false;
+
+// Relação entre ticks e o FrameClock, medida desde o primeiro
+// RegisterThread(); quanto mais longo o intervalo, mais precisa.
+static uint64_t               s_calibration_ticks = 0;
+static FrameClock::time_point s_calibration_time;
+static double                 s_ticks_per_us = 1000.0;
+
+static void Calibrate()
+{
+#ifdef TCC_PROFILER_RDTSC
+    double elapsed_us = std::chrono::duration<double, std::micro>(FrameClock::now() - s_calibration_time).count();
+    if (elapsed_us > 1000.0)
+        s_ticks_per_us = (double)(Profiler::Now() - s_calibration_ticks) / elapsed_us;
+#endif
+}
+
+void Profiler::RegisterThread(int thread)
+{
+    std::lock_guard<std::mutex> lock(s_registry_mutex);
+    if (s_history.empty())
+    {
+        s_history.resize(HISTORY_ZONES);
+        s_calibration_time = FrameClock::now();
+        s_calibration_ticks = Now();
+        s_frame_begin = s_calibration_ticks;
+    }
+    if (t_buffer != NULL)
+    {
+        t_buffer->thread = thread;
+        return;
+    }
+    int count = s_num_threads.load(std::memory_order_relaxed);
+    if (count >= MAX_THREADS)
+        return;
+
+    ProfilerThreadBuffer* buffer = new ProfilerThreadBuffer();
+    buffer->thread = thread;
+    buffer->depth = 0;
+    buffer->write.store(0, std::memory_order_relaxed);
+    buffer->read.store(0, std::memory_order_relaxed);
+    s_threads[count] = buffer;
+    s_num_threads.store(count + 1, std::memory_order_release);
+    t_buffer = buffer;
+}
+
+void Profiler::EnterZone()
+{
+    if (t_buffer != NULL)
+        ++t_buffer->depth;
+}
+
+void Profiler::Record(const char* name, uint64_t begin, uint64_t end)
+{
+    ProfilerThreadBuffer* buffer = t_buffer;
+    if (buffer == NULL)
+        return;
+    uint32_t depth = --buffer->depth;
+
+    uint64_t write = buffer->write.load(std::memory_order_relaxed);
+    if (write - buffer->read.load(std::memory_order_acquire) >= THREAD_CAPACITY)
+    {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ProfileZone& zone = buffer->zones[write % THREAD_CAPACITY];
+    zone.name = name;
+    zone.begin = begin;
+    zone.end = end;
+    zone.depth = depth;
+    zone.thread = buffer->thread;
+    buffer->write.store(write + 1, std::memory_order_release);
+}
+
+void Profiler::EndFrame()
+{
+    uint64_t now = Now();
+    Calibrate();
+    ++s_end_frames;
+
+    if (!s_paused)
+    {
+        ProfilerFrame& frame = s_frames[s_frame_count % HISTORY_FRAMES];
+        frame.number = s_end_frames;
+        frame.begin = s_frame_begin;
+        frame.end = now;
+        frame.first_zone = s_history_write;
+    }
+
+    int count = s_num_threads.load(std::memory_order_acquire);
+    for (int t = 0; t < count; ++t)
+    {
+        ProfilerThreadBuffer* buffer = s_threads[t];
+        uint64_t read = buffer->read.load(std::memory_order_relaxed);
+        uint64_t write = buffer->write.load(std::memory_order_acquire);
+        if (!s_paused)
+            for (uint64_t i = read; i < write; ++i)
+                s_history[s_history_write++ % HISTORY_ZONES] = buffer->zones[i % THREAD_CAPACITY];
+        buffer->read.store(write, std::memory_order_release);
+    }
+
+    if (!s_paused)
+        ++s_frame_count;
+    s_frame_begin = now;
+}
+
+void Profiler::SetPaused(bool paused)
+{
+    s_paused = paused;
+}
+
+bool Profiler::Paused()
+{
+    return s_paused;
+}
+
+int Profiler::Frames()
+{
+    return (int)std::min(s_frame_count, (uint64_t)HISTORY_FRAMES);
+}
+
+void Profiler::FrameBounds(int frame, uint64_t* begin, uint64_t* end)
+{
+    const ProfilerFrame& f = s_frames[(s_frame_count - Frames() + frame) % HISTORY_FRAMES];
+    *begin = f.begin;
+    *end = f.end;
+}
+
+int Profiler::FindFrame(uint64_t number)
+{
+    for (int frame = Frames() - 1; frame >= 0; --frame)
+    {
+        uint64_t found = s_frames[(s_frame_count - Frames() + frame) % HISTORY_FRAMES].number;
+        if (found == number)
+            return frame;
+        if (found < number)
+            break;
+    }
+    return -1;
+}
+
+// Zonas que podem se sobrepor ao frame: as recolhidas no fim dele e no fim
+// do seguinte (a thread de renderização termina o frame N durante o N + 1).
+bool Profiler::HistoryRange(int frame, uint64_t* first, uint64_t* last)
+{
+    uint64_t absolute = s_frame_count - Frames() + frame;
+    *first = s_frames[absolute % HISTORY_FRAMES].first_zone;
+    *last = (absolute + 2 < s_frame_count) ? s_frames[(absolute + 2) % HISTORY_FRAMES].first_zone : s_history_write;
+    if (s_history_write > HISTORY_ZONES)
+        *first = std::max(*first, s_history_write - HISTORY_ZONES);
+    return *first < *last;
+}
+
+const ProfileZone& Profiler::HistoryZone(uint64_t index)
+{
+    return s_history[index % HISTORY_ZONES];
+}
+
+double Profiler::TicksToMs(uint64_t ticks)
+{
+    return (double)ticks / s_ticks_per_us / 1000.0;
+}
+
+double Profiler::TicksToClockUs(uint64_t ticks)
+{
+    double clock_us = std::chrono::duration<double, std::micro>(s_calibration_time.time_since_epoch()).count();
+    return clock_us + (double)(int64_t)(ticks - s_calibration_ticks) / s_ticks_per_us;
+}
+
+void Profiler::AppendTraceEvents(std::vector<TraceEvent>& events)
+{
+    uint64_t first = (s_history_write > HISTORY_ZONES) ? s_history_write - HISTORY_ZONES : 0;
+    for (uint64_t i = first; i < s_history_write; ++i)
+    {
+        const ProfileZone& zone = HistoryZone(i);
+        TraceEvent event = { zone.name, zone.thread, TicksToClockUs(zone.begin), TicksToMs(zone.end - zone.begin) * 1000.0 };
+        events.push_back(event);
+    }
+}
+
+uint64_t Profiler::Dropped()
+{
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+#endif
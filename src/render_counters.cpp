@@ -0,0 +1,231 @@
+#include "render_counters.h"
+
+#include <algorithm>
+
+const char* RenderCounterLabel(int counter)
+{
+    switch (counter)
+    {
+    case COUNTER_DRAW_CALLS:         return "Draw calls";
+    case COUNTER_INSTANCES:          return "Instances";
+    case COUNTER_TRIANGLES:          return "Triangles";
+    case COUNTER_LINES:              return "Lines";
+    case COUNTER_POINTS:             return "Points";
+    case COUNTER_PROGRAM_BINDS:      return "Program binds";
+    case COUNTER_VERTEX_ARRAY_BINDS: return "VAO binds";
+    case COUNTER_TEXTURE_BINDS:      return "Texture binds";
+    case COUNTER_UNIFORM_UPLOADS:    return "Uniform uploads";
+    case COUNTER_BYTES_UPLOADED:     return "Bytes uploaded";
+    }
+    return "";
+}
+
+const char* RenderCounterColumn(int counter)
+{
+    switch (counter)
+    {
+    case COUNTER_DRAW_CALLS:         return "draw_calls";
+    case COUNTER_INSTANCES:          return "instances";
+    case COUNTER_TRIANGLES:          return "triangles";
+    case COUNTER_LINES:              return "lines";
+    case COUNTER_POINTS:             return "points";
+    case COUNTER_PROGRAM_BINDS:      return "program_binds";
+    case COUNTER_VERTEX_ARRAY_BINDS: return "vao_binds";
+    case COUNTER_TEXTURE_BINDS:      return "texture_binds";
+    case COUNTER_UNIFORM_UPLOADS:    return "uniform_uploads";
+    case COUNTER_BYTES_UPLOADED:     return "bytes_uploaded";
+    }
+    return "";
+}
+
+RenderCounters::RenderCounters()
+    : m_history(HISTORY * COUNTER_COUNT, 0), m_history_frames(HISTORY, 0), m_history_next(0), m_history_size(0), m_csv(NULL)
+{
+    std::fill(m_frame, m_frame + COUNTER_COUNT, 0);
+}
+
+RenderCounters::~RenderCounters()
+{
+    CloseCsv();
+}
+
+void RenderCounters::CountDraw(GLenum mode, GLsizei count, GLsizei instances)
+{
+    uint64_t n = (count > 0) ? (uint64_t)count : 0;
+    uint64_t primitives = 0;
+    m_frame[COUNTER_DRAW_CALLS] += 1;
+    m_frame[COUNTER_INSTANCES] += (uint64_t)instances;
+    switch (mode)
+    {
+    case GL_TRIANGLES:
+        primitives = n / 3;
+        m_frame[COUNTER_TRIANGLES] += primitives * instances;
+        break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+        primitives = (n > 2) ? n - 2 : 0;
+        m_frame[COUNTER_TRIANGLES] += primitives * instances;
+        break;
+    case GL_LINES:
+        primitives = n / 2;
+        m_frame[COUNTER_LINES] += primitives * instances;
+        break;
+    case GL_LINE_STRIP:
+        primitives = (n > 1) ? n - 1 : 0;
+        m_frame[COUNTER_LINES] += primitives * instances;
+        break;
+    case GL_LINE_LOOP:
+        primitives = (n > 1) ? n : 0;
+        m_frame[COUNTER_LINES] += primitives * instances;
+        break;
+    case GL_POINTS:
+        m_frame[COUNTER_POINTS] += n * instances;
+        break;
+    }
+}
+
+void RenderCounters::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    glDrawArrays(mode, first, count);
+    CountDraw(mode, count, 1);
+}
+
+void RenderCounters::DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint base_vertex)
+{
+    glDrawElementsBaseVertex(mode, count, type, (void*)indices, base_vertex);
+    CountDraw(mode, count, 1);
+}
+
+void RenderCounters::UseProgram(GLuint program)
+{
+    glUseProgram(program);
+    m_frame[COUNTER_PROGRAM_BINDS] += 1;
+}
+
+void RenderCounters::BindVertexArray(GLuint vertex_array)
+{
+    glBindVertexArray(vertex_array);
+    m_frame[COUNTER_VERTEX_ARRAY_BINDS] += 1;
+}
+
+void RenderCounters::BindTexture(GLenum target, GLuint texture)
+{
+    glBindTexture(target, texture);
+    m_frame[COUNTER_TEXTURE_BINDS] += 1;
+}
+
+void RenderCounters::UniformMatrix4fv(GLint location, const glm::mat4& matrix)
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+    m_frame[COUNTER_UNIFORM_UPLOADS] += 1;
+}
+
+void RenderCounters::Uniform1i(GLint location, GLint value)
+{
+    glUniform1i(location, value);
+    m_frame[COUNTER_UNIFORM_UPLOADS] += 1;
+}
+
+void RenderCounters::EndFrame(uint64_t frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::copy(m_frame, m_frame + COUNTER_COUNT, &m_history[m_history_next * COUNTER_COUNT]);
+        m_history_frames[m_history_next] = frame;
+        m_history_next = (m_history_next + 1) % HISTORY;
+        m_history_size = std::min(m_history_size + 1, (size_t)HISTORY);
+
+        // O arquivo já tem um buffer: escrever uma linha não aloca memória.
+        if (m_csv != NULL)
+        {
+            fprintf(m_csv, "%llu", (unsigned long long)frame);
+            for (int c = 0; c < COUNTER_COUNT; ++c)
+                fprintf(m_csv, ",%llu", (unsigned long long)m_frame[c]);
+            fprintf(m_csv, "\n");
+        }
+    }
+    std::fill(m_frame, m_frame + COUNTER_COUNT, 0);
+}
+
+RenderCounterStats RenderCounters::Stats() const
+{
+    RenderCounterStats stats;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.frames = (int)m_history_size;
+    size_t first = (m_history_next + HISTORY - m_history_size) % HISTORY;
+    size_t last = (m_history_next + HISTORY - 1) % HISTORY;
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+        uint64_t total = 0, min = UINT64_MAX, max = 0;
+        for (size_t i = 0; i < m_history_size; ++i)
+        {
+            uint64_t value = m_history[((first + i) % HISTORY) * COUNTER_COUNT + c];
+            total += value;
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+        stats.last[c] = m_history_size > 0 ? m_history[last * COUNTER_COUNT + c] : 0;
+        stats.min[c] = m_history_size > 0 ? min : 0;
+        stats.average[c] = m_history_size > 0 ? (double)total / (double)m_history_size : 0.0;
+        stats.max[c] = max;
+    }
+    return stats;
+}
+
+uint64_t RenderCounters::Last(RenderCounter counter) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_history_size == 0)
+        return 0;
+    size_t last = (m_history_next + HISTORY - 1) % HISTORY;
+    return m_history[last * COUNTER_COUNT + counter];
+}
+
+bool RenderCounters::FindFrame(uint64_t frame, uint64_t* out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < m_history_size; ++i)
+    {
+        size_t slot = (m_history_next + HISTORY - 1 - i) % HISTORY;
+        if (m_history_frames[slot] == frame)
+        {
+            std::copy(&m_history[slot * COUNTER_COUNT], &m_history[slot * COUNTER_COUNT] + COUNTER_COUNT, out);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RenderCounters::OpenCsv(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot open \"%s\" for writing.\n", path);
+        return false;
+    }
+    fprintf(file, "frame");
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+        fprintf(file, ",%s", RenderCounterColumn(c));
+    fprintf(file, "\n");
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_csv != NULL)
+        fclose(m_csv);
+    m_csv = file;
+    return true;
+}
+
+void RenderCounters::CloseCsv()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_csv != NULL)
+        fclose(m_csv);
+    m_csv = NULL;
+}
+
+bool RenderCounters::CsvOpen() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_csv != NULL;
+}
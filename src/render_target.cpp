@@ -0,0 +1,121 @@
+#include "render_target.h"
+
+#include <utility>
+
+bool RenderTarget::Create(GpuResourceManager& gpu, const char* name, int width, int height)
+{
+    if (m_framebuffer && width == m_width && height == m_height)
+        return true;
+    m_width = width;
+    m_height = height;
+
+    // Sem mipmaps: os filtros precisam ser GL_LINEAR ou GL_NEAREST para que
+    // a textura seja "completa" e possa ser amostrada depois.
+    m_color = gpu.CreateTexture(name);
+    glBindTexture(GL_TEXTURE_2D, m_color.Id());
+    gpu.TexImage2D(m_color.Id(), 0, GL_RGBA8, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    m_depth = gpu.CreateTexture(name);
+    glBindTexture(GL_TEXTURE_2D, m_depth.Id());
+    gpu.TexImage2D(m_depth.Id(), 0, GL_DEPTH_COMPONENT24, width, height, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_framebuffer = gpu.CreateFramebuffer(name);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Id());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color.Id(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth.Id(), 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "ERROR: framebuffer \"%s\" is incomplete (status 0x%04X).\n", name, status);
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+    pixels.resize((size_t)m_width * (size_t)m_height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer.Id());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+void RenderTargetPool::Init(GpuResourceManager& gpu, const char* name)
+{
+    m_gpu = &gpu;
+    m_name = name;
+    m_entries.clear();
+    m_entries.reserve(MAX_TARGETS);
+    m_frame = 0;
+    m_created = 0;
+}
+
+void RenderTargetPool::Clear()
+{
+    m_entries.clear();
+}
+
+RenderTarget* RenderTargetPool::Acquire(int width, int height)
+{
+    if (m_gpu == NULL)
+        return NULL;
+
+    Entry* oldest = NULL;
+    for (Entry& entry : m_entries)
+    {
+        if (entry.in_use)
+            continue;
+        if (entry.target.Width() == width && entry.target.Height() == height)
+        {
+            entry.in_use = true;
+            entry.last_used = m_frame;
+            return &entry.target;
+        }
+        if (oldest == NULL || entry.last_used < oldest->last_used)
+            oldest = &entry;
+    }
+
+    Entry* entry = oldest;
+    if (m_entries.size() < MAX_TARGETS)
+    {
+        m_entries.push_back(Entry());
+        entry = &m_entries.back();
+    }
+    if (entry == NULL)
+        return NULL;
+    entry->in_use = true;
+    entry->last_used = m_frame;
+    ++m_created;
+    if (!entry->target.Create(*m_gpu, m_name, width, height))
+        return NULL;
+    return &entry->target;
+}
+
+void RenderTargetPool::EndFrame()
+{
+    for (size_t i = 0; i < m_entries.size();)
+    {
+        Entry& entry = m_entries[i];
+        entry.in_use = false;
+        if (m_frame - entry.last_used >= KEEP_FRAMES)
+        {
+            // A ordem não importa: o último toma o lugar do removido.
+            if (i + 1 < m_entries.size())
+                entry = std::move(m_entries.back());
+            m_entries.pop_back();
+            continue;
+        }
+        ++i;
+    }
+    ++m_frame;
+}
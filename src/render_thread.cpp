@@ -0,0 +1,512 @@
+#include "render_thread.h"
+#include "job_system.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Quantos bytes de geometria a desfragmentação pode mover por frame.
+static const size_t GEOMETRY_DEFRAG_BYTES_PER_FRAME = 256 * 1024;
+
+// Copia o conteúdo de "src" para "dst" reaproveitando a memória já alocada
+// (o operator= de ImVector libera e realoca o buffer a cada cópia).
+template <typename T>
+static void CopyImVector(ImVector<T>& dst, const ImVector<T>& src)
+{
+    dst.resize(src.Size);
+    if (src.Size > 0)
+        memcpy(dst.Data, src.Data, (size_t)src.Size * sizeof(T));
+}
+
+UiDrawSnapshot::UiDrawSnapshot()
+{
+}
+
+UiDrawSnapshot::~UiDrawSnapshot()
+{
+    for (int n = 0; n < m_lists.Size; ++n)
+        IM_DELETE(m_lists[n]);
+}
+
+// Chamada pela thread principal, logo após ImGui::Render().
+void UiDrawSnapshot::Capture(const ImDrawData* draw_data)
+{
+    // Novas listas só são criadas quando a ImGui passa a ter mais janelas.
+    while (m_lists.Size < draw_data->CmdListsCount)
+        m_lists.push_back(IM_NEW(ImDrawList)(draw_data->CmdLists[m_lists.Size]->_Data));
+
+    for (int n = 0; n < draw_data->CmdListsCount; ++n)
+    {
+        const ImDrawList* src = draw_data->CmdLists[n];
+        ImDrawList* dst = m_lists[n];
+        CopyImVector(dst->CmdBuffer, src->CmdBuffer);
+        CopyImVector(dst->IdxBuffer, src->IdxBuffer);
+        CopyImVector(dst->VtxBuffer, src->VtxBuffer);
+        dst->Flags = src->Flags;
+    }
+
+    m_draw_data.Valid            = draw_data->Valid;
+    m_draw_data.CmdLists         = m_lists.Data;
+    m_draw_data.CmdListsCount    = draw_data->CmdListsCount;
+    m_draw_data.TotalIdxCount    = draw_data->TotalIdxCount;
+    m_draw_data.TotalVtxCount    = draw_data->TotalVtxCount;
+    m_draw_data.DisplayPos       = draw_data->DisplayPos;
+    m_draw_data.DisplaySize      = draw_data->DisplaySize;
+    m_draw_data.FramebufferScale = draw_data->FramebufferScale;
+}
+
+RenderThread::RenderThread()
+    : m_window(NULL), m_headless(NULL), m_interface(NULL), m_running(false), m_core(-1),
+      m_back(0), m_front(1), m_ready(2), m_published(0), m_consumed(0), m_completed(0), m_stop(false),
+      m_present_mode(-1), m_first_present(), m_first_presented(false), m_fence_count(0), m_submit_ms(0.0f), m_swap_ms(0.0f), m_idle_ms(0.0f),
+      m_main_wait_ms(0.0f), m_interval_ms(0.0f), m_jitter_ms(0.0f), m_latency_ms(0.0f), m_max_latency_ms(0.0f)
+{
+    for (int i = 0; i < 3; ++i)
+        m_packets[i].frame = 0;
+}
+
+RenderThread::~RenderThread()
+{
+    if (m_running)
+        Stop();
+}
+
+void RenderThread::Start(GLFWwindow* window, const RenderResources& resources, Interface* interface)
+{
+    m_window = window;
+    m_headless = NULL;
+    m_resources = resources;
+    m_interface = interface;
+    m_stop = false;
+
+    // Um contexto OpenGL só pode estar ativo em uma thread por vez.
+    ReleaseContext();
+    m_thread = std::thread(&RenderThread::Run, this);
+
+    // Até o renderizador da ImGui ser inicializado (ele cria a textura do
+    // atlas de fontes) a thread principal não pode começar um frame da ImGui.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_running; });
+}
+
+void RenderThread::Start(HeadlessContext* context, const RenderResources& resources)
+{
+    m_window = NULL;
+    m_headless = context;
+    m_resources = resources;
+    m_interface = NULL;
+    m_stop = false;
+
+    ReleaseContext();
+    m_thread = std::thread(&RenderThread::Run, this);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_running; });
+}
+
+void RenderThread::MakeContextCurrent()
+{
+    if (m_headless != NULL)
+        m_headless->MakeCurrent();
+    else
+        glfwMakeContextCurrent(m_window);
+}
+
+void RenderThread::ReleaseContext()
+{
+    if (m_headless != NULL)
+        m_headless->ReleaseCurrent();
+    else
+        glfwMakeContextCurrent(NULL);
+}
+
+void RenderThread::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    m_running = false;
+
+    MakeContextCurrent();
+}
+
+FramePacket& RenderThread::BeginFrame()
+{
+    FrameClock::time_point start = FrameClock::now();
+    if (m_consumed.load(std::memory_order_acquire) < m_published)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_consumed.load(std::memory_order_acquire) >= m_published; });
+    }
+    m_main_wait_ms = std::chrono::duration<float, std::milli>(FrameClock::now() - start).count();
+
+    FramePacket& packet = m_packets[m_back];
+    packet.frame = m_published + 1;
+    packet.draw_list.clear();
+    return packet;
+}
+
+void RenderThread::EndFrame()
+{
+    m_published = m_packets[m_back].frame;
+    m_back = m_ready.exchange(m_back | NEW_PACKET, std::memory_order_acq_rel) & ~NEW_PACKET;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_cv.notify_all();
+}
+
+void RenderThread::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv.wait(lock, [this]() { return m_completed.load(std::memory_order_acquire) >= m_published; });
+}
+
+void RenderThread::Run()
+{
+    if (m_core >= 0)
+        PinCurrentThreadToCore(m_core);
+    PROFILE_REGISTER_THREAD(TRACE_THREAD_RENDER);
+    MakeContextCurrent();
+    if (m_interface != NULL)
+    {
+        m_interface->InitRenderer();
+        m_ui_renderer.Init(*m_resources.gpu);
+        m_ui_layer.Init(*m_resources.gpu);
+        m_viewport.Init(*m_resources.gpu);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = true;
+    }
+    m_cv.notify_all();
+
+    while (true)
+    {
+        FrameClock::time_point wait_start = FrameClock::now();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stop.load() || (m_ready.load(std::memory_order_acquire) & NEW_PACKET) != 0; });
+        }
+        if (m_stop.load())
+            break;
+
+        m_front = m_ready.exchange(m_front, std::memory_order_acq_rel) & ~NEW_PACKET;
+        FramePacket& packet = m_packets[m_front];
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_consumed.store(packet.frame, std::memory_order_release);
+        }
+        m_cv.notify_all();
+
+        FrameClock::time_point submit_start = FrameClock::now();
+        Draw(packet);
+        FrameClock::time_point swap_start = FrameClock::now();
+        {
+            PROFILE_SCOPE("SwapBuffers");
+            if (m_headless != NULL)
+                glFinish();
+            else
+                glfwSwapBuffers(m_window);
+            LimitGpuQueue(packet.gpu_queue_depth);
+        }
+        // A latência é medida até aqui, antes da espera do limite de FPS.
+        FrameClock::time_point presented = FrameClock::now();
+        m_pacing.Add(presented, packet.input_sampled);
+        if (!m_first_presented.load(std::memory_order_relaxed))
+        {
+            m_first_present = presented;
+            m_first_presented.store(true, std::memory_order_release);
+        }
+        if (packet.present_mode == PRESENT_THROTTLED)
+        {
+            PROFILE_SCOPE("FrameLimiter::Wait");
+            m_frame_limiter.SetTargetFPS(packet.throttle_fps);
+            m_frame_limiter.Wait();
+        }
+        FrameClock::time_point end = FrameClock::now();
+        m_resources.gpu_timer->SetCpuTimes(submit_start, swap_start, end);
+
+        m_idle_ms.store(std::chrono::duration<float, std::milli>(submit_start - wait_start).count(), std::memory_order_relaxed);
+        m_submit_ms.store(std::chrono::duration<float, std::milli>(swap_start - submit_start).count(), std::memory_order_relaxed);
+        m_swap_ms.store(std::chrono::duration<float, std::milli>(end - swap_start).count(), std::memory_order_relaxed);
+        m_interval_ms.store(m_pacing.IntervalMs(), std::memory_order_relaxed);
+        m_jitter_ms.store(m_pacing.JitterMs(), std::memory_order_relaxed);
+        m_latency_ms.store(m_pacing.LatencyMs(), std::memory_order_relaxed);
+        m_max_latency_ms.store(m_pacing.MaxLatencyMs(), std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed.store(packet.frame, std::memory_order_release);
+        }
+        m_cv.notify_all();
+    }
+
+    LimitGpuQueue(0);
+    if (m_interface != NULL)
+    {
+        m_viewport.Shutdown();
+        m_ui_layer.Shutdown();
+        m_ui_renderer.Shutdown();
+        m_interface->ShutdownRenderer();
+    }
+    ReleaseContext();
+}
+
+// Sem limite, o driver deixa a CPU enviar alguns frames à frente da GPU, e
+// cada frame na fila soma um frame à latência entre a entrada e a imagem.
+// Com "depth" frames, uma fence é colocada depois de cada frame, e a thread
+// espera até que no máximo depth - 1 frames enviados não tenham terminado na
+// GPU: com 1, a GPU termina o frame antes de a thread de renderização pegar
+// o próximo pacote (como glFinish(), mas sem esvaziar a fila à força); com
+// 2, a CPU prepara um frame enquanto a GPU desenha o anterior.
+void RenderThread::LimitGpuQueue(int depth)
+{
+    depth = std::min(std::max(depth, 0), MAX_GPU_QUEUE_DEPTH);
+    // Na entrada, no máximo MAX_GPU_QUEUE_DEPTH - 1 fences estão pendentes.
+    if (depth > 0)
+        m_fences[m_fence_count++] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    while (m_fence_count > (depth > 0 ? depth - 1 : 0))
+    {
+        PROFILE_SCOPE("Wait for GPU");
+        // Sem limite (depth 0), as fences restantes são só descartadas.
+        if (depth > 0)
+            glClientWaitSync(m_fences[0], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        glDeleteSync(m_fences[0]);
+        std::copy(m_fences + 1, m_fences + m_fence_count, m_fences);
+        --m_fence_count;
+    }
+}
+
+// Todos os objetos estão nos mesmos buffers (veja geometry_pool.h): a malha
+// de cada um é só um deslocamento nos índices e nos vértices, e o VAO não
+// precisa ser trocado entre um objeto e outro.
+static void DrawSceneObject(RenderCounters& counters, const GeometryPool& geometry, const SceneObject& object)
+{
+    GeometryRange range = geometry.Range(object.geometry);
+    void* first_index = (void*)((range.first_index + object.first_index) * sizeof(GLuint));
+    counters.DrawElementsBaseVertex(object.rendering_mode, object.num_indices, GL_UNSIGNED_INT, first_index, range.base_vertex);
+}
+
+// O renderizador da ImGui (imgui_impl_opengl3.cpp) faz as próprias chamadas
+// OpenGL; contamos as que ele faz: uma vez por frame, liga o seu programa,
+// VAO e dois uniforms, e no fim religa o programa, o VAO e a textura que
+// estavam ligados; para cada lista, envia os vértices e índices; e para
+// cada comando, liga a textura e faz uma chamada de desenho de triângulos.
+static void CountUiDrawData(RenderCounters& counters, const ImDrawData* ui)
+{
+    if (ui->CmdListsCount == 0)
+        return;
+    counters.Add(COUNTER_PROGRAM_BINDS, 2);
+    counters.Add(COUNTER_VERTEX_ARRAY_BINDS, 2);
+    counters.Add(COUNTER_TEXTURE_BINDS, 1);
+    counters.Add(COUNTER_UNIFORM_UPLOADS, 2);
+    for (int n = 0; n < ui->CmdListsCount; ++n)
+    {
+        const ImDrawList* list = ui->CmdLists[n];
+        counters.Add(COUNTER_BYTES_UPLOADED, (uint64_t)list->VtxBuffer.Size * sizeof(ImDrawVert) +
+                                             (uint64_t)list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        for (int c = 0; c < list->CmdBuffer.Size; ++c)
+        {
+            if (list->CmdBuffer[c].UserCallback != NULL)
+                continue;
+            counters.Add(COUNTER_TEXTURE_BINDS, 1);
+            counters.CountDraw(GL_TRIANGLES, (GLsizei)list->CmdBuffer[c].ElemCount, 1);
+        }
+    }
+}
+
+// A imagem da janela "Viewport" é montada pela interface com
+// SCENE_VIEWPORT_TEXTURE; a textura da cena só existe aqui. Sem textura (o
+// alvo não pôde ser criado e a cena foi desenhada na tela), o comando da
+// imagem é removido. Os dois renderizadores da interface usam o IdxOffset
+// de cada comando, por isso remover um não desloca os outros.
+static void ResolveViewportTexture(ImDrawData* ui, GLuint texture)
+{
+    for (int n = 0; n < ui->CmdListsCount; ++n)
+    {
+        ImDrawList* list = ui->CmdLists[n];
+        for (int c = 0; c < list->CmdBuffer.Size; )
+        {
+            ImDrawCmd& cmd = list->CmdBuffer[c];
+            if (cmd.TextureId == SCENE_VIEWPORT_TEXTURE && texture == 0)
+            {
+                list->CmdBuffer.erase(&cmd);
+                continue;
+            }
+            if (cmd.TextureId == SCENE_VIEWPORT_TEXTURE)
+                cmd.TextureId = (ImTextureID)(intptr_t)texture;
+            ++c;
+        }
+    }
+}
+
+void RenderThread::Draw(FramePacket& packet)
+{
+    PROFILE_SCOPE("RenderThread::Draw");
+    const RenderResources& r = m_resources;
+
+    // glfwSwapInterval() afeta o contexto atual, por isso é chamada aqui.
+    if (m_window != NULL && packet.present_mode != m_present_mode)
+    {
+        m_present_mode = packet.present_mode;
+        glfwSwapInterval(m_present_mode == PRESENT_VSYNC ? 1 : 0);
+    }
+
+    RenderCounters& counters = *r.counters;
+    GpuTimer& timer = *r.gpu_timer;
+    timer.BeginFrame(packet.frame);
+
+    // Com a janela "Viewport", a cena é desenhada no alvo dela, na sua
+    // própria resolução (veja scene_viewport.h).
+    const bool in_viewport = packet.scene_viewport && m_viewport.Begin(packet.viewport, packet.clear_color);
+    if (!in_viewport)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, r.framebuffer);
+        glViewport(0, 0, packet.framebuffer_width, packet.framebuffer_height);
+        glClearColor(packet.clear_color.x, packet.clear_color.y, packet.clear_color.z, packet.clear_color.w);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Pedimos para a GPU utilizar o programa de GPU criado em main() e
+    // "ligamos" o VAO com os atributos de vértices de toda a cena, uma
+    // única vez por frame.
+    counters.UseProgram(r.program_id);
+    counters.BindVertexArray(r.geometry->VertexArray());
+
+    // Enviamos as matrizes "view" e "projection" para a placa de vídeo
+    // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
+    // efetivamente aplicadas em todos os pontos.
+    counters.UniformMatrix4fv(r.view_uniform, packet.view);
+    counters.UniformMatrix4fv(r.projection_uniform, packet.projection);
+
+    // A lista é percorrida uma vez por etapa (faces, eixos, arestas), para
+    // que o tempo de GPU de cada etapa possa ser medido separadamente (veja
+    // gpu_timer.h). Cada item possui sua própria matriz de modelagem. Veja
+    // slide 138 do documento "Aula_08_Sistemas_de_Coordenadas.pdf".
+    counters.Uniform1i(r.render_as_black_uniform, false);
+    timer.BeginPass(GPU_PASS_FACES);
+    for (const DrawItem& item : packet.draw_list)
+    {
+        if (item.flags & DRAW_FACES)
+        {
+            counters.UniformMatrix4fv(r.model_uniform, item.model);
+            DrawSceneObject(counters, *r.geometry, r.cube_faces);
+        }
+    }
+    timer.EndPass(GPU_PASS_FACES);
+
+    // Os eixos são desenhados com a matriz "model" do item, e portanto
+    // representam o sistema de coordenadas do modelo.
+    timer.BeginPass(GPU_PASS_AXES);
+    for (const DrawItem& item : packet.draw_list)
+    {
+        if (item.flags & DRAW_AXES)
+        {
+            counters.UniformMatrix4fv(r.model_uniform, item.model);
+            glLineWidth(item.axes_line_width);
+            DrawSceneObject(counters, *r.geometry, r.axes);
+        }
+    }
+    timer.EndPass(GPU_PASS_AXES);
+
+    // Arestas pretas do cubo, com a mesma espessura dos eixos do item, e por
+    // cima delas o ponto de 15 pixels em cima do vértice (0.5, 0.5, 0.5,
+    // 1.0), também preto.
+    counters.Uniform1i(r.render_as_black_uniform, true);
+    timer.BeginPass(GPU_PASS_EDGES);
+    for (const DrawItem& item : packet.draw_list)
+    {
+        if (!(item.flags & (DRAW_EDGES | DRAW_VERTEX_MARKER)))
+            continue;
+        counters.UniformMatrix4fv(r.model_uniform, item.model);
+        glLineWidth(item.axes_line_width);
+        if (item.flags & DRAW_HIGHLIGHT)
+        {
+            // Arestas do objeto selecionado, em amarelo e mais grossas.
+            counters.Uniform1i(r.render_as_black_uniform, false);
+            counters.Uniform1i(r.render_as_highlight_uniform, true);
+            glLineWidth(item.axes_line_width + 2.0f);
+        }
+        if (item.flags & DRAW_EDGES)
+            DrawSceneObject(counters, *r.geometry, r.cube_edges);
+        if (item.flags & DRAW_HIGHLIGHT)
+        {
+            counters.Uniform1i(r.render_as_highlight_uniform, false);
+            counters.Uniform1i(r.render_as_black_uniform, true);
+            glLineWidth(item.axes_line_width);
+        }
+        if (item.flags & DRAW_VERTEX_MARKER)
+        {
+            glPointSize(15.0f);
+            counters.DrawArrays(GL_POINTS, r.geometry->Range(r.cube_faces.geometry).base_vertex + 3, 1);
+        }
+    }
+    timer.EndPass(GPU_PASS_EDGES);
+
+    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
+    // alterar o mesmo.
+    counters.BindVertexArray(0);
+
+    // A cena fica na textura, e a tela só tem a interface. Se Begin()
+    // falhou, a cena já está na tela e não há textura a mostrar.
+    GLuint viewport_texture = 0;
+    if (in_viewport)
+    {
+        viewport_texture = m_viewport.End(packet.viewport, counters);
+        glBindFramebuffer(GL_FRAMEBUFFER, r.framebuffer);
+        glViewport(0, 0, packet.framebuffer_width, packet.framebuffer_height);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    if (m_interface != NULL)
+    {
+        ImDrawData* ui = packet.ui.Data();
+        if (packet.scene_viewport)
+            ResolveViewportTexture(ui, viewport_texture);
+        timer.BeginPass(GPU_PASS_UI);
+        // Glyphs rasterizados pela thread principal para este frame: só a
+        // região modificada da textura do atlas é enviada.
+        const GlyphUpload& glyphs = packet.glyph_upload;
+        if (glyphs.width > 0)
+        {
+            counters.BindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)glyphs.texture);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, glyphs.x, glyphs.y, glyphs.width, glyphs.height, GL_RGBA,
+                            GL_UNSIGNED_BYTE, glyphs.pixels.data());
+            counters.Add(COUNTER_BYTES_UPLOADED, glyphs.pixels.size());
+            counters.BindTexture(GL_TEXTURE_2D, 0);
+        }
+        // O renderizador da ImGui não desenha com cores pré-multiplicadas:
+        // só o UiRenderer usa a camada.
+        if (packet.ui_cache && packet.lean_ui_renderer)
+        {
+            if (packet.ui_redraw)
+            {
+                m_ui_layer.Begin(packet.framebuffer_width, packet.framebuffer_height);
+                m_ui_renderer.RenderDrawData(ui, counters, true);
+                m_ui_layer.End(r.framebuffer);
+            }
+            m_ui_layer.Composite(counters);
+        }
+        else if (packet.lean_ui_renderer)
+            m_ui_renderer.RenderDrawData(ui, counters);
+        else
+        {
+            m_interface->RenderDrawData(ui);
+            CountUiDrawData(counters, ui);
+        }
+        timer.EndPass(GPU_PASS_UI);
+    }
+
+    // Fecha aos poucos os buracos deixados por malhas liberadas.
+    r.geometry->Defragment(GEOMETRY_DEFRAG_BYTES_PER_FRAME);
+    m_viewport.EndFrame();
+
+    // Despeja recursos não usados neste frame se o orçamento foi excedido.
+    r.gpu->EndFrame();
+    timer.EndFrame();
+    counters.EndFrame(packet.frame);
+}
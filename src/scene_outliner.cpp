@@ -0,0 +1,366 @@
+#include "scene_outliner.h"
+#include "profiler.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+SceneIndex::SceneIndex()
+    : m_first_root(INVALID_TRANSFORM), m_last_root(INVALID_TRANSFORM), m_count(0)
+{
+}
+
+void SceneIndex::Reserve(size_t count, size_t name_bytes)
+{
+    m_names.reserve(name_bytes);
+    m_name_offsets.reserve(count);
+    m_parents.reserve(count);
+    m_first_child.reserve(count);
+    m_last_child.reserve(count);
+    m_next_sibling.reserve(count);
+    m_child_counts.reserve(count);
+}
+
+void SceneIndex::Add(TransformId id, TransformId parent, const char* name)
+{
+    if (id >= m_name_offsets.size())
+    {
+        size_t size = (size_t)id + 1;
+        m_name_offsets.resize(size, NO_NAME);
+        m_parents.resize(size, INVALID_TRANSFORM);
+        m_first_child.resize(size, INVALID_TRANSFORM);
+        m_last_child.resize(size, INVALID_TRANSFORM);
+        m_next_sibling.resize(size, INVALID_TRANSFORM);
+        m_child_counts.resize(size, 0);
+    }
+    m_name_offsets[id] = (uint32_t)m_names.size();
+    m_names.insert(m_names.end(), name, name + strlen(name) + 1);
+    m_parents[id] = parent;
+    ++m_count;
+
+    // O novo nó vai para o fim da lista de filhos do pai (ou de raízes), para
+    // a árvore aparecer na ordem de criação.
+    TransformId& first = (parent == INVALID_TRANSFORM) ? m_first_root : m_first_child[parent];
+    TransformId& last = (parent == INVALID_TRANSFORM) ? m_last_root : m_last_child[parent];
+    if (last == INVALID_TRANSFORM)
+        first = id;
+    else
+        m_next_sibling[last] = id;
+    last = id;
+    if (parent != INVALID_TRANSFORM)
+        ++m_child_counts[parent];
+}
+
+SceneOutliner::SceneOutliner()
+    : m_index_size(0), m_source_next(0), m_range_next(0), m_range_end(0), m_search_tested(0), m_search_total(0),
+      m_selected(INVALID_TRANSFORM), m_scroll_to_selected(false), m_euler_id(INVALID_TRANSFORM),
+      m_euler_rotation(1.0f, 0.0f, 0.0f, 0.0f), m_euler_degrees(0.0f)
+{
+    m_filter[0] = 0;
+    m_search[0] = 0;
+}
+
+// Acrescenta a "out" os nós visíveis a partir de "first" e dos seus irmãos
+// seguintes, em pré-ordem, descendo nos nós expandidos. Retorna o número de
+// linhas acrescentadas.
+size_t SceneOutliner::AppendVisible(const SceneIndex& index, TransformId first, uint32_t depth, std::vector<Row>& out)
+{
+    size_t before = out.size();
+    // Pilha com o próximo irmão a visitar em cada nível (a hierarquia pode
+    // ser profunda demais para recursão).
+    std::vector<Row> stack;
+    stack.push_back({ first, depth });
+    while (!stack.empty())
+    {
+        Row& next = stack.back();
+        if (next.id == INVALID_TRANSFORM)
+        {
+            stack.pop_back();
+            continue;
+        }
+        Row row = next;
+        next.id = index.NextSibling(row.id);
+        out.push_back(row);
+        if (m_expanded[row.id] && index.FirstChild(row.id) != INVALID_TRANSFORM)
+            stack.push_back({ index.FirstChild(row.id), row.depth + 1 });
+    }
+    return out.size() - before;
+}
+
+void SceneOutliner::Reset(const SceneIndex& index)
+{
+    m_expanded.resize(index.IdLimit(), 0);
+    m_rows.clear();
+    AppendVisible(index, index.FirstRoot(), 0, m_rows);
+    m_index_size = index.Size();
+}
+
+void SceneOutliner::Toggle(const SceneIndex& index, size_t row)
+{
+    const TransformId id = m_rows[row].id;
+    const uint32_t depth = m_rows[row].depth;
+    if (m_expanded[id])
+    {
+        // A subárvore visível são as linhas seguintes mais profundas.
+        size_t end = row + 1;
+        while (end < m_rows.size() && m_rows[end].depth > depth)
+            ++end;
+        m_rows.erase(m_rows.begin() + row + 1, m_rows.begin() + end);
+        m_expanded[id] = 0;
+    }
+    else
+    {
+        m_expanded[id] = 1;
+        m_inserted.clear();
+        AppendVisible(index, index.FirstChild(id), depth + 1, m_inserted);
+        m_rows.insert(m_rows.begin() + row + 1, m_inserted.begin(), m_inserted.end());
+    }
+}
+
+void SceneOutliner::ExpandAll(const SceneIndex& index, bool expanded)
+{
+    m_expanded.assign(index.IdLimit(), expanded ? 1 : 0);
+    Reset(index);
+}
+
+// Expande os ancestrais de "id" e rola a árvore até ele.
+void SceneOutliner::Reveal(TransformId id, const SceneIndex& index)
+{
+    m_expanded.resize(index.IdLimit(), 0);
+    bool changed = false;
+    for (TransformId a = index.Parent(id); a != INVALID_TRANSFORM; a = index.Parent(a))
+    {
+        changed = changed || !m_expanded[a];
+        m_expanded[a] = 1;
+    }
+    if (changed)
+        Reset(index);
+    m_scroll_to_selected = true;
+}
+
+void SceneOutliner::UpdateSearch(const SceneIndex& index)
+{
+    if (strcmp(m_filter, m_search) == 0)
+        return;
+    bool refine = m_search[0] != 0 && ImStristr(m_filter, NULL, m_search, NULL) != NULL;
+    if (refine)
+    {
+        // Quem não contém o texto anterior também não contém o novo: os
+        // candidatos são os resultados anteriores e os que faltava testar
+        // (o resto da lista e do intervalo), na mesma ordem.
+        m_matches.insert(m_matches.end(), m_search_source.begin() + m_source_next, m_search_source.end());
+        m_search_source.swap(m_matches);
+    }
+    else
+    {
+        m_search_source.clear();
+        m_range_next = 0;
+        m_range_end = m_filter[0] != 0 ? index.IdLimit() : 0;
+    }
+    m_matches.clear();
+    m_source_next = 0;
+    m_search_tested = 0;
+    m_search_total = m_search_source.size() + (m_range_end - m_range_next);
+    strcpy(m_search, m_filter);
+}
+
+void SceneOutliner::ContinueSearch(const SceneIndex& index)
+{
+    if (!Searching())
+        return;
+    PROFILE_SCOPE("SceneOutliner::Search");
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now();
+    const char* needle_end = m_search + strlen(m_search);
+    const size_t BLOCK = 1024; // o relógio só é consultado a cada bloco de nomes
+    while (Searching())
+    {
+        if (m_source_next < m_search_source.size())
+        {
+            size_t stop = std::min(m_source_next + BLOCK, m_search_source.size());
+            m_search_tested += stop - m_source_next;
+            for (; m_source_next < stop; ++m_source_next)
+            {
+                TransformId id = m_search_source[m_source_next];
+                if (ImStristr(index.Name(id), NULL, m_search, needle_end) != NULL)
+                    m_matches.push_back(id);
+            }
+        }
+        else
+        {
+            TransformId stop = (TransformId)std::min<size_t>((size_t)m_range_next + BLOCK, m_range_end);
+            m_search_tested += stop - m_range_next;
+            for (; m_range_next < stop; ++m_range_next)
+                if (index.Contains(m_range_next) && ImStristr(index.Name(m_range_next), NULL, m_search, needle_end) != NULL)
+                    m_matches.push_back(m_range_next);
+        }
+        if (std::chrono::duration<double, std::milli>(Clock::now() - start).count() >= SCAN_BUDGET_MS)
+            break;
+    }
+}
+
+void SceneOutliner::Show(const SceneIndex& index, TransformHierarchy& transforms)
+{
+    PROFILE_SCOPE("SceneOutliner::Show");
+    if (m_index_size != index.Size())
+        Reset(index);
+
+    ImGui::SetNextWindowSize(ImVec2(360.0f, 480.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Outliner"))
+    {
+        ImGui::End();
+        return;
+    }
+    ImGui::SetNextItemWidth(-1.0f);
+    ImGui::InputTextWithHint("##filter", "Search by name", m_filter, sizeof(m_filter));
+    UpdateSearch(index);
+    ContinueSearch(index);
+    if (m_search[0] != 0)
+    {
+        if (Searching())
+            ImGui::Text("%d matches (searching, %.0f%%)", (int)m_matches.size(),
+                        100.0 * m_search_tested / (double)m_search_total);
+        else
+            ImGui::Text("%d matches in %d objects", (int)m_matches.size(), (int)index.Size());
+    }
+    else
+    {
+        ImGui::Text("%d objects, %d rows", (int)index.Size(), (int)m_rows.size());
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Expand all"))
+            ExpandAll(index, true);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Collapse all"))
+            ExpandAll(index, false);
+    }
+
+    // O inspetor ocupa o fim da janela: nome, 3 campos e o separador.
+    const ImGuiStyle& style = ImGui::GetStyle();
+    const float inspector_height = ImGui::GetTextLineHeightWithSpacing() * 2 + ImGui::GetFrameHeightWithSpacing() * 3 +
+                                   style.ItemSpacing.y * 2;
+    ImGui::BeginChild("##rows", ImVec2(0.0f, -inspector_height), true);
+    if (m_search[0] != 0)
+        ShowMatches(index);
+    else
+        ShowTree(index);
+    ImGui::EndChild();
+
+    ShowInspector(index, transforms);
+    ImGui::End();
+}
+
+void SceneOutliner::ShowTree(const SceneIndex& index)
+{
+    const float row_height = ImGui::GetTextLineHeightWithSpacing();
+    const float indent = ImGui::GetStyle().IndentSpacing;
+    if (m_scroll_to_selected)
+    {
+        for (size_t i = 0; i < m_rows.size(); ++i)
+            if (m_rows[i].id == m_selected)
+            {
+                ImGui::SetScrollY(i * row_height - ImGui::GetWindowHeight() * 0.5f);
+                break;
+            }
+        m_scroll_to_selected = false;
+    }
+
+    // Só as linhas visíveis são submetidas; expandir ou recolher um nó muda
+    // m_rows, por isso é feito depois do laço.
+    size_t toggle = (size_t)-1;
+    ImGuiListClipper clipper((int)m_rows.size(), row_height);
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+        {
+            const Row& row = m_rows[i];
+            const bool has_children = index.FirstChild(row.id) != INVALID_TRANSFORM;
+            ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick |
+                                       ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth;
+            if (!has_children)
+                flags |= ImGuiTreeNodeFlags_Leaf;
+            if (row.id == m_selected)
+                flags |= ImGuiTreeNodeFlags_Selected;
+
+            ImGui::SetCursorPosX(ImGui::GetCursorPosX() + row.depth * indent);
+            const bool expanded = m_expanded[row.id] != 0;
+            ImGui::SetNextItemOpen(expanded);
+            const bool open = ImGui::TreeNodeEx((void*)(intptr_t)row.id, flags, "%s", index.Name(row.id));
+            if (ImGui::IsItemClicked())
+                m_selected = row.id;
+            if (has_children && open != expanded)
+                toggle = (size_t)i;
+            if (has_children)
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(%u)", index.ChildCount(row.id));
+            }
+        }
+    }
+    if (toggle != (size_t)-1)
+        Toggle(index, toggle);
+}
+
+void SceneOutliner::ShowMatches(const SceneIndex& index)
+{
+    ImGuiListClipper clipper((int)m_matches.size(), ImGui::GetTextLineHeightWithSpacing());
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+        {
+            const TransformId id = m_matches[i];
+            ImGui::PushID((int)id);
+            // Ao selecionar um resultado, a árvore já fica aberta nele para
+            // quando a busca for apagada.
+            if (ImGui::Selectable(index.Name(id), id == m_selected))
+            {
+                m_selected = id;
+                Reveal(id, index);
+            }
+            const TransformId parent = index.Parent(id);
+            if (parent != INVALID_TRANSFORM)
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("in %s", index.Name(parent));
+            }
+            ImGui::PopID();
+        }
+    }
+}
+
+void SceneOutliner::ShowInspector(const SceneIndex& index, TransformHierarchy& transforms)
+{
+    ImGui::Separator();
+    const TransformId id = m_selected;
+    if (id == INVALID_TRANSFORM || !index.Contains(id) || id >= transforms.Size())
+    {
+        ImGui::TextDisabled("Nothing selected");
+        return;
+    }
+    const TransformId parent = index.Parent(id);
+    ImGui::Text("%s", index.Name(id));
+    ImGui::SameLine();
+    ImGui::TextDisabled("(id %u, parent %s, %u children)", id,
+                        parent != INVALID_TRANSFORM ? index.Name(parent) : "none", index.ChildCount(id));
+
+    glm::vec3 position = transforms.Position(id);
+    glm::vec3 scale = transforms.Scale(id);
+    const glm::quat& rotation = transforms.Rotation(id);
+    if (m_euler_id != id || m_euler_rotation != rotation)
+    {
+        m_euler_id = id;
+        m_euler_rotation = rotation;
+        m_euler_degrees = glm::degrees(glm::eulerAngles(rotation));
+    }
+
+    bool changed = ImGui::DragFloat3("Position", &position.x, 0.01f);
+    bool rotated = ImGui::DragFloat3("Rotation", &m_euler_degrees.x, 0.5f, 0.0f, 0.0f, "%.1f deg");
+    changed = ImGui::DragFloat3("Scale", &scale.x, 0.01f) || changed || rotated;
+    if (changed)
+    {
+        glm::quat new_rotation = rotated ? glm::quat(glm::radians(m_euler_degrees)) : rotation;
+        transforms.SetLocal(id, position, new_rotation, scale);
+        m_euler_rotation = new_rotation;
+    }
+}
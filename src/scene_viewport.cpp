@@ -0,0 +1,101 @@
+#include "scene_viewport.h"
+#include "profiler.h"
+#include "shaders.h"
+
+#include <algorithm>
+
+SceneViewportLayout ComputeSceneViewportLayout(int display_width, int display_height, float scale, float max_scale,
+                                               float sharpen)
+{
+    SceneViewportLayout layout;
+    max_scale = std::max(max_scale, scale);
+    layout.display_width = std::max(display_width, 1);
+    layout.display_height = std::max(display_height, 1);
+    layout.scene_width = std::max((int)(layout.display_width * scale + 0.5f), 1);
+    layout.scene_height = std::max((int)(layout.display_height * scale + 0.5f), 1);
+    layout.target_width = SceneTargetSize(std::max((int)(layout.display_width * max_scale + 0.5f), layout.scene_width));
+    layout.target_height = SceneTargetSize(std::max((int)(layout.display_height * max_scale + 0.5f), layout.scene_height));
+    layout.sharpen = sharpen;
+
+    // A textura mostrada, da cena ou do filtro, tem o tamanho do alvo e a
+    // cena ocupa o seu canto inferior esquerdo. As linhas das texturas vão
+    // de baixo para cima, por isso V é invertido.
+    layout.uv0 = ImVec2(0.0f, (float)layout.scene_height / (float)layout.target_height);
+    layout.uv1 = ImVec2((float)layout.scene_width / (float)layout.target_width, 0.0f);
+    return layout;
+}
+
+void SceneViewport::Init(GpuResourceManager& gpu)
+{
+    m_gpu = &gpu;
+    m_pool.Init(gpu, "viewport da cena");
+    // O mesmo triângulo que cobre a tela da camada da interface.
+    GpuShader vertex_shader = gpu.AdoptShader("shader_ui_composite_vertex.glsl", LoadShader_Vertex("../src/shader_ui_composite_vertex.glsl"));
+    GpuShader fragment_shader = gpu.AdoptShader("shader_viewport_sharpen_fragment.glsl", LoadShader_Fragment("../src/shader_viewport_sharpen_fragment.glsl"));
+    m_program = gpu.AdoptProgram("programa da ampliação da cena", CreateGpuProgram(vertex_shader.Id(), fragment_shader.Id()));
+    m_max_uniform = glGetUniformLocation(m_program.Id(), "maximo");
+    m_amount_uniform = glGetUniformLocation(m_program.Id(), "intensidade");
+    glUseProgram(m_program.Id());
+    glUniform1i(glGetUniformLocation(m_program.Id(), "cena"), 0);
+    glUseProgram(0);
+
+    // O OpenGL core não desenha sem um VAO ligado, mesmo sem atributos.
+    m_vertex_array = gpu.CreateVertexArray("VAO da ampliação da cena");
+}
+
+void SceneViewport::Shutdown()
+{
+    m_pool.Clear();
+    m_scene = NULL;
+    m_vertex_array.Reset();
+    m_program.Reset();
+    m_gpu = NULL;
+}
+
+bool SceneViewport::Begin(const SceneViewportLayout& layout, const ImVec4& clear_color)
+{
+    PROFILE_SCOPE("SceneViewport::Begin");
+    m_scene = m_pool.Acquire(layout.target_width, layout.target_height);
+    if (m_scene == NULL)
+        return false;
+    // glClear() ignora o viewport: o alvo inteiro fica com a cor de fundo, e
+    // a filtragem bilinear na borda da imagem não lê restos de outro frame.
+    glBindFramebuffer(GL_FRAMEBUFFER, m_scene->Framebuffer());
+    glViewport(0, 0, layout.scene_width, layout.scene_height);
+    glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return true;
+}
+
+GLuint SceneViewport::End(const SceneViewportLayout& layout, RenderCounters& counters)
+{
+    PROFILE_SCOPE("SceneViewport::End");
+    GLuint texture = m_scene->ColorTexture();
+    RenderTarget* output = NULL;
+    // O filtro é aplicado na resolução da cena, em um segundo alvo do mesmo
+    // tamanho: o custo cai junto com a escala, e a ampliação continua sendo
+    // a filtragem bilinear da ImGui::Image().
+    if (layout.sharpen > 0.0f && m_program)
+        output = m_pool.Acquire(m_scene->Width(), m_scene->Height());
+    if (output != NULL)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, output->Framebuffer());
+        glViewport(0, 0, layout.scene_width, layout.scene_height);
+        glDisable(GL_DEPTH_TEST);
+        counters.UseProgram(m_program.Id());
+        glUniform2i(m_max_uniform, layout.scene_width - 1, layout.scene_height - 1);
+        glUniform1f(m_amount_uniform, layout.sharpen);
+        counters.Add(COUNTER_UNIFORM_UPLOADS, 2);
+        counters.BindVertexArray(m_vertex_array.Id());
+        counters.BindTexture(GL_TEXTURE_2D, texture);
+        counters.DrawArrays(GL_TRIANGLES, 0, 3);
+
+        // Devolve o estado que o resto do programa espera.
+        counters.BindVertexArray(0);
+        glEnable(GL_DEPTH_TEST);
+        texture = output->ColorTexture();
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    m_scene = NULL;
+    return texture;
+}
@@ -0,0 +1,13 @@
+#version 330 core
+
+// Fragment shader da composio da camada da interface. A camada tem o
+// tamanho da tela, ento cada fragmento l exatamente o seu pixel, sem
+// filtragem. As cores j esto multiplicadas pelo alfa.
+uniform sampler2D camada;
+
+out vec4 color;
+
+void main()
+{
+    color = texelFetch(camada, ivec2(gl_FragCoord.xy), 0);
+}
@@ -0,0 +1,10 @@
+#version 330 core
+
+// Vertex shader da composio da camada da interface (veja ui_layer.h): um
+// nico tringulo que cobre a tela inteira, sem atributos; os trs vrtices
+// so calculados a partir de gl_VertexID.
+void main()
+{
+    vec2 position = vec2((gl_VertexID & 1) * 4.0 - 1.0, (gl_VertexID >> 1) * 4.0 - 1.0);
+    gl_Position = vec4(position, 0.0, 1.0);
+}
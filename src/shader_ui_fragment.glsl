@@ -0,0 +1,15 @@
+#version 330 core
+
+// Fragment shader da interface: a cor do vrtice multiplicada pela textura
+// (o atlas de fontes, ou uma imagem mostrada pela interface).
+in vec2 uv_interpolado;
+in vec4 cor_interpolada;
+
+uniform sampler2D textura;
+
+out vec4 color;
+
+void main()
+{
+    color = cor_interpolada * texture(textura, uv_interpolado);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+
+// Vertex shader da interface (veja ui_renderer.h). Os atributos so os
+// campos de ImDrawVert: posio em pixels, coordenadas de textura e cor
+// (quatro bytes, normalizados para [0, 1] pelo VAO).
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 uv;
+layout (location = 2) in vec4 color;
+
+// Projeo ortogrfica da rea da tela ocupada pela interface.
+uniform mat4 projection;
+
+out vec2 uv_interpolado;
+out vec4 cor_interpolada;
+
+void main()
+{
+    uv_interpolado = uv;
+    cor_interpolada = color;
+    gl_Position = projection * vec4(position, 0.0, 1.0);
+}
@@ -18,6 +18,8 @@ uniform mat4 projection;
 
 // Varivel booleana no cdigo C++ tambm enviada para a GPU
 uniform bool render_as_black;
+// Objeto selecionado na interface (veja scene_outliner.h): desenhado em amarelo
+uniform bool render_as_highlight;
 
 void main()
 {
@@ -51,6 +53,11 @@ void main()
         // preta. Utilizamos isto para renderizar as arestas pretas dos cubos.
         cor_interpolada_pelo_rasterizador = vec4(0.0f,0.0f,0.0f,1.0f);
     }
+    else if ( render_as_highlight )
+    {
+        // Arestas do objeto selecionado no "Outliner".
+        cor_interpolada_pelo_rasterizador = vec4(1.0f,0.8f,0.0f,1.0f);
+    }
     else
     {
         // Copiamos o atributo cor (de entrada) de cada vrtice para a varivel
@@ -0,0 +1,27 @@
+#version 330 core
+
+// Fragment shader do filtro de nitidez da cena (veja scene_viewport.h). 
+// executado na resoluo da cena, antes da ampliao: cada pixel l a si
+// mesmo e aos quatro vizinhos em cruz, sem filtragem (texelFetch), e soma a
+// diferena entre ele e a mdia dos vizinhos, uma mscara de nitidez
+// ("unsharp mask") que compensa parte do contraste das bordas perdido na
+// ampliao bilinear feita pela interface.
+uniform sampler2D cena;
+uniform ivec2 maximo;      // ltimo pixel da cena dentro do alvo
+uniform float intensidade;
+
+out vec4 color;
+
+vec3 Amostra(ivec2 pixel)
+{
+    return texelFetch(cena, clamp(pixel, ivec2(0), maximo), 0).rgb;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec3 centro = Amostra(pixel);
+    vec3 vizinhas = Amostra(pixel + ivec2(1, 0)) + Amostra(pixel - ivec2(1, 0)) +
+                    Amostra(pixel + ivec2(0, 1)) + Amostra(pixel - ivec2(0, 1));
+    color = vec4(clamp(centro + intensidade * (centro - 0.25 * vizinhas), 0.0, 1.0), 1.0);
+}
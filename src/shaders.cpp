@@ -1,4 +1,21 @@
 #include "shaders.h"
+#include "allocators.h"
+#include "profiler.h"
+
+#include <atomic>
+
+static std::atomic<uint64_t> s_shaders_compiled(0);
+static std::atomic<uint64_t> s_programs_linked(0);
+
+static void CompileShader(const char* filename, const GLchar* code, GLint length, GLuint shader_id);
+
+ShaderStats GetShaderStats()
+{
+    ShaderStats stats;
+    stats.shaders_compiled = s_shaders_compiled.load(std::memory_order_relaxed);
+    stats.programs_linked = s_programs_linked.load(std::memory_order_relaxed);
+    return stats;
+}
 
 // Carrega um Vertex Shader de um arquivo GLSL. Veja definição de LoadShader() abaixo.
 GLuint LoadShader_Vertex(const char* filename)
@@ -28,32 +45,88 @@ GLuint LoadShader_Fragment(const char* filename)
     return fragment_shader_id;
 }
 
-// função auxilar, utilizada pelas duas funções acima. Carrega código de GPU de
+// As mesmas duas funções, para o código-fonte já lido por ReadShaderSource().
+GLuint LoadShader_Vertex(const ShaderSource& source)
+{
+    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+    CompileShader(source.filename.c_str(), source.code.data(), (GLint)source.code.size(), vertex_shader_id);
+    return vertex_shader_id;
+}
+
+GLuint LoadShader_Fragment(const ShaderSource& source)
+{
+    GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+    CompileShader(source.filename.c_str(), source.code.data(), (GLint)source.code.size(), fragment_shader_id);
+    return fragment_shader_id;
+}
+
+// Lê o arquivo inteiro para a memória, sem chamar o OpenGL: pode rodar em
+// qualquer thread enquanto o contexto ainda está sendo criado (veja main()).
+bool ReadShaderSource(const char* filename, ShaderSource* source)
+{
+    PROFILE_SCOPE("ReadShaderSource");
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        fprintf(stderr, "ERROR: Cannot open file \"%s\".\n", filename);
+        return false;
+    }
+    std::ostringstream code;
+    code << file.rdbuf();
+    source->filename = filename;
+    source->code = code.str();
+    return true;
+}
+
+// função auxilar, utilizada pelas duas primeiras funções acima. Carrega código de GPU de
 // um arquivo GLSL e faz sua compilação.
 void LoadShader(const char* filename, GLuint shader_id)
 {
+    PROFILE_SCOPE("LoadShader");
     // Lemos o arquivo de texto indicado pela variável "filename"
     // e colocamos seu conteúdo em memória, apontado pela variável
     // "shader_string".
     std::ifstream file;
     try {
         file.exceptions(std::ifstream::failbit);
-        file.open(filename);
+        file.open(filename, std::ios::binary);
     } catch ( std::exception& e ) {
         fprintf(stderr, "ERROR: Cannot open file \"%s\". Error: %s\n", filename, e.what());
         std::exit(1);
     }
-    std::stringstream shader;
-    shader << file.rdbuf();
-    std::string str = shader.str();
-    const GLchar* shader_string = str.c_str();
-    const GLint   shader_string_length = static_cast<GLint>( str.length() );
 
-    // Define o código do shader GLSL, contido na string "shader_string"
-    glShaderSource(shader_id, 1, &shader_string, &shader_string_length);
+    // O código-fonte e o log de compilação só são necessários durante esta
+    // função: ficam na arena de rascunho (veja allocators.h), que é
+    // restaurada ao sair do escopo, em vez de irem para o heap.
+    LinearArena& scratch = ScratchArena();
+    ArenaScope scratch_scope(scratch);
+
+    file.seekg(0, std::ios::end);
+    const std::streamsize file_size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    GLchar* shader_string = static_cast<GLchar*>(scratch.Allocate((size_t)file_size + 1, 1));
+    file.read(shader_string, file_size);
+    shader_string[file_size] = '\0';
+    const GLint shader_string_length = static_cast<GLint>( file_size );
+
+    CompileShader(filename, shader_string, shader_string_length, shader_id);
+}
+
+// Compila o código GLSL "code" no shader "shader_id" e imprime o log de
+// compilação, se houver. "filename" só aparece nas mensagens.
+static void CompileShader(const char* filename, const GLchar* code, GLint length, GLuint shader_id)
+{
+    // O log de compilação só é necessário durante esta função (veja
+    // LoadShader()).
+    LinearArena& scratch = ScratchArena();
+    ArenaScope scratch_scope(scratch);
+
+    // Define o código do shader GLSL, contido na string "code"
+    glShaderSource(shader_id, 1, &code, &length);
 
     // Compila o código do shader GLSL (em tempo de execução)
     glCompileShader(shader_id);
+    s_shaders_compiled.fetch_add(1, std::memory_order_relaxed);
 
     // Verificamos se ocorreu algum erro ou "warning" durante a compilação
     GLint compiled_ok;
@@ -62,15 +135,15 @@ void LoadShader(const char* filename, GLuint shader_id)
     GLint log_length = 0;
     glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &log_length);
 
-    // Alocamos memória para guardar o log de compilação.
-    // A chamada "new" em C++ é equivalente ao "malloc()" do C.
-    GLchar* log = new GLchar[log_length];
+    // Alocamos memória (da arena) para guardar o log de compilação.
+    GLchar* log = static_cast<GLchar*>(scratch.Allocate((size_t)log_length + 1, 1));
+    log[0] = '\0';
     glGetShaderInfoLog(shader_id, log_length, &log_length, log);
 
     // Imprime no terminal qualquer erro ou "warning" de compilação
     if ( log_length != 0 )
     {
-        std::string  output;
+        std::pmr::string output(&scratch);
 
         if ( !compiled_ok )
         {
@@ -93,15 +166,13 @@ void LoadShader(const char* filename, GLuint shader_id)
 
         fprintf(stderr, "%s", output.c_str());
     }
-
-    // A chamada "delete" em C++ é equivalente ao "free()" do C
-    delete [] log;
 }
 
 // Esta função cria um programa de GPU, o qual contém obrigatoriamente um
 // Vertex Shader e um Fragment Shader.
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
 {
+    PROFILE_SCOPE("CreateGpuProgram");
     // Criamos um identificador (ID) para este programa de GPU
     GLuint program_id = glCreateProgram();
 
@@ -111,6 +182,7 @@ GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
 
     // Linkagem dos shaders acima ao programa
     glLinkProgram(program_id);
+    s_programs_linked.fetch_add(1, std::memory_order_relaxed);
 
     // Verificamos se ocorreu algum erro durante a linkagem
     GLint linked_ok = GL_FALSE;
@@ -122,22 +194,22 @@ GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id)
         GLint log_length = 0;
         glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &log_length);
 
-        // Alocamos memória para guardar o log de compilação.
-        // A chamada "new" em C++ é equivalente ao "malloc()" do C.
-        GLchar* log = new GLchar[log_length];
+        // Alocamos memória para guardar o log de linkagem, na arena de
+        // rascunho (veja LoadShader()).
+        LinearArena& scratch = ScratchArena();
+        ArenaScope scratch_scope(scratch);
+        GLchar* log = static_cast<GLchar*>(scratch.Allocate((size_t)log_length + 1, 1));
+        log[0] = '\0';
 
         glGetProgramInfoLog(program_id, log_length, &log_length, log);
 
-        std::string output;
+        std::pmr::string output(&scratch);
 
         output += "ERROR: OpenGL linking of program failed.\n";
         output += "== Start of link log\n";
         output += log;
         output += "\n== End of link log\n";
 
-        // A chamada "delete" em C++ é equivalente ao "free()" do C
-        delete [] log;
-
         fprintf(stderr, "%s", output.c_str());
     }
 
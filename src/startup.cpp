@@ -0,0 +1,36 @@
+#include "startup.h"
+
+StartupTimeline::StartupTimeline()
+    : m_start(FrameClock::now()), m_count(0), m_first_frame_ms(-1.0f)
+{
+}
+
+void StartupTimeline::Add(const char* name, FrameClock::time_point begin)
+{
+    FrameClock::time_point end = FrameClock::now();
+    int index = m_count.fetch_add(1, std::memory_order_relaxed);
+    if (index >= MAX_STEPS)
+        return;
+    m_steps[index].name = name;
+    m_steps[index].begin_ms = std::chrono::duration<float, std::milli>(begin - m_start).count();
+    m_steps[index].end_ms = std::chrono::duration<float, std::milli>(end - m_start).count();
+}
+
+void StartupTimeline::SetFirstFrame(FrameClock::time_point presented)
+{
+    m_first_frame_ms = std::chrono::duration<float, std::milli>(presented - m_start).count();
+}
+
+void StartupTimeline::Print(FILE* out) const
+{
+    int count = m_count.load(std::memory_order_acquire);
+    if (count > MAX_STEPS)
+        count = MAX_STEPS;
+    if (HasFirstFrame())
+        fprintf(out, "Startup: first frame after %.1f ms\n", m_first_frame_ms);
+    else
+        fprintf(out, "Startup:\n");
+    for (int i = 0; i < count; ++i)
+        fprintf(out, "  %-24s %7.1f - %7.1f ms (%.1f ms)\n", m_steps[i].name, m_steps[i].begin_ms, m_steps[i].end_ms,
+                m_steps[i].end_ms - m_steps[i].begin_ms);
+}
@@ -0,0 +1,171 @@
+#include "timestep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+FixedTimestep::FixedTimestep(double ticks_per_second, int max_steps, double max_frame_time)
+    : m_dt(1.0 / ticks_per_second), m_max_steps(max_steps), m_max_frame_time(max_frame_time),
+      m_frame_time(0.0), m_last_steps(0), m_dropped_time(0.0)
+{
+    Reset();
+}
+
+void FixedTimestep::Reset()
+{
+    m_last = FrameClock::now();
+    m_accumulator = 0.0;
+}
+
+void FixedTimestep::SetTicksPerSecond(double ticks_per_second)
+{
+    // Mantém a mesma fração de passo, para que Alpha() não salte.
+    double alpha = m_accumulator / m_dt;
+    m_dt = 1.0 / ticks_per_second;
+    m_accumulator = alpha * m_dt;
+}
+
+int FixedTimestep::Advance()
+{
+    FrameClock::time_point now = FrameClock::now();
+    m_frame_time = std::chrono::duration<double>(now - m_last).count();
+    m_last = now;
+
+    // Frames muito longos (janela arrastada, breakpoint, ...) são truncados.
+    double elapsed = m_frame_time;
+    if (elapsed > m_max_frame_time)
+    {
+        m_dropped_time += elapsed - m_max_frame_time;
+        elapsed = m_max_frame_time;
+    }
+    m_accumulator += elapsed;
+
+    int steps = (int)(m_accumulator / m_dt);
+    if (steps > m_max_steps)
+    {
+        // A simulação não está conseguindo acompanhar o tempo real:
+        // descartamos os passos atrasados em vez de acumulá-los.
+        m_dropped_time += (steps - m_max_steps) * m_dt;
+        m_accumulator -= (steps - m_max_steps) * m_dt;
+        steps = m_max_steps;
+    }
+    m_accumulator = std::max(0.0, m_accumulator - steps * m_dt);
+    m_last_steps = steps;
+    return steps;
+}
+
+FrameClock::time_point FixedTimestep::StepEndTime(int step) const
+{
+    double before_end = m_accumulator + (m_last_steps - 1 - step) * m_dt;
+    return m_last - std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(before_end));
+}
+
+FrameLimiter::FrameLimiter()
+    : m_target_fps(0.0), m_period(FrameClock::duration::zero()), m_next(FrameClock::now()),
+      m_spin(std::chrono::microseconds(MAX_SPIN_US)), m_oversleep(std::chrono::microseconds(MAX_SPIN_US))
+{
+    SetTargetFPS(60.0);
+}
+
+void FrameLimiter::SetTargetFPS(double fps)
+{
+    if (fps == m_target_fps)
+        return;
+    m_target_fps = fps;
+    m_period = std::chrono::duration_cast<FrameClock::duration>(std::chrono::duration<double>(1.0 / fps));
+    m_next = FrameClock::now() + m_period;
+}
+
+void FrameLimiter::Wait()
+{
+    // O sleep do sistema operacional pode acordar com atraso; dormimos até
+    // m_spin antes e esperamos o resto em espera ativa.
+    FrameClock::time_point now = FrameClock::now();
+    if (m_next - now > m_spin)
+    {
+        FrameClock::time_point wake = m_next - m_spin;
+        std::this_thread::sleep_until(wake);
+        // O maior atraso decai 1/16 por frame, para que um atraso isolado
+        // não deixe a margem grande para sempre.
+        FrameClock::duration late = FrameClock::now() - wake;
+        m_oversleep = std::max(late, m_oversleep - m_oversleep / 16);
+        m_spin = std::min(std::max(m_oversleep + std::chrono::microseconds(MIN_SPIN_US) / 2,
+                                   FrameClock::duration(std::chrono::microseconds(MIN_SPIN_US))),
+                          FrameClock::duration(std::chrono::microseconds(MAX_SPIN_US)));
+    }
+    while (FrameClock::now() < m_next)
+        std::this_thread::yield();
+
+    // Se estamos atrasados mais de um frame, não tentamos recuperar os frames
+    // perdidos (o que geraria uma rajada de frames sem espera).
+    m_next += m_period;
+    now = FrameClock::now();
+    if (m_next < now)
+        m_next = now + m_period;
+}
+
+PacingStats::PacingStats()
+    : m_interval_count(0), m_interval_next(0), m_latency_count(0), m_latency_next(0), m_last_presented(),
+      m_has_last(false)
+{
+}
+
+void PacingStats::Add(FrameClock::time_point presented, FrameClock::time_point input_sampled)
+{
+    m_latencies[m_latency_next] = std::chrono::duration<float, std::milli>(presented - input_sampled).count();
+    m_latency_next = (m_latency_next + 1) % HISTORY;
+    m_latency_count = std::min(m_latency_count + 1, HISTORY);
+
+    if (m_has_last)
+    {
+        double interval = std::chrono::duration<double, std::milli>(presented - m_last_presented).count();
+        if (interval > MAX_INTERVAL_MS)
+            m_interval_count = 0;
+        else
+        {
+            m_intervals[m_interval_next] = (float)interval;
+            m_interval_next = (m_interval_next + 1) % HISTORY;
+            m_interval_count = std::min(m_interval_count + 1, HISTORY);
+        }
+    }
+    m_last_presented = presented;
+    m_has_last = true;
+}
+
+// Os valores estão em um anel; a ordem não importa para estas contas.
+float PacingStats::IntervalMs() const
+{
+    double sum = 0.0;
+    for (int i = 0; i < m_interval_count; ++i)
+        sum += m_intervals[(m_interval_next + HISTORY - 1 - i) % HISTORY];
+    return m_interval_count > 0 ? (float)(sum / m_interval_count) : 0.0f;
+}
+
+float PacingStats::JitterMs() const
+{
+    if (m_interval_count < 2)
+        return 0.0f;
+    double mean = IntervalMs(), sum = 0.0;
+    for (int i = 0; i < m_interval_count; ++i)
+    {
+        double d = m_intervals[(m_interval_next + HISTORY - 1 - i) % HISTORY] - mean;
+        sum += d * d;
+    }
+    return (float)std::sqrt(sum / (m_interval_count - 1));
+}
+
+float PacingStats::LatencyMs() const
+{
+    double sum = 0.0;
+    for (int i = 0; i < m_latency_count; ++i)
+        sum += m_latencies[i];
+    return m_latency_count > 0 ? (float)(sum / m_latency_count) : 0.0f;
+}
+
+float PacingStats::MaxLatencyMs() const
+{
+    float max_ms = 0.0f;
+    for (int i = 0; i < m_latency_count; ++i)
+        max_ms = std::max(max_ms, m_latencies[i]);
+    return max_ms;
+}
@@ -0,0 +1,51 @@
+#include "trace.h"
+
+#include <cstdio>
+#include <set>
+
+void TraceThreadName(int thread, char* out, size_t size)
+{
+    switch (thread)
+    {
+    case TRACE_THREAD_MAIN:   snprintf(out, size, "Main"); break;
+    case TRACE_THREAD_RENDER: snprintf(out, size, "Render"); break;
+    case TRACE_THREAD_GPU:    snprintf(out, size, "GPU"); break;
+    default:                  snprintf(out, size, "Worker %d", thread - TRACE_THREAD_WORKERS); break;
+    }
+}
+
+bool WriteChromeTrace(const char* path, const std::vector<TraceEvent>& events)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: cannot open \"%s\" for writing.\n", path);
+        return false;
+    }
+
+    // Eventos "M" (metadados) dão nome às linhas; eventos "X" são intervalos
+    // completos, com início e duração em microssegundos.
+    std::set<int> threads;
+    threads.insert(TRACE_THREAD_MAIN);
+    threads.insert(TRACE_THREAD_RENDER);
+    threads.insert(TRACE_THREAD_GPU);
+    for (const TraceEvent& event : events)
+        threads.insert(event.thread);
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (int thread : threads)
+    {
+        char name[32];
+        TraceThreadName(thread, name, sizeof(name));
+        fprintf(file, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                thread == *threads.begin() ? "" : ",", thread, name);
+    }
+    for (const TraceEvent& event : events)
+        fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                event.name, event.thread, event.start_us, event.duration_us);
+    fprintf(file, "\n]}\n");
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,352 @@
+#include "transforms.h"
+#include "matrices_batch.h"
+#include "job_system.h"
+#include "profiler.h"
+
+#include <algorithm>
+
+// Abaixo deste número de nós não vale a pena dividir o trabalho em tarefas:
+// o custo de distribuí-las supera o ganho do paralelismo.
+static const uint32_t MIN_NODES_PER_THREAD = 4096;
+
+TransformHierarchy::TransformHierarchy()
+    : m_needs_sort(false), m_last_updated(0)
+{
+}
+
+void TransformHierarchy::Reserve(size_t count)
+{
+    m_positions.reserve(count);
+    m_rotations.reserve(count);
+    m_scales.reserve(count);
+    m_parents.reserve(count);
+    m_subtree_sizes.reserve(count);
+    m_world.reserve(count);
+    m_dirty.reserve(count);
+    m_index_of.reserve(count);
+    m_id_of.reserve(count);
+}
+
+TransformId TransformHierarchy::Create(TransformId parent)
+{
+    uint32_t index = (uint32_t)m_parents.size();
+    uint32_t parent_index = (parent == INVALID_TRANSFORM) ? INVALID_TRANSFORM : m_index_of[parent];
+
+    TransformId id = (TransformId)m_index_of.size();
+    m_index_of.push_back(index);
+    m_id_of.push_back(id);
+
+    m_positions.push_back(glm::vec3(0.0f));
+    m_rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+    m_scales.push_back(glm::vec3(1.0f));
+    m_parents.push_back(parent_index);
+    m_subtree_sizes.push_back(1);
+    m_world.push_back(glm::mat4(1.0f));
+    m_dirty.push_back(0);
+
+    // Se o pai é o último nó da pré-ordem (sua subárvore termina exatamente
+    // onde o novo nó foi inserido), a ordem continua válida e basta aumentar
+    // o tamanho das subárvores dos ancestrais. Caso contrário, a hierarquia
+    // será reordenada no próximo Update().
+    if (parent_index != INVALID_TRANSFORM && !m_needs_sort)
+    {
+        if (parent_index + m_subtree_sizes[parent_index] == index)
+        {
+            for (uint32_t a = parent_index; a != INVALID_TRANSFORM; a = m_parents[a])
+                m_subtree_sizes[a] += 1;
+        }
+        else
+        {
+            m_needs_sort = true;
+        }
+    }
+
+    MarkDirty(index);
+    return id;
+}
+
+void TransformHierarchy::SetPosition(TransformId id, const glm::vec3& position)
+{
+    uint32_t index = m_index_of[id];
+    m_positions[index] = position;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetRotation(TransformId id, const glm::quat& rotation)
+{
+    uint32_t index = m_index_of[id];
+    m_rotations[index] = rotation;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetScale(TransformId id, const glm::vec3& scale)
+{
+    uint32_t index = m_index_of[id];
+    m_scales[index] = scale;
+    MarkDirty(index);
+}
+
+void TransformHierarchy::SetLocal(TransformId id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+    uint32_t index = m_index_of[id];
+    m_positions[index] = position;
+    m_rotations[index] = rotation;
+    m_scales[index] = scale;
+    MarkDirty(index);
+}
+
+const glm::vec3& TransformHierarchy::Position(TransformId id) const
+{
+    return m_positions[m_index_of[id]];
+}
+
+const glm::quat& TransformHierarchy::Rotation(TransformId id) const
+{
+    return m_rotations[m_index_of[id]];
+}
+
+const glm::vec3& TransformHierarchy::Scale(TransformId id) const
+{
+    return m_scales[m_index_of[id]];
+}
+
+TransformId TransformHierarchy::Parent(TransformId id) const
+{
+    uint32_t parent_index = m_parents[m_index_of[id]];
+    return (parent_index == INVALID_TRANSFORM) ? INVALID_TRANSFORM : m_id_of[parent_index];
+}
+
+const glm::mat4& TransformHierarchy::World(TransformId id) const
+{
+    return m_world[m_index_of[id]];
+}
+
+void TransformHierarchy::MarkDirty(uint32_t index)
+{
+    if (m_dirty[index])
+        return;
+    m_dirty[index] = 1;
+    m_dirty_list.push_back(index);
+}
+
+// Reordena todos os nós em pré-ordem de busca em profundidade, mantendo a
+// ordem relativa de irmãos. Só é chamada quando um nó foi criado fora de
+// ordem; depois dela todas as matrizes world são recalculadas.
+void TransformHierarchy::Sort()
+{
+    const uint32_t n = (uint32_t)m_parents.size();
+
+    // Listas encadeadas de filhos, em ordem crescente de índice.
+    std::vector<uint32_t> first_child(n, INVALID_TRANSFORM);
+    std::vector<uint32_t> next_sibling(n, INVALID_TRANSFORM);
+    for (uint32_t i = n; i-- > 0; )
+    {
+        uint32_t p = m_parents[i];
+        if (p == INVALID_TRANSFORM)
+            continue;
+        next_sibling[i] = first_child[p];
+        first_child[p] = i;
+    }
+
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    for (uint32_t root = 0; root < n; ++root)
+    {
+        if (m_parents[root] != INVALID_TRANSFORM)
+            continue;
+
+        uint32_t cur = root;
+        while (true)
+        {
+            order.push_back(cur);
+            if (first_child[cur] != INVALID_TRANSFORM)
+            {
+                cur = first_child[cur];
+                continue;
+            }
+            while (cur != root && next_sibling[cur] == INVALID_TRANSFORM)
+                cur = m_parents[cur];
+            if (cur == root)
+                break;
+            cur = next_sibling[cur];
+        }
+    }
+
+    std::vector<uint32_t> new_index(n);
+    for (uint32_t k = 0; k < n; ++k)
+        new_index[order[k]] = k;
+
+    std::vector<glm::vec3>   positions(n);
+    std::vector<glm::quat>   rotations(n);
+    std::vector<glm::vec3>   scales(n);
+    std::vector<uint32_t>    parents(n);
+    std::vector<TransformId> id_of(n);
+    for (uint32_t k = 0; k < n; ++k)
+    {
+        uint32_t old = order[k];
+        positions[k] = m_positions[old];
+        rotations[k] = m_rotations[old];
+        scales[k]    = m_scales[old];
+        parents[k]   = (m_parents[old] == INVALID_TRANSFORM) ? INVALID_TRANSFORM : new_index[m_parents[old]];
+        id_of[k]     = m_id_of[old];
+        m_index_of[id_of[k]] = k;
+    }
+    m_positions.swap(positions);
+    m_rotations.swap(rotations);
+    m_scales.swap(scales);
+    m_parents.swap(parents);
+    m_id_of.swap(id_of);
+
+    // Como o pai sempre precede os filhos, percorrendo de trás para frente
+    // cada subárvore já está completa quando chegamos em sua raiz.
+    std::fill(m_subtree_sizes.begin(), m_subtree_sizes.end(), 1u);
+    for (uint32_t k = n; k-- > 0; )
+        if (m_parents[k] != INVALID_TRANSFORM)
+            m_subtree_sizes[m_parents[k]] += m_subtree_sizes[k];
+
+    std::fill(m_dirty.begin(), m_dirty.end(), (uint8_t)0);
+    m_dirty_list.clear();
+    for (uint32_t k = 0; k < n; ++k)
+        if (m_parents[k] == INVALID_TRANSFORM)
+            MarkDirty(k);
+
+    m_needs_sort = false;
+}
+
+void TransformHierarchy::UpdateNode(uint32_t index)
+{
+    glm::mat4 local;
+    Batch_ComposeTRS(&m_positions[index], &m_rotations[index], &m_scales[index], &local, 1);
+
+    uint32_t p = m_parents[index];
+    m_world[index] = (p == INVALID_TRANSFORM) ? local : m_world[p] * local;
+}
+
+// Processa um intervalo em blocos: as matrizes locais do bloco são montadas
+// de uma vez com Batch_ComposeTRS() e depois multiplicadas pelas dos pais.
+// Intervalos pequenos (folhas, na maioria) são processados nó a nó.
+void TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end)
+{
+    const uint32_t BLOCK = 64;
+    if (end - begin < 8)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+            UpdateNode(i);
+        return;
+    }
+
+    glm::mat4 local[BLOCK];
+    for (uint32_t first = begin; first < end; first += BLOCK)
+    {
+        uint32_t count = std::min(BLOCK, end - first);
+        Batch_ComposeTRS(&m_positions[first], &m_rotations[first], &m_scales[first], local, count);
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            uint32_t p = m_parents[first + k];
+            m_world[first + k] = (p == INVALID_TRANSFORM) ? local[k] : m_world[p] * local[k];
+        }
+    }
+}
+
+void TransformHierarchy::UpdateAll()
+{
+    if (m_needs_sort)
+        Sort();
+    UpdateRange(0, (uint32_t)m_parents.size());
+    for (uint32_t index : m_dirty_list)
+        m_dirty[index] = 0;
+    m_dirty_list.clear();
+    m_last_updated = m_parents.size();
+}
+
+void TransformHierarchy::Update(JobSystem* jobs)
+{
+    PROFILE_SCOPE("TransformHierarchy::Update");
+    if (m_needs_sort)
+        Sort();
+
+    m_last_updated = 0;
+    if (m_dirty_list.empty())
+        return;
+
+    // Em ordem crescente, um nó sujo que está dentro da subárvore de outro nó
+    // sujo já processado é simplesmente ignorado: seu ancestral o recalcula.
+    std::sort(m_dirty_list.begin(), m_dirty_list.end());
+    m_ranges.clear();
+    uint32_t covered_end = 0;
+    uint32_t total = 0;
+    for (uint32_t index : m_dirty_list)
+    {
+        m_dirty[index] = 0;
+        if (index < covered_end)
+            continue;
+        covered_end = index + m_subtree_sizes[index];
+        m_ranges.push_back(Range(index, covered_end));
+        total += covered_end - index;
+    }
+    m_dirty_list.clear();
+    m_last_updated = total;
+
+    const unsigned int num_threads = (jobs != NULL) ? jobs->NumThreads() : 1;
+    if (num_threads <= 1 || total < 2 * MIN_NODES_PER_THREAD)
+    {
+        for (const Range& r : m_ranges)
+            UpdateRange(r.first, r.second);
+        return;
+    }
+
+    // Subárvores muito grandes são quebradas: a raiz é calculada aqui, e cada
+    // subárvore filha vira um intervalo independente.
+    const uint32_t grain = std::max(total / (num_threads * 4), MIN_NODES_PER_THREAD);
+    std::vector<Range> work;
+    std::vector<Range> pending(m_ranges.rbegin(), m_ranges.rend());
+    while (!pending.empty())
+    {
+        Range r = pending.back();
+        pending.pop_back();
+        if (r.second - r.first <= grain)
+        {
+            work.push_back(r);
+            continue;
+        }
+        UpdateNode(r.first);
+        std::vector<Range> children;
+        for (uint32_t c = r.first + 1; c < r.second; c += m_subtree_sizes[c])
+            children.push_back(Range(c, c + m_subtree_sizes[c]));
+        pending.insert(pending.end(), children.rbegin(), children.rend());
+    }
+
+    // Agrupa os intervalos em blocos contíguos com número similar de nós
+    // (alguns por thread, para que o roubo de trabalho equilibre a carga),
+    // e cada bloco vira uma tarefa.
+    uint32_t work_total = 0;
+    for (const Range& r : work)
+        work_total += r.second - r.first;
+    const uint32_t per_job = work_total / (num_threads * 4) + 1;
+
+    std::vector<size_t> group_begin(1, 0);
+    uint32_t acc = 0;
+    for (size_t w = 0; w < work.size(); ++w)
+    {
+        acc += work[w].second - work[w].first;
+        if (acc >= per_job)
+        {
+            group_begin.push_back(w + 1);
+            acc = 0;
+        }
+    }
+    if (group_begin.back() != work.size())
+        group_begin.push_back(work.size());
+
+    JobCounter counter;
+    for (size_t g = 0; g + 1 < group_begin.size(); ++g)
+    {
+        const size_t first = group_begin[g];
+        const size_t last = group_begin[g + 1];
+        jobs->Run(&counter, [this, &work, first, last]() {
+            for (size_t w = first; w < last; ++w)
+                UpdateRange(work[w].first, work[w].second);
+        });
+    }
+    jobs->Wait(&counter);
+}
@@ -0,0 +1,157 @@
+#include "ui_layer.h"
+#include "profiler.h"
+#include "shaders.h"
+
+#include <cstring>
+
+void UiLayer::Init(GpuResourceManager& gpu)
+{
+    m_gpu = &gpu;
+    GpuShader vertex_shader = gpu.AdoptShader("shader_ui_composite_vertex.glsl", LoadShader_Vertex("../src/shader_ui_composite_vertex.glsl"));
+    GpuShader fragment_shader = gpu.AdoptShader("shader_ui_composite_fragment.glsl", LoadShader_Fragment("../src/shader_ui_composite_fragment.glsl"));
+    m_program = gpu.AdoptProgram("programa da camada da interface", CreateGpuProgram(vertex_shader.Id(), fragment_shader.Id()));
+    m_layer_uniform = glGetUniformLocation(m_program.Id(), "camada");
+    glUseProgram(m_program.Id());
+    glUniform1i(m_layer_uniform, 0);
+    glUseProgram(0);
+
+    // O OpenGL core não desenha sem um VAO ligado, mesmo sem atributos.
+    m_vertex_array = gpu.CreateVertexArray("VAO da camada da interface");
+    m_valid = false;
+}
+
+void UiLayer::Shutdown()
+{
+    m_target = RenderTarget();
+    m_vertex_array.Reset();
+    m_program.Reset();
+    m_valid = false;
+    m_gpu = NULL;
+}
+
+void UiLayer::Begin(int width, int height)
+{
+    PROFILE_SCOPE("UiLayer::Begin");
+    m_valid = m_gpu != NULL && m_target.Create(*m_gpu, "camada da interface", width, height);
+    if (!m_valid)
+        return;
+    glBindFramebuffer(GL_FRAMEBUFFER, m_target.Framebuffer());
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void UiLayer::End(GLuint framebuffer)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void UiLayer::Composite(RenderCounters& counters)
+{
+    PROFILE_SCOPE("UiLayer::Composite");
+    if (!m_valid || !m_program)
+        return;
+
+    // Cores pré-multiplicadas: cena * (1 - alfa) + camada.
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+    counters.UseProgram(m_program.Id());
+    counters.BindVertexArray(m_vertex_array.Id());
+    counters.BindTexture(GL_TEXTURE_2D, m_target.ColorTexture());
+    counters.DrawArrays(GL_TRIANGLES, 0, 3);
+
+    // Devolve o estado que o resto do programa espera.
+    counters.BindVertexArray(0);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+UiRefreshPolicy::UiRefreshPolicy()
+    : m_valid(false), m_width(0), m_height(0), m_interaction(0), m_forced_frames(0),
+      m_hash(0), m_last_redraw(), m_redraws(0)
+{
+}
+
+bool UiRefreshPolicy::Update(const ImDrawData* draw_data, uint64_t interaction, bool interacting,
+                             int width, int height, float live_refresh_hz)
+{
+    PROFILE_SCOPE("UiRefreshPolicy::Update");
+    FrameClock::time_point now = FrameClock::now();
+    bool redraw = false;
+    if (!m_valid || width != m_width || height != m_height)
+        redraw = true;
+    if (interaction != m_interaction)
+    {
+        m_interaction = interaction;
+        m_forced_frames = INTERACTION_FRAMES;
+    }
+    if (m_forced_frames > 0)
+    {
+        --m_forced_frames;
+        redraw = true;
+    }
+    if (interacting)
+        redraw = true;
+
+    // O hash só é calculado quando nenhuma das regras acima decidiu.
+    uint64_t hash = redraw ? 0 : HashDrawData(draw_data);
+    if (!redraw && hash != m_hash)
+    {
+        double interval = live_refresh_hz > 0.0f ? 1.0 / live_refresh_hz : 0.0;
+        redraw = std::chrono::duration<double>(now - m_last_redraw).count() >= interval;
+    }
+    if (!redraw)
+        return false;
+
+    // Guarda o hash do que vai ser desenhado, para a comparação seguinte.
+    m_hash = hash != 0 ? hash : HashDrawData(draw_data);
+    m_valid = true;
+    m_width = width;
+    m_height = height;
+    m_last_redraw = now;
+    ++m_redraws;
+    return true;
+}
+
+// Mistura "size" bytes (múltiplo de 4) em "hash", quatro bytes por vez:
+// uma variação do FNV-1a por palavra em vez de por byte, rápida o bastante
+// para ser chamada a cada frame com os vértices de toda a interface.
+static uint64_t HashWords(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i + 4 <= size; i += 4)
+    {
+        uint32_t word;
+        memcpy(&word, bytes + i, 4);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t HashDrawData(const ImDrawData* draw_data)
+{
+    uint64_t hash = 14695981039346656037ull;
+    if (draw_data == NULL)
+        return hash;
+    for (int n = 0; n < draw_data->CmdListsCount; ++n)
+    {
+        const ImDrawList* list = draw_data->CmdLists[n];
+        hash = HashWords(hash, list->VtxBuffer.Data, (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert));
+        // Índices de 16 bits: um a mais, se a quantidade for ímpar, cai fora
+        // da palavra; os comandos abaixo dizem quantos são de qualquer jeito.
+        hash = HashWords(hash, list->IdxBuffer.Data, (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx));
+        for (int c = 0; c < list->CmdBuffer.Size; ++c)
+        {
+            const ImDrawCmd& cmd = list->CmdBuffer[c];
+            uint32_t fields[8];
+            fields[0] = cmd.ElemCount;
+            memcpy(&fields[1], &cmd.ClipRect, sizeof(float) * 4);
+            fields[5] = (uint32_t)(uintptr_t)cmd.TextureId;
+            fields[6] = cmd.VtxOffset;
+            fields[7] = cmd.IdxOffset;
+            hash = HashWords(hash, fields, sizeof(fields));
+        }
+    }
+    return hash;
+}
@@ -0,0 +1,228 @@
+#include "ui_renderer.h"
+#include "profiler.h"
+#include "shaders.h"
+
+#include <cstring>
+
+// Tamanho inicial do buffer: suficiente para a janela "Settings" e o
+// profiler. A demo da ImGui aberta precisa de umas quatro vezes isto.
+static const size_t INITIAL_CAPACITY = 256 * 1024;
+
+UiRenderer::UiRenderer()
+    : m_gpu(NULL), m_capacity(0), m_projection_uniform(-1),
+      m_projection_pos(0.0f, 0.0f), m_projection_size(0.0f, 0.0f), m_premultiplied(false)
+{
+    ForgetState();
+}
+
+void UiRenderer::Init(GpuResourceManager& gpu)
+{
+    m_gpu = &gpu;
+    GpuShader vertex_shader = gpu.AdoptShader("shader_ui_vertex.glsl", LoadShader_Vertex("../src/shader_ui_vertex.glsl"));
+    GpuShader fragment_shader = gpu.AdoptShader("shader_ui_fragment.glsl", LoadShader_Fragment("../src/shader_ui_fragment.glsl"));
+    m_program = gpu.AdoptProgram("programa da interface", CreateGpuProgram(vertex_shader.Id(), fragment_shader.Id()));
+    GLuint program_id = m_program.Id();
+
+    // O sampler lê sempre da unidade de textura 0: o uniform é definido uma
+    // vez, e fica guardado no programa.
+    m_projection_uniform = glGetUniformLocation(program_id, "projection");
+    glUseProgram(program_id);
+    glUniform1i(glGetUniformLocation(program_id, "textura"), 0);
+    glUseProgram(0);
+
+    // O mesmo buffer guarda os vértices e os índices; as duas ligações
+    // ficam no VAO, e continuam valendo quando o buffer é realocado.
+    m_vertex_array = gpu.CreateVertexArray("VAO da interface");
+    m_buffer = gpu.CreateBuffer("buffer da interface");
+    glBindVertexArray(m_vertex_array.Id());
+    glBindBuffer(GL_ARRAY_BUFFER, m_buffer.Id());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer.Id());
+    m_capacity = INITIAL_CAPACITY;
+    m_projection_size = ImVec2(0.0f, 0.0f);
+    gpu.BufferData(m_buffer.Id(), GL_ARRAY_BUFFER, (GLsizeiptr)m_capacity, NULL, GL_STREAM_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(0, 2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (void*)IM_OFFSETOF(ImDrawVert, pos));
+    glVertexAttribPointer(1, 2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (void*)IM_OFFSETOF(ImDrawVert, uv));
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (void*)IM_OFFSETOF(ImDrawVert, col));
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void UiRenderer::Shutdown()
+{
+    m_buffer.Reset();
+    m_vertex_array.Reset();
+    m_program.Reset();
+    m_capacity = 0;
+    m_gpu = NULL;
+}
+
+void UiRenderer::SetupRenderState(const ImDrawData* draw_data, RenderCounters& counters)
+{
+    glEnable(GL_BLEND);
+    if (m_premultiplied)
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    else
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
+
+    int fb_width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    int fb_height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    glViewport(0, 0, fb_width, fb_height);
+
+    counters.UseProgram(m_program.Id());
+    counters.BindVertexArray(m_vertex_array.Id());
+
+    // A matriz fica guardada no programa: só é enviada quando a área da
+    // interface muda.
+    if (draw_data->DisplayPos.x != m_projection_pos.x || draw_data->DisplayPos.y != m_projection_pos.y ||
+        draw_data->DisplaySize.x != m_projection_size.x || draw_data->DisplaySize.y != m_projection_size.y)
+    {
+        float L = draw_data->DisplayPos.x;
+        float R = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
+        float T = draw_data->DisplayPos.y;
+        float B = draw_data->DisplayPos.y + draw_data->DisplaySize.y;
+        glm::mat4 projection(2.0f / (R - L), 0.0f,            0.0f, 0.0f,
+                             0.0f,           2.0f / (T - B),  0.0f, 0.0f,
+                             0.0f,           0.0f,           -1.0f, 0.0f,
+                             (R + L) / (L - R), (T + B) / (B - T), 0.0f, 1.0f);
+        counters.UniformMatrix4fv(m_projection_uniform, projection);
+        m_projection_pos = draw_data->DisplayPos;
+        m_projection_size = draw_data->DisplaySize;
+    }
+
+    ForgetState();
+}
+
+void UiRenderer::ForgetState()
+{
+    m_bound_texture = 0;
+    m_scissor[0] = m_scissor[1] = m_scissor[2] = m_scissor[3] = -1;
+}
+
+// Copia os vértices e depois os índices de todas as listas para o buffer,
+// que já está ligado (pelo VAO) a GL_ELEMENT_ARRAY_BUFFER.
+void UiRenderer::Upload(const ImDrawData* draw_data, size_t vertex_bytes, size_t index_bytes, RenderCounters& counters)
+{
+    const size_t total = vertex_bytes + index_bytes;
+    if (total > m_capacity)
+    {
+        while (m_capacity < total)
+            m_capacity *= 2;
+        m_gpu->BufferData(m_buffer.Id(), GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)m_capacity, NULL, GL_STREAM_DRAW);
+    }
+
+    // GL_MAP_INVALIDATE_BUFFER_BIT: o conteúdo anterior é descartado, e o
+    // driver pode nos dar memória nova em vez de esperar a GPU terminar de
+    // ler o frame anterior.
+    char* dst = (char*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, (GLsizeiptr)total,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst != NULL)
+    {
+        char* vertices = dst;
+        char* indices = dst + vertex_bytes;
+        for (int n = 0; n < draw_data->CmdListsCount; ++n)
+        {
+            const ImDrawList* list = draw_data->CmdLists[n];
+            size_t list_vertex_bytes = (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert);
+            size_t list_index_bytes = (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx);
+            memcpy(vertices, list->VtxBuffer.Data, list_vertex_bytes);
+            memcpy(indices, list->IdxBuffer.Data, list_index_bytes);
+            vertices += list_vertex_bytes;
+            indices += list_index_bytes;
+        }
+        if (glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER))
+        {
+            counters.Add(COUNTER_BYTES_UPLOADED, (uint64_t)total);
+            return;
+        }
+    }
+
+    // Sem mapeamento (ou se o conteúdo foi perdido ao desmapear), uma
+    // cópia por lista.
+    size_t vertex_offset = 0, index_offset = vertex_bytes;
+    for (int n = 0; n < draw_data->CmdListsCount; ++n)
+    {
+        const ImDrawList* list = draw_data->CmdLists[n];
+        size_t list_vertex_bytes = (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert);
+        size_t list_index_bytes = (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx);
+        m_gpu->BufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)vertex_offset, (GLsizeiptr)list_vertex_bytes, list->VtxBuffer.Data);
+        m_gpu->BufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)index_offset, (GLsizeiptr)list_index_bytes, list->IdxBuffer.Data);
+        vertex_offset += list_vertex_bytes;
+        index_offset += list_index_bytes;
+    }
+}
+
+void UiRenderer::RenderDrawData(const ImDrawData* draw_data, RenderCounters& counters, bool premultiplied)
+{
+    PROFILE_SCOPE("UiRenderer::RenderDrawData");
+    int fb_width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    int fb_height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    if (fb_width <= 0 || fb_height <= 0 || draw_data->CmdListsCount == 0 || !m_program)
+        return;
+
+    const size_t vertex_bytes = (size_t)draw_data->TotalVtxCount * sizeof(ImDrawVert);
+    const size_t index_bytes = (size_t)draw_data->TotalIdxCount * sizeof(ImDrawIdx);
+    m_premultiplied = premultiplied;
+    SetupRenderState(draw_data, counters);
+    Upload(draw_data, vertex_bytes, index_bytes, counters);
+
+    const ImVec2 clip_off = draw_data->DisplayPos;
+    const ImVec2 clip_scale = draw_data->FramebufferScale;
+    const GLenum index_type = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    GLint list_base_vertex = 0;           // primeiro vértice da lista no buffer
+    size_t list_first_index = vertex_bytes; // posição (em bytes) do primeiro índice da lista
+    for (int n = 0; n < draw_data->CmdListsCount; ++n)
+    {
+        const ImDrawList* list = draw_data->CmdLists[n];
+        for (int c = 0; c < list->CmdBuffer.Size; ++c)
+        {
+            const ImDrawCmd* cmd = &list->CmdBuffer[c];
+            if (cmd->UserCallback != NULL)
+            {
+                if (cmd->UserCallback == ImDrawCallback_ResetRenderState)
+                    SetupRenderState(draw_data, counters);
+                else
+                {
+                    cmd->UserCallback(list, cmd);
+                    // A função pode ter mudado qualquer estado.
+                    ForgetState();
+                }
+                continue;
+            }
+
+            ImVec4 clip((cmd->ClipRect.x - clip_off.x) * clip_scale.x, (cmd->ClipRect.y - clip_off.y) * clip_scale.y,
+                        (cmd->ClipRect.z - clip_off.x) * clip_scale.x, (cmd->ClipRect.w - clip_off.y) * clip_scale.y);
+            if (clip.x >= fb_width || clip.y >= fb_height || clip.z < 0.0f || clip.w < 0.0f)
+                continue;
+
+            int scissor[4] = { (int)clip.x, (int)(fb_height - clip.w), (int)(clip.z - clip.x), (int)(clip.w - clip.y) };
+            if (memcmp(scissor, m_scissor, sizeof(scissor)) != 0)
+            {
+                glScissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+                memcpy(m_scissor, scissor, sizeof(scissor));
+            }
+            GLuint texture = (GLuint)(intptr_t)cmd->TextureId;
+            if (texture != m_bound_texture)
+            {
+                counters.BindTexture(GL_TEXTURE_2D, texture);
+                m_bound_texture = texture;
+            }
+            counters.DrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)cmd->ElemCount, index_type,
+                                            (void*)(list_first_index + cmd->IdxOffset * sizeof(ImDrawIdx)),
+                                            list_base_vertex + (GLint)cmd->VtxOffset);
+        }
+        list_base_vertex += list->VtxBuffer.Size;
+        list_first_index += (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx);
+    }
+
+    // Devolve o estado que o resto do programa espera.
+    counters.BindVertexArray(0);
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}